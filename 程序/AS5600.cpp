@@ -1,6 +1,4 @@
 #include "AS5600.h"
-#include "Wire.h"
-#include <Arduino.h> 
 
 // ============================================================================
 // 宏定义：_2PI
@@ -20,32 +18,15 @@ double Sensor_AS5600::getSensorAngle() {
   uint8_t angle_reg_msb = 0x0C;
 
   // 读取缓冲区：存储从传感器读取的2个字节数据
-  byte readArray[2];
+  uint8_t readArray[2];
   uint16_t readValue = 0;
 
   // ============================================================================
-  // 第一步：I2C通信初始化
+  // 第一步、第二步：I2C通信初始化并从传感器读取数据
+  // 说明：向设备0x36写入角度寄存器地址（重复起始），再读取2个字节
+  //       收到的字节数不足时记为读取失败，由Sensor_update沿用上次角度
   // ============================================================================
-  
-  // 开始I2C传输，指定AS5600设备地址0x36
-  wire->beginTransmission(0x36);
-  // 写入要读取的寄存器地址（角度寄存器高位）
-  wire->write(angle_reg_msb);
-  // 结束传输但不释放总线（false参数保持连接）
-  wire->endTransmission(false);
-
-  // ============================================================================
-  // 第二步：从传感器读取数据
-  // ============================================================================
-  
-  // 修复：明确指定参数类型，避免重载解析不明确
-  // 从设备0x36请求2个字节的数据
-  wire->requestFrom((uint8_t)0x36, (uint8_t)2); 
-  
-  // 循环读取2个字节的数据
-  for (byte i=0; i < 2; i++) {
-    readArray[i] = wire->read();  // 读取一个字节并存入缓冲区
-  }
+  read_ok = halI2CReadReg(i2c_bus, 0x36, angle_reg_msb, readArray, 2) == 2;
 
   // ============================================================================
   // 第三步：数据解析和角度计算
@@ -83,34 +64,32 @@ Sensor_AS5600::Sensor_AS5600(int Mot_Num) {
 // ============================================================================
 // 函数：Sensor_init
 // 功能：初始化AS5600传感器硬件和软件状态
-// 参数：_wire - I2C总线对象指针
+// 参数：_i2c_bus - I2C总线编号（总线已由halI2CBegin初始化）
 // 说明：执行传感器硬件初始化和状态变量初始化
 // ============================================================================
-void Sensor_AS5600::Sensor_init(TwoWire* _wire) {
-    // 保存I2C总线对象引用
-    wire = _wire;
+void Sensor_AS5600::Sensor_init(uint8_t _i2c_bus) {
+    // 保存I2C总线编号
+    i2c_bus = _i2c_bus;
     
-    // 初始化I2C总线
-    wire->begin();   // 电机Sensor I2C总线初始化
-    delay(500);      // 等待传感器稳定（500ms）
+    halDelayMs(500);  // 等待传感器稳定（500ms）
     
     // 预读取角度值，确保传感器正常工作
     getSensorAngle(); 
-    delayMicroseconds(1);
+    halDelayUs(1);
     
     // 初始化速度计算相关变量
     vel_angle_prev = getSensorAngle();      // 保存初始角度用于速度计算
-    vel_angle_prev_ts = micros();          // 记录初始时间戳
+    vel_angle_prev_ts = halMicros();          // 记录初始时间戳
     
-    delay(1);  // 短暂延迟
+    halDelayMs(1);  // 短暂延迟
     
     // 再次预读取，确保数据稳定
     getSensorAngle(); 
-    delayMicroseconds(1);
+    halDelayUs(1);
     
     // 初始化位置跟踪变量
     angle_prev = getSensorAngle();          // 保存当前角度值
-    angle_prev_ts = micros();              // 记录当前时间戳
+    angle_prev_ts = halMicros();           // 记录当前时间戳
 }
 
 // ============================================================================
@@ -121,16 +100,24 @@ void Sensor_AS5600::Sensor_init(TwoWire* _wire) {
 void Sensor_AS5600::Sensor_update() {
     // 读取当前传感器角度
     float val = getSensorAngle();
+    update_ts = halMicros();
+    
+    // I2C读取失败：收到的数据无效，保持上次角度和时间戳（故障管理器统计连续失败次数）
+    if (!read_ok) {
+        i2c_fail_streak++;
+        return;
+    }
+    i2c_fail_streak = 0;
     
     // 更新时间戳
-    angle_prev_ts = micros();
+    angle_prev_ts = update_ts;
     
     // 计算角度变化量
     float d_angle = val - angle_prev;
     
     // 圈数检测：如果角度变化超过0.8圈（约288度）
     // 说明可能发生了圈数跨越（从2π跳转到0或反之）
-    if(abs(d_angle) > (0.8f * _2PI)) {
+    if(fabsf(d_angle) > (0.8f * _2PI)) {
         // 根据变化方向增加或减少圈数计数
         full_rotations += (d_angle > 0) ? -1 : 1; 
     }
@@ -167,7 +154,8 @@ float Sensor_AS5600::getAngle() {
 // ============================================================================
 float Sensor_AS5600::getVelocity() {
     // 计算采样时间（秒）
-    float Ts = (angle_prev_ts - vel_angle_prev_ts) * 1e-6;
+    // 时间戳按32位回绕相减，再按有符号解释（与原long类型在ESP32上的行为一致）
+    float Ts = (int32_t)(angle_prev_ts - vel_angle_prev_ts) * 1e-6;
     
     // 异常时间间隔处理
     if(Ts <= 0) Ts = 1e-3f;  // 如果时间间隔异常，设为1ms
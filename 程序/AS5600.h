@@ -1,5 +1,4 @@
-#include <Arduino.h> 
-#include "Wire.h"
+#include "HAL.h"
 
 // ============================================================================
 // 头文件保护宏（建议添加）
@@ -27,10 +26,10 @@ class Sensor_AS5600
     // ============================================================================
     // 函数：Sensor_init
     // 功能：初始化传感器硬件和软件状态
-    // 参数：_wire - I2C总线对象指针，默认使用标准Wire对象
-    // 说明：执行I2C总线初始化和传感器状态初始化
+    // 参数：_i2c_bus - I2C总线编号（需先用halI2CBegin初始化），默认总线0
+    // 说明：执行传感器状态初始化
     // ============================================================================
-    void Sensor_init(TwoWire* _wire = &Wire);
+    void Sensor_init(uint8_t _i2c_bus = 0);
     
     // ============================================================================
     // 函数：Sensor_update
@@ -71,6 +70,15 @@ class Sensor_AS5600
     // ============================================================================
     double getSensorAngle();
     
+    // ============================================================================
+    // 函数：readOk / getFailStreak / getUpdateTimestamp
+    // 功能：最近一次I2C读取是否成功、连续失败次数、最近一次Sensor_update的时间戳
+    // 说明：供故障管理器使用；读取失败时getAngle()保持上次有效角度
+    // ============================================================================
+    bool readOk() const { return read_ok; }
+    uint32_t getFailStreak() const { return i2c_fail_streak; }
+    uint32_t getUpdateTimestamp() const { return update_ts; }
+    
   private:
     // ============================================================================
     // 私有成员变量：系统配置和状态
@@ -92,7 +100,7 @@ class Sensor_AS5600
     float angle_prev = 0;        //!< 最后一次调用getSensorAngle()的输出结果
                                 //!< 用于得到完整的圈数和速度计算
     
-    long angle_prev_ts = 0;      //!< 上次调用getAngle的时间戳（微秒）
+    uint32_t angle_prev_ts = 0;  //!< 上次调用getAngle的时间戳（微秒）
                                 //!< 用于计算时间间隔和速度
     
     // ============================================================================
@@ -102,7 +110,7 @@ class Sensor_AS5600
     float vel_angle_prev = 0;    //!< 最后一次调用getVelocity时的角度
                                 //!< 用于速度计算的差分基准
     
-    long vel_angle_prev_ts = 0;  //!< 最后速度计算时间戳（微秒）
+    uint32_t vel_angle_prev_ts = 0;  //!< 最后速度计算时间戳（微秒）
                                 //!< 用于计算速度的时间间隔
     
     // ============================================================================
@@ -119,8 +127,12 @@ class Sensor_AS5600
     // I2C通信相关变量
     // ============================================================================
     
-    TwoWire* wire;  //!< I2C总线对象指针
-                    //!< 指向用于与AS5600通信的I2C总线对象
+    uint8_t i2c_bus = 0;  //!< I2C总线编号
+                          //!< 用于与AS5600通信的HAL I2C总线
+    
+    bool read_ok = true;           //!< 最近一次I2C读取是否收到完整数据
+    uint32_t i2c_fail_streak = 0;  //!< 连续读取失败次数
+    uint32_t update_ts = 0;        //!< 最近一次Sensor_update的时间戳（读取失败时也更新）
 };
 
 // ============================================================================
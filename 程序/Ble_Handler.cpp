@@ -1,6 +1,8 @@
 #include "Ble_Handler.h"
 #include "FOC.h"
+#if HAL_HAS_BLE
 #include <BLE2902.h>
+#endif
 
 // ============================================================================
 // 全局变量定义
@@ -10,19 +12,29 @@
 float ble_motor_target = 0.0f;    //!< BLE接收到的电机目标值（角度/速度/电流）
 bool new_command = false;         //!< 新命令标志，表示有新控制指令需要处理
 uint8_t data_scale_type = 0;      //!< 数据类型标识：0=角度，1=速度，2=电流
-uint8_t my_device_id = 6;         //!< 本设备ID，用于多设备系统区分
+uint8_t my_device_id = MY_DEVICE_ID;  //!< 本设备ID，用于多设备系统区分（启动时从NVS读取）
+static uint8_t my_slot = 0;           //!< 上位机分配的槽位（0为未分配）
+static uint8_t my_slot_epoch = 0;     //!< 槽位表纪元号
+static bool my_id_save_pending = false;  //!< 新ID尚未写入NVS（由deviceIdService()在电机停止跟踪指令时写入）
 
 // BLE服务器相关全局变量
 bool deviceConnected = false;     //!< 当前设备连接状态
 bool oldDeviceConnected = false;  //!< 前次设备连接状态，用于状态变化检测
+#if HAL_HAS_BLE
 BLEServer* pServer = nullptr;     //!< BLE服务器对象指针
 BLEService* pService = nullptr;    //!< BLE服务对象指针
 BLECharacteristic* pTxCharacteristic = nullptr;  //!< 发送特征值对象指针
 BLECharacteristic* pRxCharacteristic = nullptr;  //!< 接收特征值对象指针
+#endif
 
 // 最近一次 MULTI_STRUCT 解析结果
 MultiStructParsed last_multi_struct_cmd = {};
 
+// BLE传输（FOC_Command.h）：回复和二进制遥测都经TX特征值通知；
+// 遥测默认关闭（上位机用CONFIG_OP_TELEMETRY按连接开启），心跳照常发送
+static bool bleTelemetry(const uint8_t* data, size_t len);
+static const CommandTransport ble_transport = {"BLE", sendBLEResponse, bleTelemetry, 0};
+
 // ============================================================================
 // BLE UUID定义
 // 说明：使用标准UUID格式，确保与客户端匹配
@@ -39,8 +51,7 @@ MultiStructParsed last_multi_struct_cmd = {};
 // ============================================================================
 void bleDebugPrint(const char* message) {
 #if BLE_DEBUG
-    Serial.print("[BLE] ");
-    Serial.println(message);
+    halPrintf("[BLE] %s\n", message);
 #endif
 }
 
@@ -54,6 +65,77 @@ uint8_t getMyDeviceID() {
     return my_device_id;
 }
 
+// ============================================================================
+// 函数：setMyDeviceID / loadMyDeviceID
+// 功能：运行时设置设备ID/启动时读取
+// 说明：新ID立即用于指令寻址、回复和CAN帧ID；BLE广播名在下次启动时更新。
+//       setMyDeviceID()在指令解析中调用（控制环内），只记录待写入，NVS写入由deviceIdService()完成
+// ============================================================================
+bool setMyDeviceID(uint8_t id) {
+    if (id < 1 || id > MAX_MOTORS) return false;
+    my_device_id = id;
+    my_id_save_pending = true;
+    return true;
+}
+
+bool loadMyDeviceID() {
+    uint8_t id;
+    my_id_save_pending = false;
+    if (!halNvsRead(DEVICE_ID_NVS_KEY, &id, 1) || id < 1 || id > MAX_MOTORS) return false;
+    my_device_id = id;
+    return true;
+}
+
+void setMySlot(uint8_t slot, uint8_t epoch) {
+    my_slot = slot;
+    my_slot_epoch = epoch;
+}
+
+uint8_t getMySlot() { return my_slot; }
+uint8_t getMySlotEpoch() { return my_slot_epoch; }
+
+// 电机正在跟踪指令（看门狗ARMED/STOPPING且无故障）
+static bool deviceIdMotorActive() {
+    uint8_t state = watchdogStatus().state;
+    return !faultActive() && (state == WATCHDOG_ARMED || state == WATCHDOG_STOPPING);
+}
+
+bool deviceIdSaveDeferred() { return my_id_save_pending && deviceIdMotorActive(); }
+
+// ============================================================================
+// 函数：deviceIdService
+// 功能：把待写入的设备ID写入NVS
+// 说明：NVS提交可能擦除扇区，阻塞数毫秒到数十毫秒，期间控制环停顿；
+//       因此只在电机未跟踪指令时（尚未收到指令、看门狗已停车或故障锁存）写入，
+//       并先输出零占空比，不让上一周期的电压在停顿期间继续作用；写入后重新开始控制周期测量并复位三环PID，
+//       停顿既不计为控制环超时，也不按停顿时长积分
+// ============================================================================
+void deviceIdService() {
+    if (!my_id_save_pending || deviceIdMotorActive()) return;
+    my_id_save_pending = false;
+    setPwm(0, 0, 0);
+    uint8_t id = my_device_id;
+    bool saved = halNvsWrite(DEVICE_ID_NVS_KEY, &id, 1);
+    faultRestartPeriod();
+    halPrintf("ID_%s,%d\n", saved ? "SAVED" : "UNSAVED", id);
+}
+
+void deviceIdCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (*args) {
+        long id = strtol(args, NULL, 10);
+        if (id < 1 || id > MAX_MOTORS) {
+            halPrintf("ID_ERROR,1..%d\n", MAX_MOTORS);
+            return;
+        }
+        setMyDeviceID((uint8_t)id);
+        halPrintf("ID_SET,%d,PENDING\n", my_device_id);  // 写入NVS后输出ID_SAVED/ID_UNSAVED
+        return;
+    }
+    halPrintf("ID,%d,slot=%d,epoch=%d%s\n", my_device_id, my_slot, my_slot_epoch,
+              my_id_save_pending ? ",PENDING" : "");
+}
+
 // ============================================================================
 // 函数：floatToInt16
 // 功能：浮点数转换为16位整数（带缩放）
@@ -81,360 +163,81 @@ float int16ToFloat(int16_t value, float scale) {
 
 // ============================================================================
 // 函数：parseDirectCommandData
-// 功能：解析直接命令数据包
-// 参数：data - 接收到的原始数据包
-// 说明：支持多种数据包格式，包括单电机控制、多电机批量控制等
+// 功能：解析一帧BLE写入数据（不带序号前缀）
+// 参数：data/length - 接收到的原始数据包（直接解析调用者的缓冲区，不复制）
+// 说明：解码与指令语义在FOC_Command.cpp中实现，各传输共用
 // ============================================================================
-void parseDirectCommandData(const std::string& data) {
-    char debugMsg[100];  // 调试信息缓冲区
-    uint8_t my_id = getMyDeviceID();  // 获取本设备ID
-    
-    // ============================================================================
-    // 第一步：调试信息输出和基本检查
-    // ============================================================================
-    
-    // 增强调试信息：分隔线与包长度输出
-    Serial.println("==========================================");
-    Serial.printf("[BLE调试] 开始解析直接命令数据，长度: %d\n", data.length());
-    
-    // 打印原始数据的十六进制表示（方便调试）
-    Serial.print("[BLE调试] 原始数据(HEX): ");
-    for (int i = 0; i < data.length(); i++) {
-        Serial.printf("%02X ", (uint8_t)data[i]);  // 把char强制为uint8_t再打印为两位16进制
-    }
-    Serial.println();
-    
-    // 基本长度检查：至少3字节（用以判断帧头或包类型）
-    if (data.length() < 3) {
-        snprintf(debugMsg, sizeof(debugMsg), "数据太短: %d字节", data.length());
-        bleDebugPrint(debugMsg);
-        Serial.printf("[BLE错误] 数据长度不足，需要至少3字节，实际: %d\n", data.length());
-        return;
-    }
-    
-    // ============================================================================
-    // 第二步：帧头检测和包类型识别
-    // ============================================================================
-    
-    // 帧头检测：看前两字节是否为0xAA 0x55，并且第三字节要是有效包类型
-    bool has_frame_header = false;
-    if (data.length() >= 2 && data[0] == 0xAA && data[1] == 0x55) {
-        // 支持SINGLE/MULTI/MULTI_STRUCT三种类型
-        if (data.length() >= 3 && (data[2] == PACKET_TYPE_SINGLE || data[2] == PACKET_TYPE_MULTI || data[2] == PACKET_TYPE_MULTI_STRUCT)) {
-            has_frame_header = true;
-            Serial.println("[BLE调试] 检测到有效帧头(AA 55)，跳过帧头解析");
-        } else {
-            Serial.println("[BLE调试] 检测到AA 55但包类型无效，按无帧头处理");
-        }
-    }
-    
-    // 解析包类型（如果存在帧头则跳过前两字节）
-    uint8_t packet_type;
-    if (has_frame_header) {
-        packet_type = data[2];  // 帧头后面的第一个字节是包类型
-    } else {
-        packet_type = data[0];  // 无帧头则第1字节就是包类型
-    }
-    
-    snprintf(debugMsg, sizeof(debugMsg), "直接数据包类型: 0x%02X, My ID: %d", packet_type, my_id);
-    bleDebugPrint(debugMsg);
-    Serial.printf("[BLE调试] 包类型: 0x%02X, 设备ID: %d\n", packet_type, my_id);
-    
-    // ============================================================================
-    // 第三步：根据包类型进行不同处理
-    // ============================================================================
-    
-    if (packet_type == PACKET_TYPE_SINGLE) {  // 单电机控制包
-        // 支持两种单包格式：
-        // - 有帧头的7字节：AA 55 01 DT ID VH VL
-        // - 无帧头的6字节：    01 ID DT VH VL 00（这里按你的注释）
-        int min_length = has_frame_header ? 7 : 6;
-        if (data.length() < min_length) {
-            bleDebugPrint("单电机控制包太短");
-            Serial.printf("[BLE错误] 单电机包长度不足，需要%d字节，实际: %d\n", min_length, data.length());
-            return;
-        }
-        
-        // 根据是否有帧头计算每个字段的偏移
-        int id_offset, type_offset, value_offset;
-        if (has_frame_header) {
-            // 7字节包格式：AA(0) 55(1) 01(2) DT(3) ID(4) VH(5) VL(6)
-            type_offset = 3;  
-            id_offset = 4;    
-            value_offset = 5; 
-        } else {
-            // 6字节包格式假设：01(0) ID(1) DT(2) VH(3) VL(4) 00(5)
-            id_offset = 1;    
-            type_offset = 2;  
-            value_offset = 3; 
-        }
-        
-        uint8_t target_id = data[id_offset];      // 目标设备ID（字节）
-        uint8_t data_type = data[type_offset];    // 数据类型（字节）
-        
-        // 如果目标ID不是本设备则忽略（并不回送）
-        if (target_id != my_id) {
-            snprintf(debugMsg, sizeof(debugMsg), "不是本设备的数据 (期望 %d, 收到 %d)", my_id, target_id);
-            bleDebugPrint(debugMsg);
-            Serial.printf("[BLE调试] 数据不是给本设备的，期望ID: %d, 收到ID: %d，直接返回不发送响应\n", my_id, target_id);
-            new_command = false;
-            return;  // 直接返回，不发送任何响应
-        }
-        
-        // 记录调试信息
-        snprintf(debugMsg, sizeof(debugMsg), "单电机控制 - 目标ID: %d, 数据类型: 0x%02X", target_id, data_type);
-        bleDebugPrint(debugMsg);
-        Serial.printf("[BLE调试] 单电机控制 - 目标ID: %d, 数据类型: 0x%02X\n", target_id, data_type);
-        
-        // 输出缩放系数（假设ANGLE_SCALE是宏或全局变量）
-        Serial.printf("[BLE调试] 使用缩放系数: %.1f\n", ANGLE_SCALE);
-        
-        // 提取2字节的int16_t值（高字节在前）并转换为float（按ANGLE_SCALE）
-        int16_t target_int;
-        target_int = (int16_t)(((uint8_t)data[value_offset] << 8) | (uint8_t)data[value_offset + 1]);
-        
-        float new_target = int16ToFloat(target_int, ANGLE_SCALE);
-        if (fabs(new_target - ble_motor_target) > 0.001f) {
-            ble_motor_target = new_target;
-            new_command = true;
-            Serial.printf("[BLE调试] 目标值改变: %.2f -> %.2f，设置new_command\n", ble_motor_target, new_target);
-        } else {
-            new_command = false;
-            Serial.printf("[BLE调试] 目标值未改变: %.2f，不设置new_command\n", new_target);
-        }
-        
-        snprintf(debugMsg, sizeof(debugMsg), "直接单电机控制接收: %.2f", ble_motor_target);
-        bleDebugPrint(debugMsg);
-        
-        // 额外打印原始字节和解析结果，便于调试
-        Serial.printf("[BLE调试] 直接控制原始字节: %02X %02X, 解析值: %d, 缩放后: %.2f\n",
-                      (uint8_t)data[value_offset], (uint8_t)data[value_offset + 1], target_int, ble_motor_target);
- 
-        // 发送BLE确认响应（格式: "<id>:SINGLE:<value>"）
-        char response[50];
-        snprintf(response, sizeof(response), "%d:SINGLE:%.2f", my_id, ble_motor_target);
-        sendBLEResponse(response);
-        
-    } else if (packet_type == PACKET_TYPE_MULTI) {   // 多电机批量控制包（切片/兼容旧版）
-        Serial.printf("[BLE调试] 开始处理多电机包，长度: %d\n", data.length());
-    
-        // 计算DT偏移（有帧头AA 55时为3；无帧头时为1）
-        int type_offset = has_frame_header ? 3 : 1;
-        if ((int)data.length() <= type_offset) {
-            Serial.printf("[BLE错误] 多电机包长度不足以包含数据类型，长度: %d\n", data.length());
-            return;
-        }
-    
-        // 数据类型与缩放
-        uint8_t data_type = (uint8_t)data[type_offset];
-        float scale = ANGLE_SCALE;
-        if (data_type == DATA_TYPE_VELOCITY) {
-            scale = VELOCITY_SCALE;
-            data_scale_type = 1;
-            Serial.printf("[BLE调试] 使用速度缩放系数: %.2f\n", scale);
-        } else if (data_type == DATA_TYPE_CURRENT) {
-            scale = 1000.0f;
-            data_scale_type = 2;
-            Serial.printf("[BLE调试] 使用电流缩放系数: %.2f\n", scale);
-        } else {
-            data_scale_type = 0;
-            Serial.printf("[BLE调试] 使用角度缩放系数: %.2f\n", scale);
-        }
-    
-        // 优先尝试"切片式MULTI"：AA 55 02 DT START_ID COUNT V(start)..V(end)
-        if (has_frame_header && data.length() >= 6) {
-            int start_id_offset   = type_offset + 1;  // 4
-            int count_offset      = type_offset + 2;  // 5
-            int data_start_offset = type_offset + 3;  // 6
-    
-            uint8_t start_id = (uint8_t)data[start_id_offset];
-            uint8_t count    = (uint8_t)data[count_offset];
-    
-            bool ids_ok = (start_id >= 1 && start_id <= MAX_MOTORS && count >= 1);
-            bool len_ok = ((int)data.length() == data_start_offset + count * 2);
-    
-            if (ids_ok && len_ok) {
-                uint8_t my_id = getMyDeviceID();
-                uint8_t end_id = start_id + count - 1;
-                Serial.printf("[BLE调试] 多电机控制(切片) - DT=0x%02X, 范围: ID %d..%d\n", data_type, start_id, end_id);
-    
-                if (my_id < start_id || my_id > end_id) {
-                    Serial.printf("[BLE调试] 本设备ID %d不在当前切片范围内，忽略\n", my_id);
-                    return;
-                }
-    
-                int index_in_slice = (my_id - start_id);  // 0-based
-                int data_offset = data_start_offset + index_in_slice * 2;
-                if (data_offset + 2 > data.length()) {
-                    Serial.printf("[BLE错误] 数据偏移超出包长度，偏移: %d, 包长度: %d\n", data_offset, data.length());
-                    return;
-                }
-    
-                int16_t target_int = (int16_t)(((uint16_t)(uint8_t)data[data_offset] << 8) | (uint16_t)(uint8_t)data[data_offset + 1]);
-                Serial.printf("[BLE调试] 设备%d原始字节: %02X %02X, 解析值: %d\n",
-                              my_id, (uint8_t)data[data_offset], (uint8_t)data[data_offset + 1], target_int);
-    
-                float new_target = int16ToFloat(target_int, scale);
-                Serial.printf("[BLE调试] 设备%d缩放后目标值: %.2f\n", my_id, new_target);
-    
-                if (fabs(new_target - ble_motor_target) > 0.001f) {
-                    ble_motor_target = new_target;
-                    new_command = true;
-                    Serial.printf("[BLE调试] 设备%d目标值改变: %.2f -> %.2f，设置new_command\n", my_id, ble_motor_target, new_target);
-                } else {
-                    new_command = false;
-                    Serial.printf("[BLE调试] 设备%d目标值未改变: %.2f，不设置new_command\n", my_id, new_target);
-                }
-    
-                char response[50];
-                snprintf(response, sizeof(response), "%d:MULTI:%.2f", my_id, ble_motor_target);
-                sendBLEResponse(response);
-                Serial.printf("[BLE调试] 设备%d收到指令: 多电机控制(切片), 目标值: %.2f\n", my_id, ble_motor_target);
-                return;
-            }
-        }
-    
-        // 兼容旧版"整包10台"格式：AA 55 02 DT V1..V10（总长度24字节）
-        if (has_frame_header && data.length() == 24) {
-            int data_start_offset = type_offset + 1;  // 4
-            uint8_t my_id = getMyDeviceID();
-    
-            if (my_id < 1 || my_id > 10) {
-                Serial.printf("[BLE调试] 旧版整包不包含设备%d的数据\n", my_id);
-                return;
-            }
-    
-            int idx = (my_id - 1);  // 1-based → 0-based
-            int data_offset = data_start_offset + idx * 2;
-            if (data_offset + 2 > data.length()) {
-                Serial.printf("[BLE错误] 数据偏移超出包长度(旧版)，偏移: %d, 包长度: %d\n", data_offset, data.length());
-                return;
-            }
-    
-            int16_t target_int = (int16_t)(((uint16_t)(uint8_t)data[data_offset] << 8) | (uint16_t)(uint8_t)data[data_offset + 1]);
-            Serial.printf("[BLE调试] 设备%d(旧版)原始字节: %02X %02X, 解析值: %d\n",
-                          my_id, (uint8_t)data[data_offset], (uint8_t)data[data_offset + 1], target_int);
-    
-            float new_target = int16ToFloat(target_int, scale);
-            Serial.printf("[BLE调试] 设备%d(旧版)缩放后目标值: %.2f\n", my_id, new_target);
-    
-            if (fabs(new_target - ble_motor_target) > 0.001f) {
-                ble_motor_target = new_target;
-                new_command = true;
-            } else {
-                new_command = false;
-            }
-    
-            char response[50];
-            snprintf(response, sizeof(response), "%d:MULTI:%.2f", my_id, ble_motor_target);
-            sendBLEResponse(response);
-            Serial.printf("[BLE调试] 设备%d收到指令: 多电机控制(旧版整包), 目标值: %.2f\n", my_id, ble_motor_target);
-            return;
-        }
-    
-        // 其它情况：格式无效
-        Serial.printf("[BLE错误] MULTI格式无效或长度不匹配，len=%d\n", data.length());
-        return;
-        
-    } else if (packet_type == PACKET_TYPE_MULTI_STRUCT) {  // 结构体多电机控制包
-        Serial.printf("[BLE调试] 开始处理结构体多电机包，长度: %d\n", data.length());
-
-        // 计算偏移：AA 55 03 DT COUNT | items...
-        int type_offset  = has_frame_header ? 3 : 1;
-        int count_offset = type_offset + 1;
-        int items_offset = type_offset + 2;
+void parseDirectCommandData(const uint8_t* data, size_t length) {
+    cmdDispatch(CMD_TRANSPORT_BLE, data, length);
+}
 
-        if ((int)data.length() < items_offset) {
-            Serial.printf("[BLE错误] MULTI_STRUCT包长度不足，len=%d\n", data.length());
-            return;
-        }
+// ============================================================================
+// 接收FIFO
+// 说明：单生产者（BLE接收回调）/单消费者（BLE_Server_Loop）环形队列，
+//       生产者只写head和槽位，消费者只写tail，不加锁；写完槽位后加内存屏障再发布head。
+//       队列满时丢弃新到的帧并计数（生产者不能安全地挤掉消费者可能正在读的最旧帧）
+// ============================================================================
+typedef struct {
+    uint8_t len;                          //!< 帧长度
+    uint8_t data[BLE_RX_SLOT_SIZE];       //!< 帧数据（含序号前缀）
+} BleRxSlot;
 
-        uint8_t dt = (uint8_t)data[type_offset];      // 数据类型
-        uint8_t count = (uint8_t)data[count_offset];  // 条目数量
-
-        // 根据数据类型选择缩放系数
-        float scale = ANGLE_SCALE;
-        if (dt == DATA_TYPE_VELOCITY) {
-            scale = VELOCITY_SCALE;
-            data_scale_type = 1;
-            Serial.printf("[BLE调试] 使用速度缩放系数: %.2f\n", scale);
-        } else if (dt == DATA_TYPE_CURRENT) {
-            scale = 1000.0f;
-            data_scale_type = 2;
-            Serial.printf("[BLE调试] 使用电流缩放系数: %.2f\n", scale);
-        } else {
-            data_scale_type = 0;
-            Serial.printf("[BLE调试] 使用角度缩放系数: %.2f\n", scale);
-        }
+static BleRxSlot ble_rx_fifo[BLE_RX_FIFO_DEPTH];
+static volatile uint16_t ble_rx_head = 0;   //!< 下一个写入位置（生产者递增）
+static volatile uint16_t ble_rx_tail = 0;   //!< 下一个读取位置（消费者递增）
+static BleRxStats ble_rx_stats = {};
 
-        int expected_min_len = items_offset + count * 3;  // 每个条目3字节
-        if ((int)data.length() < expected_min_len) {
-            Serial.printf("[BLE错误] MULTI_STRUCT包长度不匹配，期望≥%d，实际: %d\n", expected_min_len, data.length());
-            return;
-        }
+const BleRxStats& bleRxStats() { return ble_rx_stats; }
 
-        uint8_t my_id = getMyDeviceID();
-        bool found = false;  // 是否找到本设备数据的标志
-
-        // 遍历所有条目查找本设备数据
-        for (int i = 0; i < count; i++) {
-            int item_offset = items_offset + i * 3;  // 每个条目3字节
-            uint8_t id  = (uint8_t)data[item_offset + 0];  // 设备ID
-            uint8_t vh  = (uint8_t)data[item_offset + 1];  // 数值高位
-            uint8_t vl  = (uint8_t)data[item_offset + 2];  // 数值低位
-            int16_t raw = (int16_t)(((uint16_t)vh << 8) | (uint16_t)vl);  // 组合为16位整数
-
-            Serial.printf("[BLE调试] 条目%d: ID=%d 原始字节=%02X %02X 原始值=%d\n", i, id, vh, vl, raw);
-
-            if (id == my_id) {  // 找到本设备数据
-                float target = int16ToFloat(raw, scale);  // 转换为浮点数
-
-                // 保存到结构体（用于后续处理）
-                last_multi_struct_cmd.packet_type = PACKET_TYPE_MULTI_STRUCT;
-                last_multi_struct_cmd.device_id   = my_id;
-                last_multi_struct_cmd.data_type   = dt;
-                last_multi_struct_cmd.raw_value   = raw;
-                last_multi_struct_cmd.scaled_value= target;
-                last_multi_struct_cmd.count       = count;
-
-                // 更新执行目标（与主循环对接）
-                if (fabs(target - ble_motor_target) > 0.001f) {
-                    ble_motor_target = target;
-                    new_command = true;
-                    Serial.printf("[BLE调试] 设备%d目标更新: %.2f\n", my_id, target);
-                } else {
-                    new_command = false;
-                    Serial.printf("[BLE调试] 设备%d目标未改变: %.2f\n", my_id, target);
-                }
-
-                // 发送响应
-                char response[50];
-                snprintf(response, sizeof(response), "%d:MULTI_STRUCT:%.2f", my_id, ble_motor_target);
-                sendBLEResponse(response);
-
-                Serial.printf("[BLE调试] 设备%d收到结构体指令: DT=0x%02X, 目标=%.2f, COUNT=%d\n", my_id, dt, ble_motor_target, count);
-                found = true;
-                break;
-            }
-        }
+// ============================================================================
+// 函数：bleRxPush
+// 功能：复制一帧到接收FIFO（在BLE接收回调中调用）
+// 参数：data/len - 写入特征值的数据
+// 返回值：入队成功返回true；队列满或帧超长时丢弃并返回false
+// ============================================================================
+bool bleRxPush(const uint8_t* data, size_t len) {
+    if (len == 0) return false;
+    if (len > BLE_RX_SLOT_SIZE) {
+        ble_rx_stats.oversize++;
+        return false;
+    }
+    uint16_t head = ble_rx_head;
+    uint16_t used = (uint16_t)(head - ble_rx_tail);
+    if (used >= BLE_RX_FIFO_DEPTH) {
+        ble_rx_stats.overflows++;
+        return false;
+    }
+    BleRxSlot& slot = ble_rx_fifo[head & (BLE_RX_FIFO_DEPTH - 1)];
+    memcpy(slot.data, data, len);
+    slot.len = (uint8_t)len;
+    __sync_synchronize();  // 槽位写完后再发布head
+    ble_rx_head = (uint16_t)(head + 1);
+    ble_rx_stats.frames++;
+    if (used + 1 > ble_rx_stats.high_water) ble_rx_stats.high_water = (uint8_t)(used + 1);
+    return true;
+}
 
-        if (!found) {
-            Serial.printf("[BLE调试] 本设备ID %d不在MULTI_STRUCT包的%d个条目中，忽略\n", my_id, count);
-            return;
-        }
-    } else {
-        // 未知包类型处理：记录并回复错误响应
-        snprintf(debugMsg, sizeof(debugMsg), "未知的数据包类型: 0x%02X", packet_type);
-        bleDebugPrint(debugMsg);
-        
-        char response[50];
-        snprintf(response, sizeof(response), "%d:ERROR:UNKNOWN_PACKET", my_id);
-        sendBLEResponse(response);
-        
-        Serial.printf("[BLE调试] 设备%d收到未知指令: 类型0x%02X\n", my_id, packet_type);
+// ============================================================================
+// 函数：bleRxDrain
+// 功能：解析FIFO中排队的帧（在控制环所在的loop()中调用）
+// 参数：max_frames - 本次最多解析的帧数（限制单次loop的解析耗时）
+// 返回值：本次处理的帧数
+// 说明：序号检查与解析由cmdReceive()完成（帧可带"A5 序号高 序号低"前缀）
+// ============================================================================
+int bleRxDrain(int max_frames) {
+    int n = 0;
+    while (n < max_frames && ble_rx_tail != ble_rx_head) {
+        __sync_synchronize();  // 读取槽位前确认head已发布
+        const BleRxSlot& slot = ble_rx_fifo[ble_rx_tail & (BLE_RX_FIFO_DEPTH - 1)];
+        if (cmdReceive(CMD_TRANSPORT_BLE, slot.data, slot.len)) ble_rx_stats.processed++;
+        ble_rx_tail = (uint16_t)(ble_rx_tail + 1);
+        n++;
     }
+    return n;
 }
 
+#if HAL_HAS_BLE
+
 // ============================================================================
 // BLE服务器回调类
 // 功能：处理BLE连接状态变化事件
@@ -448,6 +251,7 @@ class MyServerCallbacks: public BLEServerCallbacks {
     // ============================================================================
     void onConnect(BLEServer* pServer) {
         deviceConnected = true;
+        traceRecordConnection(true);
         bleDebugPrint("设备已连接");
     }
 
@@ -459,6 +263,7 @@ class MyServerCallbacks: public BLEServerCallbacks {
     // ============================================================================
     void onDisconnect(BLEServer* pServer) {
         deviceConnected = false;
+        traceRecordConnection(false);
         bleDebugPrint("设备已断开连接");
     }
 };
@@ -468,39 +273,29 @@ class MyCallbacks: public BLECharacteristicCallbacks {
     // 函数：onWrite
     // 功能：接收到数据写入时的回调函数
     // 参数：pCharacteristic - 特征值对象指针
-    // 说明：解析接收到的数据并调用相应的处理函数
+    // 说明：直接读取特征值内部缓冲区（指针+长度），只复制一次到接收FIFO的预分配槽位，
+    //       不构造std::string；原始数据的十六进制输出由解析函数统一打印
     // ============================================================================
     void onWrite(BLECharacteristic *pCharacteristic) {
-        std::string rxValue = pCharacteristic->getValue();  // 获取接收到的数据
-        
-        if (rxValue.length() > 0) {
-            char debugMsg[100];
-            snprintf(debugMsg, sizeof(debugMsg), "收到数据，长度: %d", rxValue.length());
-            bleDebugPrint(debugMsg);
-            
-            // 新增：在串口显示原始接收数据的十六进制格式
-            Serial.print("[BLE接收] 原始数据(HEX): ");
-            for (int i = 0; i < rxValue.length(); i++) {
-                Serial.printf("%02X ", (uint8_t)rxValue[i]);
-            }
-            Serial.println();
-            
-            // 修复：添加更详细的调试信息
-            Serial.printf("[BLE调试] 开始解析数据包，长度: %d\n", rxValue.length());
-            
-            // 修复：直接解析接收到的数据，不检查广播包头
-            // 因为Python客户端发送的是直接数据，不是广播包
-            parseDirectCommandData(rxValue);
+        const uint8_t* rx_data = pCharacteristic->getData();
+        size_t rx_len = pCharacteristic->getLength();
+        if (rx_len == 0) return;
+
+        // 放入接收FIFO，由loop()中的BLE_Server_Loop()按序解析
+        // （写无响应时上位机可连续发送，回调中不做解析，尽快返回）
+        if (!bleRxPush(rx_data, rx_len)) {
+            halPrintf("[BLE错误] 接收队列已满或帧超长，丢弃，长度: %d\n", (int)rx_len);
         }
     }
 };
 
 // BLE服务器初始化函数
 void initBLEServer() {  
-    getMyDeviceID();
-    
-    // 统一为每台设备设置唯一ID与设备名
+    // 设备ID：NVS中已配置的ID优先，否则为编译期默认值；槽位需由上位机重新分配
     my_device_id = MY_DEVICE_ID;
+    loadMyDeviceID();
+    setMySlot(0, 0);
+    cmdRegisterTransport(CMD_TRANSPORT_BLE, &ble_transport);
     char name_buf[32];
     snprintf(name_buf, sizeof(name_buf), "Motor-Controller-%d", my_device_id);
 
@@ -526,7 +321,8 @@ void initBLEServer() {
     // 创建接收特征值（用于接收PC数据）
     pRxCharacteristic = pService->createCharacteristic(
                         CHARACTERISTIC_UUID_RX,
-                        BLECharacteristic::PROPERTY_WRITE  // 写入属性
+                        BLECharacteristic::PROPERTY_WRITE |    // 写入属性（带响应）
+                        BLECharacteristic::PROPERTY_WRITE_NR   // 写无响应：上位机不等ATT响应，可连续发送
                       );
     pRxCharacteristic->setCallbacks(new MyCallbacks());  // 设置回调函数
 
@@ -546,52 +342,209 @@ void initBLEServer() {
 }
 
 
+// ============================================================================
+// 函数：bleNotify
+// 功能：通过TX特征值发送通知
+// 返回值：是否已发送（特征值未创建时返回false）
+// ============================================================================
+static bool bleNotify(const char* text) {
+    if (!pTxCharacteristic) return false;
+    pTxCharacteristic->setValue(text);  // 设置特征值
+    pTxCharacteristic->notify();        // 发送通知
+    return true;
+}
+
+static bool bleNotifyBinary(const uint8_t* data, size_t len) {
+    if (!pTxCharacteristic) return false;
+    pTxCharacteristic->setValue((uint8_t*)data, len);
+    pTxCharacteristic->notify();
+    return true;
+}
+
+// ============================================================================
+// 函数：bleRestartAdvertising
+// 功能：断开连接后重新开始广播
+// ============================================================================
+static void bleRestartAdvertising() {
+    if (pServer) {
+        pServer->startAdvertising();  // 重新广播
+        bleDebugPrint("开始广播，等待连接...");
+    }
+}
+
+#else // !HAL_HAS_BLE
+
+// ============================================================================
+// 主机构建：没有BLE协议栈
+// 说明：连接状态由测试程序直接设置deviceConnected，
+//       响应与心跳通过ble_response_hook交给仿真器/测试程序
+// ============================================================================
+void (*ble_response_hook)(const char* response) = nullptr;
+void (*ble_notify_hook)(const uint8_t* data, size_t len) = nullptr;
+
+// BLE服务器初始化函数（主机构建只设置设备ID）
+void initBLEServer() {
+    my_device_id = MY_DEVICE_ID;
+    loadMyDeviceID();
+    setMySlot(0, 0);
+    cmdRegisterTransport(CMD_TRANSPORT_BLE, &ble_transport);
+    bleDebugPrint("主机构建：BLE服务器由ble_response_hook模拟");
+}
+
+static bool bleNotify(const char* text) {
+    if (!ble_response_hook) return false;
+    ble_response_hook(text);
+    return true;
+}
+
+static bool bleNotifyBinary(const uint8_t* data, size_t len) {
+    if (!ble_notify_hook) return false;
+    ble_notify_hook(data, len);
+    return true;
+}
+
+static void bleRestartAdvertising() {
+    bleDebugPrint("开始广播，等待连接...");
+}
+
+#endif // HAL_HAS_BLE
+
 // 响应发送函数
 void sendBLEResponse(const char* response) {
-    if (deviceConnected && pTxCharacteristic) {
+    if (deviceConnected) {
         try {
-            pTxCharacteristic->setValue(response);  // 设置特征值
-            pTxCharacteristic->notify();            // 发送通知
-            bleDebugPrint("已发送响应");
-            
-            // 新增：在串口显示发送的响应内容
-            Serial.printf("[BLE响应] 发送: %s\n", response);
+            if (bleNotify(response)) {
+                bleDebugPrint("已发送响应");
+                
+                // 新增：在串口显示发送的响应内容
+                halPrintf("[BLE响应] 发送: %s\n", response);
+            }
         } catch (const std::exception& e) {
             bleDebugPrint("发送响应失败");
-            Serial.printf("[BLE错误] 发送响应失败: %s\n", e.what());
+            halPrintf("[BLE错误] 发送响应失败: %s\n", e.what());
         }
     } else {
         bleDebugPrint("设备未连接，无法发送响应");
     }
 }
 
-// 在主循环中需要添加连接状态管理
-void BLE_Server_Loop() {
-    // 处理设备连接状态变化
-    if (!deviceConnected && oldDeviceConnected) {
-        delay(500);  // 给蓝牙栈时间
-        if (pServer) {
-            pServer->startAdvertising();  // 重新广播
-            bleDebugPrint("开始广播，等待连接...");
-        }
-        oldDeviceConnected = deviceConnected;
+// ============================================================================
+// 函数：bleTelemetry
+// 功能：以二进制通知发送一帧遥测（BLE_TELEMETRY_MARKER + 遥测帧）
+// 说明：由cmdTelemetryTick()按本连接设定的频率调用；未连接时不发送（不计数）
+// ============================================================================
+static bool bleTelemetry(const uint8_t* data, size_t len) {
+    if (!deviceConnected || len > TELEMETRY_SIZE) return false;
+    uint8_t frame[TELEMETRY_SIZE + 1];
+    frame[0] = BLE_TELEMETRY_MARKER;
+    memcpy(frame + 1, data, len);
+    return bleNotifyBinary(frame, len + 1);
+}
+
+// ============================================================================
+// 连接状态机
+// ============================================================================
+static BleLinkStatus ble_link = {BLE_LINK_ADVERTISING, 0, 0, 0, 0, 0, 0};
+static uint32_t ble_last_heartbeat_ms = 0;  //!< 最近一次心跳时刻（ms）
+
+const BleLinkStatus& bleLinkStatus() { return ble_link; }
+
+const char* bleLinkStateName(uint8_t state) {
+    switch (state) {
+        case BLE_LINK_CONNECTED: return "CONNECTED";
+        case BLE_LINK_RESTART_WAIT: return "RESTART_WAIT";
+        default: return "ADVERTISING";
     }
-    
-    if (deviceConnected && !oldDeviceConnected) {
-        // 连接建立时的处理
-        oldDeviceConnected = deviceConnected;
-        bleDebugPrint("设备连接已建立");
+}
+
+static void bleLinkEnter(uint8_t state, uint32_t now) {
+    ble_link.state = state;
+    ble_link.state_since_ms = now;
+}
+
+// ============================================================================
+// 函数：bleSendHeartbeat
+// 功能：发送心跳包（带设备ID，便于Python映射）
+// 说明：故障锁存时心跳改为故障报告；正常心跳附带最近处理的序号和丢失/溢出计数，
+//       上位机据此判断流水线发送是否需要降速
+// ============================================================================
+static void bleSendHeartbeat() {
+    char hb[128];
+    const FaultStatus& fs = faultStatus();
+    if (fs.latched != FAULT_NONE) {
+        snprintf(hb, sizeof(hb), "%d:FAULT:%04X:%s", my_device_id, fs.latched, faultName(fs.first));
+    } else {
+        const CommandLinkStats& ls = cmdLinkStats(CMD_TRANSPORT_BLE);
+        snprintf(hb, sizeof(hb), "%d:HEARTBEAT:T=%.0f,ILIM=%.1f,WD=%s,SEQ=%u,LOST=%lu,OVF=%lu,ACC=%lu,REJ=%lu",
+                 my_device_id, thermalState().temperature, thermalCurrentLimit(),
+                 watchdogStateName(watchdogStatus().state), ls.last_seq, (unsigned long)ls.seq_lost,
+                 (unsigned long)ble_rx_stats.overflows, (unsigned long)ls.accepted, (unsigned long)ls.rejected);
     }
-    
-    // 定期发送心跳包（带设备ID，便于Python映射）
-    static unsigned long lastHeartbeat = 0;
-    if (deviceConnected && millis() - lastHeartbeat > 5000) {  // 每5秒发送一次
-        if (pTxCharacteristic) {
-            char hb[32];
-            snprintf(hb, sizeof(hb), "%d:HEARTBEAT", my_device_id);
-            pTxCharacteristic->setValue(hb);
-            pTxCharacteristic->notify();
-        }
-        lastHeartbeat = millis();
+    bleNotify(hb);
+    ble_link.heartbeats++;
+}
+
+// ============================================================================
+// 函数：BLE_Server_Loop
+// 功能：连接状态机与心跳（与FOC三环在同一个loop()中运行）
+// 说明：原实现断开时delay(500)后重新广播，期间电流环停止更新而电机仍通电；
+//       现在记录断开时刻，之后每次调用只比较时间，到时重新广播。
+//       每次调用读取一次毫秒时钟
+// ============================================================================
+void BLE_Server_Loop() {
+    uint32_t now = halMillis();
+    bool connected = deviceConnected;  // 回调可能在其他任务中修改，本次调用使用同一个值
+
+    // 解析接收FIFO中排队的指令（每次最多BLE_RX_DRAIN_PER_LOOP帧）
+    bleRxDrain(BLE_RX_DRAIN_PER_LOOP);
+
+    // 配置包/串口设置的新设备ID，电机停止跟踪指令后写入NVS
+    deviceIdService();
+
+    // 堆分配统计（每秒结算一次）
+    memStatsTick(now);
+
+    // 新故障和看门狗状态变化不等心跳周期，立即上报一次（未连接时丢弃）
+    bool report = faultTakeReport();
+    report = watchdogTakeReport() || report;
+
+    switch (ble_link.state) {
+        case BLE_LINK_CONNECTED:
+            if (!connected) {
+                ble_link.disconnects++;
+                cmdResetSequence(CMD_TRANSPORT_BLE);  // 重连后上位机序号重新开始
+                bleLinkEnter(BLE_LINK_RESTART_WAIT, now);
+                bleDebugPrint("设备连接已断开，等待重新广播");
+                break;
+            }
+            if (report || now - ble_last_heartbeat_ms > BLE_HEARTBEAT_INTERVAL_MS) {
+                bleSendHeartbeat();
+                ble_last_heartbeat_ms = now;
+            }
+            break;
+
+        case BLE_LINK_RESTART_WAIT:
+            if (connected) {
+                // 等待期间又连上（蓝牙栈自动接受了新连接），不再重新广播
+                ble_link.connects++;
+                bleLinkEnter(BLE_LINK_CONNECTED, now);
+                bleDebugPrint("设备连接已建立");
+            } else if (now - ble_link.state_since_ms >= BLE_ADV_RESTART_DELAY_MS) {
+                bleRestartAdvertising();
+                ble_link.adv_restarts++;
+                ble_link.last_adv_restart_ms = now;
+                bleLinkEnter(BLE_LINK_ADVERTISING, now);
+            }
+            break;
+
+        default:  // BLE_LINK_ADVERTISING
+            if (connected) {
+                ble_link.connects++;
+                bleLinkEnter(BLE_LINK_CONNECTED, now);
+                ble_last_heartbeat_ms = now;
+                bleDebugPrint("设备连接已建立");
+            }
+            break;
     }
+    oldDeviceConnected = connected;
 }
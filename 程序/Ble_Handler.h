@@ -13,11 +13,14 @@
 
 // ============================================================================
 // 库文件包含
-// 说明：使用ESP32内置BLE库替代NimBLE库
+// 说明：使用ESP32内置BLE库替代NimBLE库（主机构建时不包含BLE协议栈）
 // ============================================================================
+#include "HAL.h"          //!< 硬件抽象层
+#if HAL_HAS_BLE
 #include <BLEDevice.h>    //!< BLE设备管理库
 #include <BLEUtils.h>     //!< BLE工具库
 #include <BLEScan.h>      //!< BLE扫描库
+#endif
 #include <string>         //!< C++字符串库
 
 // ============================================================================
@@ -38,6 +41,17 @@
 #define PACKET_TYPE_SINGLE 0x01       //!< 单电机控制包 - 针对单个电机的控制指令
 #define PACKET_TYPE_MULTI  0x02       //!< 多电机批量控制包 - 批量控制多个电机
 #define PACKET_TYPE_MULTI_STRUCT 0x03 //!< 多电机结构体包 - 灵活的设备ID-数值配对控制
+#define PACKET_TYPE_CONFIG 0x04       //!< 设备配置包 - 设置设备ID/槽位（须带帧头AA 55，只接受有回复通道的传输）
+#define PACKET_TYPE_MULTI_SLOT 0x05   //!< 多电机槽位包 - 按上位机分配的槽位紧凑排列，跳过缺席的ID
+
+// ============================================================================
+// 配置操作码（PACKET_TYPE_CONFIG的第4字节）
+// 说明：AA 55 04 OP ID 参数..，ID为设备当前ID；QUERY的ID可为0（点对点连接上查询未知设备）
+// ============================================================================
+#define CONFIG_OP_SET_ID   0x01       //!< AA 55 04 01 ID 新ID      写入NVS并立即生效
+#define CONFIG_OP_SET_SLOT 0x02       //!< AA 55 04 02 ID 槽位 纪元 槽位0为取消，掉电不保存
+#define CONFIG_OP_QUERY    0x03       //!< AA 55 04 03 ID          回复当前ID/槽位/纪元
+#define CONFIG_OP_TELEMETRY 0x04      //!< AA 55 04 04 ID HzH HzL  设置本连接的二进制遥测频率（0为关闭，最高5000）
 
 // ============================================================================
 // 数据类型定义
@@ -70,10 +84,15 @@ extern uint8_t my_device_id;          //!< 当前设备ID（缓存） - 用于
 // BLE服务器相关全局变量
 extern bool deviceConnected;          //!< 当前设备连接状态
 extern bool oldDeviceConnected;       //!< 前次设备连接状态 - 用于状态变化检测
+#if HAL_HAS_BLE
 extern BLEServer* pServer;            //!< BLE服务器对象指针
 extern BLEService* pService;          //!< BLE服务对象指针
 extern BLECharacteristic* pTxCharacteristic;  //!< 发送特征值对象指针
 extern BLECharacteristic* pRxCharacteristic;  //!< 接收特征值对象指针
+#else
+extern void (*ble_response_hook)(const char* response);  //!< 主机构建：响应/心跳输出回调
+extern void (*ble_notify_hook)(const uint8_t* data, size_t len);  //!< 主机构建：二进制通知（遥测）回调
+#endif
 
 // ============================================================================
 // 函数声明
@@ -89,17 +108,75 @@ void initBLEServer();
 // ============================================================================
 // 函数：BLE_Server_Loop
 // 功能：BLE服务器主循环处理函数
-// 说明：需要在主循环中定期调用，处理连接状态和发送心跳包
+// 说明：需要在主循环中定期调用，处理连接状态和发送心跳包；
+//       按时间推进连接状态机，每次调用只做常数次判断，从不延时
 // ============================================================================
 void BLE_Server_Loop();
 
 // ============================================================================
-// 函数：parseDirectCommandData
-// 功能：解析直接命令数据包
-// 参数：data - 接收到的原始数据包
-// 说明：支持多种数据包格式，包括单电机控制、多电机批量控制等
+// 连接状态机
+// 说明：断开连接后等待BLE_ADV_RESTART_DELAY_MS（给蓝牙栈释放连接的时间）再重新广播，
+//       等待期间控制环照常运行
+// ============================================================================
+#define BLE_LINK_ADVERTISING   0      //!< 广播中，等待连接
+#define BLE_LINK_CONNECTED     1      //!< 已连接，发送心跳
+#define BLE_LINK_RESTART_WAIT  2      //!< 已断开，等待重新广播
+
+#define BLE_ADV_RESTART_DELAY_MS 500  //!< 断开后到重新广播的间隔（ms）
+#define BLE_HEARTBEAT_INTERVAL_MS 5000  //!< 心跳间隔（ms）
+
+// 二进制遥测通知：BLE_TELEMETRY_MARKER + 遥测帧（FOC_Command.h，TELEMETRY_SIZE字节），
+// 与文本回复共用TX特征值；文本回复以ASCII字符开头，首字节即可区分。
+// 共TELEMETRY_SIZE+1字节，需要协商的MTU不小于TELEMETRY_SIZE+4
+#define BLE_TELEMETRY_MARKER 0xFE
+
+typedef struct {
+    uint8_t  state;               //!< 当前状态（BLE_LINK_*）
+    uint32_t state_since_ms;      //!< 进入当前状态的时刻（ms）
+    uint32_t connects;            //!< 累计连接次数
+    uint32_t disconnects;         //!< 累计断开次数
+    uint32_t adv_restarts;        //!< 累计重新广播次数
+    uint32_t heartbeats;          //!< 累计发送的心跳/故障报告数
+    uint32_t last_adv_restart_ms; //!< 最近一次重新广播的时刻（ms）
+} BleLinkStatus;
+
+const BleLinkStatus& bleLinkStatus();        //!< 连接状态机状态
+const char* bleLinkStateName(uint8_t state); //!< 状态名称
+
+// ============================================================================
+// 接收FIFO
+// 说明：RX特征值支持写无响应，上位机可不等ATT响应连续发送；接收回调只把帧复制进
+//       定长队列，BLE_Server_Loop()在控制环中按序交给cmdReceive()，突发的多帧由队列吸收。
+//       帧前可加序号前缀"A5 序号高 序号低"，固件据此统计丢失帧、丢弃重复/过期帧（见FOC_Command.h）
+// ============================================================================
+#define BLE_RX_FIFO_DEPTH 16          //!< 队列深度（2的幂）
+#define BLE_RX_SLOT_SIZE 128          //!< 单帧最大字节数（20台MULTI_STRUCT加序号为68字节，超长帧丢弃并计数）
+#define BLE_RX_DRAIN_PER_LOOP 4       //!< 每次loop最多解析的帧数
+#define BLE_SEQ_PREFIX 0xA5           //!< 序号前缀（与包类型/帧头0xAA不冲突）
+
+typedef struct {
+    uint32_t frames;              //!< 入队帧数
+    uint32_t processed;           //!< 已解析帧数
+    uint32_t overflows;           //!< 队列满丢弃的帧数
+    uint32_t oversize;            //!< 超长丢弃的帧数
+    uint8_t  high_water;          //!< 队列最高占用
+} BleRxStats;
+
+bool bleRxPush(const uint8_t* data, size_t len);  //!< 接收回调中调用：复制一帧入队
+int bleRxDrain(int max_frames);                   //!< 控制环中调用：处理排队的帧，返回处理数
+const BleRxStats& bleRxStats();                   //!< 接收统计
+
 // ============================================================================
-void parseDirectCommandData(const std::string& data);
+// 函数：parseDirectCommandData
+// 功能：解析直接命令数据包（BLE传输，不带序号前缀）
+// 参数：data/length - 接收到的原始数据包
+// 说明：支持多种数据包格式，包括单电机控制、多电机批量控制等（解码见FOC_Command.h）；
+//       直接读取调用者的缓冲区，接收路径上不分配内存
+// ============================================================================
+void parseDirectCommandData(const uint8_t* data, size_t length);
+static inline void parseDirectCommandData(const std::string& data) {
+    parseDirectCommandData((const uint8_t*)data.data(), data.length());
+}
 
 // ============================================================================
 // 函数：getMyDeviceID
@@ -109,6 +186,25 @@ void parseDirectCommandData(const std::string& data);
 // ============================================================================
 uint8_t getMyDeviceID();
 
+// ============================================================================
+// 运行时设备ID与槽位
+// 说明：设备ID在initBLEServer()中从NVS（键DEVICE_ID_NVS_KEY）读取，未配置时为编译期MY_DEVICE_ID，
+//       同一份固件可烧录到所有关节，再经BLE配置包逐台设置ID。
+//       槽位由上位机在每次会话开始时按实际在线的关节分配（1..MAX_MOTORS，掉电不保存），
+//       MULTI_SLOT包按槽位紧凑排列；纪元号随每次重新分配递增，包内纪元与本机不符时不取值，
+//       防止重启或漏收分配的关节按过期的槽位表取到别人的目标
+// ============================================================================
+#define DEVICE_ID_NVS_KEY "dev_id"                //!< NVS中保存设备ID的键
+bool setMyDeviceID(uint8_t id);                  //!< 设置设备ID（立即生效）并标记待写入NVS，无效ID返回false
+void deviceIdService();                          //!< 每次loop()调用：电机未跟踪指令时把待写入的ID写入NVS
+bool deviceIdSaveDeferred();                     //!< 有待写入的ID且电机正在跟踪指令（写入推迟到停车后）
+bool loadMyDeviceID();                           //!< 从NVS读取设备ID，未配置返回false（保持MY_DEVICE_ID）
+void setMySlot(uint8_t slot, uint8_t epoch);     //!< 设置槽位（0为取消）和纪元号
+uint8_t getMySlot();                             //!< 当前槽位（0为未分配）
+uint8_t getMySlotEpoch();                        //!< 当前槽位表纪元号
+// 串口命令："ID"（当前ID/槽位） / "ID <新ID>"（与BLE配置包相同，稍后写入NVS）
+void deviceIdCommand(const char* args);
+
 // ============================================================================
 // 函数：floatToInt16
 // 功能：浮点数转换为16位整数（带缩放）
@@ -1,12 +1,22 @@
 #ifndef DENG_FOC_H
 #define DENG_FOC_H
 
-#include <Arduino.h>
+#include "HAL.h"
 #include "AS5600.h"
 #include "lowpass_filter.h"
 #include "pid.h"
 #include "InlineCurrent.h"
 #include "Ble_Handler.h"
+#include "FOC_Trace.h"
+#include "FOC_Bode.h"
+#include "FOC_Fault.h"
+#include "FOC_Thermal.h"
+#include "FOC_Watchdog.h"
+#include "FOC_MemStats.h"
+#include "FOC_Command.h"
+#include "FOC_SerialLink.h"
+#include "FOC_CanLink.h"
+#include "FOC_RadioLink.h"
 
 // 宏定义
 #define _constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
@@ -14,10 +24,25 @@
 #define _1_SQRT3 0.57735026919f
 #define _2_SQRT3 1.15470053838f
 #define GEAR_RATIO 225.0f
-static const float I_MAX_CMD = 6.5f;
+static constexpr float I_MAX_CMD = 3.0f;   // 命令电流上限（A）：电流采样满量程约±3.3A，超出部分测不到
+static_assert(FAULT_OVERCURRENT_A > I_MAX_CMD, "过流保护阈值须高于命令电流上限，留出电流环超调余量");
+#define _SQRT3 1.73205080757f
+
+// 母线电压采样（分压电阻接ADC引脚；-1表示未接分压电路，使用setPowerSupplyVoltage的设定值）
+#ifndef VBUS_ADC_PIN
+#define VBUS_ADC_PIN -1
+#endif
+#ifndef VBUS_DIVIDER
+#define VBUS_DIVIDER 11.0f          // 分压比（如100k/10k）
+#endif
+#define VBUS_SAMPLE_DIVIDER 4       // 每4个控制周期采样一次（约1kHz）
+#define VBUS_FILTER_ALPHA 0.2f      // 一阶滤波系数（1kHz采样时时间常数约4.5ms）
+#define VBUS_MIN_VALID 5.0f         // 上电平均值低于此值视为未接分压电路
 
 // 全局变量声明
 extern float voltage_power_supply;
+extern float voltage_power_supply_inv;
+extern bool vbus_sensing;
 extern float Ualpha, Ubeta, Ua, Ub, Uc;
 extern float zero_electric_angle;
 extern int PP, DIR;
@@ -31,7 +56,7 @@ extern PIDController vel_loop_M0;
 extern PIDController angle_loop_M0;
 extern PIDController current_loop_M0;
 extern Sensor_AS5600 S0;
-extern TwoWire S0_I2C;
+extern const uint8_t S0_I2C;
 extern CurrSense CS_M0;
 
 // 核心算法函数声明
@@ -39,6 +64,8 @@ float normalizeAngle(float angle);
 void setPwm(float Ua, float Ub, float Uc);
 void setTorque(float Uq, float angle_el);
 void setPowerSupplyVoltage(float power_supply);
+void setBusVoltage(float v_bus);
+void updateBusVoltage();
 float electricalAngle();  
 void calibrateSensor(int _PP, int _DIR);
 
@@ -61,7 +88,7 @@ void setMotorVelocityWithAngle(float Target);
 void runFOC();
 
 // 通信函数声明
-String readSerialCommand();
+const char* readSerialCommand();
 float getSerialMotorTarget();
 
 #endif
@@ -0,0 +1,242 @@
+// ============================================================================
+// 文件：FOC_Bode.cpp
+// 功能：频率响应（Bode）测量实现
+// 说明：扰动相位按实际控制周期（halMicros差值）累加，非均匀采样下
+//       以dt加权的正交相关仍在整数周期内抑制直流和慢变分量
+// ============================================================================
+#include "FOC_Bode.h"
+
+#define BODE_2PI 6.28318530718f
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+static BodeConfig bode_cfg;
+static bool bode_running = false;
+static BodePoint bode_points[BODE_MAX_POINTS];
+static int bode_count = 0;
+
+static float bode_freq = 0;        //!< 当前频率（Hz）
+static float bode_phase = 0;       //!< 当前频点内累计相位（rad）
+static float bode_dt = 0;          //!< 本控制周期时长（s）
+static float bode_dt_avg = 0;      //!< 控制周期均值（用于奈奎斯特保护）
+static uint32_t bode_last_us = 0;  //!< 上次注入时间
+static bool bode_has_last = false;
+static float bode_sin = 0, bode_cos = 1;  //!< 当前相位的正弦/余弦
+static float bode_u_re, bode_u_im;        //!< 参考u的相关和
+static float bode_y_re, bode_y_im;        //!< 反馈y的相关和
+
+static const char* bodePointName(uint8_t point) {
+    switch (point) {
+        case BODE_POINT_IQ: return "IQ";
+        case BODE_POINT_VELOCITY: return "VEL";
+        default: return "POS";
+    }
+}
+
+// ============================================================================
+// 函数：bodeDefaultConfig
+// 说明：默认频率范围按各环的大致带宽选取，幅值约为额定范围的5%
+// ============================================================================
+void bodeDefaultConfig(BodeConfig* cfg, uint8_t point) {
+    cfg->point = point;
+    cfg->points_per_decade = 10;
+    cfg->settle_cycles = 3;
+    cfg->measure_cycles = 5;
+    switch (point) {
+        case BODE_POINT_IQ:
+            cfg->f_start = 2.0f;
+            cfg->f_stop = 500.0f;
+            cfg->amplitude = 0.3f;
+            break;
+        case BODE_POINT_VELOCITY:
+            cfg->f_start = 0.5f;
+            cfg->f_stop = 200.0f;
+            cfg->amplitude = 5.0f;
+            break;
+        default:
+            cfg->f_start = 0.2f;
+            cfg->f_stop = 50.0f;
+            cfg->amplitude = 0.5f;
+            break;
+    }
+}
+
+static void bodeBeginFrequency(float f) {
+    bode_freq = f;
+    bode_phase = 0;
+    bode_sin = 0;
+    bode_cos = 1;
+    bode_u_re = bode_u_im = 0;
+    bode_y_re = bode_y_im = 0;
+}
+
+bool bodeStart(const BodeConfig& cfg) {
+    if (cfg.point > BODE_POINT_POSITION || !(cfg.f_start > 0) || cfg.f_stop < cfg.f_start ||
+        !(cfg.amplitude > 0) || cfg.points_per_decade == 0 || cfg.measure_cycles == 0) {
+        return false;
+    }
+    bode_cfg = cfg;
+    bode_count = 0;
+    bode_has_last = false;
+    bode_dt_avg = 0;
+    bodeBeginFrequency(cfg.f_start);
+    bode_running = true;
+    halPrintf("BODE_START,%s,%.3f,%.3f,%.4f\n", bodePointName(cfg.point), cfg.f_start, cfg.f_stop, cfg.amplitude);
+    return true;
+}
+
+void bodeStop() {
+    bode_running = false;
+}
+
+bool bodeActive() { return bode_running; }
+int bodeResultCount() { return bode_count; }
+const BodePoint* bodeResults() { return bode_points; }
+
+// ============================================================================
+// 函数：bodeSummarize
+// 功能：在对数频率轴上线性插值求-3dB带宽、0dB穿越频率和相位裕度
+// ============================================================================
+BodeSummary bodeSummarize() {
+    BodeSummary s = {0, 0, 0};
+    for (int i = 0; i < bode_count; i++) {
+        const BodePoint& p = bode_points[i];
+        if (s.bandwidth_hz == 0 && p.cl_mag_db < -3.0f) {
+            if (i == 0) {
+                s.bandwidth_hz = p.freq_hz;
+            } else {
+                const BodePoint& q = bode_points[i - 1];
+                float k = (-3.0f - q.cl_mag_db) / (p.cl_mag_db - q.cl_mag_db);
+                s.bandwidth_hz = q.freq_hz * powf(p.freq_hz / q.freq_hz, k);
+            }
+        }
+        if (s.crossover_hz == 0 && i > 0 && p.ol_mag_db < 0 && bode_points[i - 1].ol_mag_db >= 0) {
+            const BodePoint& q = bode_points[i - 1];
+            float k = (0.0f - q.ol_mag_db) / (p.ol_mag_db - q.ol_mag_db);
+            s.crossover_hz = q.freq_hz * powf(p.freq_hz / q.freq_hz, k);
+            s.phase_margin_deg = 180.0f + q.ol_phase_deg + k * (p.ol_phase_deg - q.ol_phase_deg);
+        }
+    }
+    return s;
+}
+
+static void bodeFinishSweep() {
+    bode_running = false;
+    BodeSummary s = bodeSummarize();
+    halPrintf("BODE_DONE,%s,%d,bw=%.3f,fc=%.3f,pm=%.1f\n",
+              bodePointName(bode_cfg.point), bode_count, s.bandwidth_hz, s.crossover_hz, s.phase_margin_deg);
+}
+
+// ============================================================================
+// 函数：bodeFinishFrequency
+// 功能：由相关和计算本频点的闭环/开环响应并切换到下一频率
+// ============================================================================
+static void bodeFinishFrequency() {
+    // 复数相关：X = Σx·cosφ·dt - jΣx·sinφ·dt，T = Y/U，L = T/(1-T)
+    float den = bode_u_re * bode_u_re + bode_u_im * bode_u_im;
+    if (den > 0 && bode_count < BODE_MAX_POINTS) {
+        float t_re = (bode_y_re * bode_u_re + bode_y_im * bode_u_im) / den;
+        float t_im = (bode_y_im * bode_u_re - bode_y_re * bode_u_im) / den;
+        float d_re = 1.0f - t_re;
+        float d_im = -t_im;
+        float d_den = d_re * d_re + d_im * d_im;
+        float l_re = (t_re * d_re + t_im * d_im) / d_den;
+        float l_im = (t_im * d_re - t_re * d_im) / d_den;
+
+        BodePoint& p = bode_points[bode_count++];
+        p.freq_hz = bode_freq;
+        p.cl_mag_db = 10.0f * log10f(t_re * t_re + t_im * t_im);
+        p.cl_phase_deg = atan2f(t_im, t_re) * (180.0f / PI);
+        p.ol_mag_db = 10.0f * log10f(l_re * l_re + l_im * l_im);
+        p.ol_phase_deg = atan2f(l_im, l_re) * (180.0f / PI);
+        if (p.ol_phase_deg > 0) p.ol_phase_deg -= 360.0f;
+
+        halPrintf("BODE,%d,%.3f,%.2f,%.1f,%.2f,%.1f\n", bode_count - 1, p.freq_hz,
+                  p.cl_mag_db, p.cl_phase_deg, p.ol_mag_db, p.ol_phase_deg);
+    }
+
+    float next = bode_freq * powf(10.0f, 1.0f / bode_cfg.points_per_decade);
+    if (next > bode_cfg.f_stop * 1.0001f || bode_count >= BODE_MAX_POINTS) {
+        bodeFinishSweep();
+        return;
+    }
+    bodeBeginFrequency(next);
+}
+
+// ============================================================================
+// 函数：bodeInject
+// 功能：推进扰动相位并叠加到参考值（每个控制周期在注入点调用一次）
+// ============================================================================
+float bodeInject(uint8_t point, float ref) {
+    if (!bode_running || point != bode_cfg.point) return ref;
+
+    uint32_t now = halMicros();
+    bode_dt = bode_has_last ? (now - bode_last_us) * 1e-6f : 0.0f;
+    bode_last_us = now;
+    bode_has_last = true;
+    if (bode_dt > 0.1f) bode_dt = 0;  // 长时间停顿（串口输出等）不推进相位
+    if (bode_dt > 0) bode_dt_avg = bode_dt_avg > 0 ? bode_dt_avg + 0.01f * (bode_dt - bode_dt_avg) : bode_dt;
+
+    // 奈奎斯特保护：频率超过控制频率的1/5后结束扫频
+    if (bode_dt_avg > 0 && bode_freq * bode_dt_avg > 0.2f) {
+        bodeFinishSweep();
+        return ref;
+    }
+
+    bode_phase += BODE_2PI * bode_freq * bode_dt;
+    bode_sin = sinf(bode_phase);
+    bode_cos = cosf(bode_phase);
+    return ref + bode_cfg.amplitude * bode_sin;
+}
+
+// ============================================================================
+// 函数：bodeSample
+// 功能：稳定周期之后累加u、y的正交相关，满整数周期后结束本频点
+// ============================================================================
+void bodeSample(uint8_t point, float u, float y) {
+    if (!bode_running || point != bode_cfg.point) return;
+
+    if (bode_phase >= BODE_2PI * bode_cfg.settle_cycles) {
+        bode_u_re += u * bode_cos * bode_dt;
+        bode_u_im -= u * bode_sin * bode_dt;
+        bode_y_re += y * bode_cos * bode_dt;
+        bode_y_im -= y * bode_sin * bode_dt;
+    }
+    if (bode_phase >= BODE_2PI * (bode_cfg.settle_cycles + bode_cfg.measure_cycles)) {
+        bodeFinishFrequency();
+    }
+}
+
+// ============================================================================
+// 函数：bodeCommand
+// 功能：解析串口命令参数并启动/停止扫频
+// ============================================================================
+void bodeCommand(const char* args) {
+    char name[8] = {0};
+    float f0, f1, amp;
+    int n = sscanf(args, " %7s %f %f %f", name, &f0, &f1, &amp);
+    if (n >= 1 && strcmp(name, "STOP") == 0) {
+        bodeStop();
+        halPrintf("BODE_STOP\n");
+        return;
+    }
+
+    BodeConfig cfg;
+    if (n >= 1 && strcmp(name, "IQ") == 0) {
+        bodeDefaultConfig(&cfg, BODE_POINT_IQ);
+    } else if (n >= 1 && strcmp(name, "VEL") == 0) {
+        bodeDefaultConfig(&cfg, BODE_POINT_VELOCITY);
+    } else if (n >= 1 && strcmp(name, "POS") == 0) {
+        bodeDefaultConfig(&cfg, BODE_POINT_POSITION);
+    } else {
+        halPrintf("BODE_ERROR,用法: BODE IQ|VEL|POS [起始Hz 终止Hz 幅值] / BODE STOP\n");
+        return;
+    }
+    if (n >= 3) {
+        cfg.f_start = f0;
+        cfg.f_stop = f1;
+    }
+    if (n >= 4) cfg.amplitude = amp;
+    if (!bodeStart(cfg)) halPrintf("BODE_ERROR,参数无效\n");
+}
@@ -0,0 +1,80 @@
+// ============================================================================
+// 文件：FOC_Bode.h
+// 功能：频率响应（Bode）测量 - 步进正弦扫频注入与片上单频点DFT
+// 说明：在选定注入点（q轴电流参考/速度参考/位置参考）叠加正弦扰动，
+//       对每个频率先等待若干周期稳定，再在整数个周期内对环路参考u（含扰动）
+//       和反馈y做正交相关，得到闭环响应T = Y/U，
+//       并按单位负反馈换算开环响应L = T/(1-T)，得到带宽、穿越频率和相位裕度。
+//       每个频点的结果以"BODE,..."文本行经串口输出，可直接由主机分析
+// ============================================================================
+#ifndef FOC_BODE_H
+#define FOC_BODE_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 注入点
+// ============================================================================
+#define BODE_POINT_IQ        0   //!< q轴电流参考（电流环，单位A）
+#define BODE_POINT_VELOCITY  1   //!< 速度参考（速度环，单位rad/s）
+#define BODE_POINT_POSITION  2   //!< 位置参考（位置环，电机轴rad）
+
+#define BODE_MAX_POINTS      64  //!< 最多频点数
+
+// ============================================================================
+// 数据结构定义：BodeConfig
+// 功能：扫频参数
+// ============================================================================
+struct BodeConfig {
+    uint8_t point;              //!< 注入点（BODE_POINT_*）
+    float f_start;              //!< 起始频率（Hz）
+    float f_stop;               //!< 终止频率（Hz）
+    float amplitude;            //!< 扰动幅值（注入点单位）
+    uint8_t points_per_decade;  //!< 每十倍频程频点数
+    uint8_t settle_cycles;      //!< 每个频点的稳定周期数（不计入相关）
+    uint8_t measure_cycles;     //!< 每个频点的相关周期数
+};
+
+// ============================================================================
+// 数据结构定义：BodePoint
+// 功能：单个频点的测量结果
+// ============================================================================
+struct BodePoint {
+    float freq_hz;         //!< 频率（Hz）
+    float cl_mag_db;       //!< 闭环幅值（dB）
+    float cl_phase_deg;    //!< 闭环相位（度）
+    float ol_mag_db;       //!< 开环幅值（dB）
+    float ol_phase_deg;    //!< 开环相位（度，(-360,0]）
+};
+
+// ============================================================================
+// 数据结构定义：BodeSummary
+// 功能：扫频结论（未找到时对应频率为0）
+// ============================================================================
+struct BodeSummary {
+    float bandwidth_hz;       //!< 闭环-3dB带宽
+    float crossover_hz;       //!< 开环增益穿越频率
+    float phase_margin_deg;   //!< 相位裕度
+};
+
+// ============================================================================
+// 扫频控制
+// ============================================================================
+void bodeDefaultConfig(BodeConfig* cfg, uint8_t point);  //!< 按注入点填入默认参数
+bool bodeStart(const BodeConfig& cfg);   //!< 开始扫频（参数无效时返回false）
+void bodeStop();                         //!< 中止扫频
+bool bodeActive();                       //!< 是否正在扫频
+int bodeResultCount();                   //!< 已完成的频点数
+const BodePoint* bodeResults();          //!< 频点结果
+BodeSummary bodeSummarize();             //!< 由已完成频点计算带宽和相位裕度
+
+// 串口命令："BODE IQ|VEL|POS [起始Hz 终止Hz 幅值]" 或 "BODE STOP"（args为BODE之后的部分）
+void bodeCommand(const char* args);
+
+// ============================================================================
+// 控制环接口（在FOC_Control.cpp的三环中调用，未扫频时只做一次判断）
+// ============================================================================
+float bodeInject(uint8_t point, float ref);          //!< 返回叠加扰动后的参考值
+void bodeSample(uint8_t point, float u, float y);    //!< 记录该环的参考u和反馈y
+
+#endif // FOC_BODE_H
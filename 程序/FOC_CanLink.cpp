@@ -0,0 +1,244 @@
+// ============================================================================
+// 文件：FOC_CanLink.cpp
+// 功能：CAN总线传输实现
+// 说明：接收在loop()开头（canLinkPoll）进行，收到的目标帧转换为BLE数据包交给指令层；
+//       全部使用静态/栈上定长缓冲，不分配内存
+// ============================================================================
+#include "FOC.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+#define CAN_PACKET_MAX (6 + 2 * CAN_GROUP_SIZE)     //!< 转换后数据包最大长度（MULTI切片）
+
+static CanLinkStats can_stats = {};
+static uint8_t can_pending[CAN_PACKET_MAX];         //!< 锁存的本设备目标（等待SYNC）
+static size_t can_pending_len = 0;
+static uint32_t can_last_sync_us = 0;               //!< 最近一次SYNC的时间
+static uint8_t can_status_countdown = 0;            //!< 距下一次状态帧的SYNC数
+static uint16_t can_sent_fault = 0;                 //!< 最近回送的故障码
+static uint8_t can_sent_watchdog = 0;               //!< 最近回送的看门狗状态
+
+// ============================================================================
+// 编解码
+// ============================================================================
+static inline int32_t canSaturate(float v, int32_t lo, int32_t hi) {
+    if (!(v > (float)lo)) return lo;  // 同时处理NaN
+    if (v >= (float)hi) return hi;
+    return (int32_t)lroundf(v);
+}
+
+static inline void canPut16(uint8_t* p, int32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+static inline int16_t canGetI16(const uint8_t* p) { return (int16_t)(p[0] | (p[1] << 8)); }
+static inline uint16_t canGetU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+uint8_t canPackGroup(const int16_t* raw, uint8_t count, uint8_t* data) {
+    if (count > CAN_GROUP_SIZE) count = CAN_GROUP_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        data[i * 2] = (uint8_t)((uint16_t)raw[i] >> 8);  // 与BLE数据包相同，高字节在前
+        data[i * 2 + 1] = (uint8_t)((uint16_t)raw[i] & 0xFF);
+    }
+    return (uint8_t)(count * 2);
+}
+
+void canPackTelemetry(const Telemetry& t, uint8_t cycle, uint8_t* data) {
+    int32_t angle = canSaturate(t.angle * 1000.0f, -0x7FFFFF, 0x7FFFFF);
+    canPut16(data, angle);
+    data[2] = (uint8_t)((angle >> 16) & 0xFF);
+    canPut16(data + 3, canSaturate(t.velocity * 10.0f, INT16_MIN, INT16_MAX));
+    canPut16(data + 5, canSaturate(t.iq * 1000.0f, INT16_MIN, INT16_MAX));
+    data[7] = cycle;
+}
+
+void canPackStatus(const Telemetry& t, uint8_t cycle, uint8_t* data) {
+    canPut16(data, canSaturate(t.temperature * 10.0f, INT16_MIN, INT16_MAX));
+    canPut16(data + 2, canSaturate(t.bus_voltage * 100.0f, 0, UINT16_MAX));
+    canPut16(data + 4, t.fault);
+    data[6] = t.watchdog;
+    data[7] = cycle;
+}
+
+bool canUnpackTelemetry(const uint8_t* data, uint8_t len, CanJointState* s) {
+    if (len != 8) return false;
+    int32_t angle = (int32_t)((uint32_t)canGetU16(data) | ((uint32_t)data[2] << 16));
+    if (angle & 0x800000) angle -= 0x1000000;  // 24位符号扩展
+    s->angle = angle / 1000.0f;
+    s->velocity = canGetI16(data + 3) / 10.0f;
+    s->iq = canGetI16(data + 5) / 1000.0f;
+    s->cycle = data[7];
+    return true;
+}
+
+bool canUnpackStatus(const uint8_t* data, uint8_t len, CanJointState* s) {
+    if (len != 8) return false;
+    s->temperature = canGetI16(data) / 10.0f;
+    s->bus_voltage = canGetU16(data + 2) / 100.0f;
+    s->fault = canGetU16(data + 4);
+    s->watchdog = data[6];
+    s->status_cycle = data[7];
+    return true;
+}
+
+// ============================================================================
+// 函数：canFrameToPacket
+// 功能：把目标帧转换为等价的BLE数据包
+// 说明：分组帧 → MULTI切片  AA 55 02 DT START COUNT V..
+//       单台帧 → SINGLE      AA 55 01 DT ID VH VL
+// ============================================================================
+size_t canFrameToPacket(uint32_t id, const uint8_t* data, uint8_t len, uint8_t* out) {
+    out[0] = 0xAA;
+    out[1] = 0x55;
+    if ((id & 0x780) == CAN_ID_GROUP && id < CAN_ID_TELEMETRY) {
+        uint8_t data_type = (uint8_t)((id >> 4) & 0x07);
+        uint8_t group = (uint8_t)(id & 0x0F);
+        if (len < 2 || (len & 1) || len > CAN_GROUP_SIZE * 2) return 0;
+        out[2] = PACKET_TYPE_MULTI;
+        out[3] = data_type;
+        out[4] = (uint8_t)(group * CAN_GROUP_SIZE + 1);
+        out[5] = (uint8_t)(len / 2);
+        memcpy(out + 6, data, len);
+        return 6 + len;
+    }
+    if (id > CAN_ID_SETPOINT && id <= CAN_ID_SETPOINT + MAX_MOTORS) {
+        if (len != 3) return 0;
+        out[2] = PACKET_TYPE_SINGLE;
+        out[3] = data[0];
+        out[4] = (uint8_t)(id - CAN_ID_SETPOINT);
+        out[5] = data[1];
+        out[6] = data[2];
+        return 7;
+    }
+    return 0;
+}
+
+// ============================================================================
+// 发送
+// ============================================================================
+static bool canLinkSend(uint32_t id, const uint8_t* data, uint8_t len) {
+    if (halCanSend(id, data, len)) {
+        can_stats.tx_frames++;
+        return true;
+    }
+    can_stats.tx_errors++;
+    return false;
+}
+
+// 指令层遥测：还原为字段后打包成遥测帧，到期或故障/看门狗状态变化时再发送状态帧
+static bool canLinkTelemetry(const uint8_t* data, size_t len) {
+    uint16_t seq;
+    Telemetry t;
+    if (!telemetryDecode(data, len, &seq, &t)) return false;
+    uint8_t frame[8];
+    uint8_t my_id = getMyDeviceID();
+    canPackTelemetry(t, can_stats.cycle, frame);
+    bool sent = canLinkSend(CAN_ID_TELEMETRY + my_id, frame, 8);
+    if (can_status_countdown > 0) can_status_countdown--;
+    if (can_status_countdown == 0 || t.fault != can_sent_fault || t.watchdog != can_sent_watchdog) {
+        canPackStatus(t, can_stats.cycle, frame);
+        if (canLinkSend(CAN_ID_STATUS + my_id, frame, 8)) {
+            can_status_countdown = CAN_STATUS_DIVIDER;
+            can_sent_fault = t.fault;
+            can_sent_watchdog = t.watchdog;
+            can_stats.status++;
+        }
+    }
+    return sent;
+}
+
+// 总线上没有文本回复通道：目标帧的确认由下一次遥测体现
+static const CommandTransport can_transport = {"CAN", nullptr, canLinkTelemetry, 0};
+
+void canLinkInit() {
+#if CAN_LINK_ENABLE
+    can_stats.started = halCanBegin(CAN_TX_PIN, CAN_RX_PIN, CAN_BITRATE);
+    if (can_stats.started) {
+        cmdRegisterTransport(CMD_TRANSPORT_CAN, &can_transport);
+    } else {
+        halPrintf("[CAN] 控制器启动失败\n");
+    }
+#endif
+}
+
+const CanLinkStats& canLinkStats() { return can_stats; }
+
+// ============================================================================
+// 函数：canLinkSync
+// 功能：处理SYNC：锁存的目标生效，回送遥测
+// ============================================================================
+static void canLinkSync(const uint8_t* data, uint8_t len, uint32_t now_us) {
+    can_stats.syncs++;
+    can_stats.cycle = len >= 1 ? data[0] : (uint8_t)(can_stats.cycle + 1);
+    can_stats.sync_mode = true;
+    can_last_sync_us = now_us;
+    if (can_pending_len > 0) {
+        cmdDispatch(CMD_TRANSPORT_CAN, can_pending, can_pending_len);
+        can_pending_len = 0;
+    }
+    cmdTelemetrySend(CMD_TRANSPORT_CAN);
+}
+
+// ============================================================================
+// 函数：canLinkPoll
+// 功能：处理接收帧
+// 说明：同步模式下发给本设备的目标帧锁存到下一个SYNC（同一周期内后到的覆盖先到的），
+//       其余帧立即分发（统计为他人指令）
+// ============================================================================
+void canLinkPoll() {
+    if (!can_stats.started) return;
+    uint32_t now_us = S0.getUpdateTimestamp();
+    if (can_stats.sync_mode && (uint32_t)(now_us - can_last_sync_us) > CAN_SYNC_TIMEOUT_MS * 1000u) {
+        can_stats.sync_mode = false;
+        can_stats.sync_timeouts++;
+        if (can_pending_len > 0) {
+            cmdDispatch(CMD_TRANSPORT_CAN, can_pending, can_pending_len);
+            can_pending_len = 0;
+        }
+    }
+
+    uint32_t id;
+    uint8_t data[8];
+    uint8_t len;
+    for (int n = 0; n < CAN_RX_PER_LOOP && halCanReceive(&id, data, &len); n++) {
+        can_stats.frames++;
+        if (id == CAN_ID_SYNC) {
+            canLinkSync(data, len, now_us);
+            continue;
+        }
+        uint8_t packet[CAN_PACKET_MAX];
+        size_t packet_len = canFrameToPacket(id, data, len, packet);
+        if (packet_len == 0) {
+            can_stats.unknown++;
+            continue;
+        }
+        CommandMsg msg;
+        uint8_t my_id = getMyDeviceID();
+        if (can_stats.sync_mode && cmdAddressed(packet, packet_len, my_id) &&
+            cmdDecode(packet, packet_len, my_id, &msg) == CMD_DECODE_OK) {
+            if (can_pending_len > 0) can_stats.overwritten++;
+            memcpy(can_pending, packet, packet_len);
+            can_pending_len = packet_len;
+            can_stats.latched++;
+        } else {
+            cmdDispatch(CMD_TRANSPORT_CAN, packet, packet_len);
+        }
+    }
+}
+
+// ============================================================================
+// 函数：canLinkCommand
+// 功能：CAN状态命令处理
+// ============================================================================
+void canLinkCommand(const char* args) {
+    (void)args;
+    const CanLinkStats& s = can_stats;
+    halPrintf("CAN,%s,%s,bitrate=%lu,frames=%lu,sync=%lu,cycle=%u,latched=%lu,overwritten=%lu,unknown=%lu,"
+              "timeouts=%lu,status=%lu,tx=%lu,tx_err=%lu\n",
+              s.started ? "ON" : "OFF", s.sync_mode ? "SYNC" : "DIRECT", (unsigned long)CAN_BITRATE,
+              (unsigned long)s.frames, (unsigned long)s.syncs, s.cycle, (unsigned long)s.latched,
+              (unsigned long)s.overwritten, (unsigned long)s.unknown, (unsigned long)s.sync_timeouts,
+              (unsigned long)s.status, (unsigned long)s.tx_frames, (unsigned long)s.tx_errors);
+}
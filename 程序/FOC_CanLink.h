@@ -0,0 +1,119 @@
+// ============================================================================
+// 文件：FOC_CanLink.h
+// 功能：CAN总线传输（ESP32 TWAI控制器），用于多关节同步控制
+// 说明：作为一种传输注册到指令层（FOC_Command.h）：CAN帧先转换为等价的BLE数据包
+//       再由cmdDispatch()解码，指令语义与BLE/串口相同。
+//       帧ID（11位标准帧，ID越小仲裁优先级越高）：
+//         CAN_ID_SYNC                  主机→全部  同步：[周期计数(u8)]
+//         CAN_ID_GROUP|DT<<4|组号      主机→全部  分组目标：4个关节×int16高字节在前
+//                                                 （关节组号*4+1起，与MULTI切片相同的缩放）
+//         CAN_ID_SETPOINT+ID           主机→单台  单台目标：[DT][VH][VL]（与SINGLE相同）
+//         CAN_ID_TELEMETRY+ID          单台→主机  [角度i24 mrad][速度i16 0.1rad/s][iq i16 mA][周期u8]
+//         CAN_ID_STATUS+ID             单台→主机  [温度i16 0.1°C][母线u16 10mV][故障u16][看门狗u8][周期u8]
+//       遥测字段均为小端（与串口遥测相同），超出范围时饱和（角度±8388rad）。
+//       同步模式：收到第一个SYNC后，发给本设备的目标帧先锁存，下一个SYNC到达时才写入邮箱，
+//       随后立即回送遥测帧；全部关节在同一时刻切换目标、按ID顺序回送。状态帧每CAN_STATUS_DIVIDER
+//       个SYNC回送一次，故障码或看门狗状态变化时立即回送。
+//       总线容量：1Mbit/s下8字节帧最坏约135位，8个关节每周期约1.5k位，即周期不宜短于2ms；
+//       CAN_SYNC_TIMEOUT_MS内没有SYNC则退回收到即生效
+// ============================================================================
+#ifndef FOC_CAN_LINK_H
+#define FOC_CAN_LINK_H
+
+#include "HAL.h"
+#include "FOC_Command.h"
+
+// ============================================================================
+// 默认参数（可在编译时覆盖）
+// ============================================================================
+#ifndef CAN_LINK_ENABLE
+#define CAN_LINK_ENABLE HAL_HOST        //!< 是否启用（ESP32上需外接收发器，默认关闭以免悬空RX引脚）
+#endif
+#ifndef CAN_TX_PIN
+#define CAN_TX_PIN 26                   //!< 接收发器TXD
+#endif
+#ifndef CAN_RX_PIN
+#define CAN_RX_PIN 27                   //!< 接收发器RXD
+#endif
+#ifndef CAN_BITRATE
+#define CAN_BITRATE 1000000             //!< 波特率（1M/500k/250k/125k）
+#endif
+#ifndef CAN_RX_PER_LOOP
+#define CAN_RX_PER_LOOP 16              //!< 每个loop最多处理的接收帧
+#endif
+#ifndef CAN_SYNC_TIMEOUT_MS
+#define CAN_SYNC_TIMEOUT_MS 100         //!< 超过此时间没有SYNC则退出同步模式
+#endif
+#ifndef CAN_STATUS_DIVIDER
+#define CAN_STATUS_DIVIDER 10           //!< 每N个SYNC回送一次状态帧
+#endif
+
+// ============================================================================
+// 帧ID
+// ============================================================================
+#define CAN_ID_SYNC       0x080     //!< 同步
+#define CAN_ID_GROUP      0x100     //!< 分组目标（|数据类型<<4|组号）
+#define CAN_ID_TELEMETRY  0x180     //!< 遥测（+设备ID）
+#define CAN_ID_SETPOINT   0x200     //!< 单台目标（+设备ID）
+#define CAN_ID_STATUS     0x280     //!< 状态（+设备ID）
+#define CAN_GROUP_SIZE    4         //!< 每个分组帧的关节数
+
+// ============================================================================
+// 数据结构定义：CanJointState
+// 功能：从遥测/状态两帧还原的关节状态（主机端使用）
+// ============================================================================
+struct CanJointState {
+    float angle;            //!< 电机轴位置（rad）
+    float velocity;         //!< 电机轴速度（rad/s）
+    float iq;               //!< q轴电流（A）
+    float temperature;      //!< 绕组温度估计（°C）
+    float bus_voltage;      //!< 母线电压（V）
+    uint16_t fault;         //!< 锁存的故障码
+    uint8_t watchdog;       //!< 看门狗状态
+    uint8_t cycle;          //!< 遥测帧回送时的同步周期计数
+    uint8_t status_cycle;   //!< 状态帧回送时的同步周期计数
+};
+
+// ============================================================================
+// 数据结构定义：CanLinkStats
+// 功能：CAN传输统计
+// ============================================================================
+struct CanLinkStats {
+    uint32_t frames;            //!< 收到的帧
+    uint32_t syncs;             //!< 收到的SYNC
+    uint32_t latched;           //!< 锁存到SYNC才生效的目标帧
+    uint32_t overwritten;       //!< 同一同步周期内被后到帧覆盖的锁存帧
+    uint32_t unknown;           //!< 未知ID或长度不符的帧
+    uint32_t sync_timeouts;     //!< 退出同步模式的次数
+    uint32_t status;            //!< 已发送的状态帧
+    uint32_t tx_frames;         //!< 已发送的帧
+    uint32_t tx_errors;         //!< 发送失败（队列满/总线关闭）
+    uint8_t cycle;              //!< 最近的同步周期计数
+    bool sync_mode;             //!< 是否处于同步模式
+    bool started;               //!< 控制器是否已启动
+};
+
+// ============================================================================
+// 编解码（设备与主机共用）
+// ============================================================================
+// 分组目标帧：count（1..CAN_GROUP_SIZE）个原始值，返回数据长度
+uint8_t canPackGroup(const int16_t* raw, uint8_t count, uint8_t* data);
+// 遥测/状态帧（各8字节）
+void canPackTelemetry(const Telemetry& t, uint8_t cycle, uint8_t* data);
+void canPackStatus(const Telemetry& t, uint8_t cycle, uint8_t* data);
+bool canUnpackTelemetry(const uint8_t* data, uint8_t len, CanJointState* s);
+bool canUnpackStatus(const uint8_t* data, uint8_t len, CanJointState* s);
+// 把一帧目标转换为等价的BLE数据包（out至少6+2*CAN_GROUP_SIZE字节），非目标帧返回0
+size_t canFrameToPacket(uint32_t id, const uint8_t* data, uint8_t len, uint8_t* out);
+
+// ============================================================================
+// 设备端接口
+// ============================================================================
+void canLinkInit();                 //!< setup()中调用：启动控制器并注册为CMD_TRANSPORT_CAN
+void canLinkPoll();                 //!< loop()中调用：处理接收帧，SYNC时回送遥测
+const CanLinkStats& canLinkStats();
+
+// 串口命令："CAN"（状态）
+void canLinkCommand(const char* args);
+
+#endif // FOC_CAN_LINK_H
@@ -0,0 +1,520 @@
+// ============================================================================
+// 文件：FOC_Command.cpp
+// 功能：与传输方式无关的指令/遥测层实现
+// 说明：解码部分由原parseDirectCommandData()拆出，包格式与响应文本保持不变
+// ============================================================================
+#include "FOC.h"
+
+#define CMD_LOG(...) do { if (CMD_DEBUG) halPrintf(__VA_ARGS__); } while (0)
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+typedef struct {
+    const CommandTransport* transport;  //!< 注册的传输（未注册为空）
+    CommandLinkStats stats;
+    bool seq_valid;                     //!< 已收到过带序号的帧（下一个序号可预期）
+    uint16_t telemetry_seq;             //!< 下一帧遥测序号
+    uint32_t next_us;                   //!< 下一帧遥测时刻
+    bool next_valid;
+} CommandLink;
+
+static CommandLink cmd_links[CMD_TRANSPORT_MAX];
+
+void cmdRegisterTransport(uint8_t id, const CommandTransport* transport) {
+    if (id >= CMD_TRANSPORT_MAX) return;
+    cmd_links[id].transport = transport;
+    cmd_links[id].stats.telemetry_hz = transport ? transport->telemetry_hz : 0;
+    cmd_links[id].next_valid = false;
+}
+
+const CommandLinkStats& cmdLinkStats(uint8_t transport) {
+    return cmd_links[transport < CMD_TRANSPORT_MAX ? transport : 0].stats;
+}
+
+static inline int16_t cmdReadInt16(const uint8_t* p) {
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);  // 高字节在前
+}
+
+static float cmdScaleFor(uint8_t data_type) {
+    if (data_type == DATA_TYPE_VELOCITY) return VELOCITY_SCALE;
+    if (data_type == DATA_TYPE_CURRENT) return 1000.0f;
+    return ANGLE_SCALE;
+}
+
+// 帧头AA 55后须紧跟有效包类型，否则按无帧头处理；CONFIG与MULTI_SLOT只有带帧头的格式
+static inline bool cmdHasHeader(const uint8_t* data) {
+    return data[0] == 0xAA && data[1] == 0x55 && data[2] >= PACKET_TYPE_SINGLE && data[2] <= PACKET_TYPE_MULTI_SLOT;
+}
+
+const char* cmdPacketName(uint8_t packet_type) {
+    switch (packet_type) {
+        case PACKET_TYPE_SINGLE: return "SINGLE";
+        case PACKET_TYPE_MULTI: return "MULTI";
+        case PACKET_TYPE_MULTI_STRUCT: return "MULTI_STRUCT";
+        case PACKET_TYPE_CONFIG: return "CONFIG";
+        case PACKET_TYPE_MULTI_SLOT: return "MULTI_SLOT";
+        default: return "?";
+    }
+}
+
+// ============================================================================
+// 函数：cmdDecode
+// 功能：解码一帧，找出本设备的指令
+// 参数：data/len - 帧数据（直接读取，不复制），my_id - 本设备ID，msg - 输出
+// 返回值：CMD_DECODE_OK等
+// 说明：支持的格式（可带帧头AA 55）：
+//         SINGLE        AA 55 01 DT ID VH VL  /  01 ID DT VH VL 00（按角度缩放）
+//         MULTI切片     AA 55 02 DT START COUNT V(start)..V(start+count-1)
+//         MULTI旧版     AA 55 02 DT V1..V10（共24字节）
+//         MULTI_STRUCT  AA 55 03 DT COUNT (ID VH VL)*COUNT（取第一个匹配条目）
+//         CONFIG        AA 55 04 OP ID 参数..（见Ble_Handler.h中的CONFIG_OP_*）
+//         MULTI_SLOT    AA 55 05 DT EPOCH START COUNT V(start)..V(start+count-1)（按槽位取值）
+// ============================================================================
+uint8_t cmdDecode(const uint8_t* data, size_t len, uint8_t my_id, CommandMsg* msg) {
+    if (len < 3) return CMD_DECODE_INVALID;
+
+    bool hdr = cmdHasHeader(data);
+    uint8_t packet_type = hdr ? data[2] : data[0];
+    msg->packet_type = packet_type;
+    msg->count = 0;
+    CMD_LOG("[指令调试] 包类型: 0x%02X%s, 长度: %d, 设备ID: %d\n", packet_type, hdr ? "（帧头AA 55）" : "",
+            (int)len, my_id);
+
+    if (packet_type == PACKET_TYPE_SINGLE) {
+        if (len < (size_t)(hdr ? 7 : 6)) return CMD_DECODE_INVALID;
+        size_t id_off = hdr ? 4 : 1;
+        size_t type_off = hdr ? 3 : 2;
+        size_t val_off = hdr ? 5 : 3;
+        if (data[id_off] != my_id) return CMD_DECODE_NOT_MINE;
+        msg->data_type = data[type_off];
+        msg->raw = cmdReadInt16(data + val_off);
+        msg->value = int16ToFloat(msg->raw, ANGLE_SCALE);
+        return CMD_DECODE_OK;
+    }
+
+    if (packet_type == PACKET_TYPE_MULTI) {
+        size_t type_off = hdr ? 3 : 1;
+        if (len <= type_off) return CMD_DECODE_INVALID;
+        msg->data_type = data[type_off];
+        float scale = cmdScaleFor(msg->data_type);
+
+        // 优先按切片格式解析
+        if (hdr && len >= 6) {
+            int start = data[4];
+            int count = data[5];  // 按int计算，count较大时不能在uint8_t上回绕
+            if (start >= 1 && start <= MAX_MOTORS && count >= 1 && len == (size_t)(6 + count * 2)) {
+                CMD_LOG("[指令调试] MULTI切片 DT=0x%02X, 范围: ID %d..%d\n", msg->data_type, start, start + count - 1);
+                if (my_id < start || my_id > start + count - 1) return CMD_DECODE_NOT_MINE;
+                msg->raw = cmdReadInt16(data + 6 + (my_id - start) * 2);
+                msg->value = int16ToFloat(msg->raw, scale);
+                return CMD_DECODE_OK;
+            }
+        }
+        // 兼容旧版整包10台格式
+        if (hdr && len == 24) {
+            if (my_id < 1 || my_id > 10) return CMD_DECODE_NOT_MINE;
+            msg->raw = cmdReadInt16(data + 4 + (my_id - 1) * 2);
+            msg->value = int16ToFloat(msg->raw, scale);
+            return CMD_DECODE_OK;
+        }
+        return CMD_DECODE_INVALID;
+    }
+
+    if (packet_type == PACKET_TYPE_MULTI_STRUCT) {
+        size_t type_off = hdr ? 3 : 1;
+        size_t items_off = type_off + 2;
+        if (len < items_off) return CMD_DECODE_INVALID;
+        msg->data_type = data[type_off];
+        uint8_t count = data[type_off + 1];
+        if (len < items_off + (size_t)count * 3) return CMD_DECODE_INVALID;
+        for (int i = 0; i < count; i++) {
+            const uint8_t* item = data + items_off + i * 3;  // ID VH VL
+            CMD_LOG("[指令调试] 条目%d: ID=%d 原始值=%d\n", i, item[0], cmdReadInt16(item + 1));
+            if (item[0] == my_id) {
+                msg->count = count;
+                msg->raw = cmdReadInt16(item + 1);
+                msg->value = int16ToFloat(msg->raw, cmdScaleFor(msg->data_type));
+                return CMD_DECODE_OK;
+            }
+        }
+        return CMD_DECODE_NOT_MINE;
+    }
+
+    if (packet_type == PACKET_TYPE_MULTI_SLOT && hdr) {
+        if (len < 7) return CMD_DECODE_INVALID;
+        msg->data_type = data[3];
+        int start = data[5];
+        int count = data[6];
+        if (start < 1 || start > MAX_MOTORS || count < 1 || len != (size_t)(7 + count * 2)) return CMD_DECODE_INVALID;
+        int slot = getMySlot();
+        CMD_LOG("[指令调试] MULTI_SLOT DT=0x%02X, 纪元%d, 槽位 %d..%d, 本机槽位%d/纪元%d\n", msg->data_type, data[4],
+                start, start + count - 1, slot, getMySlotEpoch());
+        if (slot == 0 || data[4] != getMySlotEpoch() || slot < start || slot > start + count - 1) {
+            return CMD_DECODE_NOT_MINE;
+        }
+        msg->raw = cmdReadInt16(data + 7 + (slot - start) * 2);
+        msg->value = int16ToFloat(msg->raw, cmdScaleFor(msg->data_type));
+        return CMD_DECODE_OK;
+    }
+
+    if (packet_type == PACKET_TYPE_CONFIG && hdr) {
+        if (len < 5) return CMD_DECODE_INVALID;
+        msg->config_op = data[3];
+        bool query = msg->config_op == CONFIG_OP_QUERY;
+        if (data[4] != my_id && !(query && data[4] == 0)) return CMD_DECODE_NOT_MINE;
+        size_t expect = 5;
+        if (msg->config_op == CONFIG_OP_SET_ID) expect = 6;
+        else if (msg->config_op == CONFIG_OP_SET_SLOT || msg->config_op == CONFIG_OP_TELEMETRY) expect = 7;
+        if (len != expect) return CMD_DECODE_INVALID;
+        msg->config_arg[0] = len > 5 ? data[5] : 0;
+        msg->config_arg[1] = len > 6 ? data[6] : 0;
+        return CMD_DECODE_CONFIG;
+    }
+
+    return CMD_DECODE_UNKNOWN;
+}
+
+// ============================================================================
+// 函数：cmdAddressed
+// 功能：只看帧头判断一帧是否可能含本设备指令
+// 说明：判断条件与cmdDecode一致：SINGLE比较ID字节，MULTI切片比较起始ID/数量（旧版整包为ID 1..10），
+//       MULTI_STRUCT按3字节步长扫描ID列，MULTI_SLOT比较纪元和槽位范围，CONFIG比较ID字节；
+//       长度不符时返回true，由cmdDecode统计为无效帧
+// ============================================================================
+bool cmdAddressed(const uint8_t* data, size_t len, uint8_t my_id) {
+    if (len < 3) return true;
+    bool hdr = cmdHasHeader(data);
+    uint8_t packet_type = hdr ? data[2] : data[0];
+
+    if (packet_type == PACKET_TYPE_SINGLE) {
+        if (len < (size_t)(hdr ? 7 : 6)) return true;
+        return data[hdr ? 4 : 1] == my_id;
+    }
+    if (packet_type == PACKET_TYPE_MULTI && hdr) {
+        if (len >= 6) {
+            int start = data[4];
+            int count = data[5];
+            if (start >= 1 && start <= MAX_MOTORS && count >= 1 && len == (size_t)(6 + count * 2)) {
+                return my_id >= start && my_id <= start + count - 1;
+            }
+        }
+        if (len == 24) return my_id >= 1 && my_id <= 10;
+        return true;
+    }
+    if (packet_type == PACKET_TYPE_MULTI_STRUCT) {
+        size_t items_off = hdr ? 5 : 3;
+        if (len < items_off) return true;
+        uint8_t count = data[items_off - 1];
+        if (len < items_off + (size_t)count * 3) return true;
+        const uint8_t* id = data + items_off;
+        for (uint8_t i = 0; i < count; i++, id += 3) {
+            if (*id == my_id) return true;
+        }
+        return false;
+    }
+    if (packet_type == PACKET_TYPE_MULTI_SLOT && hdr) {
+        if (len < 7) return true;
+        int start = data[5];
+        int count = data[6];
+        if (start < 1 || start > MAX_MOTORS || count < 1 || len != (size_t)(7 + count * 2)) return true;
+        int slot = getMySlot();
+        return slot != 0 && data[4] == getMySlotEpoch() && slot >= start && slot <= start + count - 1;
+    }
+    if (packet_type == PACKET_TYPE_CONFIG && hdr) {
+        if (len < 5) return true;
+        return data[4] == my_id || (data[3] == CONFIG_OP_QUERY && data[4] == 0);
+    }
+    return true;
+}
+
+// ============================================================================
+// 函数：cmdPost
+// 功能：把解码后的指令写入邮箱
+// ============================================================================
+void cmdPost(const CommandMsg& msg) {
+    watchdogFeed();         // 指令看门狗：目标值未变化的重发同样算作有效指令
+    faultNotifyCommand();   // 指令超时计时清零（同上，与传输无关）
+
+    if (msg.packet_type != PACKET_TYPE_SINGLE) {
+        data_scale_type = msg.data_type == DATA_TYPE_VELOCITY ? 1 : msg.data_type == DATA_TYPE_CURRENT ? 2 : 0;
+    }
+    if (msg.packet_type == PACKET_TYPE_MULTI_STRUCT) {
+        last_multi_struct_cmd.packet_type = PACKET_TYPE_MULTI_STRUCT;
+        last_multi_struct_cmd.device_id = getMyDeviceID();
+        last_multi_struct_cmd.data_type = msg.data_type;
+        last_multi_struct_cmd.raw_value = msg.raw;
+        last_multi_struct_cmd.scaled_value = msg.value;
+        last_multi_struct_cmd.count = msg.count;
+    }
+
+    if (fabs(msg.value - ble_motor_target) > 0.001f) {
+        CMD_LOG("[指令调试] 目标值改变: %.2f -> %.2f，设置new_command\n", ble_motor_target, msg.value);
+        ble_motor_target = msg.value;
+        new_command = true;
+    }
+}
+
+static void cmdReply(uint8_t transport, const char* text) {
+    const CommandTransport* t = cmd_links[transport].transport;
+    if (t && t->reply) t->reply(text);
+}
+
+// ============================================================================
+// 函数：cmdConfigure
+// 功能：执行配置包并生成回复
+// 说明：回复以收到时的设备ID开头："<id>:CONFIG:ID=新ID[,PENDING]"（电机正在跟踪指令时NVS写入推迟到停车后）/
+//       "<id>:CONFIG:SLOT=槽位,EPOCH=纪元" / "<id>:CONFIG:ID=..,SLOT=..,EPOCH=.." /
+//       "<id>:CONFIG:TELEMETRY=频率"（设置收到该包的传输的遥测频率）；
+//       参数无效回复"<id>:ERROR:BAD_CONFIG"
+// ============================================================================
+static void cmdConfigure(uint8_t transport, const CommandMsg& msg, uint8_t my_id, char* response, size_t size) {
+    uint8_t a = msg.config_arg[0];
+    switch (msg.config_op) {
+        case CONFIG_OP_SET_ID:
+            if (a < 1 || a > MAX_MOTORS) break;
+            setMyDeviceID(a);  // NVS写入由deviceIdService()在电机停止跟踪指令后完成
+            snprintf(response, size, "%d:CONFIG:ID=%d%s", my_id, a, deviceIdSaveDeferred() ? ",PENDING" : "");
+            return;
+        case CONFIG_OP_SET_SLOT:
+            if (a > MAX_MOTORS) break;
+            setMySlot(a, msg.config_arg[1]);
+            snprintf(response, size, "%d:CONFIG:SLOT=%d,EPOCH=%d", my_id, a, msg.config_arg[1]);
+            return;
+        case CONFIG_OP_QUERY:
+            snprintf(response, size, "%d:CONFIG:ID=%d,SLOT=%d,EPOCH=%d", my_id, my_id, getMySlot(), getMySlotEpoch());
+            return;
+        case CONFIG_OP_TELEMETRY:
+            cmdSetTelemetryRate(transport, ((uint32_t)a << 8) | msg.config_arg[1]);
+            snprintf(response, size, "%d:CONFIG:TELEMETRY=%lu", my_id,
+                     (unsigned long)cmd_links[transport].stats.telemetry_hz);
+            return;
+        default:
+            break;
+    }
+    snprintf(response, size, "%d:ERROR:BAD_CONFIG", my_id);
+}
+
+// ============================================================================
+// 函数：cmdDispatch
+// 功能：解码一帧、写入邮箱并经来源传输回复
+// 说明：回复格式"<id>:<包类型>:<目标值>"，未知包类型回复"<id>:ERROR:UNKNOWN_PACKET"；
+//       不含本设备指令的帧不回复。发给其他关节的广播帧在帧头筛选时丢弃，
+//       不记录捕获、不输出调试信息也不解码（丢弃的帧对控制状态没有影响，重放结果不变）
+// ============================================================================
+void cmdDispatch(uint8_t transport, const uint8_t* data, size_t len) {
+    if (transport >= CMD_TRANSPORT_MAX) return;
+    CommandLinkStats& s = cmd_links[transport].stats;
+    s.frames++;
+    uint8_t my_id = getMyDeviceID();
+    if (!cmdAddressed(data, len, my_id)) {
+        s.rejected++;
+        return;
+    }
+    TraceFrameScope trace_frame(data, len, transport);  // 现场捕获：记录本帧
+
+#if CMD_DEBUG
+    halPrintf("[指令调试] 原始数据(HEX): ");
+    for (size_t i = 0; i < len; i++) halPrintf("%02X ", data[i]);
+    halPrintf("\n");
+#endif
+
+    CommandMsg msg;
+    char response[50];
+    switch (cmdDecode(data, len, my_id, &msg)) {
+        case CMD_DECODE_OK:
+            s.accepted++;
+            cmdPost(msg);
+            snprintf(response, sizeof(response), "%d:%s:%.2f", my_id, cmdPacketName(msg.packet_type), ble_motor_target);
+            cmdReply(transport, response);
+            break;
+        case CMD_DECODE_NOT_MINE:
+            s.ignored++;
+            break;
+        case CMD_DECODE_CONFIG:
+            // 广播传输（CAN/无线，没有回复通道）不接受配置：一帧会同时改动所有同ID的设备
+            if (!cmd_links[transport].transport || !cmd_links[transport].transport->reply) {
+                s.invalid++;
+                break;
+            }
+            s.config++;
+            cmdConfigure(transport, msg, my_id, response, sizeof(response));
+            cmdReply(transport, response);
+            break;
+        case CMD_DECODE_UNKNOWN:
+            s.invalid++;
+            snprintf(response, sizeof(response), "%d:ERROR:UNKNOWN_PACKET", my_id);
+            cmdReply(transport, response);
+            halPrintf("[指令] 设备%d收到未知指令: 类型0x%02X\n", my_id, msg.packet_type);
+            break;
+        default:
+            s.invalid++;
+            halPrintf("[指令错误] %s包格式无效或长度不匹配，len=%d\n", cmdPacketName(msg.packet_type), (int)len);
+            break;
+    }
+}
+
+// ============================================================================
+// 函数：cmdReceive
+// 功能：检查序号前缀并分发一帧
+// 返回值：已分发返回true；重复或过期（早于已处理序号）的帧丢弃并返回false
+// 说明：序号为16位、按发送顺序递增；跳过的序号计为丢失帧。落后超过CMD_SEQ_STALE_WINDOW的序号
+//       视为发送端重新开始计数（上位机/网关重启），从该帧重新同步，不计为丢失
+// ============================================================================
+bool cmdReceive(uint8_t transport, const uint8_t* data, size_t len) {
+    if (transport >= CMD_TRANSPORT_MAX) return false;
+    CommandLink& link = cmd_links[transport];
+    if (len >= 3 && data[0] == BLE_SEQ_PREFIX) {
+        uint16_t seq = (uint16_t)((data[1] << 8) | data[2]);
+        if (link.seq_valid) {
+            uint16_t ahead = (uint16_t)(seq - (uint16_t)(link.stats.last_seq + 1));
+            if (ahead >= 0x8000) {
+                if ((uint16_t)(link.stats.last_seq - seq) < CMD_SEQ_STALE_WINDOW) {
+                    link.stats.seq_stale++;
+                    return false;
+                }
+                link.stats.seq_resync++;
+            } else {
+                link.stats.seq_lost += ahead;
+            }
+        }
+        link.stats.last_seq = seq;
+        link.seq_valid = true;
+        data += 3;
+        len -= 3;
+    }
+    if (len == 0) return false;
+    cmdDispatch(transport, data, len);
+    return true;
+}
+
+void cmdResetSequence(uint8_t transport) {
+    if (transport < CMD_TRANSPORT_MAX) cmd_links[transport].seq_valid = false;
+}
+
+// ============================================================================
+// 遥测编解码（小端，按Telemetry字段顺序）
+// ============================================================================
+static inline uint8_t* telemetryPut(uint8_t* p, const void* v, size_t n) {
+    memcpy(p, v, n);
+    return p + n;
+}
+
+static inline const uint8_t* telemetryGet(const uint8_t* p, void* v, size_t n) {
+    memcpy(v, p, n);
+    return p + n;
+}
+
+size_t telemetryEncode(const Telemetry& t, uint16_t seq, uint8_t* out) {
+    uint8_t* p = out;
+    p = telemetryPut(p, &seq, 2);
+    p = telemetryPut(p, &t.t_us, 4);
+    p = telemetryPut(p, &t.angle, 4);
+    p = telemetryPut(p, &t.velocity, 4);
+    p = telemetryPut(p, &t.iq, 4);
+    p = telemetryPut(p, &t.target, 4);
+    p = telemetryPut(p, &t.bus_voltage, 4);
+    p = telemetryPut(p, &t.temperature, 4);
+    p = telemetryPut(p, &t.fault, 2);
+    p = telemetryPut(p, &t.watchdog, 1);
+    p = telemetryPut(p, &t.rx_seq, 2);
+    return (size_t)(p - out);
+}
+
+bool telemetryDecode(const uint8_t* data, size_t len, uint16_t* seq, Telemetry* t) {
+    if (len != TELEMETRY_SIZE) return false;
+    const uint8_t* p = data;
+    p = telemetryGet(p, seq, 2);
+    p = telemetryGet(p, &t->t_us, 4);
+    p = telemetryGet(p, &t->angle, 4);
+    p = telemetryGet(p, &t->velocity, 4);
+    p = telemetryGet(p, &t->iq, 4);
+    p = telemetryGet(p, &t->target, 4);
+    p = telemetryGet(p, &t->bus_voltage, 4);
+    p = telemetryGet(p, &t->temperature, 4);
+    p = telemetryGet(p, &t->fault, 2);
+    p = telemetryGet(p, &t->watchdog, 1);
+    telemetryGet(p, &t->rx_seq, 2);
+    return true;
+}
+
+void cmdSetTelemetryRate(uint8_t transport, uint32_t hz) {
+    if (transport >= CMD_TRANSPORT_MAX) return;
+    cmd_links[transport].stats.telemetry_hz = hz > 5000 ? 5000 : hz;
+    cmd_links[transport].next_valid = false;
+}
+
+// ============================================================================
+// 函数：cmdTelemetryDue
+// 功能：判断某传输是否到达遥测发送时刻
+// 说明：落后超过一个周期时（如被长操作阻塞）从当前时刻重新计时，不补发
+// ============================================================================
+static bool cmdTelemetryDue(CommandLink& link, uint32_t now_us) {
+    if (!link.transport || !link.transport->telemetry || link.stats.telemetry_hz == 0) return false;
+    uint32_t period = 1000000u / link.stats.telemetry_hz;
+    if (!link.next_valid) {
+        link.next_valid = true;
+        link.next_us = now_us;
+    }
+    int32_t late = (int32_t)(now_us - link.next_us);
+    if (late < 0) return false;
+    link.next_us = (uint32_t)late > period ? now_us + period : link.next_us + period;
+    return true;
+}
+
+static bool cmdTelemetrySendSample(CommandLink& link, Telemetry& t) {
+    t.rx_seq = link.stats.last_seq;
+    uint8_t data[TELEMETRY_SIZE];
+    telemetryEncode(t, link.telemetry_seq, data);
+    if (!link.transport->telemetry(data, sizeof(data))) return false;
+    link.telemetry_seq++;
+    link.stats.telemetry++;
+    return true;
+}
+
+// ============================================================================
+// 函数：cmdTelemetryTick
+// 功能：按各传输的频率发送遥测
+// 说明：在本周期控制计算之后调用；多个传输同时到期时只采样一次
+// ============================================================================
+void cmdTelemetryTick(uint32_t now_us) {
+    Telemetry t;
+    bool sampled = false;
+    for (uint8_t id = 0; id < CMD_TRANSPORT_MAX; id++) {
+        CommandLink& link = cmd_links[id];
+        if (!cmdTelemetryDue(link, now_us)) continue;
+        if (!sampled) {
+            telemetrySample(&t);
+            sampled = true;
+        }
+        cmdTelemetrySendSample(link, t);
+    }
+}
+
+bool cmdTelemetrySend(uint8_t transport) {
+    if (transport >= CMD_TRANSPORT_MAX) return false;
+    CommandLink& link = cmd_links[transport];
+    if (!link.transport || !link.transport->telemetry) return false;
+    Telemetry t;
+    telemetrySample(&t);
+    return cmdTelemetrySendSample(link, t);
+}
+
+// ============================================================================
+// 函数：cmdLinkCommand
+// 功能：串口传输统计命令处理
+// ============================================================================
+void cmdLinkCommand(const char* args) {
+    (void)args;
+    for (uint8_t id = 0; id < CMD_TRANSPORT_MAX; id++) {
+        const CommandLink& link = cmd_links[id];
+        if (!link.transport) continue;
+        const CommandLinkStats& s = link.stats;
+        halPrintf("LINK,%s,frames=%lu,accepted=%lu,rejected=%lu,ignored=%lu,invalid=%lu,config=%lu,seq=%u,lost=%lu,"
+                  "stale=%lu,resync=%lu,telemetry=%lu,rate=%lu\n",
+                  link.transport->name, (unsigned long)s.frames, (unsigned long)s.accepted,
+                  (unsigned long)s.rejected, (unsigned long)s.ignored, (unsigned long)s.invalid,
+                  (unsigned long)s.config, s.last_seq, (unsigned long)s.seq_lost, (unsigned long)s.seq_stale,
+                  (unsigned long)s.seq_resync, (unsigned long)s.telemetry, (unsigned long)s.telemetry_hz);
+    }
+}
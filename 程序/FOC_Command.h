@@ -0,0 +1,144 @@
+// ============================================================================
+// 文件：FOC_Command.h
+// 功能：与传输方式无关的指令/遥测层
+// 说明：BLE、串口二进制协议、CAN总线、无线广播都只负责收发字节，指令语义只在这里实现一次：
+//         接收：cmdReceive(传输, 帧) → 序号检查 → cmdAddressed()只看帧头丢弃发给其他关节的帧
+//               → cmdDecode()解码为校验过的CommandMsg
+//               → cmdPost()写入指令邮箱（控制环由getSerialMotorTarget取走）→ 经来源传输回复
+//         遥测：cmdTelemetryTick()在到达任一传输的发送时刻时采样一次，
+//               telemetryEncode()编码为定长小端格式后交给各传输发送
+//       解码直接读取传输的缓冲区，不复制、不分配内存；全部在控制环所在的loop()中调用
+// ============================================================================
+#ifndef FOC_COMMAND_H
+#define FOC_COMMAND_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 传输编号
+// 说明：编号同时写入捕获文件的FRAME记录（高4位参数），重放时按原传输分发
+// ============================================================================
+#define CMD_TRANSPORT_BLE     0     //!< BLE RX特征值
+#define CMD_TRANSPORT_SERIAL  1     //!< 串口二进制协议（FOC_SerialLink.h）
+#define CMD_TRANSPORT_CAN     2     //!< CAN总线（FOC_CanLink.h）
+#define CMD_TRANSPORT_RADIO   3     //!< ESP-NOW无线广播（FOC_RadioLink.h）
+#define CMD_TRANSPORT_MAX     4     //!< 传输槽位数
+
+// 序号检查：落后于已处理序号不超过该窗口的帧视为重复/过期而丢弃；落后更多时视为发送端重新开始计数
+// （如网关脚本重启后序号从0开始），从该帧重新同步，避免在序号追上之前丢弃全部指令
+#define CMD_SEQ_STALE_WINDOW  64
+
+#ifndef CMD_DEBUG
+#define CMD_DEBUG 0                 //!< 逐帧解析调试输出（十六进制转储与各字段）
+#endif
+
+// ============================================================================
+// 数据结构定义：CommandTransport
+// 功能：一种传输方式的发送接口（由传输模块定义为静态常量并注册）
+// ============================================================================
+typedef struct {
+    const char* name;                                       //!< 名称（状态输出用）
+    void (*reply)(const char* text);                        //!< 发送文本回复（可为空）
+    bool (*telemetry)(const uint8_t* data, size_t len);     //!< 发送编码后的遥测，未发送返回false（可为空）
+    uint32_t telemetry_hz;                                  //!< 默认遥测频率（Hz，0为不发送）
+} CommandTransport;
+
+void cmdRegisterTransport(uint8_t id, const CommandTransport* transport);
+
+// ============================================================================
+// 数据结构定义：CommandMsg
+// 功能：解码后的本设备指令
+// ============================================================================
+typedef struct {
+    uint8_t packet_type;        //!< 包类型（PACKET_TYPE_SINGLE等）
+    uint8_t data_type;          //!< 数据类型（DATA_TYPE_ANGLE等）
+    uint8_t count;              //!< MULTI_STRUCT条目数（其他包为0）
+    int16_t raw;                //!< 原始16位值
+    float value;                //!< 缩放后的目标值
+    uint8_t config_op;          //!< CONFIG操作码（CONFIG_OP_SET_ID等）
+    uint8_t config_arg[2];      //!< CONFIG参数（新ID / 槽位、纪元）
+} CommandMsg;
+
+#define CMD_DECODE_OK        0  //!< 包含本设备指令
+#define CMD_DECODE_NOT_MINE  1  //!< 格式有效但不含本设备
+#define CMD_DECODE_INVALID   2  //!< 长度/字段不符
+#define CMD_DECODE_UNKNOWN   3  //!< 未知包类型
+#define CMD_DECODE_CONFIG    4  //!< 发给本设备的配置包（不是控制目标）
+
+// 解码一帧（无副作用），格式见readme中的包格式说明；MULTI_SLOT包按getMySlot()/getMySlotEpoch()取值
+uint8_t cmdDecode(const uint8_t* data, size_t len, uint8_t my_id, CommandMsg* msg);
+// 快速筛选：只读帧头（包类型、ID/起始ID与数量、MULTI_STRUCT的ID列、槽位范围与纪元），不读数值；
+// 返回false时该帧一定不含本设备指令（cmdDecode必为CMD_DECODE_NOT_MINE），
+// 格式无效或未知类型的帧返回true，交给cmdDecode报错
+bool cmdAddressed(const uint8_t* data, size_t len, uint8_t my_id);
+// 写入指令邮箱：喂看门狗，目标值变化时更新ble_motor_target并置new_command
+// （只置位不清除，同一loop内后到的重复/他人帧不会冲掉尚未取走的指令）
+void cmdPost(const CommandMsg& msg);
+// 包类型名（回复文本"<id>:<包类型>:<目标值>"中使用）
+const char* cmdPacketName(uint8_t packet_type);
+
+// ============================================================================
+// 接收入口
+// ============================================================================
+// 带可选序号前缀（BLE_SEQ_PREFIX 序号高 序号低）的帧：检查序号后分发；返回是否已分发
+// （序号落后不超过CMD_SEQ_STALE_WINDOW的帧丢弃，落后更多时重新同步）
+bool cmdReceive(uint8_t transport, const uint8_t* data, size_t len);
+// 不带序号前缀的帧：帧头筛选、解码、写入邮箱并经来源传输回复（筛选丢弃的帧不记录到现场捕获）
+void cmdDispatch(uint8_t transport, const uint8_t* data, size_t len);
+void cmdResetSequence(uint8_t transport);   //!< 重新开始序号检查（连接断开时调用）
+
+// ============================================================================
+// 数据结构定义：CommandLinkStats
+// 功能：每种传输的收发统计
+// ============================================================================
+typedef struct {
+    uint32_t frames;            //!< 分发的帧数
+    uint32_t accepted;          //!< 含本设备指令的帧
+    uint32_t ignored;           //!< 通过帧头筛选但解码后不含本设备指令的帧
+    uint32_t rejected;          //!< 帧头筛选丢弃的帧（发给其他关节）
+    uint32_t invalid;           //!< 格式无效或未知类型的帧（含广播传输上的配置包）
+    uint32_t config;            //!< 执行的配置包
+    uint32_t seq_lost;          //!< 序号缺口累计（未收到的帧数）
+    uint32_t seq_stale;         //!< 重复/过期而丢弃的帧数
+    uint32_t seq_resync;        //!< 发送端重新开始计数而重新同步的次数
+    uint16_t last_seq;          //!< 最近处理的序号
+    uint32_t telemetry;         //!< 已发送遥测帧
+    uint32_t telemetry_hz;      //!< 当前遥测频率
+} CommandLinkStats;
+
+const CommandLinkStats& cmdLinkStats(uint8_t transport);
+
+// ============================================================================
+// 数据结构定义：Telemetry
+// 功能：遥测内容
+// 说明：线上格式为"序号(u16) | 以下字段按声明顺序"，全部小端（ESP32与x86主机相同），
+//       共TELEMETRY_SIZE字节；序号按传输各自递增
+// ============================================================================
+struct Telemetry {
+    uint32_t t_us;          //!< 编码器时间戳（us）
+    float angle;            //!< 电机轴位置（rad）
+    float velocity;         //!< 电机轴速度（rad/s）
+    float iq;               //!< q轴电流（A）
+    float target;           //!< 指令目标（电机轴rad）
+    float bus_voltage;      //!< 母线电压（V）
+    float temperature;      //!< 绕组温度估计（°C）
+    uint16_t fault;         //!< 锁存的故障码
+    uint8_t watchdog;       //!< 看门狗状态（WATCHDOG_IDLE等）
+    uint16_t rx_seq;        //!< 该传输最近处理的指令序号
+};
+#define TELEMETRY_SIZE (2 + 4 + 6 * 4 + 2 + 1 + 2)
+
+size_t telemetryEncode(const Telemetry& t, uint16_t seq, uint8_t* out);    //!< 返回TELEMETRY_SIZE
+bool telemetryDecode(const uint8_t* data, size_t len, uint16_t* seq, Telemetry* t);
+void telemetrySample(Telemetry* t);     //!< 采样当前控制状态（定义在FOC_Control.cpp）
+
+void cmdSetTelemetryRate(uint8_t transport, uint32_t hz);
+// 每个loop调用一次：now_us为本周期编码器时间戳（不额外读时钟）
+void cmdTelemetryTick(uint32_t now_us);
+// 立即向某传输发送一帧遥测（同步总线收到SYNC时调用），返回是否已发送
+bool cmdTelemetrySend(uint8_t transport);
+
+// 串口命令："LINK"（各传输统计）
+void cmdLinkCommand(const char* args);
+
+#endif // FOC_COMMAND_H
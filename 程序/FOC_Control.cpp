@@ -1,4 +1,5 @@
 #include "FOC.h"
+#include <ctype.h>
 
 // ============================================================================
 // 函数：setMotorTorque
@@ -6,9 +7,15 @@
 // 参数：Target - 目标电流值（力矩指令）
 // 说明：这是最内层的电流环控制，直接控制电机的输出力矩
 // ============================================================================
+static float iq_measured_last = 0;  // 最近一次实测q轴电流（供热模型使用，未运行电流环的周期为0）
+static float velocity_measured_last = 0;  // 最近一次滤波后的电机速度（供看门狗减速停车使用）
+
 void setMotorTorque(float Target) {
     // 计算电流环PID输出：目标电流 - 实际测量电流
-    float current_error = Target - getMotorCurrent();
+    float current_measured = getMotorCurrent();
+    iq_measured_last = current_measured;
+    bodeSample(BODE_POINT_IQ, Target, current_measured);  // 频率响应测量（电流环）
+    float current_error = Target - current_measured;
     float pid_output = current_loop_M0(current_error);
     
     // 使用PID输出和电角度设置电机力矩
@@ -23,18 +30,41 @@ void setMotorTorque(float Target) {
 //       位置环（外环）→ 速度环（中环）→ 电流环（内环）
 // ============================================================================
 void setMotorVelocityWithAngle(float Target) {
+    // 0. 故障锁存：保持零输出，不运行PID（避免停机期间积分累积）
+    if (faultActive()) {
+        setPwm(0, 0, 0);
+        return;
+    }
+
+    // 0b. 指令看门狗DAMP/COAST停车：同样保持零输出，收到新指令后恢复
+    if (!watchdogOutputEnabled()) {
+        setPwm(0, 0, 0);
+        return;
+    }
+
     // 1. 位置环控制：计算位置误差并转换为角度PID
     //    将弧度转换为角度（180/PI），计算位置误差
-    float position_error = (Target - getMotorAngle()) * 180 / PI;
+    //    （频率响应测量时，bodeInject在各环参考上叠加正弦扰动，未测量时原样返回）
+    Target = bodeInject(BODE_POINT_POSITION, Target);
+    float angle = getMotorAngle();
+    bodeSample(BODE_POINT_POSITION, Target, angle);
+    float position_error = (Target - angle) * 180 / PI;
     float angle_pid_output = calculateAnglePID(position_error);
     
     // 2. 速度环控制：将位置环输出作为速度环的参考值
     //    速度环输入 = 位置环输出 - 实际速度
-    float velocity_error = angle_pid_output - getMotorVelocity();
+    float velocity_ref = bodeInject(BODE_POINT_VELOCITY, angle_pid_output);
+    float velocity = getMotorVelocity();
+    velocity_measured_last = velocity;
+    bodeSample(BODE_POINT_VELOCITY, velocity_ref, velocity);
+    float velocity_error = velocity_ref - velocity;
     float iq_ref = calculateVelocityPID(velocity_error);
     
-    // 3. 电流限幅：限制q轴电流参考值在安全范围内
-    iq_ref = _constrain(iq_ref, -I_MAX_CMD, I_MAX_CMD);
+    // 3. 电流限幅：限制q轴电流参考值在安全范围内（扰动叠加在限幅之前）
+    //    上限由热模型给出：绕组温度低时为峰值电流THERMAL_I_PEAK（不超过I_MAX_CMD），过热时降到连续电流
+    iq_ref = bodeInject(BODE_POINT_IQ, iq_ref);
+    float iq_limit = thermalCurrentLimit();
+    iq_ref = _constrain(iq_ref, -iq_limit, iq_limit);
     
     // 4. 调用力矩控制函数（电流环）
     setMotorTorque(iq_ref);
@@ -46,6 +76,9 @@ void setMotorVelocityWithAngle(float Target) {
 // 说明：每个控制周期需要执行的核心任务
 //       1. 更新传感器数据（角度）
 //       2. 更新电流传感器数据
+//       3. 更新母线电压（每VBUS_SAMPLE_DIVIDER个周期采样一次）
+//       4. 绕组热模型（按上一周期实测电流更新温度和电流上限）
+//       5. 故障检测（过流/编码器/母线电压/指令超时/周期超时）
 // ============================================================================
 void runFOC() {
     // 更新磁编码器角度数据
@@ -53,40 +86,134 @@ void runFOC() {
     
     // 更新三相电流测量值
     CS_M0.getPhaseCurrents();
+
+    // 更新母线电压及其倒数（供setPwm/setTorque使用）
+    updateBusVoltage();
+
+    // 绕组温度估计与电流降额
+    thermalUpdate(iq_measured_last);
+    iq_measured_last = 0;
+
+    // 故障检测：触发后立即锁存并输出零占空比
+    faultUpdate(voltage_power_supply);
+}
+
+// ============================================================================
+// 函数：serialDispatchCommand
+// 功能：执行一条文本命令
+// 参数：command - 命令字符串（逐行接收的一行，或二进制协议的文本命令帧）
+// ============================================================================
+void serialDispatchCommand(const char* command) {
+    if (strncmp(command, "TRACE", 5) == 0) {
+        // 现场捕获导出命令：停止捕获并以十六进制文本输出
+        traceDumpHex();
+    } else if (strncmp(command, "BODE", 4) == 0) {
+        // 频率响应测量命令：BODE IQ|VEL|POS [起始Hz 终止Hz 幅值] / BODE STOP
+        bodeCommand(command + 4);
+    } else if (strncmp(command, "FAULT", 5) == 0) {
+        // 故障命令：FAULT（状态） / FAULT CLEAR / FAULT TIMEOUT <ms>
+        faultCommand(command + 5);
+    } else if (strncmp(command, "THERMAL", 7) == 0) {
+        // 热模型命令：THERMAL（状态） / THERMAL RESET
+        thermalCommand(command + 7);
+    } else if (strncmp(command, "WATCHDOG", 8) == 0) {
+        // 看门狗命令：WATCHDOG（状态） / WATCHDOG HOLD|DECEL|DAMP|COAST / WATCHDOG TIMEOUT <ms>
+        watchdogCommand(command + 8);
+    } else if (strncmp(command, "MEM", 3) == 0) {
+        // 堆分配统计：MEM（状态） / MEM ON|OFF（每秒输出）
+        memStatsCommand(command + 3);
+    } else if (strncmp(command, "SLINK", 5) == 0) {
+        // 二进制串口协议：SLINK（状态） / SLINK RATE <Hz> / SLINK TEXT
+        serialLinkCommand(command + 5);
+    } else if (strncmp(command, "LINK", 4) == 0) {
+        // 各传输收发统计：LINK
+        cmdLinkCommand(command + 4);
+    } else if (strncmp(command, "CAN", 3) == 0) {
+        // CAN总线状态：CAN
+        canLinkCommand(command + 3);
+    } else if (strncmp(command, "RADIO", 5) == 0) {
+        // 无线广播状态：RADIO
+        radioLinkCommand(command + 5);
+    } else if (strncmp(command, "ID", 2) == 0) {
+        // 设备ID：ID（状态） / ID <新ID>（写入NVS）
+        deviceIdCommand(command + 2);
+    } else {
+        // 提取命令数值：至少含一位数字且其后只有空白（含换行），否则视为无法识别的命令，目标值不变
+        char* end = NULL;
+        float value = strtod(command, &end);
+        bool has_digit = false;
+        for (const char* p = command; p < end; p++) has_digit |= isdigit((unsigned char)*p) != 0;
+        while (has_digit && isspace((unsigned char)*end)) end++;
+        if (!has_digit || *end != '\0') {
+            int n = (int)strcspn(command, "\r\n");
+            if (n > 0) halPrintf("[指令错误] 无法识别的命令：%.*s\n", n, command);  // 空行静默忽略
+            return;
+        }
+        motor_target = value;
+        watchdogFeed();
+        faultNotifyCommand();
+
+        // 回显接收到的目标值（用于调试）
+        halPrintf("%.2f\n", motor_target);
+    }
+}
+
+// ============================================================================
+// 函数：telemetrySample
+// 功能：采样当前控制状态（FOC_Command.h遥测）
+// 说明：在本周期控制计算之后调用，电流为本周期实测值；时间取本周期编码器时间戳
+// ============================================================================
+void telemetrySample(Telemetry* t) {
+    t->t_us = S0.getUpdateTimestamp();
+    t->angle = getMotorAngle();
+    t->velocity = velocity_measured_last;
+    t->iq = iq_measured_last;
+    t->target = motor_target;
+    t->bus_voltage = voltage_power_supply;
+    t->temperature = thermalState().temperature;
+    t->fault = faultStatus().latched;
+    t->watchdog = watchdogStatus().state;
+    t->rx_seq = 0;
 }
 
 // ============================================================================
 // 函数：readSerialCommand
 // 功能：串口通信命令处理
-// 返回值：接收到的完整命令字符串
-// 说明：处理来自串口的控制命令，支持多字符命令的接收和解析
+// 返回值：接收到的完整文本命令（本次调用未收到完整命令时为空串）
+// 说明：文本模式下逐行接收命令；收到0x00字节后切换到二进制协议（FOC_SerialLink.h），
+//       此后的字节按COBS帧接收
 // ============================================================================
-String readSerialCommand() {
-    static String received_chars;  // 静态变量，保存未完成的命令字符
-    String command = "";           // 完整的命令字符串
+const char* readSerialCommand() {
+    static char received_chars[64];  // 静态缓冲区，保存未完成的命令字符
+    static int received_len = 0;     // 缓冲区中已有的字符数
+    static char command[64];         // 完整的命令字符串
+    command[0] = '\0';
 
     // 循环读取所有可用的串口数据
-    while (Serial.available()) {
-        char inChar = (char)Serial.read();  // 读取一个字符
-        received_chars += inChar;           // 添加到接收缓冲区
+    while (halSerialAvailable()) {
+        char inChar = (char)halSerialRead();  // 读取一个字符
+        if (serialLinkActive()) {
+            serialLinkReceive((uint8_t)inChar);  // 二进制模式：按帧接收
+            continue;
+        }
+        if (inChar == '\0') {
+            // 帧界字节：上位机开始使用二进制协议，丢弃未完成的文本行
+            serialLinkBegin();
+            received_len = 0;
+            continue;
+        }
+        if (received_len < (int)sizeof(received_chars) - 1) {
+            received_chars[received_len++] = inChar;  // 添加到接收缓冲区（超长部分丢弃）
+        }
 
         // 检测到换行符表示命令结束
         if (inChar == '\n') {
-            command = received_chars;  // 获取完整命令
-            
-            // 查找换行符位置（命令结束标志）
-            int commaPosition = command.indexOf('\n');
-            if (commaPosition != -1) {
-                // 提取命令数值并转换为浮点数
-                String target_str = command.substring(0, commaPosition);
-                motor_target = target_str.toDouble();
-                
-                // 回显接收到的目标值（用于调试）
-                Serial.println(motor_target);
-            }
+            received_chars[received_len] = '\0';
+            memcpy(command, received_chars, received_len + 1);  // 获取完整命令
+            serialDispatchCommand(command);
             
             // 清空接收缓冲区，准备接收下一条命令
-            received_chars = "";
+            received_len = 0;
         }
     }
     return command;  // 返回处理后的命令
@@ -96,7 +223,8 @@ String readSerialCommand() {
 // 函数：getSerialMotorTarget
 // 功能：BLE蓝牙目标值处理
 // 返回值：处理后的电机目标位置（弧度）
-// 说明：处理来自蓝牙的电机控制命令，支持角度到弧度的转换和去重处理
+// 说明：处理来自蓝牙的电机控制命令，支持角度到弧度的转换和去重处理；
+//       指令看门狗停车时返回停车曲线的目标位置
 // ============================================================================
 float getSerialMotorTarget() {
     static float last_target = 0.0f;  // 保存上一次的目标值，用于去重
@@ -118,14 +246,14 @@ float getSerialMotorTarget() {
             motor_target = motor_rad;    // 设置新的电机目标
             
             // 调试信息：显示转换过程和参数
-            Serial.printf("[DEBUG] BLE输出角度 %.2f° -> 电机目标 %.4f rad (ratio=%g)\n",
+            halPrintf("[DEBUG] BLE输出角度 %.2f° -> 电机目标 %.4f rad (ratio=%g)\n",
                           out_deg, motor_rad, GEAR_RATIO);
         } else {
             // 目标值未变化时的调试信息
-            Serial.printf("[DEBUG] BLE目标未改变: 输出角度 %.2f°\n", out_deg);
+            halPrintf("[DEBUG] BLE目标未改变: 输出角度 %.2f°\n", out_deg);
         }
     }
     
-    // 返回当前电机目标位置
-    return motor_target;
+    // 返回当前电机目标位置（连接断开/指令超时时由看门狗替换为停车目标）
+    return watchdogUpdate(motor_target, getMotorAngle(), velocity_measured_last);
 }
\ No newline at end of file
@@ -18,23 +18,27 @@ float normalizeAngle(float angle) {
 // 函数：setPwm
 // 功能：三相PWM输出控制
 // 参数：Ua, Ub, Uc - 三相电压值
-// 说明：将三相电压转换为PWM占空比并输出到电机驱动器
+// 说明：将三相电压转换为PWM占空比并输出到电机驱动器；
+//       故障锁存时一律输出零占空比（三相下桥导通，短路制动）
 // ============================================================================
 void setPwm(float Ua, float Ub, float Uc) {
+    if (faultActive()) Ua = Ub = Uc = 0;
+
     // 电压限幅：确保电压值在电源电压范围内
     Ua = _constrain(Ua, 0.0f, voltage_power_supply);
     Ub = _constrain(Ub, 0.0f, voltage_power_supply);
     Uc = _constrain(Uc, 0.0f, voltage_power_supply);
     
     // 电压转占空比：计算每相的PWM占空比（0-1范围）
-    float dc_a = _constrain(Ua / voltage_power_supply, 0.0f, 1.0f);
-    float dc_b = _constrain(Ub / voltage_power_supply, 0.0f, 1.0f);
-    float dc_c = _constrain(Uc / voltage_power_supply, 0.0f, 1.0f);
+    // 乘以预先计算的电压倒数，母线电压变化时占空比随之修正，电流环增益保持不变
+    float dc_a = _constrain(Ua * voltage_power_supply_inv, 0.0f, 1.0f);
+    float dc_b = _constrain(Ub * voltage_power_supply_inv, 0.0f, 1.0f);
+    float dc_c = _constrain(Uc * voltage_power_supply_inv, 0.0f, 1.0f);
     
     // PWM输出：将占空比转换为8位PWM值（0-255）并输出
-    ledcWrite(0, dc_a*255);  // A相PWM输出
-    ledcWrite(1, dc_b*255);  // B相PWM输出
-    ledcWrite(2, dc_c*255);  // C相PWM输出
+    halPwmWrite(0, dc_a*255);  // A相PWM输出
+    halPwmWrite(1, dc_b*255);  // B相PWM输出
+    halPwmWrite(2, dc_c*255);  // C相PWM输出
 }
 
 // ============================================================================
@@ -45,8 +49,9 @@ void setPwm(float Ua, float Ub, float Uc) {
 // ============================================================================
 void setTorque(float Uq, float angle_el) {
     // q轴电压限幅：限制在±电源电压/2范围内
-    Uq = _constrain(Uq, -(voltage_power_supply)/2, (voltage_power_supply)/2);
-    float Ud = 0;  // d轴电压设为0（磁场定向控制，d轴不产生力矩）
+    float half_supply = 0.5f * voltage_power_supply;
+    Uq = _constrain(Uq, -half_supply, half_supply);
+    // d轴电压为0（磁场定向控制，d轴不产生力矩），下面的帕克逆变换省略Ud项
     
     // 电角度归一化处理
     angle_el = normalizeAngle(angle_el);
@@ -60,9 +65,9 @@ void setTorque(float Uq, float angle_el) {
     
     // 克拉克逆变换（Clarke逆变换）：将αβ坐标系转换为三相ABC坐标系
     // 标准三相逆变器电压公式：
-    Ua = Ualpha + voltage_power_supply/2;                    // A相电压
-    Ub = (sqrt(3)*Ubeta-Ualpha)/2 + voltage_power_supply/2;  // B相电压
-    Uc = (-Ualpha-sqrt(3)*Ubeta)/2 + voltage_power_supply/2; // C相电压
+    Ua = Ualpha + half_supply;                         // A相电压
+    Ub = (_SQRT3*Ubeta-Ualpha)/2 + half_supply;        // B相电压
+    Uc = (-Ualpha-_SQRT3*Ubeta)/2 + half_supply;       // C相电压
     
     // 调用PWM输出函数，将电压转换为实际PWM信号
     setPwm(Ua, Ub, Uc);
@@ -80,41 +85,89 @@ float electricalAngle() {
     return normalizeAngle((float)(DIR * PP) * S0.getMechanicalAngle() - zero_electric_angle);
 }
 
+// ============================================================================
+// 函数：setBusVoltage
+// 功能：更新母线电压及其倒数
+// 参数：v_bus - 母线电压（伏特）
+// 说明：倒数在这里计算一次，setPwm()每相只做乘法
+// ============================================================================
+void setBusVoltage(float v_bus) {
+    voltage_power_supply = v_bus;
+    voltage_power_supply_inv = v_bus > 0.1f ? 1.0f / v_bus : 0.0f;
+}
+
+// ============================================================================
+// 函数：readBusVoltage
+// 功能：读取一次母线电压（ADC电压 × 分压比）
+// ============================================================================
+static float readBusVoltage() {
+    return halAdcRead(VBUS_ADC_PIN) * (3.3f / 4095.0f) * VBUS_DIVIDER;
+}
+
+// ============================================================================
+// 函数：updateBusVoltage
+// 功能：母线电压采样与滤波（在runFOC中每个控制周期调用）
+// 说明：每VBUS_SAMPLE_DIVIDER个周期采样一次，一阶滤波后更新电压和倒数；
+//       未接分压电路时直接返回
+// ============================================================================
+void updateBusVoltage() {
+    static uint8_t vbus_count = 0;
+    if (!vbus_sensing || ++vbus_count < VBUS_SAMPLE_DIVIDER) return;
+    vbus_count = 0;
+    float v = readBusVoltage();
+    setBusVoltage(voltage_power_supply + VBUS_FILTER_ALPHA * (v - voltage_power_supply));
+}
+
 // ============================================================================
 // 函数：setPowerSupplyVoltage
 // 功能：系统硬件初始化
-// 参数：power_supply - 电源电压值
-// 说明：初始化PWM、编码器、电流传感器等硬件外设
+// 参数：power_supply - 电源电压值（未接母线电压分压电路时作为固定值使用）
+// 说明：初始化母线电压采样、PWM、编码器、电流传感器等硬件外设
 // ============================================================================
 void setPowerSupplyVoltage(float power_supply) {
     // 设置电源电压全局变量
-    voltage_power_supply = power_supply;
+    setBusVoltage(power_supply);
+
+    // 母线电压采样：上电取16次平均作为滤波初值，读数过低说明未接分压电路，沿用设定值
+    if (VBUS_ADC_PIN >= 0) {
+        halPinInput(VBUS_ADC_PIN);
+        float sum = 0;
+        for (int i = 0; i < 16; i++) sum += readBusVoltage();
+        float v = sum / 16;
+        vbus_sensing = v >= VBUS_MIN_VALID;
+        if (vbus_sensing) {
+            setBusVoltage(v);
+            halPrintf("母线电压实测：%.2fV\n", v);
+        } else {
+            halPrintf("母线电压读数%.2fV过低，使用设定值%.2fV\n", v, power_supply);
+        }
+    }
     
     // PWM引脚初始化
-    pinMode(pwmA, OUTPUT);  // A相PWM引脚
-    pinMode(pwmB, OUTPUT);  // B相PWM引脚
-    pinMode(pwmC, OUTPUT);  // C相PWM引脚
+    halPinOutput(pwmA);  // A相PWM引脚
+    halPinOutput(pwmB);  // B相PWM引脚
+    halPinOutput(pwmC);  // C相PWM引脚
     
     // PWM通道配置：30kHz频率，8位分辨率
-    ledcSetup(0, 30000, 8);  // 通道0：A相
-    ledcSetup(1, 30000, 8);  // 通道1：B相
-    ledcSetup(2, 30000, 8);  // 通道2：C相
+    halPwmSetup(0, 30000, 8);  // 通道0：A相
+    halPwmSetup(1, 30000, 8);  // 通道1：B相
+    halPwmSetup(2, 30000, 8);  // 通道2：C相
     
     // PWM引脚与通道绑定
-    ledcAttachPin(pwmA, 0);  // A相引脚绑定到通道0
-    ledcAttachPin(pwmB, 1);  // B相引脚绑定到通道1
-    ledcAttachPin(pwmC, 2);  // C相引脚绑定到通道2
+    halPwmAttach(pwmA, 0);  // A相引脚绑定到通道0
+    halPwmAttach(pwmB, 1);  // B相引脚绑定到通道1
+    halPwmAttach(pwmC, 2);  // C相引脚绑定到通道2
     
-    Serial.println("完成PWM初始化设置");
+    halPrintf("完成PWM初始化设置\n");
 
     // AS5600磁编码器初始化
     // I2C总线配置：SDA=19, SCL=18, 400kHz速率
-    S0_I2C.begin(19, 18, 400000UL);
-    S0.Sensor_init(&S0_I2C);  // 编码器传感器初始化
-    Serial.println("编码器加载完毕");
+    halI2CBegin(S0_I2C, 19, 18, 400000UL);
+    S0.Sensor_init(S0_I2C);  // 编码器传感器初始化
+    halPrintf("编码器加载完毕\n");
 
     // 速度环PID控制器重新初始化
-    vel_loop_M0 = PIDController{.P = 2, .I = 0, .D = 0, .ramp = 100000, .limit = voltage_power_supply/2};
+    vel_loop_M0 = PIDController(2, 0, 0, 100000, voltage_power_supply/2);
     
     // 电流传感器初始化
     CS_M0.init();
@@ -134,10 +187,20 @@ void calibrateSensor(int _PP, int _DIR) {
     // 第一步：施加固定力矩使电机转到特定位置（3π/2位置）
     // 这个位置有助于确定零电角度
     setTorque(3, _3PI_2);
-    delay(1000);  // 等待1秒让电机稳定
+    halDelayMs(1000);  // 等待1秒让电机稳定
     
-    // 第二步：更新编码器读数
+    // 第二步：更新编码器读数；同时读取相电流辨识绕组电阻（转子静止，电流 = Uα / R）
+    // 电流已稳定，在一段窗口内多次采样取平均，减小单次ADC采样噪声的影响
     S0.Sensor_update();
+    float i_alpha_sum = 0;
+    for (int i = 0; i < THERMAL_R_ID_SAMPLES; i++) {
+        if (i > 0) halDelayUs(THERMAL_R_ID_INTERVAL_US);
+        CS_M0.getPhaseCurrents();
+        i_alpha_sum += CS_M0.current_a;
+    }
+    if (thermalIdentifyResistance(3.0f, i_alpha_sum / THERMAL_R_ID_SAMPLES)) {
+        halPrintf("相电阻辨识：%.3fΩ\n", thermalState().r_identified);
+    }
     
     // 第三步：计算并保存零电角度
     // 零电角度是电机当前位置的电角度，作为后续计算的基准
@@ -147,6 +210,5 @@ void calibrateSensor(int _PP, int _DIR) {
     setTorque(0, _3PI_2);
     
     // 输出校准结果
-    Serial.print("0电角度：");
-    Serial.println(zero_electric_angle);
+    halPrintf("0电角度：%.2f\n", zero_electric_angle);
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+// ============================================================================
+// 文件：FOC_Fault.cpp
+// 功能：故障检测与安全停机实现
+// 说明：faultUpdate()只读取本周期已更新的传感器/电流数据和编码器时间戳，
+//       不增加HAL调用，每周期开销为固定的若干次比较
+// ============================================================================
+#include "FOC.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+volatile uint16_t fault_latched = FAULT_NONE;
+
+static FaultStatus fault_status = {};
+static bool fault_report_pending = false;        //!< 新故障尚未经BLE上报
+static uint32_t fault_cmd_timeout_ms = FAULT_CMD_TIMEOUT_MS;
+
+static bool fault_has_prev = false;              //!< 已有上一周期的时间戳和角度
+static uint32_t fault_prev_ts = 0;               //!< 上一周期编码器更新时间戳
+static float fault_prev_angle = 0;               //!< 上一周期有效角度
+static bool fault_angle_valid = false;           //!< fault_prev_angle是否有效
+static uint32_t fault_now_us = 0;                //!< 本周期时间戳（编码器更新时刻）
+static bool fault_cmd_seen = false;              //!< 已收到过指令（超时计时开始）
+static uint32_t fault_cmd_ts = 0;                //!< 最近一次指令的时间戳
+
+const char* faultName(uint16_t code) {
+    switch (code) {
+        case FAULT_OVERCURRENT: return "OVERCURRENT";
+        case FAULT_ENCODER_I2C: return "ENCODER_I2C";
+        case FAULT_ANGLE_JUMP: return "ANGLE_JUMP";
+        case FAULT_UNDERVOLTAGE: return "UNDERVOLTAGE";
+        case FAULT_OVERVOLTAGE: return "OVERVOLTAGE";
+        case FAULT_CMD_TIMEOUT: return "CMD_TIMEOUT";
+        case FAULT_LOOP_OVERRUN: return "LOOP_OVERRUN";
+        case FAULT_OVERTEMP: return "OVERTEMP";
+        default: return "NONE";
+    }
+}
+
+// ============================================================================
+// 函数：faultTrip
+// 功能：锁存故障并立即进入安全状态
+// 参数：code - 故障码，value - 触发时的测量值
+// 说明：第一个故障记录触发值并输出一次串口信息；之后的故障只追加到锁存码
+// ============================================================================
+void faultTrip(uint16_t code, float value) {
+    if (fault_latched & code) return;
+    bool first = fault_latched == FAULT_NONE;
+    fault_latched |= code;
+    fault_status.latched = fault_latched;
+    if (!first) return;
+
+    fault_status.first = code;
+    fault_status.trip_value = value;
+    fault_status.trip_count++;
+    fault_report_pending = true;
+
+    // 零占空比：三相下桥导通，电机短路制动
+    setPwm(0, 0, 0);
+    halPrintf("[FAULT] %s (0x%04X) 触发值 %.3f，已停止输出\n", faultName(code), code, value);
+}
+
+// ============================================================================
+// 函数：faultUpdate
+// 功能：每个控制周期的故障检测
+// 参数：bus_voltage - 母线电压（V）
+// 说明：在S0.Sensor_update()和CS_M0.getPhaseCurrents()之后调用；
+//       第一次调用只记录时间戳和角度，不做周期和跳变判断
+// ============================================================================
+void faultUpdate(float bus_voltage) {
+    uint32_t now = S0.getUpdateTimestamp();
+    fault_now_us = now;
+
+    // 1. 过流：三相电流（C相由A、B相计算）
+    float ia = fabsf(CS_M0.current_a);
+    float ib = fabsf(CS_M0.current_b);
+    float ic = fabsf(CS_M0.current_a + CS_M0.current_b);
+    float i_peak = ia > ib ? ia : ib;
+    if (ic > i_peak) i_peak = ic;
+    if (i_peak > fault_status.peak_current) fault_status.peak_current = i_peak;
+    if (i_peak > FAULT_OVERCURRENT_A) faultTrip(FAULT_OVERCURRENT, i_peak);
+
+    // 2. 编码器：连续读取失败 / 角度跳变
+    uint32_t period = fault_has_prev ? now - fault_prev_ts : 0;
+    if (!S0.readOk()) {
+        fault_status.i2c_errors++;
+        if (S0.getFailStreak() >= FAULT_I2C_FAIL_LIMIT) faultTrip(FAULT_ENCODER_I2C, (float)S0.getFailStreak());
+    } else {
+        float angle = S0.getAngle();
+        if (fault_angle_valid) {
+            float jump = fabsf(angle - fault_prev_angle);
+            float limit = FAULT_MAX_SPEED_RAD_S * period * 1e-6f;
+            if (limit < FAULT_ANGLE_JUMP_RAD) limit = FAULT_ANGLE_JUMP_RAD;
+            if (jump > limit) faultTrip(FAULT_ANGLE_JUMP, jump);
+        }
+        fault_prev_angle = angle;
+        fault_angle_valid = true;
+    }
+
+    // 3. 母线电压
+    if (bus_voltage < FAULT_UNDERVOLTAGE_V) faultTrip(FAULT_UNDERVOLTAGE, bus_voltage);
+    if (bus_voltage > FAULT_OVERVOLTAGE_V) faultTrip(FAULT_OVERVOLTAGE, bus_voltage);
+
+    // 4. 控制周期
+    if (fault_has_prev) {
+        if (period > fault_status.max_period_us) fault_status.max_period_us = period;
+        if (period > FAULT_LOOP_OVERRUN_US) faultTrip(FAULT_LOOP_OVERRUN, (float)period);
+    }
+    fault_prev_ts = now;
+    fault_has_prev = true;
+
+    // 5. 指令超时（收到第一条指令后开始计时）
+    if (fault_cmd_timeout_ms > 0 && fault_cmd_seen) {
+        uint32_t idle_us = now - fault_cmd_ts;
+        if (idle_us > fault_cmd_timeout_ms * 1000u) faultTrip(FAULT_CMD_TIMEOUT, idle_us * 1e-3f);
+    }
+}
+
+// ============================================================================
+// 函数：faultNotifyCommand
+// 功能：记录指令到达时刻（使用本周期编码器时间戳，不额外读取时钟）
+// ============================================================================
+void faultNotifyCommand() {
+    fault_cmd_ts = fault_now_us;
+    fault_cmd_seen = true;
+}
+
+const FaultStatus& faultStatus() { return fault_status; }
+
+void faultSetCommandTimeout(uint32_t ms) {
+    fault_cmd_timeout_ms = ms;
+    fault_cmd_ts = fault_now_us;
+}
+
+// ============================================================================
+// 函数：faultRestartPeriod
+// 功能：已知的阻塞操作之后重新开始控制周期测量
+// 说明：下一次faultUpdate()只记录时间戳，不把有意的停顿计为控制环超时；
+//       三环PID同时复位（目标不变），避免按停顿时长积分造成电流突跳
+// ============================================================================
+void faultRestartPeriod() {
+    fault_has_prev = false;
+    angle_loop_M0.reset();
+    vel_loop_M0.reset();
+    current_loop_M0.reset();
+}
+
+bool faultTakeReport() {
+    if (!fault_report_pending) return false;
+    fault_report_pending = false;
+    return true;
+}
+
+// ============================================================================
+// 函数：faultClear
+// 功能：清除锁存的故障并重新投入控制
+// 返回值：清除前是否有故障
+// 说明：三环PID复位，目标位置设为当前位置，避免恢复时朝旧目标突跳；
+//       故障条件仍然存在时下一个周期会再次触发
+// ============================================================================
+bool faultClear() {
+    bool had = fault_latched != FAULT_NONE;
+    fault_latched = FAULT_NONE;
+    fault_status.latched = FAULT_NONE;
+    fault_status.first = FAULT_NONE;
+    fault_status.trip_value = 0;
+    fault_status.peak_current = 0;
+    fault_status.max_period_us = 0;
+    fault_report_pending = false;
+    fault_has_prev = false;
+    fault_cmd_ts = fault_now_us;
+
+    angle_loop_M0.reset();
+    vel_loop_M0.reset();
+    current_loop_M0.reset();
+    motor_target = getMotorAngle();
+    return had;
+}
+
+// ============================================================================
+// 函数：faultCommand
+// 功能：串口故障命令处理
+// ============================================================================
+void faultCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (strncmp(args, "CLEAR", 5) == 0) {
+        bool had = faultClear();
+        halPrintf("FAULT_CLEAR,%d\n", had ? 1 : 0);
+        return;
+    }
+    if (strncmp(args, "TIMEOUT", 7) == 0) {
+        faultSetCommandTimeout((uint32_t)strtoul(args + 7, NULL, 10));
+        halPrintf("FAULT_TIMEOUT,%lu\n", (unsigned long)fault_cmd_timeout_ms);
+        return;
+    }
+    const FaultStatus& s = fault_status;
+    halPrintf("FAULT,0x%04X,%s,%.3f,trips=%lu,i2c_err=%lu,ipk=%.2f,tmax=%lu\n",
+              s.latched, faultName(s.first), s.trip_value, (unsigned long)s.trip_count,
+              (unsigned long)s.i2c_errors, s.peak_current, (unsigned long)s.max_period_us);
+}
@@ -0,0 +1,94 @@
+// ============================================================================
+// 文件：FOC_Fault.h
+// 功能：故障检测与安全停机（STO）
+// 说明：每个控制周期在runFOC()中调用faultUpdate()，以固定的少量比较检查：
+//       过流（三相电流）、编码器I2C读取失败、角度跳变、母线欠压/过压、
+//       指令超时和控制周期超时（绕组过温由热模型通过faultTrip触发）。
+//       任一故障触发后故障码锁存，setPwm()立即输出零占空比（三相下桥导通，短路制动），三环控制停止运行，
+//       直到串口"FAULT CLEAR"清除。故障码随BLE心跳上报（"<id>:FAULT:<码>:<名称>"）
+// ============================================================================
+#ifndef FOC_FAULT_H
+#define FOC_FAULT_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 故障码（按位组合）
+// ============================================================================
+#define FAULT_NONE          0x0000
+#define FAULT_OVERCURRENT   0x0001  //!< 相电流超过FAULT_OVERCURRENT_A
+#define FAULT_ENCODER_I2C   0x0002  //!< 编码器连续FAULT_I2C_FAIL_LIMIT次读取失败
+#define FAULT_ANGLE_JUMP    0x0004  //!< 相邻两次角度变化超出物理可能
+#define FAULT_UNDERVOLTAGE  0x0008  //!< 母线电压低于FAULT_UNDERVOLTAGE_V
+#define FAULT_OVERVOLTAGE   0x0010  //!< 母线电压高于FAULT_OVERVOLTAGE_V
+#define FAULT_CMD_TIMEOUT   0x0020  //!< 超过设定时间未收到新指令
+#define FAULT_LOOP_OVERRUN  0x0040  //!< 控制周期超过FAULT_LOOP_OVERRUN_US
+#define FAULT_OVERTEMP      0x0080  //!< 绕组估计温度超过THERMAL_T_TRIP（FOC_Thermal.h）
+
+// ============================================================================
+// 阈值（可在编译时覆盖）
+// ============================================================================
+#ifndef FAULT_OVERCURRENT_A
+#define FAULT_OVERCURRENT_A 3.2f        //!< 相电流保护阈值（A），采样满量程约±3.3A，须高于I_MAX_CMD（FOC.h）
+#endif
+#ifndef FAULT_I2C_FAIL_LIMIT
+#define FAULT_I2C_FAIL_LIMIT 3          //!< 允许的连续I2C失败次数（单次失败沿用上次角度）
+#endif
+#ifndef FAULT_ANGLE_JUMP_RAD
+#define FAULT_ANGLE_JUMP_RAD 0.5f       //!< 单周期角度变化下限（电机轴rad）
+#endif
+#ifndef FAULT_MAX_SPEED_RAD_S
+#define FAULT_MAX_SPEED_RAD_S 300.0f    //!< 电机轴最高可信转速（rad/s），长周期时按此放宽跳变阈值
+#endif
+#ifndef FAULT_UNDERVOLTAGE_V
+#define FAULT_UNDERVOLTAGE_V 10.0f      //!< 欠压阈值（V）
+#endif
+#ifndef FAULT_OVERVOLTAGE_V
+#define FAULT_OVERVOLTAGE_V 26.0f       //!< 过压阈值（V）
+#endif
+#ifndef FAULT_LOOP_OVERRUN_US
+#define FAULT_LOOP_OVERRUN_US 20000     //!< 控制周期上限（us），正常约270us
+#endif
+#ifndef FAULT_CMD_TIMEOUT_MS
+#define FAULT_CMD_TIMEOUT_MS 0          //!< 指令超时（ms），0为关闭；上位机只在目标变化时发送，默认不启用
+#endif
+
+// ============================================================================
+// 数据结构定义：FaultStatus
+// 功能：故障管理器状态（供串口/遥测读取）
+// ============================================================================
+struct FaultStatus {
+    uint16_t latched;          //!< 锁存的故障码（按位）
+    uint16_t first;            //!< 第一个触发的故障码
+    uint32_t trip_count;       //!< 累计触发次数
+    uint32_t i2c_errors;       //!< 累计编码器读取失败次数
+    float peak_current;        //!< 清除后观测到的最大相电流（A）
+    uint32_t max_period_us;    //!< 清除后观测到的最长控制周期（us）
+    float trip_value;          //!< 第一个故障触发时的测量值（A/rad/V/ms/us/°C）
+};
+
+// ============================================================================
+// 控制环接口
+// ============================================================================
+void faultUpdate(float bus_voltage);    //!< 每个控制周期调用一次（传感器和电流更新之后）
+void faultNotifyCommand();              //!< 收到有效指令时调用（指令超时计时清零，同值重发也算）
+void faultTrip(uint16_t code, float value);  //!< 触发并锁存故障（可由其他模块调用）
+
+// 故障锁存时setPwm()输出零占空比，控制环跳过PID计算
+extern volatile uint16_t fault_latched;  //!< 锁存的故障码（热路径只判断是否为0）
+static inline bool faultActive() { return fault_latched != FAULT_NONE; }
+
+// ============================================================================
+// 管理接口
+// ============================================================================
+const FaultStatus& faultStatus();       //!< 当前状态
+bool faultClear();                      //!< 清除锁存（三环复位，目标设为当前位置）
+void faultSetCommandTimeout(uint32_t ms);  //!< 设置指令超时（0关闭）
+void faultRestartPeriod();              //!< 已知的阻塞操作（如NVS写入）之后调用：重新开始控制周期测量并复位三环PID
+const char* faultName(uint16_t code);   //!< 单个故障码名称
+bool faultTakeReport();                 //!< 有未上报的新故障时返回true（只返回一次）
+
+// 串口命令："FAULT"（状态）、"FAULT CLEAR"、"FAULT TIMEOUT <ms>"（args为FAULT之后的部分）
+void faultCommand(const char* args);
+
+#endif // FOC_FAULT_H
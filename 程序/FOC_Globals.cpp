@@ -6,7 +6,9 @@
 // ============================================================================
 
 // 电源相关变量
-float voltage_power_supply;  // 电源电压值（单位：伏特），在系统初始化时设置
+float voltage_power_supply;  // 电源电压值（单位：伏特），在系统初始化时设置，接有分压电路时为滤波后的实测值
+float voltage_power_supply_inv = 0;  // 电源电压倒数（1/V），每次电压更新时计算，调制时用乘法代替除法
+bool vbus_sensing = false;           // 是否在控制周期中采样母线电压
 
 // FOC变换过程中的中间电压变量
 float Ualpha = 0;  // α轴电压分量（帕克逆变换输出）
@@ -38,33 +40,33 @@ LowPassFilter M0_Vel_Flt = LowPassFilter(0.01);   // 速度环低通滤波器，
 LowPassFilter M0_Curr_Flt = LowPassFilter(0.05);  // 电流环低通滤波器，截止频率0.05Hz
 
 // PID控制器对象（三环控制结构）
-PIDController vel_loop_M0 = PIDController{
-    .P = 2,        // 速度环比例增益
-    .I = 0,        // 速度环积分增益
-    .D = 0,        // 速度环微分增益
-    .ramp = 100000, // 输出变化率限制（防止突变）
-    .limit = voltage_power_supply/2  // 输出限幅（电源电压的一半）
-};
+PIDController vel_loop_M0 = PIDController(
+    2,        // 速度环比例增益
+    0,        // 速度环积分增益
+    0,        // 速度环微分增益
+    100000,   // 输出变化率限制（防止突变）
+    voltage_power_supply/2  // 输出限幅（电源电压的一半）
+);
 
-PIDController angle_loop_M0 = PIDController{
-    .P = 2,        // 位置环比例增益
-    .I = 0,        // 位置环积分增益
-    .D = 0,        // 位置环微分增益
-    .ramp = 100000, // 输出变化率限制
-    .limit = 100   // 位置环输出限幅（100度/秒）
-};
+PIDController angle_loop_M0 = PIDController(
+    2,        // 位置环比例增益
+    0,        // 位置环积分增益
+    0,        // 位置环微分增益
+    100000,   // 输出变化率限制
+    100       // 位置环输出限幅（100度/秒）
+);
 
-PIDController current_loop_M0 = PIDController{
-    .P = 1.2,      // 电流环比例增益
-    .I = 0,        // 电流环积分增益
-    .D = 0,        // 电流环微分增益
-    .ramp = 100000, // 输出变化率限制
-    .limit = 12.6  // 电流环输出限幅（12.6A，基于电源电压计算）
-};
+PIDController current_loop_M0 = PIDController(
+    1.2,      // 电流环比例增益
+    0,        // 电流环积分增益
+    0,        // 电流环微分增益
+    100000,   // 输出变化率限制
+    12.6      // 电流环输出限幅（12.6A，基于电源电压计算）
+);
 
 // 传感器对象
 Sensor_AS5600 S0 = Sensor_AS5600(0);  // AS5600磁编码器对象，I2C地址0
-TwoWire S0_I2C = TwoWire(0);          // I2C总线对象，使用Wire0
+const uint8_t S0_I2C = 0;             // I2C总线编号，使用Wire0
 
 // 电流传感器对象
 CurrSense CS_M0 = CurrSense(0);       // 电流传感器对象，用于测量电机相电流
\ No newline at end of file
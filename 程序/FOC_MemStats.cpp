@@ -0,0 +1,127 @@
+// ============================================================================
+// 文件：FOC_MemStats.cpp
+// 功能：堆分配统计实现
+// 说明：计数器可能在BLE任务和控制任务中同时更新，使用原子加；
+//       替换的operator new/delete直接转发到malloc/free
+// ============================================================================
+#include "FOC.h"
+
+#include <new>
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+static uint32_t mem_allocs = 0;
+static uint32_t mem_frees = 0;
+static uint32_t mem_alloc_bytes = 0;
+
+static MemStats mem_stats = {};
+static uint32_t mem_window_ms = 0;          //!< 当前统计窗口起点（ms）
+static bool mem_window_valid = false;
+static uint32_t mem_window_allocs = 0;      //!< 窗口起点时的累计值
+static uint32_t mem_window_frees = 0;
+static uint32_t mem_window_bytes = 0;
+static bool mem_report = false;             //!< 每秒输出一行
+
+static inline void memCountAlloc(size_t n) {
+    __atomic_fetch_add(&mem_allocs, 1u, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&mem_alloc_bytes, (uint32_t)n, __ATOMIC_RELAXED);
+}
+
+static inline void memCountFree(void* p) {
+    if (p) __atomic_fetch_add(&mem_frees, 1u, __ATOMIC_RELAXED);
+}
+
+#if MEM_STATS_HOOK_NEW
+// ============================================================================
+// 全局operator new/delete替换
+// ============================================================================
+void* operator new(size_t n) {
+    memCountAlloc(n);
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t n) {
+    memCountAlloc(n);
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    memCountAlloc(n);
+    return malloc(n ? n : 1);
+}
+
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    memCountAlloc(n);
+    return malloc(n ? n : 1);
+}
+
+void operator delete(void* p) noexcept { memCountFree(p); free(p); }
+void operator delete[](void* p) noexcept { memCountFree(p); free(p); }
+void operator delete(void* p, size_t) noexcept { memCountFree(p); free(p); }
+void operator delete[](void* p, size_t) noexcept { memCountFree(p); free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { memCountFree(p); free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { memCountFree(p); free(p); }
+#endif // MEM_STATS_HOOK_NEW
+
+// ============================================================================
+// 函数：memStatsTick
+// 功能：每秒结算一次分配速率
+// 参数：now_ms - 当前时间（ms，BLE_Server_Loop已读取的值，不额外读时钟）
+// ============================================================================
+void memStatsTick(uint32_t now_ms) {
+    if (!mem_window_valid) {
+        mem_window_valid = true;
+        mem_window_ms = now_ms;
+        mem_window_allocs = mem_allocs;
+        mem_window_frees = mem_frees;
+        mem_window_bytes = mem_alloc_bytes;
+        return;
+    }
+    if (now_ms - mem_window_ms < 1000) return;
+
+    uint32_t allocs = __atomic_load_n(&mem_allocs, __ATOMIC_RELAXED);
+    uint32_t frees = __atomic_load_n(&mem_frees, __ATOMIC_RELAXED);
+    uint32_t bytes = __atomic_load_n(&mem_alloc_bytes, __ATOMIC_RELAXED);
+    mem_stats.allocs_per_s = allocs - mem_window_allocs;
+    mem_stats.frees_per_s = frees - mem_window_frees;
+    mem_stats.bytes_per_s = bytes - mem_window_bytes;
+    mem_window_allocs = allocs;
+    mem_window_frees = frees;
+    mem_window_bytes = bytes;
+    mem_window_ms = now_ms;
+    halHeapInfo(&mem_stats.heap_free, &mem_stats.heap_min_free);
+
+    if (mem_report) {
+        halPrintf("MEM,alloc/s=%lu,free/s=%lu,bytes/s=%lu,heap=%lu,min=%lu\n",
+                  (unsigned long)mem_stats.allocs_per_s, (unsigned long)mem_stats.frees_per_s,
+                  (unsigned long)mem_stats.bytes_per_s, (unsigned long)mem_stats.heap_free,
+                  (unsigned long)mem_stats.heap_min_free);
+    }
+}
+
+const MemStats& memStats() {
+    mem_stats.allocs = __atomic_load_n(&mem_allocs, __ATOMIC_RELAXED);
+    mem_stats.frees = __atomic_load_n(&mem_frees, __ATOMIC_RELAXED);
+    mem_stats.alloc_bytes = __atomic_load_n(&mem_alloc_bytes, __ATOMIC_RELAXED);
+    return mem_stats;
+}
+
+// ============================================================================
+// 函数：memStatsCommand
+// 功能：串口内存统计命令处理
+// ============================================================================
+void memStatsCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (strncmp(args, "ON", 2) == 0) mem_report = true;
+    if (strncmp(args, "OFF", 3) == 0) mem_report = false;
+    const MemStats& s = memStats();
+    halPrintf("MEM,allocs=%lu,frees=%lu,bytes=%lu,alloc/s=%lu,heap=%lu,min=%lu,report=%d\n",
+              (unsigned long)s.allocs, (unsigned long)s.frees, (unsigned long)s.alloc_bytes,
+              (unsigned long)s.allocs_per_s, (unsigned long)s.heap_free, (unsigned long)s.heap_min_free,
+              mem_report ? 1 : 0);
+}
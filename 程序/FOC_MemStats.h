@@ -0,0 +1,38 @@
+// ============================================================================
+// 文件：FOC_MemStats.h
+// 功能：堆分配统计
+// 说明：替换全局operator new/delete，累计分配/释放次数和分配字节数；
+//       loop()中每秒结算一次，得到每秒分配次数，用于确认BLE接收等稳态路径上没有堆操作。
+//       只统计C++分配（std::string、new等），C库malloc以空闲堆变化反映
+// ============================================================================
+#ifndef FOC_MEM_STATS_H
+#define FOC_MEM_STATS_H
+
+#include "HAL.h"
+
+#ifndef MEM_STATS_HOOK_NEW
+#define MEM_STATS_HOOK_NEW 1        //!< 是否替换全局operator new/delete（与其他替换冲突时定义为0）
+#endif
+
+// ============================================================================
+// 数据结构定义：MemStats
+// 功能：分配统计（供串口读取）
+// ============================================================================
+struct MemStats {
+    uint32_t allocs;            //!< 累计分配次数
+    uint32_t frees;             //!< 累计释放次数
+    uint32_t alloc_bytes;       //!< 累计分配字节数
+    uint32_t allocs_per_s;      //!< 上一秒分配次数
+    uint32_t frees_per_s;       //!< 上一秒释放次数
+    uint32_t bytes_per_s;       //!< 上一秒分配字节数
+    uint32_t heap_free;         //!< 空闲堆（字节，主机为0）
+    uint32_t heap_min_free;     //!< 历史最低空闲堆（字节，主机为0）
+};
+
+void memStatsTick(uint32_t now_ms);     //!< 每次loop调用：满1秒时结算每秒统计
+const MemStats& memStats();             //!< 当前统计（累计值实时，每秒值为上一秒）
+
+// 串口命令："MEM"（状态）、"MEM ON"（每秒输出一行）、"MEM OFF"
+void memStatsCommand(const char* args);
+
+#endif // FOC_MEM_STATS_H
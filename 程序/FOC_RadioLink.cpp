@@ -0,0 +1,87 @@
+// ============================================================================
+// 文件：FOC_RadioLink.cpp
+// 功能：ESP-NOW无线广播传输实现
+// 说明：接收在loop()开头（radioLinkPoll）进行；帧数据直接交给指令层，不复制、不分配内存
+// ============================================================================
+#include "FOC.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+static RadioLinkStats radio_stats = {};
+
+size_t radioLinkEncode(uint8_t group, const uint8_t* packet, size_t len, uint8_t* out) {
+    if (len + RADIO_HEADER_SIZE > HAL_RADIO_MAX) return 0;
+    out[0] = RADIO_MAGIC;
+    out[1] = group;
+    memcpy(out + RADIO_HEADER_SIZE, packet, len);
+    return len + RADIO_HEADER_SIZE;
+}
+
+// 无线广播是单向的：没有回复和遥测，确认经BLE心跳或其他传输的遥测获得
+static const CommandTransport radio_transport = {"RADIO", nullptr, nullptr, 0};
+
+void radioLinkInit() {
+#if RADIO_LINK_ENABLE
+    radio_stats.started = halRadioBegin(RADIO_CHANNEL);
+    if (radio_stats.started) {
+        cmdRegisterTransport(CMD_TRANSPORT_RADIO, &radio_transport);
+    } else {
+        halPrintf("[RADIO] ESP-NOW初始化失败\n");
+    }
+#endif
+}
+
+const RadioLinkStats& radioLinkStats() { return radio_stats; }
+
+// ============================================================================
+// 函数：radioLinkHandle
+// 功能：检查魔数和组号后把数据包交给指令层
+// ============================================================================
+static void radioLinkHandle(const uint8_t* frame, size_t len) {
+    radio_stats.frames++;
+    if (len <= RADIO_HEADER_SIZE || frame[0] != RADIO_MAGIC || frame[1] != RADIO_GROUP) {
+        radio_stats.foreign++;
+        return;
+    }
+    cmdReceive(CMD_TRANSPORT_RADIO, frame + RADIO_HEADER_SIZE, len - RADIO_HEADER_SIZE);
+}
+
+void radioLinkPoll() {
+    if (!radio_stats.started) return;
+    uint8_t frame[HAL_RADIO_MAX];
+    size_t len;
+    for (int n = 0; n < RADIO_RX_PER_LOOP && (len = halRadioReceive(frame, sizeof(frame))) > 0; n++) {
+        radioLinkHandle(frame, len);
+    }
+}
+
+// ============================================================================
+// 函数：radioLinkForward
+// 功能：网关转发：广播一帧，并在本机按收到处理
+// 说明：由串口二进制协议调用，帧字节已按串口读取记录，本机处理不再记录FRAME
+// ============================================================================
+bool radioLinkForward(const uint8_t* frame, size_t len) {
+    if (!radio_stats.started) return false;
+    bool sent = halRadioBroadcast(frame, len);
+    if (sent) {
+        radio_stats.forwarded++;
+    } else {
+        radio_stats.forward_errors++;
+    }
+    TraceSuppressScope no_frame_record;
+    radioLinkHandle(frame, len);
+    return sent;
+}
+
+// ============================================================================
+// 函数：radioLinkCommand
+// 功能：无线广播状态命令处理
+// ============================================================================
+void radioLinkCommand(const char* args) {
+    (void)args;
+    const RadioLinkStats& s = radio_stats;
+    halPrintf("RADIO,%s,channel=%d,group=%d,frames=%lu,foreign=%lu,forwarded=%lu,forward_err=%lu\n",
+              s.started ? "ON" : "OFF", RADIO_CHANNEL, RADIO_GROUP, (unsigned long)s.frames,
+              (unsigned long)s.foreign, (unsigned long)s.forwarded, (unsigned long)s.forward_errors);
+}
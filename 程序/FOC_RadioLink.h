@@ -0,0 +1,60 @@
+// ============================================================================
+// 文件：FOC_RadioLink.h
+// 功能：ESP-NOW无线广播传输（一对多、无连接）
+// 说明：一台网关每个周期广播一帧，帧内包含全部关节的目标（MULTI切片/MULTI_STRUCT），
+//       各关节收到后由指令层（FOC_Command.h）取出本设备的值。空中时间与关节数基本无关，
+//       也不需要上位机与每个关节分别保持BLE连接。
+//       帧格式：RADIO_MAGIC | 组号 | 数据包（与BLE写入相同，可带A5序号前缀）
+//       组号区分同一信道上的多条肢体，魔数/组号不符的帧在解码前丢弃。
+//       网关：任意一台运行本固件的设备都可作网关——主机经串口二进制协议发送SLINK_MSG_RADIO帧
+//       （数据为完整的无线帧），设备原样广播，并在本机按收到处理（本机收不到自己的广播）。
+//       ESP32上与BLE共存时WiFi/BLE分时使用射频，默认关闭（RADIO_LINK_ENABLE）
+// ============================================================================
+#ifndef FOC_RADIO_LINK_H
+#define FOC_RADIO_LINK_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 默认参数（可在编译时覆盖）
+// ============================================================================
+#ifndef RADIO_LINK_ENABLE
+#define RADIO_LINK_ENABLE HAL_HOST      //!< 是否启用
+#endif
+#ifndef RADIO_CHANNEL
+#define RADIO_CHANNEL 1                 //!< WiFi信道（网关与关节须一致）
+#endif
+#ifndef RADIO_GROUP
+#define RADIO_GROUP 0                   //!< 本设备所属的组号
+#endif
+#ifndef RADIO_RX_PER_LOOP
+#define RADIO_RX_PER_LOOP 4             //!< 每个loop最多处理的接收帧
+#endif
+
+#define RADIO_MAGIC 0xF5                //!< 帧首字节
+#define RADIO_HEADER_SIZE 2             //!< 魔数+组号
+
+// ============================================================================
+// 数据结构定义：RadioLinkStats
+// 功能：无线传输统计
+// ============================================================================
+struct RadioLinkStats {
+    uint32_t frames;            //!< 收到的帧（含本机网关转发）
+    uint32_t foreign;           //!< 魔数/组号不符而丢弃的帧
+    uint32_t forwarded;         //!< 作为网关广播的帧
+    uint32_t forward_errors;    //!< 广播失败
+    bool started;               //!< 是否已初始化
+};
+
+// 编码一帧（out至少RADIO_HEADER_SIZE+len字节），返回帧长度；超过HAL_RADIO_MAX返回0
+size_t radioLinkEncode(uint8_t group, const uint8_t* packet, size_t len, uint8_t* out);
+
+void radioLinkInit();                                       //!< setup()中调用：注册为CMD_TRANSPORT_RADIO
+void radioLinkPoll();                                       //!< loop()中调用：处理接收帧
+bool radioLinkForward(const uint8_t* frame, size_t len);    //!< 网关：广播一帧并在本机处理
+const RadioLinkStats& radioLinkStats();
+
+// 串口命令："RADIO"（状态）
+void radioLinkCommand(const char* args);
+
+#endif // FOC_RADIO_LINK_H
@@ -0,0 +1,230 @@
+// ============================================================================
+// 文件：FOC_SerialLink.cpp
+// 功能：二进制串口协议实现
+// 说明：接收在控制环（readSerialCommand）中逐字节进行，收齐一帧即解码并处理，
+//       数据包直接交给指令层（cmdReceive），不经过BLE接收FIFO
+// ============================================================================
+#include "FOC.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+static bool slink_active = false;                   //!< 二进制模式
+static uint8_t slink_rx[SLINK_ENCODED_MAX];         //!< 当前帧的编码字节（不含帧界）
+static size_t slink_rx_len = 0;
+static bool slink_rx_overflow = false;              //!< 当前帧超长，丢弃到下一个帧界
+static SerialLinkStats slink_stats = {};
+
+// ============================================================================
+// 函数：cobsEncode / cobsDecode
+// 功能：COBS（Consistent Overhead Byte Stuffing）编解码
+// 说明：编码把数据按0x00切段，每段前写"段长+1"，段长满254字节时强制分段；
+//       解码时段长字节为0或超出数据末尾视为格式错误
+// ============================================================================
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t code_pos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) return 0;
+        for (uint8_t k = 1; k < code; k++) out[o++] = in[i++];
+        if (code != 0xFF && i < len) out[o++] = 0;
+    }
+    return o;
+}
+
+// ============================================================================
+// 函数：crc16Ccitt
+// 功能：CRC16-CCITT（多项式0x1021），按半字节查表（表仅32字节）
+// ============================================================================
+uint16_t crc16Ccitt(const uint8_t* data, size_t len, uint16_t crc) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+// ============================================================================
+// 函数：serialLinkEncodeFrame
+// 功能：编码一帧：00 | COBS(类型 | 数据 | CRC16小端) | 00
+// ============================================================================
+size_t serialLinkEncodeFrame(uint8_t type, const uint8_t* data, size_t len, uint8_t* out) {
+    if (len + 3 > SLINK_FRAME_MAX) return 0;
+    uint8_t raw[SLINK_FRAME_MAX];
+    raw[0] = type;
+    memcpy(raw + 1, data, len);
+    uint16_t crc = crc16Ccitt(raw, len + 1);
+    raw[len + 1] = (uint8_t)(crc & 0xFF);
+    raw[len + 2] = (uint8_t)(crc >> 8);
+    out[0] = 0;
+    size_t n = cobsEncode(raw, len + 3, out + 1);
+    out[n + 1] = 0;
+    return n + 2;
+}
+
+// ============================================================================
+// 函数：serialLinkDecodeFrame
+// 功能：解码一帧并校验CRC
+// 返回值："类型+数据"长度（out中CRC之前的部分）；错误返回0
+// ============================================================================
+size_t serialLinkDecodeFrame(const uint8_t* in, size_t len, uint8_t* out, bool* crc_error) {
+    if (crc_error) *crc_error = false;
+    if (len > SLINK_ENCODED_MAX) return 0;
+    size_t n = cobsDecode(in, len, out);
+    if (n < 3) return 0;
+    uint16_t crc = (uint16_t)(out[n - 2] | (out[n - 1] << 8));
+    if (crc16Ccitt(out, n - 2) != crc) {
+        if (crc_error) *crc_error = true;
+        return 0;
+    }
+    return n - 2;
+}
+
+// ============================================================================
+// 函数：serialLinkHandleFrame
+// 功能：处理一帧解码后的消息
+// 说明：数据包在屏蔽捕获的作用域内解析：帧字节已按串口读取记录，重放时重新解码
+// ============================================================================
+static void serialLinkHandleFrame(const uint8_t* frame, size_t len) {
+    const uint8_t* data = frame + 1;
+    size_t data_len = len - 1;
+    switch (frame[0]) {
+        case SLINK_MSG_PACKET: {
+            TraceSuppressScope no_frame_record;
+            cmdReceive(CMD_TRANSPORT_SERIAL, data, data_len);
+            break;
+        }
+        case SLINK_MSG_RADIO:
+            radioLinkForward(data, data_len);
+            break;
+        case SLINK_MSG_TEXT: {
+            char command[SLINK_FRAME_MAX];
+            memcpy(command, data, data_len);
+            command[data_len] = '\0';
+            serialDispatchCommand(command);
+            break;
+        }
+        default:
+            slink_stats.unknown++;
+            return;
+    }
+    slink_stats.frames++;
+}
+
+bool serialLinkActive() { return slink_active; }
+
+void serialLinkBegin() {
+    slink_active = true;
+    slink_rx_len = 0;
+    slink_rx_overflow = false;
+}
+
+// ============================================================================
+// 函数：serialLinkReceive
+// 功能：二进制模式逐字节接收
+// 说明：0x00为帧界：收到时处理已积累的字节（空帧即连续帧界，忽略）；
+//       超过SLINK_ENCODED_MAX的帧丢弃到下一个帧界
+// ============================================================================
+void serialLinkReceive(uint8_t c) {
+    if (c != 0) {
+        if (slink_rx_len < sizeof(slink_rx)) {
+            slink_rx[slink_rx_len++] = c;
+        } else {
+            slink_rx_overflow = true;
+        }
+        return;
+    }
+    if (slink_rx_overflow) {
+        slink_stats.framing_errors++;
+    } else if (slink_rx_len > 0) {
+        uint8_t frame[SLINK_FRAME_MAX];
+        bool crc_error;
+        size_t n = serialLinkDecodeFrame(slink_rx, slink_rx_len, frame, &crc_error);
+        if (n > 0) {
+            serialLinkHandleFrame(frame, n);
+        } else if (crc_error) {
+            slink_stats.crc_errors++;
+        } else {
+            slink_stats.framing_errors++;
+        }
+    }
+    slink_rx_len = 0;
+    slink_rx_overflow = false;
+}
+
+// ============================================================================
+// 函数：serialLinkSend
+// 功能：二进制模式下发送一帧（文本模式下不发送，避免二进制数据混入终端）
+// ============================================================================
+static bool serialLinkSend(uint8_t type, const uint8_t* data, size_t len) {
+    if (!slink_active) return false;
+    uint8_t wire[SLINK_WIRE_MAX];
+    size_t n = serialLinkEncodeFrame(type, data, len, wire);
+    if (n == 0) return false;
+    halSerialWrite(wire, n);
+    slink_stats.tx_bytes += n;
+    return true;
+}
+
+static void serialLinkReply(const char* text) {
+    serialLinkSend(SLINK_MSG_REPLY, (const uint8_t*)text, strlen(text));
+}
+
+static bool serialLinkTelemetry(const uint8_t* data, size_t len) {
+    return serialLinkSend(SLINK_MSG_TELEMETRY, data, len);
+}
+
+static const CommandTransport serial_transport = {"SERIAL", serialLinkReply, serialLinkTelemetry,
+                                                  SLINK_TELEMETRY_HZ};
+
+void serialLinkInit() {
+    cmdRegisterTransport(CMD_TRANSPORT_SERIAL, &serial_transport);
+}
+
+const SerialLinkStats& serialLinkStats() { return slink_stats; }
+
+// ============================================================================
+// 函数：serialLinkCommand
+// 功能：串口协议命令处理
+// ============================================================================
+void serialLinkCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (strncmp(args, "RATE", 4) == 0) {
+        cmdSetTelemetryRate(CMD_TRANSPORT_SERIAL, (uint32_t)strtoul(args + 4, NULL, 10));
+    } else if (strncmp(args, "TEXT", 4) == 0) {
+        slink_active = false;
+    }
+    const SerialLinkStats& s = slink_stats;
+    const CommandLinkStats& ls = cmdLinkStats(CMD_TRANSPORT_SERIAL);
+    halPrintf("SLINK,%s,rate=%lu,frames=%lu,crc=%lu,framing=%lu,unknown=%lu,telemetry=%lu,tx=%lu\n",
+              slink_active ? "BINARY" : "TEXT", (unsigned long)ls.telemetry_hz, (unsigned long)s.frames,
+              (unsigned long)s.crc_errors, (unsigned long)s.framing_errors, (unsigned long)s.unknown,
+              (unsigned long)ls.telemetry, (unsigned long)s.tx_bytes);
+}
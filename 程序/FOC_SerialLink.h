@@ -0,0 +1,87 @@
+// ============================================================================
+// 文件：FOC_SerialLink.h
+// 功能：二进制串口协议（COBS分帧 + CRC16校验）
+// 说明：高波特率（≥921600）下代替逐行文本命令；作为一种传输注册到指令层（FOC_Command.h），
+//       命令集、回复和遥测内容与其他传输相同。
+//       帧格式：00 | COBS(类型 | 数据 | CRC16小端) | 00
+//       CRC16-CCITT（多项式0x1021，初值0xFFFF）覆盖类型和数据；COBS编码后帧内不含0x00，
+//       0x00只作帧界，丢字节或混入文本输出（halPrintf）后在下一个0x00处重新同步。
+//       上电为文本命令模式，收到0x00字节即切换到二进制模式，发送文本命令"SLINK TEXT"返回。
+//       主机→设备：
+//         SLINK_MSG_PACKET     与BLE RX特征值相同的数据包（可带A5序号前缀）
+//         SLINK_MSG_TEXT       文本命令（与逐行命令相同，不含换行）
+//         SLINK_MSG_RADIO      无线帧（FOC_RadioLink.h），本设备作为网关广播并在本机处理
+//       设备→主机（仅二进制模式）：
+//         SLINK_MSG_TELEMETRY  定长遥测（见FOC_Command.h中的Telemetry），按设定频率发送
+//         SLINK_MSG_REPLY      数据包的文本回复（与BLE通知相同，如"6:SINGLE:30.00"）
+//       接收、解码、编码都使用静态/栈上定长缓冲，不分配内存
+// ============================================================================
+#ifndef FOC_SERIAL_LINK_H
+#define FOC_SERIAL_LINK_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 默认参数（可在编译时覆盖）
+// ============================================================================
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD 921600              //!< 串口波特率
+#endif
+#ifndef SLINK_TELEMETRY_HZ
+#define SLINK_TELEMETRY_HZ 200          //!< 遥测默认频率（Hz，0为不发送）
+#endif
+
+#define SLINK_FRAME_MAX 160                                     //!< 解码后帧最大字节数（类型+数据+CRC）
+#define SLINK_ENCODED_MAX (SLINK_FRAME_MAX + SLINK_FRAME_MAX / 254 + 1)  //!< COBS编码后最大字节数（不含帧界）
+#define SLINK_WIRE_MAX (SLINK_ENCODED_MAX + 2)                  //!< 含两端帧界的最大字节数
+
+// ============================================================================
+// 消息类型
+// ============================================================================
+#define SLINK_MSG_PACKET     0x01   //!< BLE数据包
+#define SLINK_MSG_TEXT       0x02   //!< 文本命令
+#define SLINK_MSG_RADIO      0x03   //!< 经无线广播转发的帧
+#define SLINK_MSG_TELEMETRY  0x81   //!< 遥测
+#define SLINK_MSG_REPLY      0x82   //!< 文本回复
+
+// ============================================================================
+// 数据结构定义：SerialLinkStats
+// 功能：协议统计（供串口/仿真读取）
+// ============================================================================
+struct SerialLinkStats {
+    uint32_t frames;            //!< 收到的有效帧
+    uint32_t crc_errors;        //!< CRC错误帧
+    uint32_t framing_errors;    //!< COBS错误或超长帧
+    uint32_t unknown;           //!< 未知类型帧
+    uint32_t tx_bytes;          //!< 已发送字节数
+};
+
+// ============================================================================
+// 编解码（设备与主机共用）
+// ============================================================================
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out);   //!< 返回编码长度（out至少len+len/254+1）
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out);   //!< 返回解码长度，格式错误返回0
+uint16_t crc16Ccitt(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+// 编码一帧（含两端帧界）到out（至少SLINK_WIRE_MAX字节），返回字节数；数据过长返回0
+size_t serialLinkEncodeFrame(uint8_t type, const uint8_t* data, size_t len, uint8_t* out);
+// 解码一帧（不含帧界）到out（至少SLINK_FRAME_MAX字节），返回"类型+数据"长度；COBS/CRC错误返回0，
+// crc_error非空时区分CRC错误
+size_t serialLinkDecodeFrame(const uint8_t* in, size_t len, uint8_t* out, bool* crc_error = nullptr);
+
+// ============================================================================
+// 设备端接口（readSerialCommand中调用）
+// ============================================================================
+void serialLinkInit();                      //!< setup()中调用：注册为CMD_TRANSPORT_SERIAL
+bool serialLinkActive();                    //!< 是否处于二进制模式
+void serialLinkBegin();                     //!< 切换到二进制模式
+void serialLinkReceive(uint8_t c);          //!< 二进制模式下逐字节接收，收齐一帧即处理
+const SerialLinkStats& serialLinkStats();
+
+// 文本命令分发（readSerialCommand与SLINK_MSG_TEXT帧共用，定义在FOC_Control.cpp）
+void serialDispatchCommand(const char* command);
+
+// 串口命令："SLINK"（状态）、"SLINK RATE <Hz>"（遥测频率）、"SLINK TEXT"（返回文本模式）
+void serialLinkCommand(const char* args);
+
+#endif // FOC_SERIAL_LINK_H
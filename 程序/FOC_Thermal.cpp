@@ -0,0 +1,119 @@
+// ============================================================================
+// 文件：FOC_Thermal.cpp
+// 功能：绕组热模型与电流降额实现
+// 说明：积分步长取编码器更新时间戳之差，不增加HAL调用；
+//       每周期为常数次乘加，热时间常数远大于控制周期，前向欧拉积分即可
+// ============================================================================
+#include "FOC.h"
+
+static_assert(THERMAL_I_CONT < THERMAL_I_PEAK, "连续电流须低于峰值电流，否则降额区间无意义");
+static_assert(THERMAL_I_PEAK <= I_MAX_CMD, "峰值电流不能超过命令电流上限");
+static_assert(THERMAL_I_PEAK < FAULT_OVERCURRENT_A, "峰值电流须低于过流保护阈值，否则峰值不可达");
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+static ThermalConfig thermal_cfg = {THERMAL_I_PEAK, THERMAL_I_CONT, THERMAL_R_PHASE, THERMAL_TAU_S,
+                                    THERMAL_T_AMBIENT, THERMAL_T_DERATE, THERMAL_T_MAX};
+static ThermalState thermal_state = {THERMAL_T_AMBIENT, THERMAL_I_PEAK, THERMAL_R_PHASE, 0, 0};
+static float thermal_r_th = 0;        //!< 热阻（°C/W）
+static float thermal_inv_c = 0;       //!< 热容倒数（°C/J）
+static bool thermal_has_prev = false;
+static uint32_t thermal_prev_ts = 0;
+
+static float thermalResistanceAt(float t) {
+    return thermal_cfg.r_phase * (1.0f + THERMAL_ALPHA_CU * (t - 25.0f));
+}
+
+// ============================================================================
+// 函数：thermalDerive
+// 功能：由连续电流和温升上限推出热阻，再由时间常数得到热容
+// 说明：连续电流下的稳态温度正好等于t_max
+// ============================================================================
+static void thermalDerive() {
+    float p_cont = 1.5f * thermalResistanceAt(thermal_cfg.t_max) * thermal_cfg.i_cont * thermal_cfg.i_cont;
+    thermal_r_th = p_cont > 0 ? (thermal_cfg.t_max - thermal_cfg.t_ambient) / p_cont : 0;
+    thermal_inv_c = thermal_cfg.tau_s > 0 && thermal_r_th > 0 ? thermal_r_th / thermal_cfg.tau_s : 0;
+}
+
+void thermalDefaultConfig(ThermalConfig* cfg) {
+    *cfg = {THERMAL_I_PEAK, THERMAL_I_CONT, THERMAL_R_PHASE, THERMAL_TAU_S,
+            THERMAL_T_AMBIENT, THERMAL_T_DERATE, THERMAL_T_MAX};
+}
+
+void thermalConfigure(const ThermalConfig& cfg) {
+    thermal_cfg = cfg;
+    thermalDerive();
+}
+
+// ============================================================================
+// 函数：thermalIdentifyResistance
+// 功能：由校准时的静止电压/电流辨识相电阻，并换算到25°C
+// 参数：u_alpha - 施加的α轴电压（V），i_alpha - 实测α轴电流（A）
+// 返回值：辨识结果在合理范围内时返回true
+// 说明：上电时绕组温度按环境温度处理
+// ============================================================================
+bool thermalIdentifyResistance(float u_alpha, float i_alpha) {
+    if (fabsf(i_alpha) < 0.05f) return false;
+    float r = u_alpha / i_alpha;
+    if (!(r > 0.2f && r < 50.0f)) return false;
+    float r25 = r / (1.0f + THERMAL_ALPHA_CU * (thermal_cfg.t_ambient - 25.0f));
+    thermal_state.r_identified = r25;
+    thermal_cfg.r_phase = r25;
+    thermalDerive();
+    return true;
+}
+
+// ============================================================================
+// 函数：thermalUpdate
+// 功能：积分热模型并更新降额后的电流上限
+// 参数：iq - 上一个控制周期的实测q轴电流（A）
+// 返回值：电流上限（A）
+// ============================================================================
+float thermalUpdate(float iq) {
+    if (thermal_r_th == 0) thermalDerive();
+
+    uint32_t now = S0.getUpdateTimestamp();
+    float dt = thermal_has_prev ? (now - thermal_prev_ts) * 1e-6f : 0.0f;
+    thermal_prev_ts = now;
+    thermal_has_prev = true;
+    if (dt > 0.1f) dt = 0.1f;  // 长时间停顿按0.1s积分，保证数值稳定
+
+    ThermalState& s = thermal_state;
+    s.resistance = thermalResistanceAt(s.temperature);
+    float p_loss = 1.5f * s.resistance * iq * iq;
+    s.temperature += dt * thermal_inv_c * (p_loss - (s.temperature - thermal_cfg.t_ambient) / thermal_r_th);
+    s.i2t_ratio = (s.temperature - thermal_cfg.t_ambient) / (thermal_cfg.t_max - thermal_cfg.t_ambient);
+
+    // 降额：t_derate以下为峰值电流，到t_max线性降到连续电流
+    const ThermalConfig& c = thermal_cfg;
+    if (s.temperature <= c.t_derate) {
+        s.current_limit = c.i_peak;
+    } else if (s.temperature >= c.t_max) {
+        s.current_limit = c.i_cont;
+    } else {
+        float k = (s.temperature - c.t_derate) / (c.t_max - c.t_derate);
+        s.current_limit = c.i_peak + k * (c.i_cont - c.i_peak);
+    }
+
+    if (s.temperature > THERMAL_T_TRIP) faultTrip(FAULT_OVERTEMP, s.temperature);
+    return s.current_limit;
+}
+
+float thermalCurrentLimit() { return thermal_state.current_limit; }
+const ThermalState& thermalState() { return thermal_state; }
+
+// ============================================================================
+// 函数：thermalCommand
+// 功能：串口热模型命令处理
+// ============================================================================
+void thermalCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (strncmp(args, "RESET", 5) == 0) {
+        thermal_state.temperature = thermal_cfg.t_ambient;
+        thermal_state.current_limit = thermal_cfg.i_peak;
+    }
+    const ThermalState& s = thermal_state;
+    halPrintf("THERMAL,T=%.1f,ILIM=%.2f,R=%.3f,Rid=%.3f,i2t=%.2f\n",
+              s.temperature, s.current_limit, s.resistance, s.r_identified, s.i2t_ratio);
+}
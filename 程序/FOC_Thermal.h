@@ -0,0 +1,83 @@
+// ============================================================================
+// 文件：FOC_Thermal.h
+// 功能：绕组热模型与电流降额
+// 说明：一阶热模型 C·dT/dt = 1.5·R(T)·Iq² - (T - T环境)/Rth，
+//       由实测q轴电流和绕组电阻（上电校准时辨识）驱动，估计绕组温度。
+//       温度低于降额起点时允许峰值电流，起点到上限之间线性降到连续电流，
+//       连续电流下的稳态温升正好等于上限，因此短时峰值可用、长时间运行不过热。
+//       热阻由连续电流和温升上限推出，只需配置热时间常数
+// ============================================================================
+#ifndef FOC_THERMAL_H
+#define FOC_THERMAL_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 默认参数（可在编译时覆盖）
+// ============================================================================
+#ifndef THERMAL_I_PEAK
+#define THERMAL_I_PEAK 3.0f          //!< 峰值电流（A），不超过I_MAX_CMD，低于过流保护阈值
+#endif
+#ifndef THERMAL_I_CONT
+#define THERMAL_I_CONT 2.0f          //!< 连续电流（A），低于峰值电流
+#endif
+#ifndef THERMAL_R_ID_SAMPLES
+#define THERMAL_R_ID_SAMPLES 32      //!< 相电阻辨识的电流采样次数（取平均）
+#endif
+#ifndef THERMAL_R_ID_INTERVAL_US
+#define THERMAL_R_ID_INTERVAL_US 500 //!< 相电阻辨识的采样间隔（微秒），窗口共约16ms
+#endif
+#ifndef THERMAL_R_PHASE
+#define THERMAL_R_PHASE 2.0f         //!< 25°C相电阻（欧姆），辨识失败时使用
+#endif
+#ifndef THERMAL_TAU_S
+#define THERMAL_TAU_S 60.0f          //!< 绕组热时间常数（秒）
+#endif
+#define THERMAL_T_AMBIENT 25.0f      //!< 环境温度（°C）
+#define THERMAL_T_DERATE 80.0f       //!< 降额起点（°C）
+#define THERMAL_T_MAX 100.0f         //!< 温度上限（°C），此时限流为连续电流
+#define THERMAL_T_TRIP 110.0f        //!< 过温故障（°C）
+#define THERMAL_ALPHA_CU 0.00393f    //!< 铜电阻温度系数（1/°C）
+
+// ============================================================================
+// 数据结构定义：ThermalConfig
+// 功能：热模型参数
+// ============================================================================
+struct ThermalConfig {
+    float i_peak;         //!< 峰值电流（A）
+    float i_cont;         //!< 连续电流（A）
+    float r_phase;        //!< 25°C相电阻（欧姆）
+    float tau_s;          //!< 热时间常数（秒）
+    float t_ambient;      //!< 环境温度（°C）
+    float t_derate;       //!< 降额起点（°C）
+    float t_max;          //!< 温度上限（°C）
+};
+
+// ============================================================================
+// 数据结构定义：ThermalState
+// 功能：热模型输出
+// ============================================================================
+struct ThermalState {
+    float temperature;    //!< 估计绕组温度（°C）
+    float current_limit;  //!< 当前允许的q轴电流（A）
+    float resistance;     //!< 当前温度下的相电阻（欧姆）
+    float r_identified;   //!< 上电辨识的25°C相电阻（0表示未辨识）
+    float i2t_ratio;      //!< 稳态温升占用比例（0~1，1表示已到上限）
+};
+
+void thermalDefaultConfig(ThermalConfig* cfg);   //!< 默认参数
+void thermalConfigure(const ThermalConfig& cfg); //!< 设置参数（温度保持不变）
+
+// 上电辨识：施加固定α轴电压时测得的α轴电流，计算相电阻（超出合理范围时保持原值）
+bool thermalIdentifyResistance(float u_alpha, float i_alpha);
+
+// 每个控制周期调用一次：iq为实测q轴电流（A），返回降额后的电流上限
+float thermalUpdate(float iq);
+
+float thermalCurrentLimit();                     //!< 当前电流上限（A）
+const ThermalState& thermalState();              //!< 模型状态
+
+// 串口命令："THERMAL"（状态）、"THERMAL RESET"（温度复位为环境温度）
+void thermalCommand(const char* args);
+
+#endif // FOC_THERMAL_H
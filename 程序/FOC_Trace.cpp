@@ -0,0 +1,263 @@
+// ============================================================================
+// 文件：FOC_Trace.cpp
+// 功能：现场数据捕获记录器实现
+// 说明：记录写入调用方提供的线性缓冲区，写满即停止（不覆盖），
+//       保证捕获从上电开始连续，重放时状态可以逐位复现
+// ============================================================================
+#include "FOC_Trace.h"
+#include "Ble_Handler.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+volatile bool trace_recording = false;
+
+static uint8_t* trace_buf = nullptr;      //!< 捕获缓冲区
+static size_t trace_cap = 0;              //!< 缓冲区容量
+static size_t trace_len = 0;              //!< 已写入字节数
+static bool trace_full = false;           //!< 缓冲区已写满
+static uint8_t trace_flags = 0;           //!< 文件头标志
+static int trace_suppress = 0;            //!< 嵌套屏蔽深度（仅控制任务）
+static uint32_t trace_last_micros = 0;    //!< 上次记录的micros
+static uint32_t trace_last_millis = 0;    //!< 上次记录的millis
+static uint16_t trace_last_adc[64];       //!< 各引脚上次ADC值（按引脚号低6位索引）
+
+// ============================================================================
+// 并发保护
+// 说明：ESP32上BLE回调运行在BLE任务中，与loop()所在任务并发写入；
+//       只有开始捕获的任务（控制任务）的HAL调用属于控制输入
+// ============================================================================
+#if HAL_ESP32
+static portMUX_TYPE trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t trace_owner = nullptr;
+#define TRACE_LOCK()   portENTER_CRITICAL(&trace_mux)
+#define TRACE_UNLOCK() portEXIT_CRITICAL(&trace_mux)
+static inline bool traceFromControlTask() { return xTaskGetCurrentTaskHandle() == trace_owner; }
+#else
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+static inline bool traceFromControlTask() { return true; }
+#endif
+
+// ============================================================================
+// 函数：traceAppend
+// 功能：原子地追加一条完整记录（head为记录头，data为可选的后续数据）
+// 说明：空间不足时停止捕获，不写入半条记录
+// ============================================================================
+static void traceAppend(const uint8_t* head, size_t head_len, const uint8_t* data, size_t data_len) {
+    TRACE_LOCK();
+    if (trace_recording) {
+        if (trace_len + head_len + data_len > trace_cap) {
+            trace_full = true;
+            trace_recording = false;
+        } else {
+            memcpy(trace_buf + trace_len, head, head_len);
+            if (data_len) memcpy(trace_buf + trace_len + head_len, data, data_len);
+            trace_len += head_len + data_len;
+        }
+    }
+    TRACE_UNLOCK();
+}
+
+static size_t tracePutVarint(uint8_t* p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// 类型 + 小参数（不小于15时后跟varint）
+static void traceAppendSmall(uint8_t tag, uint32_t value) {
+    uint8_t rec[6];
+    size_t n;
+    if (value < TRACE_SMALL_MAX) {
+        rec[0] = (uint8_t)(tag | (value << 4));
+        n = 1;
+    } else {
+        rec[0] = (uint8_t)(tag | (TRACE_SMALL_MAX << 4));
+        n = 1 + tracePutVarint(rec + 1, value - TRACE_SMALL_MAX);
+    }
+    traceAppend(rec, n, nullptr, 0);
+}
+
+size_t traceGetVarint(const uint8_t* p, size_t len, uint32_t* value) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < len && i < 5; i++) {
+        v |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *value = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// 捕获控制
+// ============================================================================
+bool traceBegin(uint8_t* buf, size_t capacity, uint8_t flags) {
+    if (!buf || capacity < TRACE_HEADER_SIZE) return false;
+    trace_recording = false;
+
+    trace_buf = buf;
+    trace_cap = capacity;
+    trace_full = false;
+    trace_flags = flags;
+    trace_suppress = 0;
+    trace_last_micros = halMicros();
+    trace_last_millis = 0;  // 首条MILLIS记录即为绝对值
+    memset(trace_last_adc, 0, sizeof(trace_last_adc));
+#if HAL_ESP32
+    trace_owner = xTaskGetCurrentTaskHandle();
+#endif
+
+    memcpy(trace_buf, TRACE_MAGIC, 4);
+    trace_buf[4] = TRACE_VERSION;
+    trace_buf[5] = flags;
+    trace_buf[6] = getMyDeviceID();
+    trace_buf[7] = 0;
+    for (int i = 0; i < 4; i++) trace_buf[8 + i] = (uint8_t)(trace_last_micros >> (8 * i));
+    trace_len = TRACE_HEADER_SIZE;
+
+    trace_recording = true;
+    return true;
+}
+
+void traceStop() { trace_recording = false; }
+
+void traceBoot() {
+#if FOC_TRACE_BUFFER_SIZE > 0
+    static uint8_t boot_buf[FOC_TRACE_BUFFER_SIZE];
+    traceBegin(boot_buf, sizeof(boot_buf), TRACE_FLAG_OUTPUTS);
+#endif
+}
+
+const uint8_t* traceData() { return trace_buf; }
+size_t traceLength() { return trace_len; }
+bool traceTruncated() { return trace_full; }
+
+void traceDumpHex() {
+    traceStop();
+    halPrintf("\nTRACE BEGIN %u%s\n", (unsigned)trace_len, trace_full ? " TRUNCATED" : "");
+    char line[2 * 32 + 2];
+    for (size_t off = 0; off < trace_len; off += 32) {
+        size_t n = trace_len - off < 32 ? trace_len - off : 32;
+        for (size_t i = 0; i < n; i++) {
+            static const char hex[] = "0123456789ABCDEF";
+            line[2 * i] = hex[trace_buf[off + i] >> 4];
+            line[2 * i + 1] = hex[trace_buf[off + i] & 0x0F];
+        }
+        line[2 * n] = '\n';
+        line[2 * n + 1] = '\0';
+        halPrintf("%s", line);
+    }
+    halPrintf("TRACE END\n");
+}
+
+// ============================================================================
+// 输入记录
+// ============================================================================
+void traceRecordMicros(uint32_t value) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    uint32_t delta = value - trace_last_micros;
+    trace_last_micros = value;
+    traceAppendSmall(TRACE_TAG_MICROS, delta);
+}
+
+void traceRecordMillis(uint32_t value) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    uint32_t delta = value - trace_last_millis;
+    trace_last_millis = value;
+    traceAppendSmall(TRACE_TAG_MILLIS, delta);
+}
+
+void traceRecordSerialAvailable(int value) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    traceAppendSmall(TRACE_TAG_SERIAL_AVAIL, (uint32_t)(value < 0 ? 0 : value));
+}
+
+void traceRecordSerialRead(int value) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    uint8_t rec[6];
+    rec[0] = TRACE_TAG_SERIAL_READ;
+    size_t n = 1 + tracePutVarint(rec + 1, (uint32_t)(value + 1));
+    traceAppend(rec, n, nullptr, 0);
+}
+
+void traceRecordAdc(int pin, uint16_t raw) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    uint16_t& last = trace_last_adc[pin & 63];
+    int32_t d = (int32_t)raw - (int32_t)last;
+    last = raw;
+    uint8_t rec[8];
+    rec[0] = TRACE_TAG_ADC;
+    rec[1] = (uint8_t)pin;
+    size_t n = 2 + tracePutVarint(rec + 2, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+    traceAppend(rec, n, nullptr, 0);
+}
+
+void traceRecordI2C(uint8_t bus, uint8_t addr, uint8_t reg, const uint8_t* buf, uint8_t len, int ret) {
+    if (trace_suppress || !traceFromControlTask()) return;
+    uint8_t rec[5] = {
+        (uint8_t)(TRACE_TAG_I2C | ((bus & 0x0F) << 4)), addr, reg, len, (uint8_t)ret
+    };
+    traceAppend(rec, sizeof(rec), buf, len);
+}
+
+// ============================================================================
+// 输出记录（仅TRACE_FLAG_OUTPUTS）
+// ============================================================================
+void traceRecordPwm(uint8_t channel, uint32_t duty) {
+    if (!(trace_flags & TRACE_FLAG_OUTPUTS) || trace_suppress || !traceFromControlTask()) return;
+    uint8_t rec[6];
+    rec[0] = (uint8_t)(TRACE_TAG_PWM | ((channel & 0x0F) << 4));
+    size_t n = 1 + tracePutVarint(rec + 1, duty);
+    traceAppend(rec, n, nullptr, 0);
+}
+
+void traceRecordDigital(int pin, int level) {
+    if (!(trace_flags & TRACE_FLAG_OUTPUTS) || trace_suppress || !traceFromControlTask()) return;
+    uint8_t rec[2] = { (uint8_t)(TRACE_TAG_DIGITAL | ((level ? 1 : 0) << 4)), (uint8_t)pin };
+    traceAppend(rec, sizeof(rec), nullptr, 0);
+}
+
+// ============================================================================
+// 通信事件记录（可来自任意任务）
+// ============================================================================
+void traceRecordConnection(bool connected) {
+    if (!trace_recording) return;
+    uint8_t rec = (uint8_t)(TRACE_TAG_CONNECT | ((connected ? 1 : 0) << 4));
+    traceAppend(&rec, 1, nullptr, 0);
+}
+
+TraceFrameScope::TraceFrameScope(const uint8_t* data, size_t len, uint8_t source)
+    : nested(false)
+{
+    if (trace_recording && !trace_suppress) {
+        uint8_t head[6];
+        head[0] = (uint8_t)(TRACE_TAG_FRAME | ((source & 0x0F) << 4));
+        size_t n = 1 + tracePutVarint(head + 1, (uint32_t)len);
+        traceAppend(head, n, data, len);
+    }
+    if (traceFromControlTask()) {
+        trace_suppress++;
+        nested = true;
+    }
+}
+
+TraceFrameScope::~TraceFrameScope() {
+    if (nested) trace_suppress--;
+}
+
+TraceSuppressScope::TraceSuppressScope()
+    : nested(traceFromControlTask())
+{
+    if (nested) trace_suppress++;
+}
+
+TraceSuppressScope::~TraceSuppressScope() {
+    if (nested) trace_suppress--;
+}
@@ -0,0 +1,123 @@
+// ============================================================================
+// 文件：FOC_Trace.h
+// 功能：现场数据捕获（trace）- 记录控制代码的全部外部输入，供主机逐位重放
+// 说明：在HAL边界记录时钟、编码器I2C读数、ADC采样、串口字节，
+//       在解析入口记录BLE帧，在连接回调中记录连接状态；
+//       PWM/使能引脚输出可选记录，用于重放时逐项核对。
+//       捕获从setup()开头开始，主机端foc_replay按记录顺序回放（见host/TraceReplay.h）
+// ============================================================================
+#ifndef FOC_TRACE_H
+#define FOC_TRACE_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 编译配置
+// 说明：FOC_TRACE_BUFFER_SIZE > 0 时，固件上电即开始捕获到静态缓冲区，
+//       缓冲区写满后自动停止；串口发送"TRACE"命令以十六进制文本导出
+// ============================================================================
+#ifndef FOC_TRACE_BUFFER_SIZE
+#define FOC_TRACE_BUFFER_SIZE 0       //!< 设备端捕获缓冲区大小（字节），0为关闭
+#endif
+
+// ============================================================================
+// 捕获格式（版本1）
+// 文件头12字节：
+//   "FTRC" | 版本(1) | 标志 | 设备ID | 保留 | 起始时间micros(u32，小端)
+// 记录：首字节低4位为类型，高4位为小参数；变长整数为LEB128（每字节7位）
+//   MICROS/MILLIS  参数=与上次差值（<15），否则参数=15并跟随varint(差值-15)
+//   SERIAL_AVAIL   参数=返回值（<15），否则参数=15并跟随varint(值-15)
+//   SERIAL_READ    varint(返回值+1)（-1记为0）
+//   ADC            引脚(1) | zigzag varint(与该引脚上次值之差)
+//   I2C            参数=总线 | 地址(1) | 寄存器(1) | 长度(1) | 返回值(1) | 数据(长度)
+//   PWM            参数=通道 | varint(占空比)                 （输出，可选）
+//   DIGITAL        参数=电平 | 引脚(1)                        （输出，可选）
+//   FRAME          参数=来源传输（CMD_TRANSPORT_*） | varint(长度) | 数据
+//   CONNECT        参数=连接状态
+// ============================================================================
+#define TRACE_MAGIC          "FTRC"
+#define TRACE_VERSION        1
+#define TRACE_HEADER_SIZE    12
+
+#define TRACE_FLAG_OUTPUTS   0x01   //!< 记录了PWM/数字输出，可用于核对
+
+#define TRACE_TAG_MICROS       0x1
+#define TRACE_TAG_MILLIS       0x2
+#define TRACE_TAG_SERIAL_AVAIL 0x3
+#define TRACE_TAG_SERIAL_READ  0x4
+#define TRACE_TAG_ADC          0x5
+#define TRACE_TAG_I2C          0x6
+#define TRACE_TAG_PWM          0x7
+#define TRACE_TAG_DIGITAL      0x8
+#define TRACE_TAG_FRAME        0x9
+#define TRACE_TAG_CONNECT      0xA
+
+#define TRACE_SMALL_MAX        15   //!< 高4位参数的"后跟varint"标记
+
+// ============================================================================
+// 捕获状态
+// 说明：HAL后端通过TRACE_TAP在热路径上只做一次标志判断
+// ============================================================================
+extern volatile bool trace_recording;  //!< 正在捕获
+
+#define TRACE_TAP(call) do { if (trace_recording) { call; } } while (0)
+
+// ============================================================================
+// 捕获控制
+// ============================================================================
+bool traceBegin(uint8_t* buf, size_t capacity, uint8_t flags);  //!< 开始捕获（写入文件头）
+void traceStop();                                               //!< 停止捕获
+void traceBoot();               //!< setup()开头调用：按FOC_TRACE_BUFFER_SIZE启动设备端捕获
+const uint8_t* traceData();     //!< 捕获数据（含文件头）
+size_t traceLength();           //!< 已写入字节数
+bool traceTruncated();          //!< 缓冲区是否写满（之后的记录被丢弃）
+void traceDumpHex();            //!< 以"TRACE BEGIN/END"包围的十六进制文本输出到串口
+
+// ============================================================================
+// 记录函数（由HAL后端和通信代码调用）
+// ============================================================================
+void traceRecordMicros(uint32_t value);
+void traceRecordMillis(uint32_t value);
+void traceRecordSerialAvailable(int value);
+void traceRecordSerialRead(int value);
+void traceRecordAdc(int pin, uint16_t raw);
+void traceRecordI2C(uint8_t bus, uint8_t addr, uint8_t reg, const uint8_t* buf, uint8_t len, int ret);
+void traceRecordPwm(uint8_t channel, uint32_t duty);
+void traceRecordDigital(int pin, int level);
+void traceRecordConnection(bool connected);
+
+// ============================================================================
+// 类定义：TraceFrameScope
+// 功能：记录一帧接收数据，并在作用域内屏蔽解析过程中的嵌套HAL记录
+// 说明：放在cmdDispatch()入口；重放时由重放器在同一位置按原传输调用解析函数，
+//       解析过程本身的时钟/串口读取不属于控制输入
+// ============================================================================
+class TraceFrameScope {
+  public:
+    TraceFrameScope(const uint8_t* data, size_t len, uint8_t source = 0);
+    ~TraceFrameScope();
+  private:
+    bool nested;  //!< 是否屏蔽了控制任务的记录
+};
+
+// ============================================================================
+// 类定义：TraceSuppressScope
+// 功能：屏蔽作用域内的全部记录
+// 说明：用于输入已在HAL边界记录过的解析（如串口二进制帧：字节已按SERIAL_READ记录，
+//       重放时由同样的字节重新解码，解出的数据包不再作为FRAME记录）
+// ============================================================================
+class TraceSuppressScope {
+  public:
+    TraceSuppressScope();
+    ~TraceSuppressScope();
+  private:
+    bool nested;  //!< 是否屏蔽了控制任务的记录
+};
+
+// ============================================================================
+// 格式辅助函数（记录器与重放器共用）
+// ============================================================================
+size_t traceGetVarint(const uint8_t* p, size_t len, uint32_t* value);  //!< 返回消耗字节数，0为数据不完整
+static inline int32_t traceUnzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+#endif // FOC_TRACE_H
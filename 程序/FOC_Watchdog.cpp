@@ -0,0 +1,228 @@
+// ============================================================================
+// 文件：FOC_Watchdog.cpp
+// 功能：指令看门狗与安全停车实现
+// 说明：喂狗只递增计数，控制环比较计数判断是否有新指令，BLE回调与控制环之间不加锁；
+//       正常跟踪时每周期为几次比较，不增加HAL调用
+// ============================================================================
+#include "FOC.h"
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+bool watchdog_output_enabled = true;
+
+static volatile uint32_t watchdog_feed_count = 0;  //!< 喂狗次数（BLE回调/串口递增）
+static uint32_t watchdog_feed_seen = 0;            //!< 控制环已处理的喂狗次数
+static WatchdogStatus watchdog_status = {WATCHDOG_IDLE, WATCHDOG_POLICY, WATCHDOG_REASON_NONE,
+                                         WATCHDOG_TIMEOUT_MS, 0, 0, 0, 0, 0};
+static bool watchdog_report_pending = false;       //!< 状态变化尚未经BLE上报
+static bool watchdog_link_seen = false;            //!< 跟踪期间见到过BLE连接
+static uint32_t watchdog_cmd_ts = 0;               //!< 最近一次指令的时间戳（us）
+static uint32_t watchdog_prev_ts = 0;              //!< 上一周期时间戳（减速积分用）
+
+// DECEL减速曲线状态（按速度大小计算，方向单独保存）
+static float decel_sign = 0;      //!< 减速开始时的运动方向
+static float decel_speed = 0;     //!< 当前速度大小（rad/s）
+static float decel_rate = 0;      //!< 当前减速度（rad/s²）
+static float decel_pos = 0;       //!< 曲线位置（rad）
+
+const char* watchdogStateName(uint8_t state) {
+    switch (state) {
+        case WATCHDOG_ARMED: return "ARMED";
+        case WATCHDOG_STOPPING: return "STOPPING";
+        case WATCHDOG_STOPPED: return "STOPPED";
+        default: return "IDLE";
+    }
+}
+
+const char* watchdogPolicyName(uint8_t policy) {
+    switch (policy) {
+        case WATCHDOG_POLICY_HOLD: return "HOLD";
+        case WATCHDOG_POLICY_DECEL: return "DECEL";
+        case WATCHDOG_POLICY_DAMP: return "DAMP";
+        case WATCHDOG_POLICY_COAST: return "COAST";
+        default: return "?";
+    }
+}
+
+void watchdogFeed() {
+    watchdog_feed_count = watchdog_feed_count + 1;
+}
+
+// ============================================================================
+// 函数：watchdogTrip
+// 功能：按策略进入安全停车
+// 参数：reason - 停车原因，now - 本周期时间戳，angle/velocity - 实测位置/速度
+// ============================================================================
+static void watchdogTrip(uint8_t reason, uint32_t now, float angle, float velocity) {
+    WatchdogStatus& s = watchdog_status;
+    s.reason = reason;
+    s.trip_count++;
+    s.trip_ts = now;
+    s.stop_us = 0;
+    s.stop_target = angle;
+    s.state = WATCHDOG_STOPPED;
+
+    switch (s.policy) {
+        case WATCHDOG_POLICY_DECEL:
+            decel_sign = velocity >= 0 ? 1.0f : -1.0f;
+            decel_speed = fabsf(velocity);
+            decel_rate = 0;
+            decel_pos = angle;
+            s.state = WATCHDOG_STOPPING;
+            break;
+        case WATCHDOG_POLICY_DAMP:
+            watchdog_output_enabled = false;
+            setPwm(0, 0, 0);
+            break;
+        case WATCHDOG_POLICY_COAST:
+            watchdog_output_enabled = false;
+            setPwm(0, 0, 0);
+            halDigitalWrite(WATCHDOG_ENABLE_PIN, 0);
+            break;
+        default:  // HOLD
+            break;
+    }
+    watchdog_report_pending = true;
+    halPrintf("[WATCHDOG] %s，%s停车\n", reason == WATCHDOG_REASON_LINK ? "连接断开" : "指令超时",
+              watchdogPolicyName(s.policy));
+}
+
+// ============================================================================
+// 函数：watchdogResume
+// 功能：停车后收到新指令，恢复跟踪
+// 说明：DAMP/COAST期间三环未运行，积分项已过时，恢复前复位
+// ============================================================================
+static void watchdogResume() {
+    if (!watchdog_output_enabled) {
+        if (watchdog_status.policy == WATCHDOG_POLICY_COAST) halDigitalWrite(WATCHDOG_ENABLE_PIN, 1);
+        angle_loop_M0.reset();
+        vel_loop_M0.reset();
+        current_loop_M0.reset();
+        watchdog_output_enabled = true;
+    }
+    watchdog_status.state = WATCHDOG_ARMED;
+    watchdog_report_pending = true;
+    halPrintf("[WATCHDOG] 收到新指令，恢复跟踪\n");
+}
+
+// ============================================================================
+// 函数：decelStep
+// 功能：S曲线减速一步
+// 参数：dt - 步长（秒）
+// 返回值：速度减到零时返回true
+// 说明：剩余速度不大于减速度以最大加加速度回零所需的速度变化（a²/2J）时开始减小减速度，
+//       否则以最大加加速度增大减速度（不超过最大减速度）
+// ============================================================================
+static bool decelStep(float dt) {
+    if (decel_speed <= decel_rate * decel_rate * (0.5f / WATCHDOG_JERK_MAX)) {
+        decel_rate -= WATCHDOG_JERK_MAX * dt;
+        if (decel_rate < 0) decel_rate = 0;
+    } else {
+        decel_rate += WATCHDOG_JERK_MAX * dt;
+        if (decel_rate > WATCHDOG_DECEL_MAX) decel_rate = WATCHDOG_DECEL_MAX;
+    }
+    float v_next = decel_speed - decel_rate * dt;
+    if (v_next <= 0 || (decel_rate == 0 && decel_speed < WATCHDOG_JERK_MAX * dt * dt)) {
+        decel_pos += decel_sign * 0.5f * decel_speed * dt;
+        decel_speed = 0;
+        decel_rate = 0;
+        return true;
+    }
+    decel_pos += decel_sign * 0.5f * (decel_speed + v_next) * dt;
+    decel_speed = v_next;
+    return false;
+}
+
+// ============================================================================
+// 函数：watchdogUpdate
+// 功能：每个控制周期的看门狗判断与停车曲线
+// 参数：target - 指令目标（rad），angle - 实测位置（rad），velocity - 实测速度（rad/s）
+// 返回值：本周期使用的目标位置（rad）
+// ============================================================================
+float watchdogUpdate(float target, float angle, float velocity) {
+    WatchdogStatus& s = watchdog_status;
+    uint32_t now = S0.getUpdateTimestamp();
+    float dt = (now - watchdog_prev_ts) * 1e-6f;
+    watchdog_prev_ts = now;
+
+    // 1. 新指令：记录时刻，停车中则恢复
+    uint32_t feeds = watchdog_feed_count;
+    if (feeds != watchdog_feed_seen) {
+        watchdog_feed_seen = feeds;
+        watchdog_cmd_ts = now;
+        if (s.state == WATCHDOG_IDLE) {
+            s.state = WATCHDOG_ARMED;
+            watchdog_report_pending = true;
+        } else if (s.state != WATCHDOG_ARMED) {
+            watchdogResume();
+        }
+        watchdog_link_seen = deviceConnected;
+    }
+    if (s.state == WATCHDOG_IDLE) return target;
+    s.command_age_us = now - watchdog_cmd_ts;
+
+    // 2. 跟踪中：判断连接断开和指令超时
+    if (s.state == WATCHDOG_ARMED) {
+        if (deviceConnected) {
+            watchdog_link_seen = true;
+        } else if (watchdog_link_seen) {
+            watchdogTrip(WATCHDOG_REASON_LINK, now, angle, velocity);
+        }
+        if (s.state == WATCHDOG_ARMED && s.timeout_ms > 0 && s.command_age_us > s.timeout_ms * 1000u) {
+            watchdogTrip(WATCHDOG_REASON_TIMEOUT, now, angle, velocity);
+        }
+        if (s.state == WATCHDOG_ARMED) return target;
+    }
+
+    // 3. 停车中：DECEL沿曲线减速，其余策略保持停车位置
+    if (s.state == WATCHDOG_STOPPING) {
+        if (dt > 0.05f) dt = 0.05f;
+        if (decelStep(dt)) {
+            s.state = WATCHDOG_STOPPED;
+            s.stop_us = now - s.trip_ts;
+            watchdog_report_pending = true;
+        }
+        s.stop_target = decel_pos;
+    }
+    return watchdog_output_enabled ? s.stop_target : angle;
+}
+
+const WatchdogStatus& watchdogStatus() { return watchdog_status; }
+
+void watchdogSetPolicy(uint8_t policy) {
+    if (policy > WATCHDOG_POLICY_COAST) return;
+    watchdog_status.policy = policy;
+}
+
+void watchdogSetTimeout(uint32_t ms) {
+    watchdog_status.timeout_ms = ms;
+    watchdog_cmd_ts = S0.getUpdateTimestamp();
+}
+
+bool watchdogTakeReport() {
+    if (!watchdog_report_pending) return false;
+    watchdog_report_pending = false;
+    return true;
+}
+
+// ============================================================================
+// 函数：watchdogCommand
+// 功能：串口看门狗命令处理
+// ============================================================================
+void watchdogCommand(const char* args) {
+    while (*args == ' ') args++;
+    if (strncmp(args, "TIMEOUT", 7) == 0) {
+        watchdogSetTimeout((uint32_t)strtoul(args + 7, NULL, 10));
+    } else {
+        for (uint8_t p = WATCHDOG_POLICY_HOLD; p <= WATCHDOG_POLICY_COAST; p++) {
+            const char* name = watchdogPolicyName(p);
+            if (strncmp(args, name, strlen(name)) == 0) watchdogSetPolicy(p);
+        }
+    }
+    const WatchdogStatus& s = watchdog_status;
+    halPrintf("WATCHDOG,%s,%s,timeout=%lu,age=%lu,trips=%lu,stop=%lu\n",
+              watchdogStateName(s.state), watchdogPolicyName(s.policy), (unsigned long)s.timeout_ms,
+              (unsigned long)(s.command_age_us / 1000), (unsigned long)s.trip_count,
+              (unsigned long)(s.stop_us / 1000));
+}
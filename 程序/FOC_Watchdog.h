@@ -0,0 +1,96 @@
+// ============================================================================
+// 文件：FOC_Watchdog.h
+// 功能：指令看门狗与安全停车
+// 说明：每条发给本设备的有效指令（包括目标值未变化的重发）都喂狗；
+//       已收到指令后，BLE连接断开或超过设定时间未收到指令时按策略安全停车：
+//         HOLD  - 目标设为当前位置，三环保持
+//         DECEL - 从当前速度按限加加速度（S曲线）减速到零，停在减速终点
+//         DAMP  - 不运行三环，零占空比短路制动（仅电气阻尼）
+//         COAST - 不运行三环，拉低驱动器使能，三相悬空自由滑行
+//       判断在控制环中进行，时间取本周期编码器时间戳（us）；
+//       停车后收到新指令即恢复跟踪。状态随BLE心跳上报（"WD=<状态>"）
+// ============================================================================
+#ifndef FOC_WATCHDOG_H
+#define FOC_WATCHDOG_H
+
+#include "HAL.h"
+
+// ============================================================================
+// 策略与状态
+// ============================================================================
+#define WATCHDOG_POLICY_HOLD   0    //!< 保持当前位置
+#define WATCHDOG_POLICY_DECEL  1    //!< 限加加速度减速停车
+#define WATCHDOG_POLICY_DAMP   2    //!< 短路制动
+#define WATCHDOG_POLICY_COAST  3    //!< 驱动器失能滑行
+
+#define WATCHDOG_IDLE      0        //!< 尚未收到指令（不判断超时）
+#define WATCHDOG_ARMED     1        //!< 正常跟踪指令
+#define WATCHDOG_STOPPING  2        //!< DECEL策略减速中
+#define WATCHDOG_STOPPED   3        //!< 已按策略停车，等待新指令
+
+#define WATCHDOG_REASON_NONE     0
+#define WATCHDOG_REASON_TIMEOUT  1  //!< 指令超时
+#define WATCHDOG_REASON_LINK     2  //!< BLE连接断开
+
+// ============================================================================
+// 默认参数（可在编译时覆盖）
+// ============================================================================
+#ifndef WATCHDOG_POLICY
+#define WATCHDOG_POLICY WATCHDOG_POLICY_DECEL
+#endif
+#ifndef WATCHDOG_TIMEOUT_MS
+#define WATCHDOG_TIMEOUT_MS 0           //!< 指令超时（ms），0为只在断开连接时停车
+#endif
+#ifndef WATCHDOG_DECEL_MAX
+#define WATCHDOG_DECEL_MAX 200.0f       //!< DECEL最大减速度（电机轴rad/s²）
+#endif
+#ifndef WATCHDOG_JERK_MAX
+#define WATCHDOG_JERK_MAX 2000.0f       //!< DECEL最大加加速度（电机轴rad/s³）
+#endif
+#ifndef WATCHDOG_ENABLE_PIN
+#define WATCHDOG_ENABLE_PIN 12          //!< 驱动器使能引脚（COAST时拉低）
+#endif
+
+// ============================================================================
+// 数据结构定义：WatchdogStatus
+// 功能：看门狗状态（供串口/遥测读取）
+// ============================================================================
+struct WatchdogStatus {
+    uint8_t state;             //!< WATCHDOG_IDLE/ARMED/STOPPING/STOPPED
+    uint8_t policy;            //!< 当前策略
+    uint8_t reason;            //!< 最近一次停车原因
+    uint32_t timeout_ms;       //!< 指令超时（0关闭）
+    uint32_t trip_count;       //!< 累计停车次数
+    uint32_t command_age_us;   //!< 距最近一次指令的时间（us）
+    uint32_t trip_ts;          //!< 最近一次停车时刻（编码器时间戳，us）
+    uint32_t stop_us;          //!< 停车开始到速度为零的用时（us，DECEL有效）
+    float stop_target;         //!< 停车后的目标位置（电机轴rad）
+};
+
+// ============================================================================
+// 控制环接口
+// ============================================================================
+void watchdogFeed();            //!< 收到发给本设备的有效指令时调用（可在BLE回调中调用）
+
+// 每个控制周期调用一次：target为指令目标，angle/velocity为实测电机轴位置/速度；
+// 返回本周期实际使用的目标位置
+float watchdogUpdate(float target, float angle, float velocity);
+
+// DAMP/COAST停车时为false：控制环输出零占空比，不运行三环
+extern bool watchdog_output_enabled;
+static inline bool watchdogOutputEnabled() { return watchdog_output_enabled; }
+
+// ============================================================================
+// 管理接口
+// ============================================================================
+const WatchdogStatus& watchdogStatus();     //!< 当前状态
+void watchdogSetPolicy(uint8_t policy);     //!< 设置停车策略
+void watchdogSetTimeout(uint32_t ms);       //!< 设置指令超时（0关闭）
+const char* watchdogStateName(uint8_t state);
+const char* watchdogPolicyName(uint8_t policy);
+bool watchdogTakeReport();                  //!< 状态变化尚未上报时返回true（只返回一次）
+
+// 串口命令："WATCHDOG"（状态）、"WATCHDOG HOLD|DECEL|DAMP|COAST"、"WATCHDOG TIMEOUT <ms>"
+void watchdogCommand(const char* args);
+
+#endif // FOC_WATCHDOG_H
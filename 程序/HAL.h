@@ -0,0 +1,116 @@
+// ============================================================================
+// 文件：HAL.h
+// 功能：硬件抽象层（HAL）接口
+// 说明：控制代码只通过本头文件访问时钟、PWM、ADC、I2C和串口，
+//       ESP32后端在HAL_ESP32.cpp中实现，主机（Linux）后端在host/HAL_Host.cpp中实现
+// ============================================================================
+#ifndef HAL_H
+#define HAL_H
+
+// ============================================================================
+// 后端选择
+// 说明：Arduino-ESP32工具链下使用ESP32后端，其余平台（主机构建）使用主机后端
+// ============================================================================
+#if defined(ARDUINO) && defined(ESP32)
+#define HAL_ESP32 1           //!< ESP32后端
+#define HAL_HOST 0
+#define HAL_HAS_BLE 1         //!< 是否有ESP32 BLE协议栈
+#include <Arduino.h>
+#else
+#define HAL_ESP32 0
+#define HAL_HOST 1            //!< 主机后端（Linux仿真/测试）
+#define HAL_HAS_BLE 0
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795  //!< 与Arduino.h中的定义保持一致
+#endif
+#endif
+
+// ============================================================================
+// 时钟
+// 说明：与Arduino的micros()/millis()语义相同，32位计数，溢出后回绕
+// ============================================================================
+uint32_t halMicros();                 //!< 系统时间（微秒）
+uint32_t halMillis();                 //!< 系统时间（毫秒）
+void halDelayMs(uint32_t ms);         //!< 阻塞延时（毫秒）
+void halDelayUs(uint32_t us);         //!< 阻塞延时（微秒）
+
+// ============================================================================
+// GPIO
+// ============================================================================
+void halPinOutput(int pin);                 //!< 设置引脚为输出模式
+void halPinInput(int pin);                  //!< 设置引脚为输入模式
+void halDigitalWrite(int pin, int level);   //!< 输出电平（0/1）
+
+// ============================================================================
+// PWM
+// 说明：通道式PWM，与ESP32 LEDC外设对应
+// ============================================================================
+void halPwmSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits);  //!< 配置通道频率和分辨率
+void halPwmAttach(int pin, uint8_t channel);                                //!< 引脚绑定到通道
+void halPwmWrite(uint8_t channel, uint32_t duty);                           //!< 写入占空比计数值
+
+// ============================================================================
+// ADC
+// ============================================================================
+uint16_t halAdcRead(int pin);               //!< 读取ADC原始值（12位，0-4095）
+
+// ============================================================================
+// I2C
+// 说明：bus为总线编号（ESP32上对应TwoWire(0)/TwoWire(1)）
+// ============================================================================
+void halI2CBegin(uint8_t bus, int sda, int scl, uint32_t freq);  //!< 初始化I2C总线
+
+// 读取从设备寄存器：先写寄存器地址（重复起始），再读取len字节
+// 返回值：实际收到的字节数（小于len表示通信失败，未收到的字节填0xFF）
+int halI2CReadReg(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len);
+
+// ============================================================================
+// 通信：串口字节流与调试输出
+// ============================================================================
+void halSerialBegin(uint32_t baud);                    //!< 初始化串口
+int halSerialAvailable();                              //!< 可读字节数
+int halSerialRead();                                   //!< 读取一个字节（无数据返回-1）
+size_t halSerialWrite(const uint8_t* data, size_t len); //!< 写入字节流
+void halPrintf(const char* fmt, ...);                  //!< 格式化调试输出（串口/标准输出）
+
+// ============================================================================
+// CAN总线（ESP32上为TWAI控制器）
+// 说明：标准帧（11位ID），数据0-8字节；收发均不阻塞。不记录到现场捕获：
+//       指令帧在分发时按FRAME记录（FOC_Command.h），遥测帧只是输出
+// ============================================================================
+bool halCanBegin(int tx_pin, int rx_pin, uint32_t bitrate);           //!< 初始化并启动控制器，失败返回false
+bool halCanSend(uint32_t id, const uint8_t* data, uint8_t len);       //!< 发送一帧（发送队列满返回false）
+bool halCanReceive(uint32_t* id, uint8_t* data, uint8_t* len);        //!< 取出一帧（无数据返回false）
+
+// ============================================================================
+// 无线广播（ESP32上为ESP-NOW）
+// 说明：无连接的广播数据报，单帧不超过HAL_RADIO_MAX字节；收发均不阻塞。
+//       本机发出的广播不会被本机收到。不记录到现场捕获（指令帧在分发时按FRAME记录）
+// ============================================================================
+#define HAL_RADIO_MAX 250                                         //!< 单帧最大字节数（ESP-NOW上限）
+bool halRadioBegin(uint8_t channel);                              //!< 初始化（WiFi信道1-13），失败返回false
+bool halRadioBroadcast(const uint8_t* data, size_t len);          //!< 广播一帧
+size_t halRadioReceive(uint8_t* data, size_t max);                //!< 取出一帧，返回字节数（无数据返回0）
+
+// ============================================================================
+// 非易失存储（ESP32上为NVS，命名空间"foc"）
+// 说明：按键名存取小块数据；写入要擦写flash，只在启动和配置命令中调用。
+//       不记录到现场捕获：重放时设备ID取自捕获文件头
+// ============================================================================
+bool halNvsRead(const char* key, void* data, size_t len);           //!< 读取，键不存在或长度不符返回false
+bool halNvsWrite(const char* key, const void* data, size_t len);    //!< 写入并提交，失败返回false
+
+// ============================================================================
+// 内存
+// 说明：只用于诊断输出，不参与控制（不记录到现场捕获）；主机后端没有固定堆，返回0
+// ============================================================================
+void halHeapInfo(uint32_t* free_bytes, uint32_t* min_free_bytes);  //!< 当前空闲堆/历史最低空闲堆（字节）
+
+#endif // HAL_H
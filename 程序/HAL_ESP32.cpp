@@ -0,0 +1,332 @@
+// ============================================================================
+// 文件：HAL_ESP32.cpp
+// 功能：硬件抽象层ESP32后端
+// 说明：将HAL接口映射到Arduino-ESP32库（micros/ledc/analogRead/TwoWire/Serial）、TWAI驱动和ESP-NOW
+// ============================================================================
+#include "HAL.h"
+#include "FOC_Trace.h"
+
+#if HAL_ESP32
+
+#include <Preferences.h>
+#include <Wire.h>
+#include <driver/twai.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <stdarg.h>
+
+// ============================================================================
+// I2C总线对象
+// 说明：ESP32有两个硬件I2C控制器，按总线编号索引
+// ============================================================================
+static TwoWire hal_i2c_bus[2] = { TwoWire(0), TwoWire(1) };
+
+// ============================================================================
+// 时钟
+// ============================================================================
+uint32_t halMicros() {
+    uint32_t t = micros();
+    TRACE_TAP(traceRecordMicros(t));
+    return t;
+}
+
+uint32_t halMillis() {
+    uint32_t t = millis();
+    TRACE_TAP(traceRecordMillis(t));
+    return t;
+}
+
+void halDelayMs(uint32_t ms) { delay(ms); }
+void halDelayUs(uint32_t us) { delayMicroseconds(us); }
+
+// ============================================================================
+// GPIO
+// ============================================================================
+void halPinOutput(int pin) { pinMode(pin, OUTPUT); }
+void halPinInput(int pin) { pinMode(pin, INPUT); }
+void halDigitalWrite(int pin, int level) {
+    digitalWrite(pin, level ? HIGH : LOW);
+    TRACE_TAP(traceRecordDigital(pin, level));
+}
+
+// ============================================================================
+// PWM（LEDC）
+// 说明：Arduino-ESP32 3.x删除了ledcSetup/ledcAttachPin，改为绑定引脚时指定频率和分辨率、
+//       按引脚写占空比；这里记下各通道的配置和引脚，保持HAL按通道的接口不变
+// ============================================================================
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#define HAL_PWM_CHANNELS 16  //!< LEDC通道数
+
+static struct {
+    uint32_t freq;
+    uint8_t resolution_bits;
+    int pin;
+    bool attached;
+} hal_pwm[HAL_PWM_CHANNELS];
+
+void halPwmSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) {
+    if (channel >= HAL_PWM_CHANNELS) return;
+    hal_pwm[channel].freq = freq;
+    hal_pwm[channel].resolution_bits = resolution_bits;
+}
+
+void halPwmAttach(int pin, uint8_t channel) {
+    if (channel >= HAL_PWM_CHANNELS) return;
+    if (ledcAttachChannel(pin, hal_pwm[channel].freq, hal_pwm[channel].resolution_bits, channel)) {
+        hal_pwm[channel].pin = pin;
+        hal_pwm[channel].attached = true;
+    }
+}
+
+void halPwmWrite(uint8_t channel, uint32_t duty) {
+    if (channel < HAL_PWM_CHANNELS && hal_pwm[channel].attached) ledcWrite(hal_pwm[channel].pin, duty);
+    TRACE_TAP(traceRecordPwm(channel, duty));
+}
+#else
+void halPwmSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) {
+    ledcSetup(channel, freq, resolution_bits);
+}
+
+void halPwmAttach(int pin, uint8_t channel) {
+    ledcAttachPin(pin, channel);
+}
+
+void halPwmWrite(uint8_t channel, uint32_t duty) {
+    ledcWrite(channel, duty);
+    TRACE_TAP(traceRecordPwm(channel, duty));
+}
+#endif
+
+// ============================================================================
+// ADC
+// ============================================================================
+uint16_t halAdcRead(int pin) {
+    uint16_t raw = (uint16_t)analogRead(pin);
+    TRACE_TAP(traceRecordAdc(pin, raw));
+    return raw;
+}
+
+// ============================================================================
+// I2C
+// ============================================================================
+void halI2CBegin(uint8_t bus, int sda, int scl, uint32_t freq) {
+    hal_i2c_bus[bus & 1].begin(sda, scl, freq);
+}
+
+int halI2CReadReg(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len) {
+    TwoWire& wire = hal_i2c_bus[bus & 1];
+
+    // 写寄存器地址，不释放总线（重复起始）
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    wire.endTransmission(false);
+
+    // 读取数据：与原驱动一致，始终读取len次，缺失字节为0xFF
+    int received = wire.requestFrom(addr, len);
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)wire.read();
+    }
+    TRACE_TAP(traceRecordI2C(bus, addr, reg, buf, len, received));
+    return received;
+}
+
+// ============================================================================
+// 串口
+// ============================================================================
+#ifndef HAL_SERIAL_RX_BUFFER
+#define HAL_SERIAL_RX_BUFFER 1024   //!< UART驱动接收环形缓冲（字节，921600波特下约11ms数据）
+#endif
+#ifndef HAL_SERIAL_TX_BUFFER
+#define HAL_SERIAL_TX_BUFFER 1024   //!< UART驱动发送缓冲（遥测写入不阻塞控制环）
+#endif
+
+void halSerialBegin(uint32_t baud) {
+    // 缓冲大小须在begin之前设置（驱动安装时一次性分配，之后收发不再分配）
+    Serial.setRxBufferSize(HAL_SERIAL_RX_BUFFER);
+    Serial.setTxBufferSize(HAL_SERIAL_TX_BUFFER);
+    Serial.begin(baud);
+}
+
+int halSerialAvailable() {
+    int n = Serial.available();
+    TRACE_TAP(traceRecordSerialAvailable(n));
+    return n;
+}
+
+int halSerialRead() {
+    int c = Serial.read();
+    TRACE_TAP(traceRecordSerialRead(c));
+    return c;
+}
+
+size_t halSerialWrite(const uint8_t* data, size_t len) { return Serial.write(data, len); }
+
+void halPrintf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    Serial.print(buf);
+}
+
+// ============================================================================
+// CAN总线（TWAI）
+// ============================================================================
+#ifndef HAL_CAN_RX_QUEUE
+#define HAL_CAN_RX_QUEUE 32     //!< 驱动接收队列（帧，1Mbit/s满载约4ms）
+#endif
+#ifndef HAL_CAN_TX_QUEUE
+#define HAL_CAN_TX_QUEUE 16     //!< 驱动发送队列（帧）
+#endif
+
+static bool hal_can_started = false;
+
+bool halCanBegin(int tx_pin, int rx_pin, uint32_t bitrate) {
+    twai_general_config_t g = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)tx_pin, (gpio_num_t)rx_pin, TWAI_MODE_NORMAL);
+    g.rx_queue_len = HAL_CAN_RX_QUEUE;
+    g.tx_queue_len = HAL_CAN_TX_QUEUE;
+    // 时序配置宏为复合字面量，只能按波特率分别赋值
+    twai_timing_config_t t;
+    switch (bitrate) {
+        case 1000000: t = TWAI_TIMING_CONFIG_1MBITS(); break;
+        case 500000: t = TWAI_TIMING_CONFIG_500KBITS(); break;
+        case 250000: t = TWAI_TIMING_CONFIG_250KBITS(); break;
+        case 125000: t = TWAI_TIMING_CONFIG_125KBITS(); break;
+        default: return false;
+    }
+    twai_filter_config_t f = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    if (twai_driver_install(&g, &t, &f) != ESP_OK) return false;
+    hal_can_started = twai_start() == ESP_OK;
+    return hal_can_started;
+}
+
+bool halCanSend(uint32_t id, const uint8_t* data, uint8_t len) {
+    if (!hal_can_started) return false;
+    twai_message_t msg = {};
+    msg.identifier = id;
+    msg.data_length_code = len > 8 ? 8 : len;
+    memcpy(msg.data, data, msg.data_length_code);
+    if (twai_transmit(&msg, 0) == ESP_OK) return true;
+    // 总线关闭（错误计数溢出）后需要主动恢复，恢复完成后由halCanReceive重新启动
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) == ESP_OK && status.state == TWAI_STATE_BUS_OFF) {
+        twai_initiate_recovery();
+    }
+    return false;
+}
+
+bool halCanReceive(uint32_t* id, uint8_t* data, uint8_t* len) {
+    if (!hal_can_started) return false;
+    twai_message_t msg;
+    if (twai_receive(&msg, 0) != ESP_OK) {
+        twai_status_info_t status;
+        if (twai_get_status_info(&status) == ESP_OK && status.state == TWAI_STATE_STOPPED) {
+            twai_start();  // 总线关闭恢复完成
+        }
+        return false;
+    }
+    if (msg.extd || msg.rtr) return false;  // 只使用标准数据帧
+    *id = msg.identifier;
+    *len = msg.data_length_code > 8 ? 8 : msg.data_length_code;
+    memcpy(data, msg.data, *len);
+    return true;
+}
+
+// ============================================================================
+// 无线广播（ESP-NOW）
+// 说明：接收回调运行在WiFi任务中，经单生产者/单消费者环形队列交给控制环（与BLE接收FIFO相同）
+// ============================================================================
+#ifndef HAL_RADIO_RX_SLOTS
+#define HAL_RADIO_RX_SLOTS 8        //!< 接收队列深度（2的幂）
+#endif
+
+struct HalRadioSlot {
+    uint8_t len;
+    uint8_t data[HAL_RADIO_MAX];
+};
+
+static HalRadioSlot hal_radio_rx[HAL_RADIO_RX_SLOTS];
+static volatile uint16_t hal_radio_head = 0;    //!< 下一个写入位置（WiFi任务递增）
+static volatile uint16_t hal_radio_tail = 0;    //!< 下一个读取位置（控制环递增）
+static const uint8_t hal_radio_broadcast_addr[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static void halRadioPush(const uint8_t* data, int len) {
+    uint16_t head = hal_radio_head;
+    if (len <= 0 || len > HAL_RADIO_MAX || (uint16_t)(head - hal_radio_tail) >= HAL_RADIO_RX_SLOTS) return;
+    HalRadioSlot& slot = hal_radio_rx[head & (HAL_RADIO_RX_SLOTS - 1)];
+    memcpy(slot.data, data, len);
+    slot.len = (uint8_t)len;
+    __sync_synchronize();  // 槽位写完后再发布head
+    hal_radio_head = (uint16_t)(head + 1);
+}
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+static void halRadioOnReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+    (void)info;
+    halRadioPush(data, len);
+}
+#else
+static void halRadioOnReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    (void)mac;
+    halRadioPush(data, len);
+}
+#endif
+
+bool halRadioBegin(uint8_t channel) {
+    WiFi.mode(WIFI_STA);  // 只用作ESP-NOW收发，不连接AP
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    if (esp_now_init() != ESP_OK) return false;
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, hal_radio_broadcast_addr, 6);
+    peer.channel = channel;
+    peer.encrypt = false;
+    if (esp_now_add_peer(&peer) != ESP_OK) return false;
+    return esp_now_register_recv_cb(halRadioOnReceive) == ESP_OK;
+}
+
+bool halRadioBroadcast(const uint8_t* data, size_t len) {
+    return esp_now_send(hal_radio_broadcast_addr, data, len) == ESP_OK;
+}
+
+size_t halRadioReceive(uint8_t* data, size_t max) {
+    if (hal_radio_tail == hal_radio_head) return 0;
+    __sync_synchronize();  // 读取槽位前确认head已发布
+    const HalRadioSlot& slot = hal_radio_rx[hal_radio_tail & (HAL_RADIO_RX_SLOTS - 1)];
+    size_t n = slot.len < max ? slot.len : max;
+    memcpy(data, slot.data, n);
+    hal_radio_tail = (uint16_t)(hal_radio_tail + 1);
+    return n;
+}
+
+// ============================================================================
+// 非易失存储
+// 说明：首次使用时打开命名空间；Preferences::putBytes内部已提交（nvs_commit）
+// ============================================================================
+static Preferences hal_nvs;
+static bool hal_nvs_open = false;
+
+static bool halNvsOpen() {
+    if (!hal_nvs_open) hal_nvs_open = hal_nvs.begin("foc", false);
+    return hal_nvs_open;
+}
+
+bool halNvsRead(const char* key, void* data, size_t len) {
+    if (!halNvsOpen() || !hal_nvs.isKey(key) || hal_nvs.getBytesLength(key) != len) return false;
+    return hal_nvs.getBytes(key, data, len) == len;
+}
+
+bool halNvsWrite(const char* key, const void* data, size_t len) {
+    return halNvsOpen() && hal_nvs.putBytes(key, data, len) == len;
+}
+
+// ============================================================================
+// 内存
+// ============================================================================
+void halHeapInfo(uint32_t* free_bytes, uint32_t* min_free_bytes) {
+    *free_bytes = ESP.getFreeHeap();
+    *min_free_bytes = ESP.getMinFreeHeap();
+}
+
+#endif // HAL_ESP32
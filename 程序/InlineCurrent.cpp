@@ -1,4 +1,3 @@
-#include <Arduino.h> 
 #include "InlineCurrent.h"
 
 // ============================================================================
@@ -78,7 +77,7 @@ CurrSense::CurrSense(int Mot_Num)
 // ============================================================================
 float CurrSense::readADCVoltageInline(const int pinA){
   // 读取ADC原始值（0-4095）
-  uint32_t raw_adc = analogRead(pinA);
+  uint32_t raw_adc = halAdcRead(pinA);
   
   // ADC计数值转换为电压值：电压 = 计数值 × 转换比率
   return raw_adc * _ADC_CONV;
@@ -91,11 +90,11 @@ float CurrSense::readADCVoltageInline(const int pinA){
 // 说明：将ADC引脚设置为输入模式，准备进行电压采样
 // ============================================================================
 void CurrSense::configureADCInline(const int pinA,const int pinB, const int pinC){
-  pinMode(pinA, INPUT);  // 设置A相引脚为输入模式
-  pinMode(pinB, INPUT);  // 设置B相引脚为输入模式
+  halPinInput(pinA);  // 设置A相引脚为输入模式
+  halPinInput(pinB);  // 设置B相引脚为输入模式
   
   // 如果C相引脚已设置，也配置为输入模式
-  if( _isset(pinC) ) pinMode(pinC, INPUT);
+  if( _isset(pinC) ) halPinInput(pinC);
 }
 
 // ============================================================================
@@ -119,7 +118,7 @@ void CurrSense::calibrateOffsets(){
         // 如果C相引脚已设置，也进行采样
         if(_isset(pinC)) offset_ic += readADCVoltageInline(pinC);
         
-        delay(1);  // 短暂延时，避免采样过于密集
+        halDelayMs(1);  // 短暂延时，避免采样过于密集
     }
     
     // 计算各相的平均偏移电压（零点误差）
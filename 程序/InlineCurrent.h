@@ -1,4 +1,4 @@
-#include <Arduino.h>
+#include "HAL.h"
 
 // ============================================================================
 // 类定义：CurrSense
@@ -33,7 +33,7 @@ int angle_PID_limit = 70;  //!< 角度PID输出限幅：70度/秒
                           //!< 限制位置环控制器的最大输出速度
 
 // 速度环PID限幅参数  
-float vel_PID_limit = 6.5;  //!< 速度PID输出限幅：6.5安培（电流）
+float vel_PID_limit = I_MAX_CMD;  //!< 速度PID输出限幅：3安培（电流），低于过流保护阈值
                            //!< 限制速度环控制器的最大输出电流
 
 // 备用配置（注释状态）
@@ -45,18 +45,22 @@ float vel_PID_limit = 6.5;  //!< 速度PID输出限幅：6.5安培（电流）
 // 说明：在系统启动时执行一次，完成硬件和软件的初始化
 // ============================================================================
 void setup() {
+  // 现场数据捕获（FOC_TRACE_BUFFER_SIZE > 0时从此处开始记录，供主机重放）
+  traceBoot();
+
   // 串口通信初始化
-  Serial.begin(115200);  //!< 初始化串口通信，波特率115200
-                       //!< 用于调试信息输出和串口命令接收
+  halSerialBegin(SERIAL_BAUD);  //!< 初始化串口通信，波特率SERIAL_BAUD（默认921600）
+                            //!< 用于调试信息输出、文本命令和二进制协议（FOC_SerialLink.h）
+  serialLinkInit();              //!< 注册串口二进制协议传输（与BLE共用指令层FOC_Command.h）
 
   // 电机使能控制
-  pinMode(12, OUTPUT);     //!< 设置12号引脚为输出模式（电机使能引脚）
-  digitalWrite(12, HIGH); //!< 输出高电平，使能电机驱动器
+  halPinOutput(12);        //!< 设置12号引脚为输出模式（电机使能引脚）
+  halDigitalWrite(12, 1); //!< 输出高电平，使能电机驱动器
                          //!< 确保电机处于可控制状态
 
   // FOC系统参数配置
   setPowerSupplyVoltage(15.6);  //!< 设置供电电压：15.6V
-                               //!< 用于电压补偿和电流计算
+                               //!< 用于电压补偿和电流计算（定义VBUS_ADC_PIN时改用母线电压实测值）
 
   calibrateSensor(Motor_PP, Sensor_DIR);  //!< 传感器校准：设置极对数和旋转方向
                                         //!< 确保传感器读数与电机实际位置对应
@@ -64,6 +68,12 @@ void setup() {
   // BLE通信初始化
   initBLEServer();  //!< 初始化BLE服务器，开始广播等待连接
                    //!< 启用无线控制功能
+
+  // CAN总线初始化（CAN_LINK_ENABLE为0时不启动）
+  canLinkInit();  //!< 启动TWAI控制器并注册为CMD_TRANSPORT_CAN
+
+  // ESP-NOW无线广播初始化（RADIO_LINK_ENABLE为0时不启动）
+  radioLinkInit();  //!< 注册为CMD_TRANSPORT_RADIO，接收网关的一对多目标帧
 }
 
 // ============================================================================
@@ -72,27 +82,11 @@ void setup() {
 int count = 0;  //!< 循环计数器 - 可用于调试或定时任务
 
 // ============================================================================
-// 函数：loop
-// 功能：主循环函数
-// 说明：系统主循环，持续执行控制算法和通信处理
+// 函数：configureControlLoops
+// 功能：三环PID参数配置
+// 说明：每个控制周期在loop()中调用；主机仿真/基准测试也调用本函数，保证参数一致
 // ============================================================================
-void loop() {
-  // ==========================================================================
-  // 第一步：通信处理
-  // ==========================================================================
-  BLE_Server_Loop();  //!< BLE服务器循环处理
-                     //!< 处理连接状态、接收数据、发送心跳包
-
-  // ==========================================================================
-  // 第二步：FOC算法执行
-  // ==========================================================================
-  runFOC();  //!< 执行FOC核心算法
-            //!< 包括：传感器读数、坐标变换、SVPWM生成等
-
-  // ==========================================================================
-  // 第三步：PID控制器参数配置
-  // ==========================================================================
-  
+void configureControlLoops() {
   // 位置环PID参数配置
   configureAnglePID(1, 0, 0, 10000, angle_PID_limit);
   // 参数说明：
@@ -109,7 +103,7 @@ void loop() {
   // - I=1.0：积分增益 - 消除速度稳态误差
   // - D=0：微分增益 - 速度环阻尼（当前禁用）
   // - 输出变化率限制=10000：限制速度环输出变化
-  // - 输出限幅=vel_PID_limit：限制最大输出电流（6.5A）
+  // - 输出限幅=vel_PID_limit：限制最大输出电流（3A）
 
   // 电流环PID参数配置
   configureCurrentPID(5, 200, 0, 10000);
@@ -118,6 +112,33 @@ void loop() {
   // - I=200：积分增益 - 消除电流跟踪误差
   // - D=0：微分增益 - 电流环阻尼（当前禁用）
   // - 输出变化率限制=10000：限制电流环输出变化
+}
+
+// ============================================================================
+// 函数：loop
+// 功能：主循环函数
+// 说明：系统主循环，持续执行控制算法和通信处理
+// ============================================================================
+void loop() {
+  // ==========================================================================
+  // 第一步：通信处理
+  // ==========================================================================
+  BLE_Server_Loop();  //!< BLE服务器循环处理
+                     //!< 处理连接状态、接收数据、发送心跳包
+  canLinkPoll();  //!< CAN总线接收处理
+                 //!< 同步模式下SYNC到达时目标生效并回送遥测
+  radioLinkPoll();  //!< ESP-NOW广播接收处理
+
+  // ==========================================================================
+  // 第二步：FOC算法执行
+  // ==========================================================================
+  runFOC();  //!< 执行FOC核心算法
+            //!< 包括：传感器读数、坐标变换、SVPWM生成等
+
+  // ==========================================================================
+  // 第三步：PID控制器参数配置
+  // ==========================================================================
+  configureControlLoops();
 
   // ==========================================================================
   // 第四步：电机控制执行
@@ -133,4 +154,10 @@ void loop() {
   // ==========================================================================
   readSerialCommand();  //!< 读取和处理串口命令
                        //!< 支持调试命令和实时参数调整
+
+  // ==========================================================================
+  // 第六步：遥测
+  // ==========================================================================
+  cmdTelemetryTick(S0.getUpdateTimestamp());  //!< 按各传输设定的频率发送遥测
+                                             //!< 时间取本周期编码器时间戳，不额外读时钟
 }
\ No newline at end of file
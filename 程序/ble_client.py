@@ -18,6 +18,12 @@ CHARACTERISTIC_UUID_TX = "6d68efe5-04b6-4a85-abc4-c2670b7bf7fd"  # ESP32发送
 PACKET_TYPE_SINGLE = 0x01    # 单电机控制包
 PACKET_TYPE_MULTI = 0x02     # 多电机批量控制包
 PACKET_TYPE_MULTI_STRUCT = 0x03  # 新增：结构体化MULTI
+PACKET_TYPE_CONFIG = 0x04    # 设备配置包：AA 55 04 OP ID 参数..
+PACKET_TYPE_MULTI_SLOT = 0x05  # 槽位包：按上位机分配的槽位紧凑排列
+CONFIG_OP_SET_ID = 0x01      # 设置设备ID（写入NVS）
+CONFIG_OP_SET_SLOT = 0x02    # 分配槽位和纪元号（掉电不保存）
+CONFIG_OP_QUERY = 0x03       # 查询ID/槽位（ID为0时任意设备应答）
+SEQ_PREFIX = 0xA5  # 序号前缀：A5 序号高 序号低 <原数据包>，固件据此统计丢包
 
 class MultiBLECommunicator:
     def __init__(self, max_devices=20):
@@ -36,6 +42,12 @@ class MultiBLECommunicator:
         self.max_device_id: int = 0
         self.watch_file_path: Optional[str] = DEFAULT_WATCH_FILE
         self._watch_task: Optional[asyncio.Task] = None
+        # 写无响应流水线发送：不等待ATT写响应，每台设备独立的16位序号
+        self.write_without_response: bool = True
+        self.tx_seq: Dict[str, int] = {}
+        # 槽位表：设备ID→槽位（1..N，按在线设备紧凑分配），纪元号随每次分配递增
+        self.slot_of: Dict[int, int] = {}
+        self.slot_epoch: int = 0
     
     def notification_handler(self, device_address):
         def handler(sender, data):
@@ -50,6 +62,13 @@ class MultiBLECommunicator:
                     if head.isdigit():
                         dev_id = int(head)
                         self.id_to_address[dev_id] = device_address
+                # 设置ID的回复"<旧ID>:CONFIG:ID=<新ID>"：映射改为新ID
+                if ":CONFIG:ID=" in message:
+                    new_id = message.split(":CONFIG:ID=")[1].split(',')[0]
+                    if new_id.isdigit():
+                        if self.id_to_address.get(int(head)) == device_address:
+                            del self.id_to_address[int(head)]
+                        self.id_to_address[int(new_id)] = device_address
                 
                 # 更新设备最后活动时间
                 if device_address in self.device_status:
@@ -233,6 +252,38 @@ class MultiBLECommunicator:
             packet.extend(struct.pack('>h', scaled))
         return packet
 
+    def create_config_packet(self, op: int, device_id: int, *args: int) -> bytearray:
+        """设备配置包: AA 55 04 OP ID 参数..（SET_ID: 新ID；SET_SLOT: 槽位 纪元；QUERY: 无参数）"""
+        return bytearray([0xAA, 0x55, PACKET_TYPE_CONFIG, op, device_id & 0xFF] + [a & 0xFF for a in args])
+
+    def create_multi_slot_packet(self, epoch: int, start_slot: int, values: List[float], data_type: int) -> bytearray:
+        """槽位包: AA 55 05 DT EPOCH START COUNT V(start)..V(start+count-1)，每台2字节，不为缺席的ID留位置"""
+        packet = bytearray([0xAA, 0x55, PACKET_TYPE_MULTI_SLOT, data_type, epoch & 0xFF, start_slot, len(values)])
+        for v in values:
+            packet.extend(struct.pack('>h', int(v * 10.0)))
+        return packet
+
+    async def query_device_ids(self, timeout: float = 2.0):
+        """逐台发送QUERY（ID为0），由回复建立ID→地址映射"""
+        packet = self.create_config_packet(CONFIG_OP_QUERY, 0)
+        for addr in list(self.clients.keys()):
+            await self.send_to_single_device(addr, packet)
+        await asyncio.sleep(timeout)
+
+    async def assign_slots(self) -> int:
+        """按ID顺序为已知ID的在线设备分配槽位1..N（纪元号递增），返回分配数"""
+        self.slot_epoch = (self.slot_epoch % 255) + 1
+        self.slot_of = {}
+        for slot, dev_id in enumerate(sorted(self.id_to_address.keys()), start=1):
+            addr = self.id_to_address[dev_id]
+            if addr not in self.clients:
+                continue
+            packet = self.create_config_packet(CONFIG_OP_SET_SLOT, dev_id, slot, self.slot_epoch)
+            if await self.send_to_single_device(addr, packet):
+                self.slot_of[dev_id] = slot
+        print(f"🧩 槽位表（纪元{self.slot_epoch}）: " + ", ".join(f"ID{d}→{s}" for d, s in sorted(self.slot_of.items())))
+        return len(self.slot_of)
+
     async def run_multi_slice_scheduler(
         self,
         total_devices: int = 20,
@@ -288,11 +339,19 @@ class MultiBLECommunicator:
         finally:
             print("✅ 自动轮询结束")
     
+    def sequenced_packet(self, device_address: str, packet_data) -> bytes:
+        """加序号前缀（每台设备独立递增，重连后从0开始）"""
+        seq = self.tx_seq.get(device_address, 0)
+        self.tx_seq[device_address] = (seq + 1) & 0xFFFF
+        return bytes([SEQ_PREFIX, seq >> 8, seq & 0xFF]) + bytes(packet_data)
+
     async def send_broadcast_data(self, packet_data):
         """向所有连接设备发送数据（广播）"""
         tasks = []
         for device_address, client in self.clients.items():
-            task = asyncio.create_task(client.write_gatt_char(CHARACTERISTIC_UUID_RX, packet_data))
+            task = asyncio.create_task(client.write_gatt_char(
+                CHARACTERISTIC_UUID_RX, self.sequenced_packet(device_address, packet_data),
+                response=not self.write_without_response))
             tasks.append(task)
         
         await asyncio.gather(*tasks, return_exceptions=True)
@@ -625,6 +684,7 @@ class MultiBLECommunicator:
         self.clients.clear()
         self.device_responses.clear()
         self.device_status.clear()
+        self.tx_seq.clear()
         print("🔌 已断开所有设备连接")
     
     async def send_to_single_device(self, device_address, packet_data):
@@ -635,7 +695,8 @@ class MultiBLECommunicator:
         
         try:
             client = self.clients[device_address]
-            await client.write_gatt_char(CHARACTERISTIC_UUID_RX, packet_data)
+            await client.write_gatt_char(CHARACTERISTIC_UUID_RX, self.sequenced_packet(device_address, packet_data),
+                                         response=not self.write_without_response)
             print(f"📤 向设备 {device_address} 发送单电机控制数据")
             return True
         except Exception as e:
@@ -674,7 +735,9 @@ async def multi_device_demo():
             print("4. 自动分组一次性发送（切片MULTI）")
             print("5. 自动执行（从文件读取并一键发送）")
             print("6. 发送结构体数据（MULTI_STRUCT）")
-            choice = input("请输入选择 (0-6): ").strip()
+            print("7. 设置设备ID（写入NVS）")
+            print("8. 分配槽位并发送槽位包（MULTI_SLOT）")
+            choice = input("请输入选择 (0-8): ").strip()
 
             if choice == '1':
                 # 单电机控制（按设备ID路由；若未知ID映射则广播）
@@ -924,6 +987,37 @@ async def multi_device_demo():
                 except Exception as e:
                     print(f"❌ 结构体化自动执行失败: {e}")
 
+            elif choice == '7':
+                # 设置设备ID：只有当前ID匹配的设备执行，新ID立即生效并保存到NVS
+                try:
+                    old_id = int(input("请输入设备当前ID (1-20): ").strip())
+                    new_id = int(input("请输入新ID (1-20): ").strip())
+                    packet = communicator.create_config_packet(CONFIG_OP_SET_ID, old_id, new_id)
+                    target_addr = communicator.id_to_address.get(old_id)
+                    if target_addr:
+                        await communicator.send_to_single_device(target_addr, packet)
+                    else:
+                        await communicator.send_broadcast_data(packet)
+                    await communicator.wait_for_responses(target_device_id=old_id)
+                except ValueError:
+                    print("❌ 输入格式错误")
+
+            elif choice == '8':
+                # 槽位：先查询在线设备的ID，按ID顺序分配槽位1..N，再按槽位顺序发送一帧紧凑包
+                try:
+                    await communicator.query_device_ids()
+                    if await communicator.assign_slots() == 0:
+                        print("❌ 没有可分配槽位的设备")
+                        continue
+                    await asyncio.sleep(0.5)
+                    values_input = input(f"请按ID顺序输入 {len(communicator.slot_of)} 个角度值（用空格分隔）: ").strip()
+                    values = [float(x) for x in values_input.split()]
+                    packet = communicator.create_multi_slot_packet(communicator.slot_epoch, 1, values, 0x01)
+                    await communicator.send_broadcast_data(packet)
+                    await communicator.wait_for_responses()
+                except ValueError:
+                    print("❌ 输入格式错误")
+
             elif choice == '0' or choice.lower() == 'quit':
                 break
             else:
@@ -29,9 +29,55 @@ CHARACTERISTIC_UUID_TX = "6d68efe5-04b6-4a85-abc4-c2670b7bf7fd"  # ESP32发送
 PACKET_TYPE_SINGLE = 0x01
 PACKET_TYPE_MULTI = 0x02
 PACKET_TYPE_MULTI_STRUCT = 0x03  # 新增：结构体化MULTI
+PACKET_TYPE_CONFIG = 0x04  # 设备配置包：AA 55 04 OP ID 参数..
+PACKET_TYPE_MULTI_SLOT = 0x05  # 槽位包：按上位机分配的槽位紧凑排列
+CONFIG_OP_SET_SLOT = 0x02
+CONFIG_OP_QUERY = 0x03
+SEQ_PREFIX = 0xA5  # 序号前缀：A5 序号高 序号低 <原数据包>，固件据此统计丢包
+
+# ESP-NOW网关（FOC_RadioLink.h）：经串口二进制协议把一帧交给网关板，由网关一次广播给全部关节
+SERIAL_BAUD = 921600
+SLINK_MSG_RADIO = 0x03
+RADIO_MAGIC = 0xF5
+
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data: bytes) -> bytes:
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_pos] = code
+                code_pos, code = len(out), 1
+                out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def slink_frame(msg_type: int, data: bytes) -> bytes:
+    """串口二进制协议帧：00 | COBS(类型 | 数据 | CRC16小端) | 00"""
+    raw = bytes([msg_type]) + data
+    return b'\x00' + cobs_encode(raw + struct.pack('<H', crc16_ccitt(raw))) + b'\x00'
+
 
 class MultiBLEInputOutput:
-    def __init__(self, max_devices: int = 50, watch_file_path: Optional[str] = DEFAULT_WATCH_FILE, poll_interval: float = 0.5):
+    def __init__(self, max_devices: int = 50, watch_file_path: Optional[str] = DEFAULT_WATCH_FILE, poll_interval: float = 0.5,
+                 gateway_port: Optional[str] = None, radio_group: int = 0, use_slots: bool = False):
         self.max_devices = max_devices
         self.watch_file_path = watch_file_path
         self.poll_interval = poll_interval
@@ -47,6 +93,17 @@ class MultiBLEInputOutput:
         self.max_device_id: int = 0
 
         self._last_file_hash: Optional[str] = None
+        # 写无响应流水线发送：不等待ATT写响应，每台设备独立的16位序号
+        self.write_without_response: bool = True
+        self.tx_seq: Dict[str, int] = {}
+        # ESP-NOW网关：设置串口后广播改为一帧经网关发出，不再逐台写入
+        self.gateway_port = gateway_port
+        self.radio_group = radio_group
+        self.gateway = None
+        # 槽位：连接后按ID顺序为在线设备分配槽位1..N，广播改用MULTI_SLOT包（缺席的ID不占字节）
+        self.use_slots = use_slots
+        self.slot_of: Dict[int, int] = {}
+        self.slot_epoch = 0
 
     def notification_handler(self, device_address):
         def handler(sender, data):
@@ -129,6 +186,7 @@ class MultiBLEInputOutput:
         self.clients.clear()
         self.device_responses.clear()
         self.device_status.clear()
+        self.tx_seq.clear()
         print("🔌 已断开所有设备连接")
 
     def create_multi_slice_packet(self, start_id: int, values: List[float], data_type: int) -> bytearray:
@@ -155,10 +213,58 @@ class MultiBLEInputOutput:
             packet.extend(struct.pack('>h', scaled))
         return packet
 
+    def create_multi_slot_packet(self, epoch: int, start_slot: int, values: List[float], data_type: int) -> bytearray:
+        packet = bytearray([0xAA, 0x55, PACKET_TYPE_MULTI_SLOT, data_type, epoch & 0xFF, start_slot, len(values)])
+        for v in values:
+            packet.extend(struct.pack('>h', int(v * 10.0)))
+        return packet
+
+    async def write_to_device(self, addr: str, packet_data):
+        await self.clients[addr].write_gatt_char(CHARACTERISTIC_UUID_RX, self.sequenced_packet(addr, packet_data),
+                                                 response=not self.write_without_response)
+
+    async def assign_slots(self, timeout: float = 2.0):
+        """查询各连接的设备ID（QUERY，ID为0），再按ID顺序逐台分配槽位1..N，纪元号递增"""
+        for addr in list(self.clients.keys()):
+            await self.write_to_device(addr, bytes([0xAA, 0x55, PACKET_TYPE_CONFIG, CONFIG_OP_QUERY, 0]))
+        await asyncio.sleep(timeout)
+        self.slot_epoch = (self.slot_epoch % 255) + 1
+        self.slot_of = {}
+        for slot, dev_id in enumerate(sorted(self.id_to_address.keys()), start=1):
+            addr = self.id_to_address[dev_id]
+            if addr in self.clients:
+                await self.write_to_device(addr, bytes([0xAA, 0x55, PACKET_TYPE_CONFIG, CONFIG_OP_SET_SLOT, dev_id,
+                                                        slot, self.slot_epoch]))
+                self.slot_of[dev_id] = slot
+        print(f"🧩 槽位表（纪元{self.slot_epoch}）: " + ", ".join(f"ID{d}→{s}" for d, s in sorted(self.slot_of.items())))
+
+    def sequenced_packet(self, device_address: str, packet_data) -> bytes:
+        """加序号前缀（每台设备独立递增，重连后从0开始）"""
+        seq = self.tx_seq.get(device_address, 0)
+        self.tx_seq[device_address] = (seq + 1) & 0xFFFF
+        return bytes([SEQ_PREFIX, seq >> 8, seq & 0xFF]) + bytes(packet_data)
+
+    def open_gateway(self) -> bool:
+        try:
+            import serial  # pyserial，仅网关模式需要
+            self.gateway = serial.Serial(self.gateway_port, SERIAL_BAUD, timeout=0)
+        except Exception as e:
+            print(f"❌ 无法打开网关串口 {self.gateway_port}: {e}")
+            return False
+        self.gateway.write(b'\x00')  # 切换到二进制协议
+        print(f"📡 ESP-NOW网关: {self.gateway_port}，组号 {self.radio_group}")
+        return True
+
     async def send_broadcast_data(self, packet_data: bytes):
+        if self.gateway:
+            frame = bytes([RADIO_MAGIC, self.radio_group]) + self.sequenced_packet("radio", packet_data)
+            self.gateway.write(slink_frame(SLINK_MSG_RADIO, frame))
+            print(f"📡 经网关广播 {len(frame)} 字节")
+            return
         tasks = []
         for addr, client in self.clients.items():
-            tasks.append(asyncio.create_task(client.write_gatt_char(CHARACTERISTIC_UUID_RX, packet_data)))
+            tasks.append(asyncio.create_task(client.write_gatt_char(CHARACTERISTIC_UUID_RX, self.sequenced_packet(addr, packet_data),
+                                                                  response=not self.write_without_response)))
         await asyncio.gather(*tasks, return_exceptions=True)
         print(f"📤 广播到 {len(self.clients)} 台设备")
 
@@ -195,7 +301,10 @@ class MultiBLEInputOutput:
             print("❌ 尚未加载任何设备数据")
             return
 
-        group_count = (self.max_device_id + group_size - 1) // group_size
+        # 槽位模式：按槽位顺序打包在线设备，缺席的ID不占字节
+        slot_ids = [d for d, _ in sorted(self.slot_of.items(), key=lambda kv: kv[1])]
+        span = len(slot_ids) if slot_ids else self.max_device_id
+        group_count = (span + group_size - 1) // group_size
         slot_seconds = 0.0
         if per_device_hz and per_device_hz > 0:
             slot_seconds = 1.0 / (per_device_hz * group_count)
@@ -208,10 +317,11 @@ class MultiBLEInputOutput:
             any_data = False
             for g in range(group_count):
                 start_id = g * group_size + 1
-                end_id = min(start_id + group_size - 1, self.max_device_id)
+                end_id = min(start_id + group_size - 1, span)
                 slice_vals: List[float] = []
                 items: List[Tuple[int, float]] = []
-                for dev_id in range(start_id, end_id + 1):
+                for index in range(start_id, end_id + 1):
+                    dev_id = slot_ids[index - 1] if slot_ids else index
                     buf = self.device_buffers.get(dev_id)
                     if not buf:
                         val = 0.0
@@ -225,11 +335,12 @@ class MultiBLEInputOutput:
                             val = buf["last_value"]
                     slice_vals.append(val)
                     items.append((dev_id, val))
-                packet = (
-                    self.create_multi_struct_packet(items, data_type)
-                    if use_struct
-                    else self.create_multi_slice_packet(start_id, slice_vals, data_type)
-                )
+                if slot_ids:
+                    packet = self.create_multi_slot_packet(self.slot_epoch, start_id, slice_vals, data_type)
+                elif use_struct:
+                    packet = self.create_multi_struct_packet(items, data_type)
+                else:
+                    packet = self.create_multi_slice_packet(start_id, slice_vals, data_type)
                 await self.send_broadcast_data(packet)
                 if slot_seconds > 0:
                     await asyncio.sleep(slot_seconds)
@@ -375,6 +486,14 @@ class MultiBLEInputOutput:
             await asyncio.sleep(self.poll_interval)
 
     async def run(self):
+        if self.gateway_port:
+            if not self.open_gateway():
+                return
+            try:
+                await self.watch_file_and_broadcast_loop()
+            finally:
+                self.gateway.close()
+            return
         devices = await self.scan_esp32_devices()
         if not devices:
             print("❌ 未找到ESP32设备")
@@ -384,6 +503,9 @@ class MultiBLEInputOutput:
             print("❌ 没有成功连接的设备")
             return
 
+        if self.use_slots:
+            await self.assign_slots()
+
         print("\n" + "="*50)
         print("自动文件监听与广播（按 ESC 退出）")
         print("="*50)
@@ -399,7 +521,11 @@ async def main():
     if sys.version_info < (3, 7):
         print("❌ 需要Python 3.7或更高版本")
         return
-    io = MultiBLEInputOutput(max_devices=50, watch_file_path=DEFAULT_WATCH_FILE, poll_interval=0.5)
+    # --gateway <串口>：经ESP-NOW网关广播（一帧送达全部关节），不建立BLE连接
+    gateway = sys.argv[sys.argv.index("--gateway") + 1] if "--gateway" in sys.argv[:-1] else None
+    # --slots：按在线设备分配槽位，广播改用紧凑的MULTI_SLOT包（仅BLE连接模式）
+    io = MultiBLEInputOutput(max_devices=50, watch_file_path=DEFAULT_WATCH_FILE, poll_interval=0.5,
+                             gateway_port=gateway, use_slots="--slots" in sys.argv)
     await io.run()
 
 
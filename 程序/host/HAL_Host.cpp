@@ -0,0 +1,485 @@
+// ============================================================================
+// 文件：HAL_Host.cpp
+// 功能：硬件抽象层主机（Linux）后端
+// 说明：虚拟时钟 + 回调式外设，使控制代码可以在主机上编译、仿真和测试
+// ============================================================================
+#include "HAL_Host.h"
+#include "../FOC_Trace.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 内部状态
+// ============================================================================
+#define HAL_HOST_MAX_PINS     64    //!< 支持的GPIO/ADC引脚数
+#define HAL_HOST_PWM_CHANNELS 16    //!< 支持的PWM通道数
+#define HAL_HOST_SERIAL_RX    4096  //!< 串口接收缓冲大小
+#define HAL_HOST_SERIAL_TX    65536 //!< 串口发送捕获缓冲大小
+#define HAL_HOST_CAN_QUEUE    256   //!< CAN收/发队列（帧）
+#define HAL_HOST_RADIO_QUEUE  64    //!< 无线广播收/发队列（帧）
+#define HAL_HOST_NVS_WRITE_US 30000 //!< NVS写入阻塞时间（提交时擦除扇区，按ESP32实测量级）
+
+static uint64_t host_now_us = 0;                       //!< 虚拟时间（微秒）
+static HalHostHooks host_hooks = {};                   //!< 当前回调
+static uint32_t host_pwm_duty[HAL_HOST_PWM_CHANNELS];  //!< PWM占空比
+static uint8_t host_pwm_bits[HAL_HOST_PWM_CHANNELS];   //!< PWM分辨率
+static uint8_t host_pin_level[HAL_HOST_MAX_PINS];      //!< 引脚电平
+static uint16_t host_adc_raw[HAL_HOST_MAX_PINS];       //!< ADC默认值
+static uint8_t host_serial_rx[HAL_HOST_SERIAL_RX];     //!< 串口接收环形缓冲
+static size_t host_serial_head = 0;                    //!< 写指针
+static size_t host_serial_tail = 0;                    //!< 读指针
+static uint8_t host_serial_tx[HAL_HOST_SERIAL_TX];     //!< 串口发送捕获缓冲
+static size_t host_serial_tx_len = 0;                  //!< 已捕获字节数
+static bool host_serial_capture = false;               //!< 发送捕获开关
+static uint32_t host_serial_baud = 0;                  //!< 设定的波特率
+static bool host_log_enabled = true;                   //!< 调试输出开关
+
+struct HostCanFrame {
+    uint32_t id;
+    uint8_t len;
+    uint8_t data[8];
+};
+
+// CAN帧队列（环形，满时丢弃新帧）
+struct HostCanQueue {
+    HostCanFrame frames[HAL_HOST_CAN_QUEUE];
+    size_t head;
+    size_t tail;
+};
+
+static HostCanQueue host_can_rx = {};                  //!< 注入的待接收帧
+static HostCanQueue host_can_tx = {};                  //!< 发送的帧
+static uint32_t host_can_bitrate = 0;                  //!< halCanBegin设定的波特率（0为未初始化）
+
+struct HostRadioFrame {
+    size_t len;
+    uint8_t data[HAL_RADIO_MAX];
+};
+
+// 无线广播帧队列（环形，满时丢弃新帧）
+struct HostRadioQueue {
+    HostRadioFrame frames[HAL_HOST_RADIO_QUEUE];
+    size_t head;
+    size_t tail;
+};
+
+static HostRadioQueue host_radio_rx = {};              //!< 注入的待接收帧
+static HostRadioQueue host_radio_tx = {};              //!< 广播的帧
+static int host_radio_channel = 0;                     //!< halRadioBegin设定的信道（0为未初始化）
+static int host_radio_rx_fd = -1;                      //!< UDP替身：接收套接字（-1为使用队列）
+static int host_radio_tx_fd = -1;                      //!< UDP替身：发送套接字
+static sockaddr_in host_radio_group = {};              //!< UDP替身：组播地址
+static uint16_t host_radio_tx_port = 0;                //!< 发送套接字的本地端口（用于过滤本机广播）
+static std::map<std::string, std::vector<uint8_t>> host_nvs;  //!< 非易失存储（键→数据）
+
+// ============================================================================
+// 回调管理
+// ============================================================================
+void halHostSetHooks(const HalHostHooks* hooks) {
+    if (hooks) {
+        host_hooks = *hooks;
+    } else {
+        host_hooks = HalHostHooks{};
+    }
+}
+
+void halHostReset() {
+    host_now_us = 0;
+    host_hooks = HalHostHooks{};
+    memset(host_pwm_duty, 0, sizeof(host_pwm_duty));
+    memset(host_pwm_bits, 0, sizeof(host_pwm_bits));
+    memset(host_pin_level, 0, sizeof(host_pin_level));
+    memset(host_adc_raw, 0, sizeof(host_adc_raw));
+    host_serial_head = host_serial_tail = 0;
+    host_serial_tx_len = 0;
+    host_serial_capture = false;
+    host_serial_baud = 0;
+    host_can_rx.head = host_can_rx.tail = 0;
+    host_can_tx.head = host_can_tx.tail = 0;
+    host_can_bitrate = 0;
+    host_radio_rx.head = host_radio_rx.tail = 0;
+    host_radio_tx.head = host_radio_tx.tail = 0;
+    host_radio_channel = 0;
+    halHostRadioUdp(nullptr, 0);
+}
+
+// ============================================================================
+// 虚拟时钟
+// ============================================================================
+uint64_t halHostNowMicros() { return host_now_us; }
+
+void halHostSetMicros(uint64_t now_us) { host_now_us = now_us; }
+
+void halHostAdvanceMicros(uint32_t us) {
+    host_now_us += us;
+    if (host_hooks.on_time_advance) {
+        host_hooks.on_time_advance(host_hooks.ctx, host_now_us, us);
+    }
+}
+
+uint32_t halMicros() {
+    uint32_t t = host_hooks.micros_read ? host_hooks.micros_read(host_hooks.ctx) : (uint32_t)host_now_us;
+    TRACE_TAP(traceRecordMicros(t));
+    return t;
+}
+
+uint32_t halMillis() {
+    uint32_t t = host_hooks.millis_read ? host_hooks.millis_read(host_hooks.ctx) : (uint32_t)(host_now_us / 1000);
+    TRACE_TAP(traceRecordMillis(t));
+    return t;
+}
+
+void halDelayMs(uint32_t ms) { halHostAdvanceMicros(ms * 1000u); }
+void halDelayUs(uint32_t us) { halHostAdvanceMicros(us); }
+
+// ============================================================================
+// GPIO
+// ============================================================================
+void halPinOutput(int pin) { (void)pin; }
+void halPinInput(int pin) { (void)pin; }
+
+void halDigitalWrite(int pin, int level) {
+    if (pin >= 0 && pin < HAL_HOST_MAX_PINS) host_pin_level[pin] = level ? 1 : 0;
+    TRACE_TAP(traceRecordDigital(pin, level));
+    if (host_hooks.digital_write) host_hooks.digital_write(host_hooks.ctx, pin, level);
+}
+
+int halHostPinLevel(int pin) {
+    return (pin >= 0 && pin < HAL_HOST_MAX_PINS) ? host_pin_level[pin] : 0;
+}
+
+// ============================================================================
+// PWM
+// ============================================================================
+void halPwmSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) {
+    (void)freq;
+    if (channel < HAL_HOST_PWM_CHANNELS) host_pwm_bits[channel] = resolution_bits;
+}
+
+void halPwmAttach(int pin, uint8_t channel) {
+    (void)pin;
+    (void)channel;
+}
+
+void halPwmWrite(uint8_t channel, uint32_t duty) {
+    if (channel < HAL_HOST_PWM_CHANNELS) host_pwm_duty[channel] = duty;
+    TRACE_TAP(traceRecordPwm(channel, duty));
+    if (host_hooks.pwm_write) host_hooks.pwm_write(host_hooks.ctx, channel, duty);
+}
+
+uint32_t halHostPwmDuty(uint8_t channel) {
+    return channel < HAL_HOST_PWM_CHANNELS ? host_pwm_duty[channel] : 0;
+}
+
+uint8_t halHostPwmResolution(uint8_t channel) {
+    return channel < HAL_HOST_PWM_CHANNELS ? host_pwm_bits[channel] : 0;
+}
+
+// ============================================================================
+// ADC
+// ============================================================================
+uint16_t halAdcRead(int pin) {
+    uint16_t raw;
+    if (host_hooks.adc_read) {
+        raw = host_hooks.adc_read(host_hooks.ctx, pin);
+    } else {
+        raw = (pin >= 0 && pin < HAL_HOST_MAX_PINS) ? host_adc_raw[pin] : 0;
+    }
+    TRACE_TAP(traceRecordAdc(pin, raw));
+    return raw;
+}
+
+void halHostSetAdcRaw(int pin, uint16_t raw) {
+    if (pin >= 0 && pin < HAL_HOST_MAX_PINS) host_adc_raw[pin] = raw;
+}
+
+// ============================================================================
+// I2C
+// ============================================================================
+void halI2CBegin(uint8_t bus, int sda, int scl, uint32_t freq) {
+    (void)bus;
+    (void)sda;
+    (void)scl;
+    (void)freq;
+}
+
+int halI2CReadReg(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len) {
+    int received;
+    if (host_hooks.i2c_read_reg) {
+        received = host_hooks.i2c_read_reg(host_hooks.ctx, bus, addr, reg, buf, len);
+    } else {
+        // 无设备：与总线无应答时一致，数据全为0xFF
+        memset(buf, 0xFF, len);
+        received = 0;
+    }
+    TRACE_TAP(traceRecordI2C(bus, addr, reg, buf, len, received));
+    return received;
+}
+
+// ============================================================================
+// 串口
+// ============================================================================
+void halSerialBegin(uint32_t baud) { host_serial_baud = baud; }
+
+int halSerialAvailable() {
+    int n;
+    if (host_hooks.serial_available) {
+        n = host_hooks.serial_available(host_hooks.ctx);
+    } else {
+        n = (int)((host_serial_head - host_serial_tail + HAL_HOST_SERIAL_RX) % HAL_HOST_SERIAL_RX);
+    }
+    TRACE_TAP(traceRecordSerialAvailable(n));
+    return n;
+}
+
+int halSerialRead() {
+    int c;
+    if (host_hooks.serial_read) {
+        c = host_hooks.serial_read(host_hooks.ctx);
+    } else if (host_serial_head == host_serial_tail) {
+        c = -1;
+    } else {
+        c = host_serial_rx[host_serial_tail];
+        host_serial_tail = (host_serial_tail + 1) % HAL_HOST_SERIAL_RX;
+    }
+    TRACE_TAP(traceRecordSerialRead(c));
+    return c;
+}
+
+size_t halSerialWrite(const uint8_t* data, size_t len) {
+    if (host_hooks.serial_write) {
+        host_hooks.serial_write(host_hooks.ctx, data, len);
+    } else if (host_serial_capture) {
+        size_t n = len < HAL_HOST_SERIAL_TX - host_serial_tx_len ? len : HAL_HOST_SERIAL_TX - host_serial_tx_len;
+        memcpy(host_serial_tx + host_serial_tx_len, data, n);  // 缓冲满时丢弃剩余数据
+        host_serial_tx_len += n;
+    }
+    return len;
+}
+
+void halHostSerialCapture(bool enabled) {
+    host_serial_capture = enabled;
+    host_serial_tx_len = 0;
+}
+
+size_t halHostSerialTake(uint8_t* out, size_t max) {
+    size_t n = host_serial_tx_len < max ? host_serial_tx_len : max;
+    memcpy(out, host_serial_tx, n);
+    memmove(host_serial_tx, host_serial_tx + n, host_serial_tx_len - n);
+    host_serial_tx_len -= n;
+    return n;
+}
+
+uint32_t halHostSerialBaud() { return host_serial_baud; }
+
+void halHostSerialInject(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        size_t next = (host_serial_head + 1) % HAL_HOST_SERIAL_RX;
+        if (next == host_serial_tail) break;  // 缓冲满，丢弃剩余数据
+        host_serial_rx[host_serial_head] = data[i];
+        host_serial_head = next;
+    }
+}
+
+// ============================================================================
+// CAN总线（队列模拟：测试程序注入接收帧、取出发送帧）
+// ============================================================================
+static bool hostCanPush(HostCanQueue& q, uint32_t id, const uint8_t* data, uint8_t len) {
+    size_t next = (q.head + 1) % HAL_HOST_CAN_QUEUE;
+    if (next == q.tail) return false;
+    HostCanFrame& f = q.frames[q.head];
+    f.id = id;
+    f.len = len > 8 ? 8 : len;
+    memcpy(f.data, data, f.len);
+    q.head = next;
+    return true;
+}
+
+static bool hostCanPop(HostCanQueue& q, uint32_t* id, uint8_t* data, uint8_t* len) {
+    if (q.head == q.tail) return false;
+    const HostCanFrame& f = q.frames[q.tail];
+    *id = f.id;
+    *len = f.len;
+    memcpy(data, f.data, f.len);
+    q.tail = (q.tail + 1) % HAL_HOST_CAN_QUEUE;
+    return true;
+}
+
+bool halCanBegin(int tx_pin, int rx_pin, uint32_t bitrate) {
+    (void)tx_pin;
+    (void)rx_pin;
+    host_can_bitrate = bitrate;
+    return true;
+}
+
+bool halCanSend(uint32_t id, const uint8_t* data, uint8_t len) {
+    if (!host_can_bitrate) return false;
+    return hostCanPush(host_can_tx, id, data, len);
+}
+
+bool halCanReceive(uint32_t* id, uint8_t* data, uint8_t* len) {
+    if (!host_can_bitrate) return false;
+    return hostCanPop(host_can_rx, id, data, len);
+}
+
+bool halHostCanInject(uint32_t id, const uint8_t* data, uint8_t len) {
+    return hostCanPush(host_can_rx, id, data, len);
+}
+
+bool halHostCanTake(uint32_t* id, uint8_t* data, uint8_t* len) {
+    return hostCanPop(host_can_tx, id, data, len);
+}
+
+uint32_t halHostCanBitrate() { return host_can_bitrate; }
+
+// ============================================================================
+// 无线广播（队列模拟，或UDP组播替身：同一主机上的多个仿真进程加入同一组播组，
+// 一次发送全部收到，与ESP-NOW广播相同）
+// ============================================================================
+static bool hostRadioPush(HostRadioQueue& q, const uint8_t* data, size_t len) {
+    size_t next = (q.head + 1) % HAL_HOST_RADIO_QUEUE;
+    if (next == q.tail || len > HAL_RADIO_MAX) return false;
+    HostRadioFrame& f = q.frames[q.head];
+    f.len = len;
+    memcpy(f.data, data, len);
+    q.head = next;
+    return true;
+}
+
+static size_t hostRadioPop(HostRadioQueue& q, uint8_t* data, size_t max) {
+    if (q.head == q.tail) return 0;
+    const HostRadioFrame& f = q.frames[q.tail];
+    size_t n = f.len < max ? f.len : max;
+    memcpy(data, f.data, n);
+    q.tail = (q.tail + 1) % HAL_HOST_RADIO_QUEUE;
+    return n;
+}
+
+bool halRadioBegin(uint8_t channel) {
+    host_radio_channel = channel;
+    return true;
+}
+
+bool halRadioBroadcast(const uint8_t* data, size_t len) {
+    if (!host_radio_channel || len > HAL_RADIO_MAX) return false;
+    if (host_radio_tx_fd >= 0) {
+        return sendto(host_radio_tx_fd, data, len, 0, (const sockaddr*)&host_radio_group,
+                      sizeof(host_radio_group)) == (ssize_t)len;
+    }
+    return hostRadioPush(host_radio_tx, data, len);
+}
+
+size_t halRadioReceive(uint8_t* data, size_t max) {
+    if (!host_radio_channel) return 0;
+    if (host_radio_rx_fd < 0) return hostRadioPop(host_radio_rx, data, max);
+    for (;;) {
+        sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(host_radio_rx_fd, data, max, MSG_DONTWAIT, (sockaddr*)&from, &from_len);
+        if (n <= 0) return 0;
+        if (ntohs(from.sin_port) != host_radio_tx_port) return (size_t)n;  // 丢弃本机发出的广播
+    }
+}
+
+bool halHostRadioInject(const uint8_t* data, size_t len) { return hostRadioPush(host_radio_rx, data, len); }
+
+size_t halHostRadioTake(uint8_t* data, size_t max) { return hostRadioPop(host_radio_tx, data, max); }
+
+int halHostRadioChannel() { return host_radio_channel; }
+
+bool halHostRadioUdp(const char* group, uint16_t port) {
+    if (host_radio_rx_fd >= 0) close(host_radio_rx_fd);
+    if (host_radio_tx_fd >= 0) close(host_radio_tx_fd);
+    host_radio_rx_fd = host_radio_tx_fd = -1;
+    if (!group) return true;
+
+    host_radio_group = {};
+    host_radio_group.sin_family = AF_INET;
+    host_radio_group.sin_port = htons(port);
+    if (inet_pton(AF_INET, group, &host_radio_group.sin_addr) != 1) return false;
+
+    // 接收：多个进程共用同一端口，经回环接口加入组播组
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    int one = 1;
+    setsockopt(rx, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    ip_mreq mreq = {};
+    mreq.imr_multiaddr = host_radio_group.sin_addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    if (rx < 0 || bind(rx, (const sockaddr*)&local, sizeof(local)) < 0 ||
+        setsockopt(rx, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        if (rx >= 0) close(rx);
+        return false;
+    }
+
+    // 发送：组播经回环接口发出并回送到本机其他进程
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr loopback = {};
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_LOOP, &one, sizeof(one));
+    sockaddr_in any = {};
+    any.sin_family = AF_INET;
+    socklen_t any_len = sizeof(any);
+    if (tx < 0 || bind(tx, (const sockaddr*)&any, sizeof(any)) < 0 ||
+        getsockname(tx, (sockaddr*)&any, &any_len) < 0) {
+        close(rx);
+        if (tx >= 0) close(tx);
+        return false;
+    }
+    host_radio_rx_fd = rx;
+    host_radio_tx_fd = tx;
+    host_radio_tx_port = ntohs(any.sin_port);
+    return true;
+}
+
+// ============================================================================
+// 非易失存储
+// ============================================================================
+bool halNvsRead(const char* key, void* data, size_t len) {
+    auto it = host_nvs.find(key);
+    if (it == host_nvs.end() || it->second.size() != len) return false;
+    memcpy(data, it->second.data(), len);
+    return true;
+}
+
+bool halNvsWrite(const char* key, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    host_nvs[key].assign(p, p + len);
+    halHostAdvanceMicros(HAL_HOST_NVS_WRITE_US);  // 模拟提交期间调用方被阻塞
+    return true;
+}
+
+void halHostNvsClear() { host_nvs.clear(); }
+
+// ============================================================================
+// 调试输出
+// ============================================================================
+void halHostSetLogEnabled(bool enabled) { host_log_enabled = enabled; }
+
+void halPrintf(const char* fmt, ...) {
+    if (!host_log_enabled) return;
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+// ============================================================================
+// 内存（主机进程没有固定大小的堆）
+// ============================================================================
+void halHeapInfo(uint32_t* free_bytes, uint32_t* min_free_bytes) {
+    *free_bytes = 0;
+    *min_free_bytes = 0;
+}
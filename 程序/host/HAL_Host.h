@@ -0,0 +1,86 @@
+// ============================================================================
+// 文件：HAL_Host.h
+// 功能：硬件抽象层主机后端的控制接口
+// 说明：主机构建中，时间是虚拟时钟，PWM/ADC/I2C/串口都由仿真器或测试程序
+//       通过回调接管。控制代码本身仍只使用HAL.h中的接口。
+// ============================================================================
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "../HAL.h"
+
+// ============================================================================
+// 数据结构定义：HalHostHooks
+// 功能：主机后端的外设回调集合
+// 说明：未设置的回调使用默认行为（ADC返回设定值，I2C读失败，PWM仅记录）
+// ============================================================================
+struct HalHostHooks {
+    void* ctx;  //!< 回调上下文指针，原样传给各回调
+
+    //!< 虚拟时钟前进时调用（now_us为前进后的时间，elapsed_us为前进量）
+    void (*on_time_advance)(void* ctx, uint64_t now_us, uint32_t elapsed_us);
+
+    //!< ADC读取
+    uint16_t (*adc_read)(void* ctx, int pin);
+
+    //!< I2C寄存器读取，返回实际字节数
+    int (*i2c_read_reg)(void* ctx, uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len);
+
+    //!< PWM占空比写入
+    void (*pwm_write)(void* ctx, uint8_t channel, uint32_t duty);
+
+    //!< 数字输出
+    void (*digital_write)(void* ctx, int pin, int level);
+
+    //!< 串口发送
+    void (*serial_write)(void* ctx, const uint8_t* data, size_t len);
+
+    //!< 时钟/串口接收覆盖（trace重放时由记录提供，未设置时使用虚拟时钟和接收缓冲）
+    uint32_t (*micros_read)(void* ctx);
+    uint32_t (*millis_read)(void* ctx);
+    int (*serial_available)(void* ctx);
+    int (*serial_read)(void* ctx);
+};
+
+// ============================================================================
+// 回调管理
+// ============================================================================
+void halHostSetHooks(const HalHostHooks* hooks);  //!< 安装回调（nullptr恢复默认）
+void halHostReset();                              //!< 复位时钟、外设状态和回调
+
+// ============================================================================
+// 虚拟时钟
+// ============================================================================
+uint64_t halHostNowMicros();                //!< 64位虚拟时间（微秒）
+void halHostSetMicros(uint64_t now_us);     //!< 直接设置虚拟时间（不触发回调）
+void halHostAdvanceMicros(uint32_t us);     //!< 推进虚拟时间并触发on_time_advance
+
+// ============================================================================
+// 外设状态查询/注入
+// ============================================================================
+uint32_t halHostPwmDuty(uint8_t channel);        //!< 最近一次写入的占空比计数值
+uint8_t halHostPwmResolution(uint8_t channel);   //!< 通道分辨率（位）
+int halHostPinLevel(int pin);                    //!< 引脚当前输出电平
+void halHostSetAdcRaw(int pin, uint16_t raw);    //!< 设定ADC默认返回值（无adc_read回调时使用）
+void halHostSerialInject(const uint8_t* data, size_t len);  //!< 向串口接收缓冲注入数据
+void halHostSerialCapture(bool enabled);                     //!< 开关串口发送捕获（无serial_write回调时使用）
+size_t halHostSerialTake(uint8_t* out, size_t max);          //!< 取出已捕获的发送数据，返回字节数
+uint32_t halHostSerialBaud();                                //!< halSerialBegin设定的波特率
+bool halHostCanInject(uint32_t id, const uint8_t* data, uint8_t len);  //!< 向CAN接收队列注入一帧（队列满返回false）
+bool halHostCanTake(uint32_t* id, uint8_t* data, uint8_t* len);        //!< 取出一帧已发送的CAN帧（无帧返回false）
+uint32_t halHostCanBitrate();                                          //!< halCanBegin设定的波特率（0为未初始化）
+bool halHostRadioInject(const uint8_t* data, size_t len);   //!< 向无线接收队列注入一帧（队列满返回false）
+size_t halHostRadioTake(uint8_t* data, size_t max);         //!< 取出一帧已广播的无线帧，返回字节数（无帧返回0）
+int halHostRadioChannel();                                  //!< halRadioBegin设定的信道（0为未初始化）
+// 无线广播改用UDP组播替身（group为组播地址如"239.255.70.67"，nullptr恢复队列），失败返回false；
+// 收发都经回环接口，同一主机上加入同一组播组的进程互相收到广播
+bool halHostRadioUdp(const char* group, uint16_t port);
+// 非易失存储：halHostReset不清除（模拟断电重启后保留），halHostNvsClear模拟擦除整个分区
+void halHostNvsClear();
+
+// ============================================================================
+// 调试输出
+// ============================================================================
+void halHostSetLogEnabled(bool enabled);    //!< 开关halPrintf输出（基准测试/模糊测试时关闭）
+
+#endif // HAL_HOST_H
@@ -0,0 +1,219 @@
+// ============================================================================
+// 文件：PlantSim.cpp
+// 功能：主机端被控对象仿真器实现
+// 说明：αβ坐标系下的PMSM电气模型 + 双惯量（电机/输出端）机械模型，
+//       减速器按带回差的弹簧-阻尼耦合处理，显式欧拉法固定子步长积分
+// ============================================================================
+#include "PlantSim.h"
+
+#define _SQRT3   1.73205080757f
+#define _2PI_SIM 6.28318530718f
+
+// ============================================================================
+// 构造函数：PlantSim
+// ============================================================================
+PlantSim::PlantSim(const PlantParams& p)
+    : params(p)
+    , rng(p.seed)
+{
+}
+
+// ============================================================================
+// 函数：attach / detach
+// 功能：安装/移除HAL主机后端回调
+// ============================================================================
+void PlantSim::attach() {
+    HalHostHooks hooks = {};
+    hooks.ctx = this;
+    hooks.on_time_advance = &PlantSim::onTimeAdvance;
+    hooks.adc_read = &PlantSim::onAdcRead;
+    hooks.i2c_read_reg = &PlantSim::onI2CReadReg;
+    halHostSetHooks(&hooks);
+}
+
+void PlantSim::detach() {
+    halHostSetHooks(nullptr);
+}
+
+// ============================================================================
+// 函数：reset
+// 功能：状态复位
+// ============================================================================
+void PlantSim::reset() {
+    i_alpha = i_beta = 0;
+    theta_m = omega_m = 0;
+    theta_o = omega_o = 0;
+    load_torque = 0;
+    v_dc = params.v_bus;
+    sensor_fault = false;
+    pending_us = 0;
+    rng.seed(params.seed);
+    noise.reset();
+}
+
+// ============================================================================
+// 函数：advance
+// 功能：按固定子步长推进仿真，不足一个子步长的时间留到下次
+// ============================================================================
+void PlantSim::advance(uint32_t dt_us) {
+    pending_us += dt_us;
+    const float dt = params.substep_us * 1e-6f;
+    while (pending_us >= params.substep_us) {
+        integrate(dt);
+        pending_us -= params.substep_us;
+    }
+}
+
+// ============================================================================
+// 函数：integrate
+// 功能：单个子步长的机电模型积分
+// ============================================================================
+void PlantSim::integrate(float dt) {
+    const PlantParams& p = params;
+    float theta_e = p.pole_pairs * theta_m;
+    float omega_e = p.pole_pairs * omega_m;
+    float st = sinf(theta_e);
+    float ct = cosf(theta_e);
+
+    // ------------------------------------------------------------------------
+    // 逆变器：占空比 → 相电压 → αβ电压（中性点悬空，去除共模分量）
+    // ------------------------------------------------------------------------
+    bool enabled = halHostPinLevel(p.enable_pin) != 0;
+    if (enabled) {
+        // 直流侧电流 = Σ 占空比 × 相电流（上一子步长的电流），内阻上产生压降
+        float duty[3];
+        float i_dc = 0;
+        for (int ch = 0; ch < 3; ch++) {
+            uint8_t bits = halHostPwmResolution(ch);
+            duty[ch] = bits ? (float)halHostPwmDuty(ch) / (float)(1u << bits) : 0.0f;
+            i_dc += duty[ch] * phaseCurrent(ch);
+        }
+        v_dc = p.v_bus - p.bus_resistance * i_dc;
+
+        float v[3];
+        for (int ch = 0; ch < 3; ch++) v[ch] = duty[ch] * v_dc;
+        float v_alpha = (2.0f * v[0] - v[1] - v[2]) / 3.0f;
+        float v_beta = (v[1] - v[2]) / _SQRT3;
+
+        // 反电动势（αβ坐标系）
+        float e_alpha = -omega_e * p.flux_linkage * st;
+        float e_beta = omega_e * p.flux_linkage * ct;
+
+        // 电压方程：L di/dt = v - R i - e
+        i_alpha += dt * (v_alpha - p.R * i_alpha - e_alpha) / p.L;
+        i_beta += dt * (v_beta - p.R * i_beta - e_beta) / p.L;
+    } else {
+        // 驱动器关闭：三相悬空，电流经续流二极管迅速衰减为零
+        v_dc = p.v_bus;
+        i_alpha = 0;
+        i_beta = 0;
+    }
+
+    // ------------------------------------------------------------------------
+    // 电磁转矩：Te = 1.5·pp·λ·iq
+    // ------------------------------------------------------------------------
+    float tau_e = electromagneticTorque();
+
+    // ------------------------------------------------------------------------
+    // 减速器耦合：带回差的弹簧-阻尼（输出端坐标）
+    // ------------------------------------------------------------------------
+    float delta = theta_m / p.gear_ratio - theta_o;
+    float d_delta = omega_m / p.gear_ratio - omega_o;
+    float half_gap = 0.5f * p.backlash;
+    float tau_c = 0;
+    if (delta > half_gap) {
+        tau_c = p.gear_stiffness * (delta - half_gap) + p.gear_damping * d_delta;
+        if (tau_c < 0) tau_c = 0;  // 齿面只能推不能拉
+    } else if (delta < -half_gap) {
+        tau_c = p.gear_stiffness * (delta + half_gap) + p.gear_damping * d_delta;
+        if (tau_c > 0) tau_c = 0;
+    }
+
+    // ------------------------------------------------------------------------
+    // 机械方程（库仑摩擦用tanh平滑，避免零速抖振）
+    // ------------------------------------------------------------------------
+    float tau_f_m = p.b_motor * omega_m + p.coulomb_motor * tanhf(omega_m / 0.01f);
+    float tau_f_o = p.b_output * omega_o + p.coulomb_output * tanhf(omega_o / 0.001f);
+
+    omega_m += dt * (tau_e - tau_f_m - tau_c / p.gear_ratio) / p.J_motor;
+    omega_o += dt * (tau_c - tau_f_o - load_torque) / p.J_output;
+    theta_m += dt * omega_m;
+    theta_o += dt * omega_o;
+}
+
+// ============================================================================
+// 状态查询
+// ============================================================================
+float PlantSim::currentQ() const {
+    float theta_e = params.pole_pairs * theta_m;
+    return i_beta * cosf(theta_e) - i_alpha * sinf(theta_e);
+}
+
+float PlantSim::electromagneticTorque() const {
+    return 1.5f * params.pole_pairs * params.flux_linkage * currentQ();
+}
+
+float PlantSim::phaseCurrent(int phase) const {
+    switch (phase) {
+        case 0: return i_alpha;
+        case 1: return 0.5f * (-i_alpha + _SQRT3 * i_beta);
+        default: return 0.5f * (-i_alpha - _SQRT3 * i_beta);
+    }
+}
+
+uint16_t PlantSim::sensorRaw() const {
+    float a = fmodf(params.sensor_direction * theta_m + params.sensor_offset, _2PI_SIM);
+    if (a < 0) a += _2PI_SIM;
+    return (uint16_t)((uint32_t)(a / _2PI_SIM * 4096.0f) & 0x0FFF);
+}
+
+// ============================================================================
+// HAL回调
+// ============================================================================
+void PlantSim::onTimeAdvance(void* ctx, uint64_t now_us, uint32_t elapsed_us) {
+    (void)now_us;
+    static_cast<PlantSim*>(ctx)->advance(elapsed_us);
+}
+
+uint16_t PlantSim::onAdcRead(void* ctx, int pin) {
+    PlantSim* self = static_cast<PlantSim*>(ctx);
+    const PlantParams& p = self->params;
+
+    float volts;
+    if (pin == p.adc_pin_a) {
+        volts = p.adc_offset_a + self->phaseCurrent(0) * p.shunt_resistor * p.amp_gain;
+    } else if (pin == p.adc_pin_b) {
+        volts = p.adc_offset_b + self->phaseCurrent(1) * p.shunt_resistor * p.amp_gain;
+    } else if (pin == p.vbus_adc_pin) {
+        volts = self->v_dc / p.vbus_divider;
+    } else {
+        return 0;
+    }
+
+    float counts = volts / 3.3f * 4095.0f + p.adc_noise * self->noise(self->rng);
+    int raw = (int)lroundf(counts);
+    if (raw < 0) raw = 0;
+    if (raw > 4095) raw = 4095;
+
+    // 采样完成后计入转换耗时
+    halHostAdvanceMicros(p.adc_latency_us);
+    return (uint16_t)raw;
+}
+
+int PlantSim::onI2CReadReg(void* ctx, uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len) {
+    (void)bus;
+    PlantSim* self = static_cast<PlantSim*>(ctx);
+
+    // 仅仿真AS5600角度寄存器（0x36 / 0x0C）；注入故障时无应答
+    if (addr != 0x36 || reg != 0x0C || len != 2 || self->sensor_fault) {
+        memset(buf, 0xFF, len);
+        return 0;
+    }
+
+    // 先锁存角度，再计入I2C传输耗时
+    uint16_t raw = self->sensorRaw();
+    buf[0] = (uint8_t)(raw >> 8);
+    buf[1] = (uint8_t)(raw & 0xFF);
+    halHostAdvanceMicros(self->params.i2c_latency_us);
+    return len;
+}
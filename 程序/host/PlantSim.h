@@ -0,0 +1,127 @@
+// ============================================================================
+// 文件：PlantSim.h
+// 功能：主机端被控对象仿真器（PMSM + 逆变器 + 摆线减速器 + 传感器）
+// 说明：通过HAL主机后端的回调接入控制代码：
+//       - PWM占空比 → 三相逆变器 → 电机αβ电压
+//       - 虚拟时钟推进 → 机电模型积分（固定子步长）
+//       - I2C读取 → 仿真AS5600（12位量化、通信延时）
+//       - ADC读取 → 仿真电流采样（零偏、噪声、饱和）
+// ============================================================================
+#ifndef PLANT_SIM_H
+#define PLANT_SIM_H
+
+#include "HAL_Host.h"
+#include <random>
+
+// ============================================================================
+// 数据结构定义：PlantParams
+// 功能：仿真模型参数（默认值对应7对极云台电机 + 225:1双摆线减速器）
+// ============================================================================
+struct PlantParams {
+    // 电机电气参数
+    int   pole_pairs = 7;          //!< 极对数
+    float R = 2.0f;                //!< 相电阻（欧姆）
+    float L = 1.0e-3f;             //!< 相电感（亨）
+    float flux_linkage = 0.01f;    //!< 永磁磁链（V·s/rad），Kt = 1.5·pp·λ
+    float v_bus = 15.6f;           //!< 电源空载电压（伏特）
+    float bus_resistance = 0.0f;   //!< 电源内阻+线阻（欧姆），母线电压随负载电流跌落
+
+    // 电机机械参数（电机侧）
+    float J_motor = 2.0e-5f;       //!< 转子惯量（kg·m²）
+    float b_motor = 2.0e-5f;       //!< 粘滞摩擦（N·m·s/rad）
+    float coulomb_motor = 2.0e-3f; //!< 库仑摩擦（N·m）
+
+    // 减速器与输出端
+    float gear_ratio = 225.0f;     //!< 减速比
+    float backlash = 0.0017f;      //!< 输出端回差（弧度，约0.1°）
+    float gear_stiffness = 2000.0f; //!< 减速器扭转刚度（输出端，N·m/rad）
+    float gear_damping = 5.0f;     //!< 减速器扭转阻尼（输出端，N·m·s/rad）
+    float J_output = 0.05f;        //!< 输出端负载惯量（kg·m²）
+    float b_output = 0.05f;        //!< 输出端粘滞摩擦（N·m·s/rad）
+    float coulomb_output = 0.2f;   //!< 输出端库仑摩擦（N·m）
+
+    // AS5600仿真
+    int   sensor_direction = -1;   //!< 传感器方向（与Pos_Current_Velocity.ino中Sensor_DIR一致）
+    float sensor_offset = 1.0f;    //!< 磁铁安装偏移（弧度）
+    uint32_t i2c_latency_us = 100; //!< 一次角度读取的I2C耗时（400kHz约100us）
+
+    // 电流采样仿真
+    int   adc_pin_a = 39;          //!< A相电流ADC引脚
+    int   adc_pin_b = 36;          //!< B相电流ADC引脚
+    float shunt_resistor = 0.01f;  //!< 分流电阻（欧姆）
+    float amp_gain = 50.0f;        //!< 放大器增益
+    float adc_offset_a = 1.65f;    //!< A相零点电压（伏特）
+    float adc_offset_b = 1.66f;    //!< B相零点电压（伏特）
+    float adc_noise = 2.0f;        //!< ADC噪声标准差（计数值）
+    uint32_t adc_latency_us = 10;  //!< 一次ADC转换耗时
+
+    // 母线电压采样（与host/CMakeLists.txt中的VBUS_ADC_PIN/VBUS_DIVIDER一致）
+    int   vbus_adc_pin = 34;       //!< 母线电压ADC引脚
+    float vbus_divider = 11.0f;    //!< 分压比
+
+    // 逆变器
+    int   enable_pin = 12;         //!< 驱动器使能引脚（低电平时三相悬空）
+
+    // 积分
+    uint32_t substep_us = 10;      //!< 积分子步长（微秒）
+    uint32_t seed = 1;             //!< 噪声随机数种子
+};
+
+// ============================================================================
+// 类定义：PlantSim
+// 功能：机电仿真模型，安装到HAL主机后端后由虚拟时钟驱动
+// ============================================================================
+class PlantSim
+{
+  public:
+    explicit PlantSim(const PlantParams& params = PlantParams());
+
+    void attach();                    //!< 安装HAL回调（接管时钟/PWM/ADC/I2C）
+    void detach();                    //!< 移除HAL回调
+    void reset();                     //!< 状态复位（静止、零电流）
+
+    void advance(uint32_t dt_us);     //!< 按子步长积分dt_us
+
+    // 外部负载
+    void setLoadTorque(float tau) { load_torque = tau; }
+
+    // 故障注入：编码器I2C无应答（读取返回0字节）
+    void setSensorFault(bool fail) { sensor_fault = fail; }
+
+    // 状态查询
+    float motorAngle() const { return theta_m; }         //!< 电机轴机械角度（弧度）
+    float motorVelocity() const { return omega_m; }      //!< 电机轴角速度（弧度/秒）
+    float outputAngle() const { return theta_o; }        //!< 输出端角度（弧度）
+    float outputVelocity() const { return omega_o; }     //!< 输出端角速度（弧度/秒）
+    float currentAlpha() const { return i_alpha; }       //!< α轴电流（安培）
+    float currentBeta() const { return i_beta; }         //!< β轴电流（安培）
+    float currentQ() const;                              //!< 真实q轴电流（安培）
+    float electromagneticTorque() const;                 //!< 电磁转矩（N·m）
+    float phaseCurrent(int phase) const;                 //!< 相电流（0=A,1=B,2=C）
+    float busVoltage() const { return v_dc; }            //!< 逆变器直流侧电压（伏特）
+    uint16_t sensorRaw() const;                          //!< AS5600当前计数值（0-4095）
+
+    PlantParams params;
+
+  private:
+    static void onTimeAdvance(void* ctx, uint64_t now_us, uint32_t elapsed_us);
+    static uint16_t onAdcRead(void* ctx, int pin);
+    static int onI2CReadReg(void* ctx, uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len);
+
+    void integrate(float dt);
+
+    // 电气状态
+    float i_alpha = 0, i_beta = 0;
+    // 机械状态
+    float theta_m = 0, omega_m = 0;   // 电机侧
+    float theta_o = 0, omega_o = 0;   // 输出侧
+    float load_torque = 0;
+    float v_dc = 0;                   // 直流侧电压（计入内阻压降）
+    bool sensor_fault = false;
+
+    uint32_t pending_us = 0;          // 未满一个子步长的剩余时间
+    std::mt19937 rng;
+    std::normal_distribution<float> noise{0.0f, 1.0f};
+};
+
+#endif // PLANT_SIM_H
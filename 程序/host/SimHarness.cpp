@@ -0,0 +1,89 @@
+// ============================================================================
+// 文件：SimHarness.cpp
+// 功能：主机仿真公共流程实现
+// ============================================================================
+#include "SimHarness.h"
+
+#include <chrono>
+
+void simBoot(PlantSim& plant, bool log_enabled) {
+    halHostReset();
+    plant.reset();
+    plant.attach();
+    halHostSetLogEnabled(log_enabled);
+
+    // 上电初始化（含零电角度校准和电流零点校准）
+    setup();
+    deviceConnected = true;
+    traceRecordConnection(true);
+}
+
+uint64_t simControlStep(float target_motor_rad) {
+    configureControlLoops();
+
+    auto t0 = std::chrono::steady_clock::now();
+    runFOC();
+    setMotorVelocityWithAngle(target_motor_rad);
+    auto t1 = std::chrono::steady_clock::now();
+
+    halHostAdvanceMicros(SIM_LOOP_OVERHEAD_US);
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+float simOutputDegToMotorRad(float out_deg) {
+    return out_deg * GEAR_RATIO * (PI / 180.0f);
+}
+
+float simMotorRadToOutputDeg(float motor_rad) {
+    return motor_rad / GEAR_RATIO * (180.0f / PI);
+}
+
+// ============================================================================
+// 数值缩放：与ble_client.py一致，所有数据类型都按×10.0打包
+// ============================================================================
+static void simPushInt16(std::string& pkt, float value, float scale) {
+    int16_t v = floatToInt16(value, scale);
+    pkt.push_back((char)((uint16_t)v >> 8));
+    pkt.push_back((char)(v & 0xFF));
+}
+
+std::string simMakeSinglePacket(uint8_t device_id, uint8_t data_type, float value) {
+    std::string pkt = {(char)0xAA, (char)0x55, (char)PACKET_TYPE_SINGLE, (char)data_type, (char)device_id};
+    simPushInt16(pkt, value, ANGLE_SCALE);
+    return pkt;
+}
+
+std::string simMakeMultiSlicePacket(uint8_t start_id, const float* values, uint8_t count, uint8_t data_type) {
+    std::string pkt = {(char)0xAA, (char)0x55, (char)PACKET_TYPE_MULTI, (char)data_type, (char)start_id, (char)count};
+    for (uint8_t i = 0; i < count; i++) simPushInt16(pkt, values[i], ANGLE_SCALE);
+    return pkt;
+}
+
+std::string simMakeMultiStructPacket(const uint8_t* ids, const float* values, uint8_t count, uint8_t data_type) {
+    std::string pkt = {(char)0xAA, (char)0x55, (char)PACKET_TYPE_MULTI_STRUCT, (char)data_type, (char)count};
+    for (uint8_t i = 0; i < count; i++) {
+        pkt.push_back((char)ids[i]);
+        simPushInt16(pkt, values[i], ANGLE_SCALE);
+    }
+    return pkt;
+}
+
+std::string simMakeSequencedPacket(uint16_t seq, const std::string& packet) {
+    std::string pkt = {(char)BLE_SEQ_PREFIX, (char)(seq >> 8), (char)(seq & 0xFF)};
+    return pkt + packet;
+}
+
+std::string simMakeMultiSlotPacket(uint8_t epoch, uint8_t start_slot, const float* values, uint8_t count,
+                                   uint8_t data_type) {
+    std::string pkt = {(char)0xAA, (char)0x55, (char)PACKET_TYPE_MULTI_SLOT, (char)data_type, (char)epoch,
+                       (char)start_slot, (char)count};
+    for (uint8_t i = 0; i < count; i++) simPushInt16(pkt, values[i], ANGLE_SCALE);
+    return pkt;
+}
+
+std::string simMakeConfigPacket(uint8_t op, uint8_t device_id, int arg0, int arg1) {
+    std::string pkt = {(char)0xAA, (char)0x55, (char)PACKET_TYPE_CONFIG, (char)op, (char)device_id};
+    if (arg0 >= 0) pkt.push_back((char)arg0);
+    if (arg1 >= 0) pkt.push_back((char)arg1);
+    return pkt;
+}
@@ -0,0 +1,55 @@
+// ============================================================================
+// 文件：SimHarness.h
+// 功能：主机仿真公共流程（上电、控制周期、目标单位换算、BLE包构造）
+// 说明：foc_sim / foc_bench等主机程序共用，保证与Pos_Current_Velocity.ino
+//       的初始化和控制顺序一致
+// ============================================================================
+#ifndef SIM_HARNESS_H
+#define SIM_HARNESS_H
+
+#include "PlantSim.h"
+#include "FOC.h"
+
+#include <string>
+
+// Pos_Current_Velocity.ino 中定义
+void setup();
+void loop();
+void configureControlLoops();
+
+#define SIM_LOOP_OVERHEAD_US 150  //!< 每次loop()的计算耗时估计（不含I2C/ADC）
+
+// ============================================================================
+// 函数：simBoot
+// 功能：复位HAL主机后端，安装被控对象并执行.ino的setup()
+// 说明：结束后BLE视为已连接（响应经ble_response_hook输出）
+// ============================================================================
+void simBoot(PlantSim& plant, bool log_enabled = false);
+
+// ============================================================================
+// 函数：simControlStep
+// 功能：执行一个控制周期（runFOC → 参数配置 → 三环控制），并计入计算耗时
+// 参数：target_motor_rad - 电机轴目标角度（弧度）
+// 返回值：runFOC + setMotorVelocityWithAngle 的墙钟耗时（纳秒）
+// ============================================================================
+uint64_t simControlStep(float target_motor_rad);
+
+// ============================================================================
+// 单位换算：输出端角度（度）↔ 电机轴角度（弧度），与getSerialMotorTarget()一致
+// ============================================================================
+float simOutputDegToMotorRad(float out_deg);
+float simMotorRadToOutputDeg(float motor_rad);
+
+// ============================================================================
+// BLE包构造（与ble_client.py中的打包函数格式一致）
+// ============================================================================
+std::string simMakeSinglePacket(uint8_t device_id, uint8_t data_type, float value);
+std::string simMakeMultiSlicePacket(uint8_t start_id, const float* values, uint8_t count, uint8_t data_type);
+std::string simMakeMultiStructPacket(const uint8_t* ids, const float* values, uint8_t count, uint8_t data_type);
+std::string simMakeSequencedPacket(uint16_t seq, const std::string& packet);  //!< 加序号前缀（BLE_SEQ_PREFIX）
+std::string simMakeMultiSlotPacket(uint8_t epoch, uint8_t start_slot, const float* values, uint8_t count,
+                                   uint8_t data_type);
+// 配置包AA 55 04 OP ID 参数..（参数为负时不附加）
+std::string simMakeConfigPacket(uint8_t op, uint8_t device_id, int arg0 = -1, int arg1 = -1);
+
+#endif // SIM_HARNESS_H
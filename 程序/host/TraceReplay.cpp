@@ -0,0 +1,336 @@
+// ============================================================================
+// 文件：TraceReplay.cpp
+// 功能：现场捕获重放器实现
+// ============================================================================
+#include "TraceReplay.h"
+#include "SimHarness.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+// ============================================================================
+// 函数：traceLoadFile
+// ============================================================================
+bool traceLoadFile(const char* path, std::vector<uint8_t>& out, std::string* err) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        if (err) *err = std::string("无法打开 ") + path;
+        return false;
+    }
+    std::string raw((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    out.clear();
+    if (raw.compare(0, 4, TRACE_MAGIC) == 0) {
+        out.assign(raw.begin(), raw.end());
+        return true;
+    }
+
+    // 串口日志：取最后一段 TRACE BEGIN ... TRACE END 之间的十六进制行
+    size_t begin = raw.rfind("TRACE BEGIN");
+    if (begin == std::string::npos) {
+        if (err) *err = "既不是二进制捕获文件，也没有找到TRACE BEGIN";
+        return false;
+    }
+    std::istringstream lines(raw.substr(begin));
+    std::string line;
+    std::getline(lines, line);  // TRACE BEGIN行
+    bool ended = false;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 9, "TRACE END") == 0) {
+            ended = true;
+            break;
+        }
+        for (size_t i = 0; i + 1 < line.size(); i += 2) {
+            if (!isxdigit((unsigned char)line[i]) || !isxdigit((unsigned char)line[i + 1])) break;
+            out.push_back((uint8_t)strtoul(line.substr(i, 2).c_str(), nullptr, 16));
+        }
+    }
+    if (!ended) {
+        if (err) *err = "十六进制捕获缺少TRACE END（日志不完整）";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// 函数：load
+// ============================================================================
+bool TracePlayer::load(const std::vector<uint8_t>& bytes, std::string* err) {
+    if (bytes.size() < TRACE_HEADER_SIZE || memcmp(bytes.data(), TRACE_MAGIC, 4) != 0) {
+        if (err) *err = "文件头无效";
+        return false;
+    }
+    if (bytes[4] != TRACE_VERSION) {
+        if (err) *err = "不支持的捕获格式版本 " + std::to_string(bytes[4]);
+        return false;
+    }
+    data = bytes;
+    flags = bytes[5];
+    device_id = bytes[6];
+    start_micros = 0;
+    for (int i = 0; i < 4; i++) start_micros |= (uint32_t)bytes[8 + i] << (8 * i);
+    pos = TRACE_HEADER_SIZE;
+    cur_micros = start_micros;
+    return true;
+}
+
+// ============================================================================
+// 记录读取
+// ============================================================================
+void TracePlayer::fail(const char* reason) {
+    if (!st.desync) {
+        st.desync = true;
+        st.desync_offset = pos;
+        st.desync_reason = reason;
+    }
+    done = true;
+}
+
+bool TracePlayer::readVarint(uint32_t* v) {
+    size_t n = traceGetVarint(data.data() + pos, data.size() - pos, v);
+    if (n == 0) {
+        fail("记录被截断");
+        return false;
+    }
+    pos += n;
+    return true;
+}
+
+bool TracePlayer::readSmall(uint32_t* v) {
+    uint32_t arg = data[pos] >> 4;
+    pos++;
+    if (arg < TRACE_SMALL_MAX) {
+        *v = arg;
+        return true;
+    }
+    if (!readVarint(v)) return false;
+    *v += TRACE_SMALL_MAX;
+    return true;
+}
+
+// ============================================================================
+// 函数：drainEvents
+// 功能：执行紧跟在当前位置的通信事件（BLE帧、连接状态）
+// 说明：事件在前一条HAL记录消耗后立即生效，与记录时"发生在两次HAL调用之间"一致；
+//       若延迟到下一次HAL调用，之间对deviceConnected等状态的判断会与设备不同。
+//       setup()中不执行：捕获中的事件都发生在启动完成之后，若在setup()的最后一次读取后执行，
+//       其后的initBLEServer()等初始化会冲掉配置帧的效果
+// ============================================================================
+void TracePlayer::drainEvents() {
+    if (done || in_frame || booting) return;
+
+    while (pos < data.size()) {
+        uint8_t t = data[pos] & 0x0F;
+        if (t == TRACE_TAG_FRAME) {
+            size_t rec = pos;
+            uint8_t source = data[pos] >> 4;  // 来源传输（旧捕获为0，即BLE）
+            pos++;
+            uint32_t len;
+            if (!readVarint(&len)) return;
+            if (pos + len > data.size()) {
+                pos = rec;
+                fail("帧数据被截断");
+                return;
+            }
+            const uint8_t* frame = data.data() + pos;
+            pos += len;
+            st.records++;
+            st.frames++;
+            in_frame = true;
+            cmdDispatch(source, frame, len);
+            in_frame = false;
+        } else if (t == TRACE_TAG_CONNECT) {
+            deviceConnected = (data[pos] >> 4) != 0;
+            pos++;
+            st.records++;
+        } else {
+            break;
+        }
+    }
+    if (pos >= data.size()) {
+        st.complete = true;
+        done = true;
+    }
+}
+
+// ============================================================================
+// 函数：fetch
+// 功能：定位到指定类型的记录
+// 返回值：pos指向该记录首字节时返回true；记录耗尽或类型不符时返回false
+// ============================================================================
+bool TracePlayer::fetch(uint8_t tag) {
+    if (done || in_frame) return false;
+    if ((data[pos] & 0x0F) != tag) {
+        fail("HAL调用顺序与记录不一致");
+        return false;
+    }
+    st.records++;
+    return true;
+}
+
+// ============================================================================
+// 输出核对
+// ============================================================================
+void TracePlayer::hashOutput(uint32_t a, uint32_t b) {
+    uint32_t words[2] = {a, b};
+    const uint8_t* p = (const uint8_t*)words;
+    for (size_t i = 0; i < sizeof(words); i++) {
+        st.output_hash ^= p[i];
+        st.output_hash *= 1099511628211ull;
+    }
+}
+
+void TracePlayer::checkOutput(uint8_t tag, uint32_t a, uint32_t b) {
+    hashOutput(((uint32_t)tag << 16) | a, b);
+    if (!hasOutputs() || !fetch(tag)) return;
+
+    size_t rec = pos;
+    uint32_t ra = data[pos] >> 4;
+    uint32_t rb;
+    pos++;
+    if (tag == TRACE_TAG_PWM) {
+        if (!readVarint(&rb)) return;
+    } else {
+        if (pos >= data.size()) {
+            fail("记录被截断");
+            return;
+        }
+        // 数字输出：参数为电平，后跟引脚号
+        rb = ra;
+        ra = data[pos++];
+    }
+    st.outputs_checked++;
+    if (ra != a || rb != b) {
+        if (st.output_mismatches == 0) st.first_mismatch_offset = rec;
+        st.output_mismatches++;
+    }
+    drainEvents();
+}
+
+// ============================================================================
+// HAL回调
+// ============================================================================
+uint32_t TracePlayer::onMicros(void* ctx) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    uint32_t d;
+    if (self->fetch(TRACE_TAG_MICROS) && self->readSmall(&d)) {
+        self->cur_micros += d;
+        self->drainEvents();
+    }
+    return self->cur_micros;
+}
+
+uint32_t TracePlayer::onMillis(void* ctx) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    uint32_t d;
+    if (self->fetch(TRACE_TAG_MILLIS) && self->readSmall(&d)) {
+        self->cur_millis += d;
+        self->drainEvents();
+    }
+    return self->cur_millis;
+}
+
+int TracePlayer::onSerialAvailable(void* ctx) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    uint32_t n;
+    if (!self->fetch(TRACE_TAG_SERIAL_AVAIL) || !self->readSmall(&n)) return 0;
+    self->drainEvents();
+    return (int)n;
+}
+
+int TracePlayer::onSerialRead(void* ctx) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    uint32_t v;
+    if (!self->fetch(TRACE_TAG_SERIAL_READ)) return -1;
+    self->pos++;
+    if (!self->readVarint(&v)) return -1;
+    self->drainEvents();
+    return (int)v - 1;
+}
+
+uint16_t TracePlayer::onAdcRead(void* ctx, int pin) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    uint16_t& cur = self->cur_adc[pin & 63];
+    if (!self->fetch(TRACE_TAG_ADC)) return cur;
+    if (self->pos + 1 >= self->data.size() || self->data[self->pos + 1] != (uint8_t)pin) {
+        self->fail("ADC引脚与记录不一致");
+        return cur;
+    }
+    self->pos += 2;
+    uint32_t z;
+    if (self->readVarint(&z)) {
+        cur = (uint16_t)(cur + traceUnzigzag(z));
+        self->drainEvents();
+    }
+    return cur;
+}
+
+int TracePlayer::onI2CReadReg(void* ctx, uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len) {
+    TracePlayer* self = static_cast<TracePlayer*>(ctx);
+    memset(buf, 0xFF, len);
+    if (!self->fetch(TRACE_TAG_I2C)) return 0;
+
+    const uint8_t* r = self->data.data() + self->pos;
+    if (self->pos + 5 > self->data.size() || self->pos + 5 + r[3] > self->data.size()) {
+        self->fail("记录被截断");
+        return 0;
+    }
+    if ((r[0] >> 4) != (bus & 0x0F) || r[1] != addr || r[2] != reg || r[3] != len) {
+        self->fail("I2C请求与记录不一致");
+        return 0;
+    }
+    memcpy(buf, r + 5, len);
+    int ret = r[4];
+    self->pos += 5 + len;
+    self->drainEvents();
+    return ret;
+}
+
+void TracePlayer::onPwmWrite(void* ctx, uint8_t channel, uint32_t duty) {
+    static_cast<TracePlayer*>(ctx)->checkOutput(TRACE_TAG_PWM, channel & 0x0F, duty);
+}
+
+void TracePlayer::onDigitalWrite(void* ctx, int pin, int level) {
+    static_cast<TracePlayer*>(ctx)->checkOutput(TRACE_TAG_DIGITAL, (uint8_t)pin, level ? 1 : 0);
+}
+
+// ============================================================================
+// 函数：run
+// ============================================================================
+TraceReplayStats TracePlayer::run(uint64_t max_loops) {
+    st = TraceReplayStats();
+    st.output_hash = 14695981039346656037ull;
+
+    halHostReset();
+    // 设备ID按捕获文件头写入NVS，由initBLEServer像设备启动时一样读取
+    halHostNvsClear();
+    halNvsWrite(DEVICE_ID_NVS_KEY, &device_id, 1);
+    HalHostHooks hooks = {};
+    hooks.ctx = this;
+    hooks.micros_read = &TracePlayer::onMicros;
+    hooks.millis_read = &TracePlayer::onMillis;
+    hooks.serial_available = &TracePlayer::onSerialAvailable;
+    hooks.serial_read = &TracePlayer::onSerialRead;
+    hooks.adc_read = &TracePlayer::onAdcRead;
+    hooks.i2c_read_reg = &TracePlayer::onI2CReadReg;
+    hooks.pwm_write = &TracePlayer::onPwmWrite;
+    hooks.digital_write = &TracePlayer::onDigitalWrite;
+    halHostSetHooks(&hooks);
+
+    auto wall_start = std::chrono::steady_clock::now();
+    drainEvents();
+    booting = true;
+    setup();
+    booting = false;
+    drainEvents();
+    while (!done && (max_loops == 0 || st.loops < max_loops)) {
+        loop();
+        st.loops++;
+    }
+    st.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    st.trace_us = cur_micros - start_micros;
+
+    halHostSetHooks(nullptr);
+    return st;
+}
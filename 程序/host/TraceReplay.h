@@ -0,0 +1,94 @@
+// ============================================================================
+// 文件：TraceReplay.h
+// 功能：现场捕获（FOC_Trace）的主机端重放器
+// 说明：按记录顺序把时钟、编码器I2C、ADC、串口字节作为HAL输入提供给
+//       .ino的setup()/loop()，BLE帧和连接事件在前一条HAL记录之后立即生效，
+//       并把控制代码产生的PWM/使能输出与记录逐项核对。
+//       不运行被控对象仿真，速度只取决于控制代码本身
+// ============================================================================
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include "HAL_Host.h"
+#include "../FOC_Trace.h"
+
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 函数：traceLoadFile
+// 功能：读取捕获文件
+// 说明：支持二进制格式，以及设备串口日志中"TRACE BEGIN ... TRACE END"的十六进制文本
+// 返回值：成功返回true，失败时err给出原因
+// ============================================================================
+bool traceLoadFile(const char* path, std::vector<uint8_t>& out, std::string* err);
+
+// ============================================================================
+// 数据结构定义：TraceReplayStats
+// 功能：一次重放的统计结果
+// ============================================================================
+struct TraceReplayStats {
+    uint64_t loops = 0;               //!< 执行的loop()次数
+    uint64_t records = 0;             //!< 消耗的记录数
+    uint64_t frames = 0;              //!< 重放的BLE帧数
+    uint64_t outputs_checked = 0;     //!< 核对的输出数
+    uint64_t output_mismatches = 0;   //!< 与记录不一致的输出数
+    size_t first_mismatch_offset = 0; //!< 首个不一致输出的记录偏移
+    bool desync = false;              //!< 调用顺序与记录不一致（重放中止）
+    size_t desync_offset = 0;         //!< 出现不一致的记录偏移
+    std::string desync_reason;        //!< 不一致原因
+    bool complete = false;            //!< 已消耗全部记录
+    uint32_t trace_us = 0;            //!< 记录覆盖的设备时间（微秒）
+    uint64_t output_hash = 0;         //!< 重放输出序列的FNV-1a指纹
+    double wall_s = 0;                //!< 重放墙钟耗时
+};
+
+// ============================================================================
+// 类定义：TracePlayer
+// 功能：单次重放（固件静态状态不可复位，每个进程只应重放一次）
+// ============================================================================
+class TracePlayer {
+  public:
+    // 载入捕获数据（检查文件头）
+    bool load(const std::vector<uint8_t>& bytes, std::string* err);
+
+    // 执行setup()与loop()直到记录耗尽、出现不一致或达到max_loops（0为不限）
+    TraceReplayStats run(uint64_t max_loops = 0);
+
+    uint8_t deviceId() const { return device_id; }
+    bool hasOutputs() const { return (flags & TRACE_FLAG_OUTPUTS) != 0; }
+
+  private:
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    uint8_t flags = 0;
+    uint8_t device_id = 0;
+    uint32_t start_micros = 0;
+
+    uint32_t cur_micros = 0;
+    uint32_t cur_millis = 0;
+    uint16_t cur_adc[64] = {};
+    bool done = false;
+    bool in_frame = false;
+    bool booting = false;   //!< setup()执行中：通信事件推迟到setup()返回后
+    TraceReplayStats st;
+
+    void drainEvents();
+    bool fetch(uint8_t tag);
+    bool readVarint(uint32_t* v);
+    bool readSmall(uint32_t* v);
+    void fail(const char* reason);
+    void hashOutput(uint32_t a, uint32_t b);
+    void checkOutput(uint8_t tag, uint32_t a, uint32_t b);
+
+    static uint32_t onMicros(void* ctx);
+    static uint32_t onMillis(void* ctx);
+    static int onSerialAvailable(void* ctx);
+    static int onSerialRead(void* ctx);
+    static uint16_t onAdcRead(void* ctx, int pin);
+    static int onI2CReadReg(void* ctx, uint8_t bus, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len);
+    static void onPwmWrite(void* ctx, uint8_t channel, uint32_t duty);
+    static void onDigitalWrite(void* ctx, int pin, int level);
+};
+
+#endif // TRACE_REPLAY_H
@@ -0,0 +1,439 @@
+// ============================================================================
+// 文件：bench_main.cpp
+// 功能：控制性能基准测试 - 标准运动场景 + 机器可读报告 + 基线对比
+// 用法：foc_bench [--out 报告.json] [--baseline 基线.json] [--targets targets.csv]
+//                 [--tolerance 0.10] [--check-cpu] [--only 场景名前缀]
+// 说明：每个场景在独立子进程中从上电开始仿真（固件全局状态互不影响），
+//       通过setMotorVelocityWithAngle()驱动三环级联，对象为PlantSim。
+//       场景：阶跃、斜坡、正弦扫频、targets.csv多关节广播轨迹。
+//       指标：跟踪误差、超调、调节时间、电流纹波、控制周期CPU耗时。
+//       与基线对比时，控制指标变差超过容差即返回1；cpu_*指标默认只报告不判定。
+// ============================================================================
+#include "SimHarness.h"
+#include "ctl/TargetsFile.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef FOC_TARGETS_CSV
+#define FOC_TARGETS_CSV "targets.csv"
+#endif
+
+typedef std::vector<std::pair<std::string, double>> Metrics;
+
+// ============================================================================
+// 场景定义
+// ============================================================================
+struct Scenario {
+    std::string name;
+    double duration_s;                 //!< 仿真时长（秒）
+    double (*profile)(double t);       //!< 输出端目标轨迹（相对起点，度）
+    double step_time_s;                //!< 阶跃时刻（非阶跃场景为负）
+    double step_deg;                   //!< 阶跃幅值
+};
+
+static double profileStep(double t) { return t < 0.2 ? 0.0 : 10.0; }
+
+static double profileRamp(double t) {
+    if (t < 0.2) return 0.0;
+    if (t < 2.2) return 5.0 * (t - 0.2);  // 5°/s 斜坡，持续2秒
+    return 10.0;
+}
+
+static double profileSweep(double t) {
+    // 线性调频：2°幅值，0.2Hz → 2Hz，历时5秒
+    const double f0 = 0.2, f1 = 2.0, T = 5.0;
+    double phase = 2.0 * PI * (f0 * t + (f1 - f0) * t * t / (2.0 * T));
+    return 2.0 * sin(phase);
+}
+
+// ============================================================================
+// 指标累计
+// ============================================================================
+struct Tracker {
+    double sum_sq_err = 0, max_err = 0;
+    uint64_t samples = 0;
+    double iq_lp = 0, ripple_sq = 0;
+    std::vector<uint64_t> cpu_ns;
+
+    void add(double err_deg, double iq, uint64_t ns, double dt_s) {
+        sum_sq_err += err_deg * err_deg;
+        max_err = std::max(max_err, fabs(err_deg));
+        samples++;
+        // 电流纹波：q轴电流相对其5ms低通值的均方根
+        iq_lp += (iq - iq_lp) * std::min(1.0, dt_s / 5e-3);
+        ripple_sq += (iq - iq_lp) * (iq - iq_lp);
+        cpu_ns.push_back(ns);
+    }
+
+    void report(Metrics& m) {
+        m.push_back({"rms_error_deg", sqrt(sum_sq_err / std::max<uint64_t>(samples, 1))});
+        m.push_back({"max_error_deg", max_err});
+        m.push_back({"iq_ripple_a", sqrt(ripple_sq / std::max<uint64_t>(samples, 1))});
+        std::vector<uint64_t> v = cpu_ns;
+        double mean = 0;
+        for (uint64_t x : v) mean += x;
+        mean /= std::max<size_t>(v.size(), 1);
+        size_t p99 = v.empty() ? 0 : (v.size() * 99) / 100;
+        if (!v.empty()) std::nth_element(v.begin(), v.begin() + p99, v.end());
+        m.push_back({"cpu_mean_ns", mean});
+        m.push_back({"cpu_p99_ns", v.empty() ? 0.0 : (double)v[p99]});
+    }
+};
+
+// ============================================================================
+// 阶跃响应指标：上升时间（10%→90%）、超调、调节时间（±2%或±0.2°）、稳态误差
+// ============================================================================
+static void stepMetrics(const std::vector<double>& t, const std::vector<double>& y, double t_step,
+                        double y0, double step, Metrics& m) {
+    double band = std::max(0.02 * fabs(step), 0.2);
+    double t10 = -1, t90 = -1, peak = 0, settle = 0;
+    double dir = step >= 0 ? 1.0 : -1.0;
+    for (size_t i = 0; i < t.size(); i++) {
+        if (t[i] < t_step) continue;
+        double rel = (y[i] - y0) * dir;  // 沿阶跃方向的位移
+        if (t10 < 0 && rel >= 0.1 * fabs(step)) t10 = t[i];
+        if (t90 < 0 && rel >= 0.9 * fabs(step)) t90 = t[i];
+        peak = std::max(peak, rel);
+        if (fabs(y[i] - (y0 + step)) > band) settle = t[i] - t_step;
+    }
+    size_t tail = t.size() / 10;
+    double sse = 0;
+    for (size_t i = t.size() - tail; i < t.size(); i++) sse += y[i] - (y0 + step);
+    sse = tail ? fabs(sse / tail) : 0;
+
+    m.push_back({"rise_time_s", (t10 >= 0 && t90 >= 0) ? t90 - t10 : t.back()});
+    m.push_back({"overshoot_pct", std::max(0.0, (peak - fabs(step)) / fabs(step) * 100.0)});
+    m.push_back({"settling_time_s", settle});
+    m.push_back({"steady_state_error_deg", sse});
+}
+
+// ============================================================================
+// 运行一个轨迹场景（子进程中执行）
+// ============================================================================
+static Metrics runProfileScenario(const Scenario& sc) {
+    PlantSim plant;
+    simBoot(plant);
+
+    // 以当前位置为起点，先保持一个周期
+    float start_motor = getMotorAngle();
+    simControlStep(start_motor);
+    double y0 = simMotorRadToOutputDeg(getMotorAngle());
+    double theta_o0 = plant.outputAngle();
+
+    Tracker tr;
+    std::vector<double> ts, ys;
+    uint64_t t0 = halHostNowMicros();
+    uint64_t loops = 0;
+    uint64_t t_prev = t0;
+    while (true) {
+        double t = (halHostNowMicros() - t0) * 1e-6;
+        if (t >= sc.duration_s) break;
+        double ref = y0 + sc.profile(t);
+        uint64_t ns = simControlStep(start_motor + simOutputDegToMotorRad((float)(ref - y0)));
+        double y = y0 + (plant.outputAngle() - theta_o0) * 180.0 / PI;
+        tr.add(ref - y, plant.currentQ(), ns, (halHostNowMicros() - t_prev) * 1e-6);
+        t_prev = halHostNowMicros();
+        ts.push_back(t);
+        ys.push_back(y);
+        loops++;
+    }
+
+    Metrics m;
+    tr.report(m);
+    m.push_back({"loop_rate_hz", loops / sc.duration_s});
+    if (sc.step_time_s >= 0) stepMetrics(ts, ys, sc.step_time_s, y0, sc.step_deg, m);
+    return m;
+}
+
+// ============================================================================
+// 运行一个关节的targets.csv广播场景（子进程中执行）
+// 说明：按ble_input_output.py的分组方式构造MULTI/MULTI_STRUCT包，
+//       每个关节都会收到全部分组包，由parseDirectCommandData()挑出自己的数据
+// ============================================================================
+static Metrics runTargetsJoint(const TargetsFile& tf, int joint_id) {
+    PlantSim plant;
+    simBoot(plant);
+    my_device_id = (uint8_t)joint_id;
+
+    int max_id = tf.id_values.empty() ? 0 : tf.id_values.rbegin()->first;
+    int group_size = std::max(1, tf.group_size);
+    int groups = (max_id + group_size - 1) / group_size;
+    double slot_s = tf.per_device_hz > 0 ? 1.0 / (tf.per_device_hz * groups) : 0.0;
+
+    // 构造一轮分组包
+    std::vector<std::string> packets;
+    for (int g = 0; g < groups; g++) {
+        int start_id = g * group_size + 1;
+        int end_id = std::min(start_id + group_size - 1, max_id);
+        uint8_t ids[MAX_MOTORS];
+        float vals[MAX_MOTORS];
+        uint8_t n = 0;
+        for (int id = start_id; id <= end_id && n < MAX_MOTORS; id++, n++) {
+            auto it = tf.id_values.find(id);
+            ids[n] = (uint8_t)id;
+            vals[n] = it == tf.id_values.end() ? 0.0f : it->second;
+        }
+        packets.push_back(tf.use_struct ? simMakeMultiStructPacket(ids, vals, n, DATA_TYPE_ANGLE)
+                                        : simMakeMultiSlicePacket((uint8_t)start_id, vals, n, DATA_TYPE_ANGLE));
+    }
+
+    float target_deg = tf.id_values.count(joint_id) ? tf.id_values.at(joint_id) : 0.0f;
+    double y_start = simMotorRadToOutputDeg(getMotorAngle());
+    double theta_o0 = plant.outputAngle();
+    double duration = 2.0 + fabs(target_deg - y_start) / 15.0;
+
+    Tracker tr;
+    std::vector<double> ts, ys;
+    uint64_t t0 = halHostNowMicros();
+    size_t next_packet = 0;
+    uint64_t t_prev = t0;
+    while (true) {
+        double t = (halHostNowMicros() - t0) * 1e-6;
+        if (t >= duration) break;
+        while (next_packet < packets.size() && t >= next_packet * slot_s) {
+            parseDirectCommandData(packets[next_packet++]);
+        }
+        float motor_target_rad = getSerialMotorTarget();
+        uint64_t ns = simControlStep(motor_target_rad);
+        double y = y_start + (plant.outputAngle() - theta_o0) * 180.0 / PI;
+        tr.add(simMotorRadToOutputDeg(motor_target_rad) - y, plant.currentQ(), ns, (halHostNowMicros() - t_prev) * 1e-6);
+        t_prev = halHostNowMicros();
+        ts.push_back(t);
+        ys.push_back(y);
+    }
+
+    Metrics m;
+    tr.report(m);
+    m.push_back({"loop_rate_hz", ts.size() / duration});
+    double final_err = fabs(target_deg - ys.back());
+    m.push_back({"final_error_deg", final_err});
+    double band = std::max(0.02 * fabs(target_deg - y_start), 0.2);
+    double settle = 0;
+    for (size_t i = 0; i < ts.size(); i++) {
+        if (fabs(ys[i] - target_deg) > band) settle = ts[i];
+    }
+    m.push_back({"settling_time_s", settle});
+    return m;
+}
+
+// ============================================================================
+// 子进程隔离执行：每个场景都从全新的固件全局状态开始
+// ============================================================================
+template <typename Fn>
+static bool runIsolated(Fn fn, Metrics& out) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Metrics m = fn();
+        FILE* w = fdopen(fds[1], "w");
+        for (auto& kv : m) fprintf(w, "%s %.9g\n", kv.first.c_str(), kv.second);
+        fclose(w);
+        _exit(0);
+    }
+    close(fds[1]);
+    FILE* r = fdopen(fds[0], "r");
+    char key[64];
+    double val;
+    while (fscanf(r, "%63s %lf", key, &val) == 2) out.push_back({key, val});
+    fclose(r);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ============================================================================
+// 最小JSON读取：把数值叶子展开为“a.b.c”路径（仅用于读取本程序生成的报告）
+// ============================================================================
+static void jsonSkipWs(const char*& p) {
+    while (*p && isspace((unsigned char)*p)) p++;
+}
+
+static bool jsonParseValue(const char*& p, const std::string& path, std::map<std::string, double>& out);
+
+static bool jsonParseString(const char*& p, std::string& s) {
+    if (*p != '"') return false;
+    p++;
+    while (*p && *p != '"') {
+        if (*p == '\\' && p[1]) p++;
+        s.push_back(*p++);
+    }
+    if (*p != '"') return false;
+    p++;
+    return true;
+}
+
+static bool jsonParseValue(const char*& p, const std::string& path, std::map<std::string, double>& out) {
+    jsonSkipWs(p);
+    if (*p == '{') {
+        p++;
+        jsonSkipWs(p);
+        if (*p == '}') { p++; return true; }
+        while (true) {
+            jsonSkipWs(p);
+            std::string key;
+            if (!jsonParseString(p, key)) return false;
+            jsonSkipWs(p);
+            if (*p++ != ':') return false;
+            if (!jsonParseValue(p, path.empty() ? key : path + "." + key, out)) return false;
+            jsonSkipWs(p);
+            if (*p == ',') { p++; continue; }
+            if (*p == '}') { p++; return true; }
+            return false;
+        }
+    }
+    if (*p == '"') {
+        std::string ignored;
+        return jsonParseString(p, ignored);
+    }
+    char* end = nullptr;
+    double v = strtod(p, &end);
+    if (end == p) return false;
+    out[path] = v;
+    p = end;
+    return true;
+}
+
+static bool loadReport(const char* path, std::map<std::string, double>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    fclose(f);
+    const char* p = text.c_str();
+    return jsonParseValue(p, "", out);
+}
+
+// ============================================================================
+// 报告输出
+// ============================================================================
+static void writeReport(FILE* f, const std::vector<std::pair<std::string, Metrics>>& results) {
+    fprintf(f, "{\n  \"version\": 1,\n");
+    fprintf(f, "  \"sim\": {\"loop_overhead_us\": %d, \"substep_us\": %u},\n",
+            SIM_LOOP_OVERHEAD_US, PlantParams().substep_us);
+    fprintf(f, "  \"scenarios\": {\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(f, "    \"%s\": {\n", results[i].first.c_str());
+        const Metrics& m = results[i].second;
+        for (size_t j = 0; j < m.size(); j++) {
+            fprintf(f, "      \"%s\": %.6g%s\n", m[j].first.c_str(), m[j].second, j + 1 < m.size() ? "," : "");
+        }
+        fprintf(f, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* out_path = nullptr;
+    const char* baseline_path = nullptr;
+    const char* targets_path = FOC_TARGETS_CSV;
+    const char* only = "";
+    double tolerance = 0.10;
+    bool check_cpu = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--out" && i + 1 < argc) out_path = argv[++i];
+        else if (a == "--baseline" && i + 1 < argc) baseline_path = argv[++i];
+        else if (a == "--targets" && i + 1 < argc) targets_path = argv[++i];
+        else if (a == "--tolerance" && i + 1 < argc) tolerance = atof(argv[++i]);
+        else if (a == "--only" && i + 1 < argc) only = argv[++i];
+        else if (a == "--check-cpu") check_cpu = true;
+        else {
+            fprintf(stderr, "用法：%s [--out 报告.json] [--baseline 基线.json] [--targets targets.csv] "
+                            "[--tolerance 0.10] [--check-cpu] [--only 场景名前缀]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Scenario> scenarios = {
+        {"step_10deg", 2.0, profileStep, 0.2, 10.0},
+        {"ramp_5dps", 3.0, profileRamp, -1, 0},
+        {"sine_sweep_2deg", 5.0, profileSweep, -1, 0},
+    };
+
+    std::vector<std::pair<std::string, Metrics>> results;
+    bool ok = true;
+    for (const Scenario& sc : scenarios) {
+        if (sc.name.compare(0, strlen(only), only) != 0) continue;
+        Metrics m;
+        if (!runIsolated([&] { return runProfileScenario(sc); }, m)) {
+            fprintf(stderr, "场景 %s 运行失败\n", sc.name.c_str());
+            ok = false;
+        }
+        results.push_back({sc.name, m});
+    }
+
+    TargetsFile tf;
+    if (loadTargets(targets_path, tf)) {
+        for (auto& kv : tf.id_values) {
+            char name[32];
+            snprintf(name, sizeof(name), "targets_joint_%02d", kv.first);
+            if (strncmp(name, only, strlen(only)) != 0) continue;
+            Metrics m;
+            int id = kv.first;
+            if (!runIsolated([&] { return runTargetsJoint(tf, id); }, m)) {
+                fprintf(stderr, "场景 %s 运行失败\n", name);
+                ok = false;
+            }
+            results.push_back({name, m});
+        }
+    } else {
+        fprintf(stderr, "未找到目标文件 %s，跳过多关节场景\n", targets_path);
+    }
+
+    if (out_path) {
+        FILE* f = fopen(out_path, "w");
+        if (!f) {
+            fprintf(stderr, "无法写入 %s\n", out_path);
+            return 2;
+        }
+        writeReport(f, results);
+        fclose(f);
+    } else {
+        writeReport(stdout, results);
+    }
+
+    if (baseline_path) {
+        std::map<std::string, double> base, cur;
+        if (!loadReport(baseline_path, base)) {
+            fprintf(stderr, "无法读取基线 %s\n", baseline_path);
+            return 2;
+        }
+        for (auto& r : results) {
+            for (auto& kv : r.second) cur["scenarios." + r.first + "." + kv.first] = kv.second;
+        }
+        int regressions = 0;
+        for (auto& kv : base) {
+            if (kv.first.compare(0, 10, "scenarios.") != 0) continue;
+            auto it = cur.find(kv.first);
+            if (it == cur.end()) {
+                if (only[0] == '\0') {
+                    fprintf(stderr, "缺少指标 %s\n", kv.first.c_str());
+                    regressions++;
+                }
+                continue;
+            }
+            std::string metric = kv.first.substr(kv.first.rfind('.') + 1);
+            if (metric == "loop_rate_hz") continue;  // 仿真参数决定，非性能指标
+            bool is_cpu = metric.compare(0, 4, "cpu_") == 0;
+            double limit = kv.second + std::max(1e-3, tolerance * fabs(kv.second));
+            if (it->second > limit) {
+                fprintf(stderr, "%s %s: %.6g -> %.6g (上限 %.6g)\n", is_cpu && !check_cpu ? "[cpu]" : "[退化]",
+                        kv.first.c_str(), kv.second, it->second, limit);
+                if (!is_cpu || check_cpu) regressions++;
+            }
+        }
+        fprintf(stderr, "基线对比：%d 项退化\n", regressions);
+        if (regressions) ok = false;
+    }
+    return ok ? 0 : 1;
+}
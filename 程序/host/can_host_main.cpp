@@ -0,0 +1,194 @@
+// ============================================================================
+// 文件：can_host_main.cpp
+// 功能：CAN总线主机（Linux SocketCAN）- 按固定周期同步控制多个关节
+// 用法：foc_can_host [接口名] [--joints N] [--period ms] [--seconds 秒] [--amp 度] [--freq Hz]
+// 说明：每个周期先发送分组目标帧（FOC_CanLink.h，正弦轨迹，相邻关节相位依次错开），再发送SYNC；
+//       各关节在SYNC时同时切换目标并回送遥测/状态帧。周期用CLOCK_MONOTONIC绝对时间定时，
+//       结束时输出周期抖动、各关节回送率和SYNC→遥测帧延迟。
+//       无硬件时可用虚拟接口测试：
+//         ip link add dev vcan0 type vcan && ip link set up vcan0
+// ============================================================================
+#include "FOC.h"
+#include "ctl/HostController.h"
+
+#include <errno.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 数据结构定义：JointLog
+// 功能：单个关节的回送统计
+// ============================================================================
+struct JointLog {
+    CanJointState state;        //!< 最近一次回送的状态
+    uint32_t replies;           //!< 收到的本周期遥测帧
+    uint32_t missed;            //!< 未回送的周期
+    uint32_t stale;             //!< 周期计数不符的遥测帧
+    uint64_t latency_sum_ns;    //!< SYNC→遥测帧延迟累计
+    uint64_t latency_max_ns;
+    bool replied;               //!< 本周期已回送
+};
+
+static int canHostOpen(const char* ifname) {
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        perror("socket(PF_CAN)");
+        return -1;
+    }
+    ifreq ifr = {};
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        fprintf(stderr, "找不到CAN接口 %s: %s\n", ifname, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool canHostSend(int fd, uint32_t id, const uint8_t* data, uint8_t len) {
+    can_frame f = {};
+    f.can_id = id;
+    f.can_dlc = len;
+    memcpy(f.data, data, len);
+    return write(fd, &f, sizeof(f)) == (ssize_t)sizeof(f);
+}
+
+int main(int argc, char** argv) {
+    const char* ifname = "vcan0";
+    int joints = 8;
+    double period_ms = 2.0;
+    double seconds = 5.0;
+    double amp_deg = 30.0;
+    double freq_hz = 0.5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--joints" && i + 1 < argc) {
+            joints = atoi(argv[++i]);
+        } else if (arg == "--period" && i + 1 < argc) {
+            period_ms = atof(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--amp" && i + 1 < argc) {
+            amp_deg = atof(argv[++i]);
+        } else if (arg == "--freq" && i + 1 < argc) {
+            freq_hz = atof(argv[++i]);
+        } else if (arg[0] != '-') {
+            ifname = argv[i];
+        } else {
+            fprintf(stderr,
+                    "用法: foc_can_host [接口名] [--joints N] [--period ms] [--seconds 秒] [--amp 度] [--freq Hz]\n");
+            return 2;
+        }
+    }
+    if (joints < 1 || joints > MAX_MOTORS || period_ms <= 0) {
+        fprintf(stderr, "关节数须为1..%d，周期须大于0\n", MAX_MOTORS);
+        return 2;
+    }
+
+    int fd = canHostOpen(ifname);
+    if (fd < 0) return 1;
+
+    std::vector<JointLog> log(joints + 1, JointLog{});
+    uint64_t period_ns = (uint64_t)(period_ms * 1e6);
+    uint64_t cycles = (uint64_t)(seconds * 1e3 / period_ms);
+    uint64_t t0 = HostController::nowNs() + period_ns;
+    uint64_t jitter_max_ns = 0, jitter_sum_ns = 0;
+    uint32_t tx_errors = 0;
+    uint8_t cycle = 0;
+
+    for (uint64_t c = 0; c <= cycles; c++) {
+        uint64_t deadline = t0 + c * period_ns;
+        timespec ts = {(time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+        uint64_t wake = HostController::nowNs();
+        uint64_t jitter = wake - deadline;
+        jitter_sum_ns += jitter;
+        if (jitter > jitter_max_ns) jitter_max_ns = jitter;
+        if (c > 0) {
+            for (int j = 1; j <= joints; j++) {
+                if (!log[j].replied) log[j].missed++;
+                log[j].replied = false;
+            }
+        }
+        if (c == cycles) break;  // 最后一次只结算上一周期
+
+        // 分组目标 + SYNC
+        double t = c * period_ms * 1e-3;
+        int16_t raw[CAN_GROUP_SIZE];
+        uint8_t data[8];
+        for (int g = 0; g * CAN_GROUP_SIZE < joints; g++) {
+            uint8_t count = (uint8_t)(joints - g * CAN_GROUP_SIZE < CAN_GROUP_SIZE ? joints - g * CAN_GROUP_SIZE
+                                                                                 : CAN_GROUP_SIZE);
+            for (int k = 0; k < count; k++) {
+                double phase = 2.0 * PI * (freq_hz * t + (double)(g * CAN_GROUP_SIZE + k) / joints);
+                raw[k] = floatToInt16((float)(amp_deg * sin(phase)), ANGLE_SCALE);
+            }
+            uint8_t len = canPackGroup(raw, count, data);
+            if (!canHostSend(fd, CAN_ID_GROUP | (DATA_TYPE_ANGLE << 4) | g, data, len)) tx_errors++;
+        }
+        data[0] = ++cycle;
+        uint64_t sync_ns = HostController::nowNs();
+        if (!canHostSend(fd, CAN_ID_SYNC, data, 1)) tx_errors++;
+
+        // 接收回送直到下一周期开始
+        uint64_t next = deadline + period_ns;
+        for (;;) {
+            uint64_t now = HostController::nowNs();
+            if (now >= next) break;
+            timespec wait = {0, (long)(next - now)};
+            pollfd p = {fd, POLLIN, 0};
+            if (ppoll(&p, 1, &wait, nullptr) <= 0) continue;
+            can_frame f;
+            if (read(fd, &f, sizeof(f)) != (ssize_t)sizeof(f)) continue;
+            uint32_t id = f.can_id & CAN_SFF_MASK;
+            if (id > CAN_ID_STATUS && id <= CAN_ID_STATUS + (uint32_t)joints) {
+                canUnpackStatus(f.data, f.can_dlc, &log[id - CAN_ID_STATUS].state);
+            } else if (id > CAN_ID_TELEMETRY && id <= CAN_ID_TELEMETRY + (uint32_t)joints) {
+                JointLog& j = log[id - CAN_ID_TELEMETRY];
+                if (!canUnpackTelemetry(f.data, f.can_dlc, &j.state)) continue;
+                if (j.state.cycle != cycle) {
+                    j.stale++;
+                    continue;
+                }
+                uint64_t latency = HostController::nowNs() - sync_ns;
+                j.latency_sum_ns += latency;
+                if (latency > j.latency_max_ns) j.latency_max_ns = latency;
+                j.replies++;
+                j.replied = true;
+            }
+        }
+    }
+    close(fd);
+
+    printf("CAN主机 %s：%d 个关节，周期 %.3fms，%llu 个周期，发送失败 %u\n", ifname, joints, period_ms,
+           (unsigned long long)cycles, tx_errors);
+    printf("周期唤醒抖动：平均 %.1fus，最大 %.1fus\n", cycles ? jitter_sum_ns / 1e3 / (cycles + 1) : 0.0,
+           jitter_max_ns / 1e3);
+    printf("关节  回送    未回送  过期   延迟平均us  延迟最大us  角度rad    iq A     温度°C  故障    看门狗\n");
+    for (int j = 1; j <= joints; j++) {
+        const JointLog& l = log[j];
+        printf("%4d  %6u  %6u  %5u  %10.1f  %10.1f  %9.4f  %7.3f  %6.1f  0x%04X  %s\n", j, l.replies, l.missed,
+               l.stale, l.replies ? l.latency_sum_ns / 1e3 / l.replies : 0.0, l.latency_max_ns / 1e3,
+               l.state.angle, l.state.iq, l.state.temperature, l.state.fault,
+               l.replies ? watchdogStateName(l.state.watchdog) : "-");
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// ============================================================================
+// 文件：CtlPacket.cpp
+// 功能：上位机数据包构造实现
+// ============================================================================
+#include "CtlPacket.h"
+
+float ctlScaleFor(uint8_t data_type) {
+    if (data_type == DATA_TYPE_VELOCITY) return VELOCITY_SCALE;
+    if (data_type == DATA_TYPE_CURRENT) return 1000.0f;  // 与固件cmdScaleFor()一致
+    return ANGLE_SCALE;
+}
+
+static inline uint8_t* ctlPut16(uint8_t* p, int16_t raw) {
+    p[0] = (uint8_t)((uint16_t)raw >> 8);  // 高字节在前
+    p[1] = (uint8_t)((uint16_t)raw & 0xFF);
+    return p + 2;
+}
+
+static inline uint8_t* ctlPutHeader(uint8_t* p, uint8_t packet_type) {
+    p[0] = 0xAA;
+    p[1] = 0x55;
+    p[2] = packet_type;
+    return p + 3;
+}
+
+size_t ctlPackSingle(uint8_t* out, size_t cap, uint8_t data_type, uint8_t id, int16_t raw) {
+    if (cap < 7) return 0;
+    uint8_t* p = ctlPutHeader(out, PACKET_TYPE_SINGLE);
+    *p++ = data_type;
+    *p++ = id;
+    ctlPut16(p, raw);
+    return 7;
+}
+
+size_t ctlPackMultiSlice(uint8_t* out, size_t cap, uint8_t data_type, uint8_t start_id, const int16_t* raw,
+                         uint8_t count) {
+    size_t len = 6 + (size_t)count * 2;
+    if (count == 0 || cap < len) return 0;
+    uint8_t* p = ctlPutHeader(out, PACKET_TYPE_MULTI);
+    *p++ = data_type;
+    *p++ = start_id;
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++) p = ctlPut16(p, raw[i]);
+    return len;
+}
+
+size_t ctlPackMultiStruct(uint8_t* out, size_t cap, uint8_t data_type, const uint8_t* ids, const int16_t* raw,
+                          uint8_t count) {
+    size_t len = 5 + (size_t)count * 3;
+    if (count == 0 || cap < len) return 0;
+    uint8_t* p = ctlPutHeader(out, PACKET_TYPE_MULTI_STRUCT);
+    *p++ = data_type;
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++) {
+        *p++ = ids[i];
+        p = ctlPut16(p, raw[i]);
+    }
+    return len;
+}
+
+size_t ctlPackMultiSlot(uint8_t* out, size_t cap, uint8_t data_type, uint8_t epoch, uint8_t start_slot,
+                        const int16_t* raw, uint8_t count) {
+    size_t len = 7 + (size_t)count * 2;
+    if (count == 0 || cap < len) return 0;
+    uint8_t* p = ctlPutHeader(out, PACKET_TYPE_MULTI_SLOT);
+    *p++ = data_type;
+    *p++ = epoch;
+    *p++ = start_slot;
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++) p = ctlPut16(p, raw[i]);
+    return len;
+}
+
+size_t ctlPackConfig(uint8_t* out, size_t cap, uint8_t op, uint8_t id, int arg0, int arg1) {
+    size_t len = 5 + (arg0 >= 0) + (arg0 >= 0 && arg1 >= 0);
+    if (cap < len) return 0;
+    uint8_t* p = ctlPutHeader(out, PACKET_TYPE_CONFIG);
+    *p++ = op;
+    *p++ = id;
+    if (arg0 >= 0) *p++ = (uint8_t)arg0;
+    if (arg0 >= 0 && arg1 >= 0) *p++ = (uint8_t)arg1;
+    return len;
+}
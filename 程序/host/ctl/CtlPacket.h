@@ -0,0 +1,42 @@
+// ============================================================================
+// 文件：CtlPacket.h
+// 功能：上位机数据包构造（与固件共用Ble_Handler.h中的包类型/数据类型定义）
+// 说明：直接写入调用方预分配的缓冲，不分配内存；容量不足时返回0。
+//       多值包的值为已量化的原始值（floatToInt16），高字节在前。
+//       构造时在缓冲前预留CTL_HEADROOM字节，发送时由ctlPackSequence()原地写入序号前缀，
+//       同一个包写入多条连接时只需改写3字节，不复制数据
+// ============================================================================
+#ifndef CTL_PACKET_H
+#define CTL_PACKET_H
+
+#include "FOC.h"
+
+#define CTL_HEADROOM 3                                  //!< 序号前缀长度（A5 序号高 序号低）
+#define CTL_PACKET_MAX (CTL_HEADROOM + 5 + 3 * MAX_MOTORS)  //!< 最长的包（全部关节MULTI_STRUCT加序号）
+
+// 数据类型对应的缩放系数（原始值 = 目标值 × 系数）
+float ctlScaleFor(uint8_t data_type);
+
+// AA 55 01 DT ID VH VL
+size_t ctlPackSingle(uint8_t* out, size_t cap, uint8_t data_type, uint8_t id, int16_t raw);
+// AA 55 02 DT START COUNT V..
+size_t ctlPackMultiSlice(uint8_t* out, size_t cap, uint8_t data_type, uint8_t start_id, const int16_t* raw,
+                         uint8_t count);
+// AA 55 03 DT COUNT (ID VH VL)..
+size_t ctlPackMultiStruct(uint8_t* out, size_t cap, uint8_t data_type, const uint8_t* ids, const int16_t* raw,
+                          uint8_t count);
+// AA 55 05 DT EPOCH START COUNT V..
+size_t ctlPackMultiSlot(uint8_t* out, size_t cap, uint8_t data_type, uint8_t epoch, uint8_t start_slot,
+                        const int16_t* raw, uint8_t count);
+// AA 55 04 OP ID [ARG0 [ARG1]]，参数为负时省略
+size_t ctlPackConfig(uint8_t* out, size_t cap, uint8_t op, uint8_t id, int arg0 = -1, int arg1 = -1);
+
+// 在packet之前的CTL_HEADROOM字节写入序号前缀，返回前缀起点（长度加CTL_HEADROOM）
+static inline uint8_t* ctlPackSequence(uint8_t* packet, uint16_t seq) {
+    packet[-3] = BLE_SEQ_PREFIX;
+    packet[-2] = (uint8_t)(seq >> 8);
+    packet[-1] = (uint8_t)(seq & 0xFF);
+    return packet - CTL_HEADROOM;
+}
+
+#endif // CTL_PACKET_H
@@ -0,0 +1,124 @@
+// ============================================================================
+// 文件：DeltaSender.cpp
+// 功能：上位机增量目标发送器实现
+// 说明：包在栈上的定长缓冲中组装（前面预留序号前缀），每轮不分配内存
+// ============================================================================
+#include "DeltaSender.h"
+
+#include <cmath>
+
+DeltaSender::DeltaSender(const DeltaSenderConfig& c) : cfg(c), scale(ctlScaleFor(c.data_type)) {
+    for (Joint& j : joints) j = Joint{};
+    if (cfg.max_packet < 8) cfg.max_packet = 8;  // 至少容纳一个条目
+}
+
+bool DeltaSender::setTarget(uint8_t id, float value) { return setTargetRaw(id, floatToInt16(value, scale)); }
+
+bool DeltaSender::setTargetRaw(uint8_t id, int16_t raw) {
+    if (id < 1 || id > MAX_MOTORS) return false;
+    Joint& j = joints[id];
+    if (!j.present) keyframe_due = true;  // 新关节从关键帧开始
+    j.present = true;
+    j.target = raw;
+    return true;
+}
+
+int DeltaSender::unacked() const {
+    int n = 0;
+    for (int id = 1; id <= MAX_MOTORS; id++) {
+        if (joints[id].sent && !joints[id].acked) n++;
+    }
+    return n;
+}
+
+int16_t DeltaSender::lastSent(uint8_t id) const {
+    return id >= 1 && id <= MAX_MOTORS && joints[id].sent ? joints[id].last_sent : 0;
+}
+
+// ============================================================================
+// 函数：DeltaSender::emitItems
+// 功能：把按ID升序的关节打包发出
+// 说明：贪心装包：MULTI_STRUCT每条目3字节，装满max_packet后换包；
+//       包内ID恰好连续且多于1个时改用更短的MULTI切片
+// ============================================================================
+void DeltaSender::emitItems(const uint8_t* ids, int count, DeltaEmitFn emit, void* ctx) {
+    int per_packet = (int)((cfg.max_packet - 5) / 3);
+    uint8_t buf[CTL_PACKET_MAX];
+    uint8_t* pkt = buf + CTL_HEADROOM;
+    int16_t raw[MAX_MOTORS];
+    for (int first = 0; first < count; first += per_packet) {
+        int n = count - first < per_packet ? count - first : per_packet;
+        for (int k = 0; k < n; k++) {
+            Joint& j = joints[ids[first + k]];
+            raw[k] = j.target;
+            if (!j.sent || j.last_sent != j.target) j.acked = false;
+            j.sent = true;
+            j.last_sent = j.target;
+            j.sent_round = st.rounds;
+        }
+        bool contiguous = n > 1 && ids[first + n - 1] - ids[first] == n - 1;
+        size_t cap = sizeof(buf) - CTL_HEADROOM;
+        size_t len = contiguous ? ctlPackMultiSlice(pkt, cap, cfg.data_type, ids[first], raw, (uint8_t)n)
+                                : ctlPackMultiStruct(pkt, cap, cfg.data_type, ids + first, raw, (uint8_t)n);
+        st.packets++;
+        st.bytes += len;
+        st.items += n;
+        emit(ctx, pkt, len);
+    }
+}
+
+// ============================================================================
+// 函数：DeltaSender::round
+// 功能：发送一轮
+// ============================================================================
+size_t DeltaSender::round(DeltaEmitFn emit, void* ctx) {
+    uint64_t packets_before = st.packets;
+    bool keyframe = keyframe_due || (cfg.keyframe_rounds > 0 && st.rounds % cfg.keyframe_rounds == 0);
+    uint8_t ids[MAX_MOTORS];
+    int count = 0;
+    for (int id = 1; id <= MAX_MOTORS; id++) {
+        const Joint& j = joints[id];
+        if (!j.present) continue;
+        bool changed = !j.sent || j.target != j.last_sent;
+        bool resend = !changed && cfg.ack_timeout_rounds > 0 && !j.acked &&
+                      st.rounds - j.sent_round >= cfg.ack_timeout_rounds;
+        if (changed) st.changed++;
+        if (resend && !keyframe) st.resends++;
+        if (keyframe || changed || resend) ids[count++] = (uint8_t)id;
+    }
+    if (keyframe) {
+        st.keyframes++;
+        keyframe_due = false;
+    }
+    emitItems(ids, count, emit, ctx);
+    st.rounds++;
+    return (size_t)(st.packets - packets_before);
+}
+
+// ============================================================================
+// 函数：DeltaSender::onReply
+// 功能：处理固件回复"<id>:<包类型>:<目标值>"
+// 说明：回复值按"%.2f"格式化，与最近发送值相差不超过半个显示位加半个量化步长即视为确认；
+//       ERROR/CONFIG回复和无关文本返回false
+// ============================================================================
+bool DeltaSender::onReply(const char* text) {
+    char* end;
+    long id = strtol(text, &end, 10);
+    if (end == text || *end != ':' || id < 1 || id > MAX_MOTORS) return false;
+    const char* type = end + 1;
+    const char* colon = strchr(type, ':');
+    if (!colon) return false;
+    if (strncmp(type, "ERROR:", 6) == 0 || strncmp(type, "CONFIG:", 7) == 0) return false;
+    float value = strtof(colon + 1, &end);
+    if (end == colon + 1) return false;
+
+    Joint& j = joints[id];
+    if (!j.sent) return false;
+    if (fabsf(value - int16ToFloat(j.last_sent, scale)) <= 0.005f + 0.5f / scale) {
+        j.acked = true;
+        st.acks++;
+    } else {
+        st.stale_acks++;
+    }
+    return true;
+}
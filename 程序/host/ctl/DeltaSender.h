@@ -0,0 +1,92 @@
+// ============================================================================
+// 文件：DeltaSender.h
+// 功能：上位机增量目标发送器 - 每轮只发送目标有变化的关节
+// 说明：记录每个关节最近发送的原始值和固件确认（回复"<id>:<包类型>:<目标值>"），
+//       每轮只打包以下关节：
+//         - 目标的原始值（量化后）与最近发送值不同；
+//         - 已发送但超过ack_timeout_rounds轮仍未确认（BLE写无响应可能丢失）。
+//       每keyframe_rounds轮发送一次关键帧（全部关节），作为丢包后的兜底，并持续喂固件的
+//       指令看门狗：启用WATCHDOG_TIMEOUT_MS时，轮周期×keyframe_rounds须小于该超时。
+//       打包：每个包内ID连续时用MULTI切片（6+2N字节），否则用MULTI_STRUCT（5+3N字节），
+//       超过max_packet时拆成多个包。包由回调逐个交给调用方（写入各BLE连接、网关等），
+//       不带序号前缀（序号按连接分别编号，由调用方在预留空间中写入）。
+//       无回复通道的传输（无线广播、CAN）把ack_timeout_rounds设为0，只靠关键帧兜底
+// ============================================================================
+#ifndef DELTA_SENDER_H
+#define DELTA_SENDER_H
+
+#include "CtlPacket.h"
+
+// ============================================================================
+// 数据结构定义：DeltaSenderConfig
+// 功能：增量发送参数
+// ============================================================================
+struct DeltaSenderConfig {
+    uint8_t data_type = DATA_TYPE_ANGLE;            //!< 数据类型（决定缩放系数）
+    uint32_t keyframe_rounds = 5;                   //!< 关键帧间隔（轮），0为只在第一轮发送
+    uint32_t ack_timeout_rounds = 2;                //!< 未确认重发间隔（轮），0为不跟踪确认
+    size_t max_packet = BLE_RX_SLOT_SIZE - 3;       //!< 单包最大字节数（固件接收槽减去序号前缀）
+};
+
+// ============================================================================
+// 数据结构定义：DeltaSenderStats
+// 功能：发送统计
+// ============================================================================
+struct DeltaSenderStats {
+    uint64_t rounds;            //!< 轮数
+    uint64_t keyframes;         //!< 关键帧轮数
+    uint64_t packets;           //!< 发出的包
+    uint64_t bytes;             //!< 发出的字节（不含序号前缀）
+    uint64_t items;             //!< 发出的关节条目
+    uint64_t changed;           //!< 因目标变化发出的条目
+    uint64_t resends;           //!< 因未确认重发的条目
+    uint64_t acks;              //!< 与最近发送值一致的确认
+    uint64_t stale_acks;        //!< 与最近发送值不符的确认（对较早的包的回复）
+};
+
+// 包回调：packet为完整数据包（AA 55帧头起），仅在回调期间有效；
+// packet之前有CTL_HEADROOM字节可写，供ctlPackSequence()原地加序号前缀
+typedef void (*DeltaEmitFn)(void* ctx, uint8_t* packet, size_t len);
+
+class DeltaSender {
+public:
+    explicit DeltaSender(const DeltaSenderConfig& cfg = DeltaSenderConfig());
+
+    // 设置关节目标（1..MAX_MOTORS），首次设置即加入关键帧；只记录，不发送
+    bool setTarget(uint8_t id, float value);
+    bool setTargetRaw(uint8_t id, int16_t raw);         //!< 同上，值为已量化的原始值
+
+    // 发送一轮：按规则挑出关节并打包，逐包调用emit，返回包数
+    size_t round(DeltaEmitFn emit, void* ctx);
+
+    // 下一轮强制发送关键帧（如重新连接后）
+    void forceKeyframe() { keyframe_due = true; }
+
+    // 处理固件回复文本，是目标确认时返回true
+    bool onReply(const char* text);
+
+    int unacked() const;                                //!< 已发送但未确认的关节数
+    int16_t lastSent(uint8_t id) const;                 //!< 最近发送的原始值（未发送过为0）
+    const DeltaSenderStats& stats() const { return st; }
+    const DeltaSenderConfig& config() const { return cfg; }
+
+private:
+    struct Joint {
+        bool present;           //!< 已设置过目标
+        bool sent;              //!< 已发送过
+        bool acked;             //!< 最近发送值已确认
+        int16_t target;         //!< 当前目标（原始值）
+        int16_t last_sent;      //!< 最近发送的原始值
+        uint64_t sent_round;    //!< 最近发送的轮次
+    };
+
+    void emitItems(const uint8_t* ids, int count, DeltaEmitFn emit, void* ctx);
+
+    DeltaSenderConfig cfg;
+    float scale;
+    Joint joints[MAX_MOTORS + 1];
+    bool keyframe_due = true;
+    DeltaSenderStats st = {};
+};
+
+#endif // DELTA_SENDER_H
@@ -0,0 +1,156 @@
+// ============================================================================
+// 文件：HostController.cpp
+// 功能：上位机实时发送线程实现
+// ============================================================================
+#include "HostController.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define CTL_TARGET_UNSET INT32_MIN      //!< 目标未设置
+#define CTL_JITTER_BINS 10000           //!< 直方图档数（1us一档，覆盖10ms）
+
+HostController::HostController(HostTransport& t, const HostControllerConfig& c)
+    : transport(t), cfg(c), delta(c.delta), scale(ctlScaleFor(c.delta.data_type)) {
+    for (auto& v : targets) v.store(CTL_TARGET_UNSET, std::memory_order_relaxed);
+    if (cfg.period_us == 0) cfg.period_us = 1;
+}
+
+HostController::~HostController() { stop(); }
+
+uint64_t HostController::nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool HostController::setTarget(uint8_t id, float value) {
+    if (id < 1 || id > MAX_MOTORS) return false;
+    targets[id].store(floatToInt16(value, scale), std::memory_order_relaxed);
+    return true;
+}
+
+bool HostController::setTargetRaw(uint8_t id, int16_t raw) {
+    if (id < 1 || id > MAX_MOTORS) return false;
+    targets[id].store(raw, std::memory_order_relaxed);
+    return true;
+}
+
+void HostController::setCycleHook(HostCycleFn fn, void* ctx) {
+    cycle_fn = fn;
+    cycle_ctx = ctx;
+}
+
+bool HostController::start() {
+    if (thread.joinable()) return false;
+    seq.assign(transport.links(), 0);
+    jitter_hist.assign(CTL_JITTER_BINS, 0);
+    st = HostControllerStats{};
+    jitter_sum_us = busy_sum_us = 0;
+    stop_flag.store(false);
+    thread = std::thread(&HostController::run, this);
+    return true;
+}
+
+void HostController::stop() {
+    if (!thread.joinable()) return;
+    stop_flag.store(true);
+    thread.join();
+}
+
+void HostController::emitPacket(void* ctx, uint8_t* packet, size_t len) {
+    HostController& c = *(HostController*)ctx;
+    for (int link = 0; link < (int)c.seq.size(); link++) {
+        uint8_t* frame = ctlPackSequence(packet, c.seq[link]++);
+        c.st.writes++;
+        if (!c.transport.write(link, frame, len + CTL_HEADROOM)) c.st.write_errors++;
+    }
+}
+
+void HostController::onReply(void* ctx, int link, const char* text) {
+    (void)link;
+    HostController& c = *(HostController*)ctx;
+    c.st.replies++;
+    c.delta.onReply(text);
+}
+
+// ============================================================================
+// 函数：HostController::run
+// 功能：实时线程主循环
+// ============================================================================
+void HostController::run() {
+    if (cfg.rt_priority > 0) {
+        sched_param sp = {};
+        sp.sched_priority = cfg.rt_priority;
+        st.realtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+    }
+    if (cfg.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cfg.cpu, &set);
+        st.pinned = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    timespec cpu0;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu0);
+    uint64_t period_ns = (uint64_t)cfg.period_us * 1000ull;
+    uint64_t t0 = nowNs() + period_ns;
+    uint64_t k = 0;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        uint64_t deadline = t0 + k * period_ns;
+        timespec ts = {(time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+        uint64_t wake = nowNs();
+        uint64_t late_ns = wake > deadline ? wake - deadline : 0;
+        double late_us = late_ns / 1e3;
+        jitter_sum_us += late_us;
+        if (late_us > st.jitter_max_us) st.jitter_max_us = late_us;
+        jitter_hist[late_ns / 1000 < CTL_JITTER_BINS ? late_ns / 1000 : CTL_JITTER_BINS - 1]++;
+
+        transport.poll(onReply, this);
+        if (cycle_fn) cycle_fn(cycle_ctx, *this, st.cycles, deadline);
+        for (int id = 1; id <= MAX_MOTORS; id++) {
+            int32_t raw = targets[id].load(std::memory_order_relaxed);
+            if (raw != CTL_TARGET_UNSET) delta.setTargetRaw((uint8_t)id, (int16_t)raw);
+        }
+        delta.round(emitPacket, this);
+        st.cycles++;
+
+        uint64_t done = nowNs();
+        double busy_us = (done - wake) / 1e3;
+        busy_sum_us += busy_us;
+        if (busy_us > st.busy_max_us) st.busy_max_us = busy_us;
+
+        // 错过的周期不补发，保持原有相位
+        uint64_t next = k + 1;
+        if (done > t0 + next * period_ns) {
+            uint64_t skip = (done - t0) / period_ns + 1;
+            st.overruns += skip - next;
+            next = skip;
+        }
+        k = next;
+    }
+    timespec cpu1;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu1);
+    uint64_t cpu_ns = (uint64_t)(cpu1.tv_sec - cpu0.tv_sec) * 1000000000ull + (uint64_t)cpu1.tv_nsec -
+                      (uint64_t)cpu0.tv_nsec;
+    finishStats(nowNs() - (t0 - period_ns), cpu_ns);
+}
+
+void HostController::finishStats(uint64_t wall_ns, uint64_t cpu_ns) {
+    if (st.cycles == 0) return;
+    st.jitter_mean_us = jitter_sum_us / st.cycles;
+    st.busy_mean_us = busy_sum_us / st.cycles;
+    uint64_t need = (st.cycles * 99 + 99) / 100, seen = 0;
+    for (size_t b = 0; b < jitter_hist.size(); b++) {
+        seen += jitter_hist[b];
+        if (seen >= need) {
+            st.jitter_p99_us = (double)(b + 1);  // 档上沿
+            break;
+        }
+    }
+    st.cpu_percent = wall_ns ? 100.0 * cpu_ns / wall_ns : 0.0;
+}
@@ -0,0 +1,101 @@
+// ============================================================================
+// 文件：HostController.h
+// 功能：上位机实时发送线程 - 按固定周期把各关节目标经传输发出
+// 说明：独立线程按绝对时间（CLOCK_MONOTONIC + TIMER_ABSTIME）定时，周期相位不随处理耗时漂移；
+//       醒来晚于下一个周期时跳过错过的周期（不补发）并计为超时。每个周期：
+//         1. 取回传输上的回复，交给DeltaSender确认；
+//         2. 调用周期回调（可选，在实时线程中运行，如轨迹播放）；
+//         3. 读取各关节最新目标（任意线程经setTarget()写入，无锁）；
+//         4. DeltaSender挑出需要发送的关节并打包，同一个包按连接写入各自的序号前缀后
+//            直接写入传输（不复制）。
+//       循环内不分配内存、不加锁。可选SCHED_FIFO优先级和CPU绑定（需要权限，失败时按普通
+//       线程运行并在统计中注明）
+// ============================================================================
+#ifndef HOST_CONTROLLER_H
+#define HOST_CONTROLLER_H
+
+#include "DeltaSender.h"
+#include "HostTransport.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class HostController;
+
+// 周期回调：cycle为周期序号，t_ns为本周期的计划时刻（CLOCK_MONOTONIC），在实时线程中调用
+typedef void (*HostCycleFn)(void* ctx, HostController& c, uint64_t cycle, uint64_t t_ns);
+
+// ============================================================================
+// 数据结构定义：HostControllerConfig
+// 功能：实时线程参数
+// ============================================================================
+struct HostControllerConfig {
+    uint32_t period_us = 10000;         //!< 发送周期（us）
+    int rt_priority = 0;                //!< SCHED_FIFO优先级（1..99），0为普通调度
+    int cpu = -1;                       //!< 绑定的CPU，-1为不绑定
+    DeltaSenderConfig delta;            //!< 增量发送参数（keyframe_rounds=1即每周期发送全部关节）
+};
+
+// ============================================================================
+// 数据结构定义：HostControllerStats
+// 功能：实时线程统计（stop()之后读取）
+// ============================================================================
+struct HostControllerStats {
+    uint64_t cycles;            //!< 执行的周期
+    uint64_t overruns;          //!< 跳过的周期（醒来时已过下一个周期）
+    uint64_t writes;            //!< 传输写入次数（包×连接）
+    uint64_t write_errors;      //!< 写入失败
+    uint64_t replies;           //!< 收到的回复
+    double jitter_mean_us;      //!< 唤醒延迟（相对计划时刻）
+    double jitter_p99_us;
+    double jitter_max_us;
+    double busy_mean_us;        //!< 每周期处理耗时
+    double busy_max_us;
+    double cpu_percent;         //!< 线程CPU时间占墙上时间的百分比
+    bool realtime;              //!< SCHED_FIFO已生效
+    bool pinned;                //!< CPU绑定已生效
+};
+
+class HostController {
+public:
+    HostController(HostTransport& transport, const HostControllerConfig& cfg = HostControllerConfig());
+    ~HostController();
+
+    // 设置关节目标（1..MAX_MOTORS），任意线程可调用，下一个周期生效
+    bool setTarget(uint8_t id, float value);
+    bool setTargetRaw(uint8_t id, int16_t raw);         //!< 已量化的原始值（按config().delta.data_type）
+    void setCycleHook(HostCycleFn fn, void* ctx);       //!< start()之前设置
+
+    bool start();                                       //!< 启动实时线程
+    void stop();                                        //!< 停止并等待线程退出
+    bool running() const { return thread.joinable(); }
+
+    static uint64_t nowNs();                            //!< CLOCK_MONOTONIC（ns）
+
+    const HostControllerStats& stats() const { return st; }
+    const DeltaSender& sender() const { return delta; }
+    const HostControllerConfig& config() const { return cfg; }
+
+private:
+    void run();
+    void finishStats(uint64_t wall_ns, uint64_t cpu_ns);
+    static void emitPacket(void* ctx, uint8_t* packet, size_t len);
+    static void onReply(void* ctx, int link, const char* text);
+
+    HostTransport& transport;
+    HostControllerConfig cfg;
+    DeltaSender delta;
+    float scale;
+    std::atomic<int32_t> targets[MAX_MOTORS + 1];       //!< 原始值，未设置为CTL_TARGET_UNSET
+    std::vector<uint16_t> seq;                          //!< 各连接的下一个序号
+    std::vector<uint32_t> jitter_hist;                  //!< 唤醒延迟直方图（1us一档，末档为溢出）
+    HostCycleFn cycle_fn = nullptr;
+    void* cycle_ctx = nullptr;
+    std::atomic<bool> stop_flag{false};
+    std::thread thread;
+    HostControllerStats st = {};
+    double jitter_sum_us = 0, busy_sum_us = 0;
+};
+
+#endif // HOST_CONTROLLER_H
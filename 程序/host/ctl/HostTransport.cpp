@@ -0,0 +1,73 @@
+// ============================================================================
+// 文件：HostTransport.cpp
+// 功能：回环传输实现
+// ============================================================================
+#include "HostTransport.h"
+
+LoopbackTransport::LoopbackTransport(const uint8_t* ids, int count) : joints(count > 0 ? count : 0, LoopbackJoint{}) {
+    for (int i = 0; i < count; i++) joints[i].id = ids[i];
+}
+
+// ============================================================================
+// 函数：LoopbackTransport::write
+// 功能：一个虚拟关节接收一帧
+// 说明：序号处理与固件cmdReceive()一致（窗口内过期/重复的帧丢弃，缺口计入丢失，远远落后时重新同步）
+// ============================================================================
+bool LoopbackTransport::write(int link, const uint8_t* data, size_t len) {
+    if (link < 0 || link >= (int)joints.size()) return false;
+    LoopbackJoint& j = joints[link];
+    j.frames++;
+    if (len >= 3 && data[0] == BLE_SEQ_PREFIX) {
+        uint16_t seq = (uint16_t)((data[1] << 8) | data[2]);
+        if (j.seq_valid) {
+            uint16_t ahead = (uint16_t)(seq - (uint16_t)(j.last_seq + 1));
+            if (ahead >= 0x8000) {
+                if ((uint16_t)(j.last_seq - seq) < CMD_SEQ_STALE_WINDOW) {
+                    j.seq_stale++;
+                    return true;
+                }
+                j.seq_resync++;
+            } else {
+                j.seq_lost += ahead;
+            }
+        }
+        j.last_seq = seq;
+        j.seq_valid = true;
+        data += 3;
+        len -= 3;
+    }
+    if (len == 0) return true;
+    if (!cmdAddressed(data, len, j.id)) {
+        j.rejected++;
+        return true;
+    }
+    CommandMsg msg;
+    uint8_t result = cmdDecode(data, len, j.id, &msg);
+    if (result != CMD_DECODE_OK) {
+        if (result != CMD_DECODE_NOT_MINE) j.invalid++;
+        return true;
+    }
+    j.accepted++;
+    j.has_target = true;
+    j.data_type = msg.data_type;
+    j.raw = msg.raw;
+    if (reply_count == LOOPBACK_REPLY_DEPTH) {
+        reply_overflows++;
+        return true;
+    }
+    Reply& r = replies[(reply_head + reply_count++) % LOOPBACK_REPLY_DEPTH];
+    r.link = link;
+    snprintf(r.text, sizeof(r.text), "%d:%s:%.2f", j.id, cmdPacketName(msg.packet_type), msg.value);
+    return true;
+}
+
+size_t LoopbackTransport::poll(HostReplyFn fn, void* ctx) {
+    size_t n = 0;
+    for (; reply_count > 0; n++) {
+        const Reply& r = replies[reply_head];
+        reply_head = (reply_head + 1) % LOOPBACK_REPLY_DEPTH;
+        reply_count--;
+        if (fn) fn(ctx, r.link, r.text);
+    }
+    return n;
+}
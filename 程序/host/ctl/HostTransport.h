@@ -0,0 +1,76 @@
+// ============================================================================
+// 文件：HostTransport.h
+// 功能：上位机传输接口 + 回环传输
+// 说明：一个传输含若干条连接（BLE每个关节一条，网关/广播为一条），
+//       写入为写无响应语义：只交给传输，不等待确认；固件的文本回复经poll()取回。
+//       实现须在HostController的实时线程中可用：write()/poll()不阻塞、不分配内存。
+//       回环传输（LoopbackTransport）不经过任何无线电：每条连接对应一个虚拟关节，
+//       收到的帧按固件的序号检查规则处理，再用固件指令层的cmdAddressed()/cmdDecode()解码，
+//       并生成与固件相同格式的回复，用于在没有硬件时测试上位机控制库
+// ============================================================================
+#ifndef HOST_TRANSPORT_H
+#define HOST_TRANSPORT_H
+
+#include "FOC.h"
+
+#include <vector>
+
+// 回复回调：link为连接序号，text为一条回复（不含换行），仅在回调期间有效
+typedef void (*HostReplyFn)(void* ctx, int link, const char* text);
+
+class HostTransport {
+public:
+    virtual ~HostTransport() {}
+    virtual int links() const = 0;                                      //!< 连接数
+    virtual bool write(int link, const uint8_t* data, size_t len) = 0;  //!< 写入一帧（可带序号前缀）
+    virtual size_t poll(HostReplyFn fn, void* ctx) = 0;                 //!< 取出已到达的回复，返回条数
+};
+
+// ============================================================================
+// 数据结构定义：LoopbackJoint
+// 功能：回环传输中一个虚拟关节的接收状态
+// ============================================================================
+struct LoopbackJoint {
+    uint8_t id;                 //!< 设备ID
+    uint32_t frames;            //!< 收到的帧
+    uint32_t accepted;          //!< 含本关节指令的帧
+    uint32_t rejected;          //!< 帧头筛选丢弃的帧
+    uint32_t invalid;           //!< 格式无效的帧
+    uint32_t seq_lost;          //!< 序号缺口累计
+    uint32_t seq_stale;         //!< 重复/过期而丢弃的帧
+    uint32_t seq_resync;        //!< 发送端重新开始计数而重新同步的次数
+    uint16_t last_seq;          //!< 最近处理的序号
+    bool seq_valid;             //!< 已收到过带序号的帧
+    bool has_target;            //!< 已收到过目标
+    uint8_t data_type;          //!< 最近目标的数据类型
+    int16_t raw;                //!< 最近目标（原始值）
+};
+
+#ifndef LOOPBACK_REPLY_DEPTH
+#define LOOPBACK_REPLY_DEPTH 64     //!< 回复队列深度，满时丢弃新回复并计数
+#endif
+
+class LoopbackTransport : public HostTransport {
+public:
+    LoopbackTransport(const uint8_t* ids, int count);
+
+    int links() const override { return (int)joints.size(); }
+    bool write(int link, const uint8_t* data, size_t len) override;
+    size_t poll(HostReplyFn fn, void* ctx) override;
+
+    const LoopbackJoint& joint(int link) const { return joints[link]; }
+    uint32_t replyOverflows() const { return reply_overflows; }
+
+private:
+    struct Reply {
+        int link;
+        char text[48];
+    };
+
+    std::vector<LoopbackJoint> joints;
+    Reply replies[LOOPBACK_REPLY_DEPTH];
+    size_t reply_head = 0, reply_count = 0;
+    uint32_t reply_overflows = 0;
+};
+
+#endif // HOST_TRANSPORT_H
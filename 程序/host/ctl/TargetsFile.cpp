@@ -0,0 +1,53 @@
+// ============================================================================
+// 文件：TargetsFile.cpp
+// 功能：targets.csv读取实现
+// ============================================================================
+#include "TargetsFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+int parseTargetsLine(const char* line, size_t len, TargetsFile& out) {
+    const char* comma = (const char*)memchr(line, ',', len);
+    if (!comma) return -1;
+    std::string key = trim(std::string(line, comma));
+    std::string val = trim(std::string(comma + 1, line + len));
+    if (!key.empty() && std::all_of(key.begin(), key.end(), ::isdigit)) {
+        val = trim(val.substr(0, val.find(',')));  // 只取第二列
+        char* end;
+        float v = strtof(val.c_str(), &end);
+        if (val.empty() || *end != '\0') return -1;
+        int id = atoi(key.c_str());
+        out.id_values[id] = v;
+        return id;
+    }
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    std::transform(val.begin(), val.end(), val.begin(), ::tolower);
+    if (key == "group_size") out.group_size = atoi(val.c_str());
+    else if (key == "per_device_hz") out.per_device_hz = (float)atof(val.c_str());
+    else if (key == "max_rounds") out.max_rounds = atoi(val.c_str());
+    else if (key == "data_type") out.data_type = val == "velocity" ? 0x02 : val == "current" ? 0x03 : 0x01;
+    else if (key == "packet_mode" || key == "packet_type")
+        out.use_struct = (val == "struct" || val == "multi_struct" || val == "03" || val == "0x03");
+    else return -1;
+    return 0;
+}
+
+bool loadTargets(const char* path, TargetsFile& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) parseTargetsLine(line, strcspn(line, "\r\n"), out);
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,33 @@
+// ============================================================================
+// 文件：TargetsFile.h
+// 功能：targets.csv读取（ID→目标值 + 分组发送配置）
+// 说明：解析规则与ble_input_output.py一致：首列为纯数字的行是"ID,值"，
+//       其余"键,值"行为配置项（键、值不区分大小写），无逗号的行和数值无效的ID行忽略
+// ============================================================================
+#ifndef TARGETS_FILE_H
+#define TARGETS_FILE_H
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// 数据结构定义：TargetsFile
+// 功能：targets.csv内容
+// ============================================================================
+struct TargetsFile {
+    std::map<int, float> id_values;     //!< ID→目标值（按ID升序）
+    int group_size = 5;                 //!< 每个分组包的关节数
+    float per_device_hz = 0;            //!< 每台设备的更新频率（0为尽快发送）
+    int max_rounds = 0;                 //!< 最大轮次（0为不限）
+    bool use_struct = false;            //!< 分组包使用MULTI_STRUCT（否则MULTI切片）
+    uint8_t data_type = 0x01;           //!< 数据类型（DATA_TYPE_ANGLE/VELOCITY/CURRENT）
+};
+
+// 读取targets.csv，文件无法打开返回false
+bool loadTargets(const char* path, TargetsFile& out);
+
+// 解析一行（len不含换行）：ID行写入id_values并返回ID，配置行更新配置并返回0，其余返回-1
+int parseTargetsLine(const char* line, size_t len, TargetsFile& out);
+
+#endif // TARGETS_FILE_H
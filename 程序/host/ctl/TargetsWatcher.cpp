@@ -0,0 +1,195 @@
+// ============================================================================
+// 文件：TargetsWatcher.cpp
+// 功能：目标文件增量读取实现
+// ============================================================================
+#include "TargetsWatcher.h"
+#include "CtlPacket.h"
+#include "HostController.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TargetsWatcher::TargetsWatcher(const char* p)
+    : path(p), id_count(MAX_MOTORS + 1, 0), sent_raw(MAX_MOTORS + 1, 0), sent_valid(MAX_MOTORS + 1, false),
+      touched(MAX_MOTORS + 1, false) {
+    size_t slash = path.rfind('/');
+    dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    name = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+TargetsWatcher::~TargetsWatcher() {
+    if (inotify_fd >= 0) close(inotify_fd);
+}
+
+bool TargetsWatcher::open() {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) return false;
+    if (inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+        return false;
+    }
+    reload();
+    return true;
+}
+
+// ============================================================================
+// 函数：TargetsWatcher::wait
+// 功能：等待本文件的写入完成/改名事件，读取后有变化的关节即返回
+// ============================================================================
+bool TargetsWatcher::wait(int timeout_ms) {
+    if (inotify_fd < 0) return false;
+    uint64_t deadline = timeout_ms >= 0 ? HostController::nowNs() + (uint64_t)timeout_ms * 1000000ull : 0;
+    for (;;) {
+        int remain = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = HostController::nowNs();
+            if (now >= deadline) return false;
+            remain = (int)((deadline - now + 999999) / 1000000);
+        }
+        pollfd p = {inotify_fd, POLLIN, 0};
+        int r = poll(&p, 1, remain);
+        if (r < 0 && errno != EINTR) return false;
+        if (r <= 0) continue;
+
+        alignas(inotify_event) char buf[4096];
+        bool relevant = false;
+        ssize_t n;
+        while ((n = read(inotify_fd, buf, sizeof(buf))) > 0) {
+            for (char* q = buf; q < buf + n;) {
+                const inotify_event* ev = (const inotify_event*)q;
+                if (ev->len > 0 && name == ev->name) relevant = true;
+                q += sizeof(inotify_event) + ev->len;
+            }
+        }
+        if (!relevant) continue;
+        st.events++;
+        st.last_event_ns = HostController::nowNs();
+        if (reload()) return true;
+    }
+}
+
+// ============================================================================
+// 函数：TargetsWatcher::reload
+// 功能：读入整个文件并与上一版比较
+// 说明：读到文件末尾为止（读取期间文件被截断或追加时以读到的内容为准），
+//       缓冲区按fstat大小预留，读满时扩大
+// ============================================================================
+bool TargetsWatcher::reload() {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        close(fd);
+        return false;
+    }
+    if (buf.size() < (size_t)sb.st_size + 1) buf.resize((size_t)sb.st_size + 1);
+    size_t len = 0;
+    for (;;) {
+        if (len == buf.size()) buf.resize(buf.size() * 2);
+        ssize_t n = pread(fd, buf.data() + len, buf.size() - len, (off_t)len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            close(fd);
+            return false;
+        }
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+    close(fd);
+    return ingest(buf.data(), len);
+}
+
+// ============================================================================
+// 函数：TargetsWatcher::countIds
+// 功能：逐行解析[begin, end)，按delta维护各ID的出现次数；out为空时只计数（旧版本区域）
+// ============================================================================
+void TargetsWatcher::countIds(const char* begin, const char* end, int delta, TargetsFile* out) {
+    TargetsFile scratch;
+    st.bytes_parsed += (uint64_t)(end - begin);
+    while (begin < end) {
+        const char* nl = (const char*)memchr(begin, '\n', (size_t)(end - begin));
+        const char* line_end = nl ? nl : end;
+        size_t len = (size_t)(line_end - begin);
+        if (len > 0 && begin[len - 1] == '\r') len--;
+        int id = parseTargetsLine(begin, len, out ? *out : scratch);
+        if (id >= 1 && id <= MAX_MOTORS) {
+            id_count[id] += delta;
+            if (out) touched[id] = true;
+        }
+        begin = nl ? nl + 1 : end;
+    }
+}
+
+// ============================================================================
+// 函数：TargetsWatcher::ingest
+// 功能：与上一版比较并解析变化的行，生成变化的关节列表
+// ============================================================================
+bool TargetsWatcher::ingest(const char* data, size_t len) {
+    changed.clear();
+    st.reloads++;
+    st.bytes_read += len;
+    if (have_prev && len == prev.size() && memcmp(data, prev.data(), len) == 0) {
+        st.unchanged++;
+        return false;
+    }
+    std::fill(touched.begin(), touched.end(), false);
+
+    bool full = !have_prev || had_dups;  // 上一版有重复ID时删掉其中一行会让另一行重新生效
+    if (!full) {
+        // 公共前缀/后缀之外的区域扩展到整行
+        size_t common = len < prev.size() ? len : prev.size();
+        size_t pre = 0;
+        while (pre < common && data[pre] == prev[pre]) pre++;
+        size_t suf = 0;
+        while (suf < common - pre && data[len - 1 - suf] == prev[prev.size() - 1 - suf]) suf++;
+        size_t b = pre;
+        while (b > 0 && data[b - 1] != '\n') b--;
+        size_t e_new = len - suf, e_old = prev.size() - suf;
+        while (e_new < len && data[e_new] != '\n') {
+            e_new++;
+            e_old++;
+        }
+        countIds(prev.data() + b, prev.data() + e_old, -1, nullptr);
+        countIds(data + b, data + e_new, +1, &file);
+        for (int id = 1; id <= MAX_MOTORS; id++) {
+            if (id_count[id] > 1) full = true;  // 重复ID：区域外的行可能生效，整个文件重新解析
+        }
+    }
+    had_dups = false;
+    if (full) {
+        TargetsFile fresh;
+        std::fill(id_count.begin(), id_count.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        countIds(data, data + len, +1, &fresh);
+        std::map<int, float> merged = file.id_values;  // 删除的行不撤销目标
+        for (auto& kv : fresh.id_values) merged[kv.first] = kv.second;
+        file = fresh;
+        file.id_values.swap(merged);
+        st.full_parses++;
+        for (int id = 1; id <= MAX_MOTORS; id++) {
+            if (id_count[id] > 1) had_dups = true;
+        }
+    }
+    prev.assign(data, data + len);
+    have_prev = true;
+
+    bool all = file.data_type != sent_data_type;
+    sent_data_type = file.data_type;
+    float scale = ctlScaleFor(file.data_type);
+    for (auto& kv : file.id_values) {
+        int id = kv.first;
+        if (id < 1 || id > MAX_MOTORS || !(all || touched[id])) continue;
+        int16_t raw = floatToInt16(kv.second, scale);
+        if (!all && sent_valid[id] && sent_raw[id] == raw) continue;
+        sent_raw[id] = raw;
+        sent_valid[id] = true;
+        changed.push_back({(uint8_t)id, kv.second});
+    }
+    st.changes += changed.size();
+    return !changed.empty();
+}
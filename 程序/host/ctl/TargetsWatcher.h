@@ -0,0 +1,84 @@
+// ============================================================================
+// 文件：TargetsWatcher.h
+// 功能：目标文件（targets.csv）增量读取 - inotify通知 + pread + 只解析变化的行
+// 说明：监听文件所在目录（IN_CLOSE_WRITE/IN_MOVED_TO，编辑器"写临时文件再改名"的保存方式
+//       同样能收到；不监听IN_MODIFY，避免读到写了一半的文件）。收到通知后用pread读入复用的缓冲区
+//       （不用mmap：其他程序原地截断文件时，读到映射中超出文件末尾的页会产生SIGBUS），
+//       与上一版内容比较公共前缀和公共后缀，只解析中间变化的行（旧版本的同一区域也解析一遍，
+//       用于维护每个ID的出现次数）；新旧任一版本有重复ID时整个文件解析，保证"后出现的行生效"。
+//       解析结果与上一次的目标按数据类型量化后比较，只把值变化的关节放入changes()。
+//       文件中删除的行不撤销已发送的目标（与ble_input_output.py一致），data_type变化时
+//       全部关节都视为变化。不在实时线程中调用
+// ============================================================================
+#ifndef TARGETS_WATCHER_H
+#define TARGETS_WATCHER_H
+
+#include "TargetsFile.h"
+
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 数据结构定义：TargetsChange
+// 功能：一个值有变化的关节
+// ============================================================================
+struct TargetsChange {
+    uint8_t id;                 //!< 关节ID（1..MAX_MOTORS）
+    float value;                //!< 新目标
+};
+
+// ============================================================================
+// 数据结构定义：TargetsWatcherStats
+// 功能：读取统计
+// ============================================================================
+struct TargetsWatcherStats {
+    uint64_t events;            //!< 收到的相关inotify事件
+    uint64_t reloads;           //!< 重新读取文件的次数
+    uint64_t unchanged;         //!< 内容与上一版相同的读取
+    uint64_t full_parses;       //!< 整个文件解析的次数（首次读取、有重复ID）
+    uint64_t bytes_read;        //!< 读入的字节累计
+    uint64_t bytes_parsed;      //!< 解析的字节累计（新旧两版）
+    uint64_t changes;           //!< 放入changes()的关节累计
+    uint64_t last_event_ns;     //!< 最近一次事件到达的时刻（CLOCK_MONOTONIC）
+};
+
+class TargetsWatcher {
+public:
+    explicit TargetsWatcher(const char* path);
+    ~TargetsWatcher();
+
+    // 开始监听并读取一次（之后changes()为文件中的全部目标；文件不存在时也可开始，出现后读取）；
+    // inotify不可用时返回false
+    bool open();
+    int fd() const { return inotify_fd; }              //!< inotify描述符（可放入poll）
+
+    // 等待文件变化（最多timeout_ms，-1为一直等），有变化的关节时返回true
+    bool wait(int timeout_ms);
+    // 立即重新读取并比较，有变化的关节时返回true
+    bool reload();
+
+    const std::vector<TargetsChange>& changes() const { return changed; }  //!< 最近一次读取的变化
+    const TargetsFile& snapshot() const { return file; }                   //!< 当前内容（含配置）
+    const TargetsWatcherStats& stats() const { return st; }
+
+private:
+    bool ingest(const char* data, size_t len);
+    void countIds(const char* begin, const char* end, int delta, TargetsFile* out);
+
+    std::string path, dir, name;
+    int inotify_fd = -1;
+    std::vector<char> prev;                 //!< 上一版文件内容
+    std::vector<char> buf;                  //!< 读取缓冲区（复用，只增不减）
+    bool have_prev = false;
+    bool had_dups = false;                  //!< 当前版本有重复ID（下次读取整个文件解析）
+    TargetsFile file;                       //!< 当前解析结果
+    std::vector<int> id_count;              //!< 每个ID在文件中出现的行数
+    std::vector<int16_t> sent_raw;          //!< 已报告的目标（量化后）
+    std::vector<bool> sent_valid;
+    std::vector<bool> touched;              //!< 本次解析到的ID
+    uint8_t sent_data_type = 0;
+    std::vector<TargetsChange> changed;
+    TargetsWatcherStats st = {};
+};
+
+#endif // TARGETS_WATCHER_H
@@ -0,0 +1,175 @@
+// ============================================================================
+// 文件：TelemetryLog.cpp
+// 功能：遥测日志读取实现
+// ============================================================================
+#include "TelemetryLog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint8_t tlog_sizes[TLOG_CH_COUNT] = {8, 2, 4, 4, 4, 4, 4, 4, 4, 2, 1, 2};
+static const char* const tlog_names[TLOG_CH_COUNT] = {"rx_ns", "seq",         "t_us",        "angle",
+                                                      "velocity", "iq",       "target",      "bus_voltage",
+                                                      "temperature", "fault", "watchdog",    "rx_seq"};
+
+size_t tlogChannelSize(int ch) { return ch >= 0 && ch < TLOG_CH_COUNT ? tlog_sizes[ch] : 0; }
+const char* tlogChannelName(int ch) { return ch >= 0 && ch < TLOG_CH_COUNT ? tlog_names[ch] : ""; }
+
+static size_t tlogAlign8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// 一个块的通道数据长度
+static size_t tlogPayloadSize(uint16_t count) {
+    size_t n = 0;
+    for (int ch = 0; ch < TLOG_CH_COUNT; ch++) n += tlogAlign8((size_t)count * tlog_sizes[ch]);
+    return n;
+}
+
+static bool tlogFail(std::string* err, const std::string& msg) {
+    if (err) *err = msg;
+    return false;
+}
+
+TelemetryLogReader::~TelemetryLogReader() { close(); }
+
+void TelemetryLogReader::close() {
+    if (base) munmap((void*)base, map_len);
+    base = nullptr;
+    map_len = 0;
+    has_index = false;
+    block_list.clear();
+}
+
+// 校验并加入偏移off处的块
+bool TelemetryLogReader::addBlock(uint64_t off, std::string* why) {
+    if (off % 8 != 0 || off < TLOG_HEADER_SIZE || off > map_len || map_len - off < TLOG_BLOCK_HEADER) {
+        return tlogFail(why, "块越界");
+    }
+    const uint8_t* h = base + off;
+    if (memcmp(h, TLOG_BLOCK_MAGIC, 4) != 0) return tlogFail(why, "块头错误");
+    TelemetryBlockRef b;
+    uint32_t payload;
+    b.device = h[4];
+    b.link = h[5];
+    memcpy(&b.count, h + 6, 2);
+    memcpy(&payload, h + 8, 4);
+    memcpy(&b.first_ns, h + 12, 8);
+    memcpy(&b.last_ns, h + 20, 8);
+    if (b.count == 0 || payload != tlogPayloadSize(b.count) || map_len - off - TLOG_BLOCK_HEADER < payload) {
+        return tlogFail(why, "块长度错误");
+    }
+    b.offset = off;
+    b.data = h + TLOG_BLOCK_HEADER;
+    block_list.push_back(b);
+    return true;
+}
+
+bool TelemetryLogReader::readIndex(uint64_t index_off, std::string* why) {
+    if (index_off > map_len - TLOG_TRAILER_SIZE || map_len - TLOG_TRAILER_SIZE - index_off < 8) {
+        return tlogFail(why, "索引越界");
+    }
+    const uint8_t* p = base + index_off;
+    uint32_t n;
+    memcpy(&n, p + 4, 4);
+    if (memcmp(p, TLOG_INDEX_MAGIC, 4) != 0 || (map_len - TLOG_TRAILER_SIZE - index_off - 8) / TLOG_INDEX_ENTRY < n) {
+        return tlogFail(why, "索引错误");
+    }
+    p += 8;
+    for (uint32_t i = 0; i < n; i++, p += TLOG_INDEX_ENTRY) {
+        uint64_t off;
+        memcpy(&off, p, 8);
+        if (!addBlock(off, why)) return false;
+        const TelemetryBlockRef& b = block_list.back();
+        if (b.device != p[24] || b.link != p[25]) return tlogFail(why, "索引与块头不符");
+    }
+    return true;
+}
+
+// 没有索引：从文件头之后逐块读取，到第一个不完整的块为止
+void TelemetryLogReader::scanBlocks() {
+    uint64_t off = TLOG_HEADER_SIZE;
+    while (addBlock(off, nullptr)) {
+        const TelemetryBlockRef& b = block_list.back();
+        off += TLOG_BLOCK_HEADER + tlogPayloadSize(b.count);
+    }
+}
+
+// ============================================================================
+// 函数：TelemetryLogReader::open
+// 功能：映射文件并建立块列表；索引损坏时退回到扫描块头
+// ============================================================================
+bool TelemetryLogReader::open(const char* path, std::string* err) {
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return tlogFail(err, std::string("无法打开 ") + path);
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < TLOG_HEADER_SIZE) {
+        ::close(fd);
+        return tlogFail(err, std::string(path) + "：文件过短");
+    }
+    size_t len = (size_t)sb.st_size;
+    void* map = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return tlogFail(err, std::string("无法映射 ") + path);
+    base = (const uint8_t*)map;
+    map_len = len;
+
+    uint16_t version, header_size, channels;
+    memcpy(&version, base + 4, 2);
+    memcpy(&header_size, base + 6, 2);
+    memcpy(&channels, base + 8, 2);
+    memcpy(&start_mono_ns, base + 16, 8);
+    memcpy(&start_real_ns, base + 24, 8);
+    std::string why;
+    if (memcmp(base, TLOG_MAGIC, 4) != 0) why = "不是遥测日志";
+    else if (version != TLOG_VERSION) why = "不支持的版本 " + std::to_string(version);
+    else if (header_size != TLOG_HEADER_SIZE || channels != TLOG_CH_COUNT) why = "文件头错误";
+    if (!why.empty()) {
+        close();
+        return tlogFail(err, std::string(path) + "：" + why);
+    }
+
+    if (len >= TLOG_HEADER_SIZE + TLOG_TRAILER_SIZE &&
+        memcmp(base + len - TLOG_TRAILER_SIZE, TLOG_TRAILER_MAGIC, 4) == 0) {
+        uint64_t index_off;
+        memcpy(&index_off, base + len - 8, 8);
+        has_index = readIndex(index_off, nullptr);
+        if (!has_index) block_list.clear();
+    }
+    if (!has_index) scanBlocks();
+    return true;
+}
+
+const void* TelemetryLogReader::column(const TelemetryBlockRef& b, int ch) const {
+    if (ch < 0 || ch >= TLOG_CH_COUNT) return nullptr;
+    const uint8_t* p = b.data;
+    for (int c = 0; c < ch; c++) p += tlogAlign8((size_t)b.count * tlog_sizes[c]);
+    return p;
+}
+
+// ============================================================================
+// 函数：TelemetryLogReader::slice
+// 功能：按块的时间范围挑出相交的块，边界块内对接收时刻二分查找
+// ============================================================================
+std::vector<TelemetrySlice> TelemetryLogReader::slice(uint64_t from_ns, uint64_t to_ns, int device) const {
+    std::vector<TelemetrySlice> out;
+    uint64_t from = start_mono_ns + from_ns;
+    uint64_t to = to_ns > UINT64_MAX - start_mono_ns ? UINT64_MAX : start_mono_ns + to_ns;
+    for (const TelemetryBlockRef& b : block_list) {
+        if (device && b.device != device) continue;
+        if (b.last_ns < from || b.first_ns >= to) continue;
+        const int64_t* rx = (const int64_t*)column(b, TLOG_CH_RX_NS);
+        uint16_t lo = 0, hi = b.count;
+        if (b.first_ns < from) {
+            lo = (uint16_t)(std::lower_bound(rx, rx + b.count, (int64_t)from) - rx);
+        }
+        if (b.last_ns >= to) {
+            hi = (uint16_t)(std::lower_bound(rx, rx + b.count, (int64_t)to) - rx);
+        }
+        if (lo < hi) out.push_back({&b, lo, hi});
+    }
+    return out;
+}
@@ -0,0 +1,114 @@
+// ============================================================================
+// 文件：TelemetryLog.h
+// 功能：遥测日志（二进制、按块分列存储）格式定义与内存映射读取
+// 说明：日志只追加：文件头之后是一个个数据块，每块为同一连接的连续若干帧遥测，
+//       块内按通道分列（上位机接收时刻、序号、Telemetry各字段）。正常关闭时在末尾写入索引
+//       （每块的偏移、设备ID、时间范围）和尾标；没有尾标的文件（进程中断）按块头顺序扫描，
+//       到第一个不完整的块为止。写入见TelemetryLogger.h
+// ============================================================================
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include "FOC.h"
+
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 日志格式（版本1，全部小端）
+// 文件头64字节：
+//   "FTLG" | 版本(u16) | 文件头长度(u16) | 通道数(u16) | 每块最多帧数(u16) | 保留(4)
+//   | 起始时刻CLOCK_MONOTONIC(ns,u64) | 起始时刻CLOCK_REALTIME(ns,u64) | 保留(32)
+// 数据块：块头32字节 "TBLK" | 设备ID(u8) | 连接(u8) | 帧数(u16) | 数据长度(u32)
+//         | 首帧接收时刻(u64) | 末帧接收时刻(u64) | 保留(4)，
+//         之后按TLOG_CH_*顺序排列各通道（帧数个元素，补齐到8字节）
+// 索引：  "TIDX" | 块数(u32) | 每块32字节：偏移(u64) | 首帧时刻(u64) | 末帧时刻(u64) | 设备ID(u8)
+//         | 连接(u8) | 帧数(u16) | 保留(4)
+// 尾标：  "TEND" | 保留(4) | 索引偏移(u64)，位于文件最后16字节
+// 接收时刻为上位机CLOCK_MONOTONIC（ns），同一连接的块按时间顺序排列
+// ============================================================================
+#define TLOG_MAGIC          "FTLG"
+#define TLOG_VERSION        1
+#define TLOG_HEADER_SIZE    64
+#define TLOG_BLOCK_MAGIC    "TBLK"
+#define TLOG_BLOCK_HEADER   32
+#define TLOG_INDEX_MAGIC    "TIDX"
+#define TLOG_INDEX_ENTRY    32
+#define TLOG_TRAILER_MAGIC  "TEND"
+#define TLOG_TRAILER_SIZE   16
+
+#define TLOG_CH_RX_NS       0   //!< 上位机接收时刻（i64，ns）
+#define TLOG_CH_SEQ         1   //!< 遥测序号（u16）
+#define TLOG_CH_T_US        2   //!< 编码器时间戳（u32，us）
+#define TLOG_CH_ANGLE       3   //!< 以下为Telemetry各字段（f32）
+#define TLOG_CH_VELOCITY    4
+#define TLOG_CH_IQ          5
+#define TLOG_CH_TARGET      6
+#define TLOG_CH_BUS_VOLTAGE 7
+#define TLOG_CH_TEMPERATURE 8
+#define TLOG_CH_FAULT       9   //!< u16
+#define TLOG_CH_WATCHDOG    10  //!< u8
+#define TLOG_CH_RX_SEQ      11  //!< u16
+#define TLOG_CH_COUNT       12
+
+size_t tlogChannelSize(int ch);             //!< 通道元素字节数
+const char* tlogChannelName(int ch);        //!< 通道名（CSV表头）
+
+// ============================================================================
+// 数据结构定义：TelemetryBlockRef
+// 功能：映射区中的一个数据块
+// ============================================================================
+struct TelemetryBlockRef {
+    const uint8_t* data;        //!< 块头之后的通道数据
+    uint64_t offset;            //!< 块头在文件中的偏移
+    uint64_t first_ns;          //!< 首帧接收时刻
+    uint64_t last_ns;           //!< 末帧接收时刻
+    uint8_t device;             //!< 设备ID（0为写入时未知）
+    uint8_t link;               //!< 连接序号
+    uint16_t count;             //!< 帧数
+};
+
+// ============================================================================
+// 数据结构定义：TelemetrySlice
+// 功能：一个块中落在时间范围内的帧[begin, end)
+// ============================================================================
+struct TelemetrySlice {
+    const TelemetryBlockRef* block;
+    uint16_t begin;
+    uint16_t end;
+};
+
+class TelemetryLogReader {
+public:
+    TelemetryLogReader() {}
+    ~TelemetryLogReader();
+    TelemetryLogReader(const TelemetryLogReader&) = delete;
+    TelemetryLogReader& operator=(const TelemetryLogReader&) = delete;
+
+    bool open(const char* path, std::string* err);     //!< 映射文件，读取索引（没有索引时扫描块头）
+    void close();
+
+    uint64_t startMonoNs() const { return start_mono_ns; }
+    uint64_t startRealNs() const { return start_real_ns; }
+    bool indexed() const { return has_index; }          //!< 文件带索引（正常关闭）
+    size_t bytes() const { return map_len; }
+    const std::vector<TelemetryBlockRef>& blocks() const { return block_list; }
+
+    // 块中某通道的起点（映射区内，按tlogChannelSize()解释）
+    const void* column(const TelemetryBlockRef& b, int ch) const;
+    // 设备device（0为全部）在[from_ns, to_ns)内的帧，时刻相对日志起点；按块顺序返回，不复制数据
+    std::vector<TelemetrySlice> slice(uint64_t from_ns, uint64_t to_ns, int device) const;
+
+private:
+    bool readIndex(uint64_t index_off, std::string* why);
+    void scanBlocks();
+    bool addBlock(uint64_t off, std::string* why);
+
+    const uint8_t* base = nullptr;
+    size_t map_len = 0;
+    uint64_t start_mono_ns = 0, start_real_ns = 0;
+    bool has_index = false;
+    std::vector<TelemetryBlockRef> block_list;
+};
+
+#endif // TELEMETRY_LOG_H
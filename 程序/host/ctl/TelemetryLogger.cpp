@@ -0,0 +1,257 @@
+// ============================================================================
+// 文件：TelemetryLogger.cpp
+// 功能：遥测记录实现
+// ============================================================================
+#include "TelemetryLogger.h"
+#include "HostController.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+static size_t loggerAlign8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+TelemetryLogger::TelemetryLogger(const TelemetryLoggerConfig& c) : cfg(c) {
+    if (cfg.links < 1) cfg.links = 1;
+    if (cfg.block_samples == 0) cfg.block_samples = 1;
+    uint64_t depth = 2;
+    while (depth < cfg.ring_depth) depth <<= 1;
+    cfg.ring_depth = (uint32_t)depth;
+    ring_mask = depth - 1;
+    rings.reset(new Ring[cfg.links]);
+    for (int i = 0; i < cfg.links; i++) rings[i].slots.reset(new Record[depth]);
+
+    size_t off = 0;
+    for (int ch = 0; ch < TLOG_CH_COUNT; ch++) {
+        channel_off.push_back(off);
+        off += loggerAlign8((size_t)cfg.block_samples * tlogChannelSize(ch));
+    }
+    blocks.resize(cfg.links);
+    for (Block& b : blocks) b.buf.resize(TLOG_BLOCK_HEADER + off);
+}
+
+TelemetryLogger::~TelemetryLogger() { close(); }
+
+void TelemetryLogger::setDevice(int link, uint8_t id) {
+    if (link >= 0 && link < cfg.links) rings[link].device.store(id, std::memory_order_relaxed);
+}
+
+bool TelemetryLogger::ingest(int link, const uint8_t* data, size_t len, uint64_t rx_ns) {
+    if (len != TELEMETRY_SIZE + 1 || data[0] != BLE_TELEMETRY_MARKER) {
+        if (link >= 0 && link < cfg.links) rings[link].rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return ingestFrame(link, data + 1, len - 1, rx_ns);
+}
+
+// ============================================================================
+// 函数：TelemetryLogger::ingestFrame
+// 功能：解码一帧并写入该连接的队列（生产者一侧，无锁）
+// ============================================================================
+bool TelemetryLogger::ingestFrame(int link, const uint8_t* frame, size_t len, uint64_t rx_ns) {
+    if (link < 0 || link >= cfg.links) return false;
+    Ring& r = rings[link];
+    Record rec;
+    if (!telemetryDecode(frame, len, &rec.seq, &rec.t)) {
+        r.rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    rec.rx_ns = rx_ns ? rx_ns : HostController::nowNs();
+    uint64_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= cfg.ring_depth) {
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    r.slots[head & ring_mask] = rec;
+    r.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool TelemetryLogger::open(const char* path, std::string* err) {
+    if (thread.joinable()) return false;
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        if (err) *err = std::string("无法创建 ") + path;
+        return false;
+    }
+    uint8_t header[TLOG_HEADER_SIZE] = {};
+    uint16_t version = TLOG_VERSION, header_size = TLOG_HEADER_SIZE, channels = TLOG_CH_COUNT;
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t mono = HostController::nowNs(), real = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    memcpy(header, TLOG_MAGIC, 4);
+    memcpy(header + 4, &version, 2);
+    memcpy(header + 6, &header_size, 2);
+    memcpy(header + 8, &channels, 2);
+    memcpy(header + 10, &cfg.block_samples, 2);
+    memcpy(header + 16, &mono, 8);
+    memcpy(header + 24, &real, 8);
+    st = TelemetryLoggerStats{};
+    file_off = 0;
+    index.clear();
+    if (!writeAll(header, sizeof(header))) {
+        ::close(fd);
+        fd = -1;
+        if (err) *err = std::string("写入失败：") + path;
+        return false;
+    }
+    stop_flag.store(false);
+    thread = std::thread(&TelemetryLogger::run, this);
+    return true;
+}
+
+// ============================================================================
+// 函数：TelemetryLogger::close
+// 功能：停止写入线程（线程退出前取空队列并写出未满的块），写入索引和尾标
+// ============================================================================
+void TelemetryLogger::close() {
+    if (!thread.joinable()) return;
+    stop_flag.store(true);
+    thread.join();
+
+    std::vector<uint8_t> buf(8 + index.size() * TLOG_INDEX_ENTRY + TLOG_TRAILER_SIZE, 0);
+    uint64_t index_off = file_off;
+    uint32_t n = (uint32_t)index.size();
+    memcpy(buf.data(), TLOG_INDEX_MAGIC, 4);
+    memcpy(buf.data() + 4, &n, 4);
+    uint8_t* p = buf.data() + 8;
+    for (const IndexEntry& e : index) {
+        memcpy(p, &e.offset, 8);
+        memcpy(p + 8, &e.first_ns, 8);
+        memcpy(p + 16, &e.last_ns, 8);
+        p[24] = e.device;
+        p[25] = e.link;
+        memcpy(p + 26, &e.count, 2);
+        p += TLOG_INDEX_ENTRY;
+    }
+    memcpy(p, TLOG_TRAILER_MAGIC, 4);
+    memcpy(p + 8, &index_off, 8);
+    writeAll(buf.data(), buf.size());
+    ::close(fd);
+    fd = -1;
+}
+
+bool TelemetryLogger::writeAll(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            st.write_errors++;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+        file_off += (uint64_t)n;
+        st.bytes += (uint64_t)n;
+    }
+    return true;
+}
+
+// 写入线程：把一条记录按通道放入该连接正在攒的块
+void TelemetryLogger::append(int link, const Record& r) {
+    Block& b = blocks[link];
+    uint8_t device = (uint8_t)rings[link].device.load(std::memory_order_relaxed);
+    if (b.count > 0 && device != b.device) writeBlock(link);  // 设备ID变化：不同ID不放在同一块
+    uint64_t rx_ns = r.rx_ns < b.last_ns ? b.last_ns : r.rx_ns;  // 保持块内外接收时刻不减（读取时二分查找）
+    if (b.count == 0) {
+        b.device = device;
+        b.first_ns = rx_ns;
+        b.opened_ns = HostController::nowNs();
+    }
+    b.last_ns = rx_ns;
+    uint8_t* d = b.buf.data() + TLOG_BLOCK_HEADER;
+    size_t i = b.count;
+    memcpy(d + channel_off[TLOG_CH_RX_NS] + i * 8, &rx_ns, 8);
+    memcpy(d + channel_off[TLOG_CH_SEQ] + i * 2, &r.seq, 2);
+    memcpy(d + channel_off[TLOG_CH_T_US] + i * 4, &r.t.t_us, 4);
+    memcpy(d + channel_off[TLOG_CH_ANGLE] + i * 4, &r.t.angle, 4);
+    memcpy(d + channel_off[TLOG_CH_VELOCITY] + i * 4, &r.t.velocity, 4);
+    memcpy(d + channel_off[TLOG_CH_IQ] + i * 4, &r.t.iq, 4);
+    memcpy(d + channel_off[TLOG_CH_TARGET] + i * 4, &r.t.target, 4);
+    memcpy(d + channel_off[TLOG_CH_BUS_VOLTAGE] + i * 4, &r.t.bus_voltage, 4);
+    memcpy(d + channel_off[TLOG_CH_TEMPERATURE] + i * 4, &r.t.temperature, 4);
+    memcpy(d + channel_off[TLOG_CH_FAULT] + i * 2, &r.t.fault, 2);
+    d[channel_off[TLOG_CH_WATCHDOG] + i] = r.t.watchdog;
+    memcpy(d + channel_off[TLOG_CH_RX_SEQ] + i * 2, &r.t.rx_seq, 2);
+    if (++b.count == cfg.block_samples) writeBlock(link);
+}
+
+// ============================================================================
+// 函数：TelemetryLogger::writeBlock
+// 功能：写出一个连接正在攒的块；未满的块把各通道依次前移，使通道长度与帧数一致
+// ============================================================================
+void TelemetryLogger::writeBlock(int link) {
+    Block& b = blocks[link];
+    if (b.count == 0) return;
+    uint8_t* d = b.buf.data() + TLOG_BLOCK_HEADER;
+    size_t pos = 0;
+    for (int ch = 0; ch < TLOG_CH_COUNT; ch++) {
+        size_t n = (size_t)b.count * tlogChannelSize(ch);
+        if (pos != channel_off[ch]) memmove(d + pos, d + channel_off[ch], n);
+        memset(d + pos + n, 0, loggerAlign8(n) - n);
+        pos += loggerAlign8(n);
+    }
+    uint8_t* h = b.buf.data();
+    uint32_t payload = (uint32_t)pos;
+    memset(h, 0, TLOG_BLOCK_HEADER);
+    memcpy(h, TLOG_BLOCK_MAGIC, 4);
+    h[4] = b.device;
+    h[5] = (uint8_t)link;
+    memcpy(h + 6, &b.count, 2);
+    memcpy(h + 8, &payload, 4);
+    memcpy(h + 12, &b.first_ns, 8);
+    memcpy(h + 20, &b.last_ns, 8);
+    uint64_t off = file_off;
+    if (writeAll(h, TLOG_BLOCK_HEADER + pos)) {
+        index.push_back({off, b.first_ns, b.last_ns, b.device, (uint8_t)link, b.count});
+        st.blocks++;
+    }
+    b.count = 0;
+}
+
+// 写入线程：取空一个连接的队列，返回是否取到数据
+bool TelemetryLogger::drain(int link, uint64_t now_ns) {
+    Ring& r = rings[link];
+    uint64_t head = r.head.load(std::memory_order_acquire);
+    uint64_t tail = r.tail.load(std::memory_order_relaxed);
+    if (head - tail > st.max_fill) st.max_fill = (uint32_t)(head - tail);
+    for (uint64_t i = tail; i < head; i++) {
+        append(link, r.slots[i & ring_mask]);
+        if ((i & 255) == 255) r.tail.store(i + 1, std::memory_order_release);  // 大量积压时分段归还槽位
+    }
+    r.tail.store(head, std::memory_order_release);
+    Block& b = blocks[link];
+    if (b.count > 0 && now_ns >= b.opened_ns + (uint64_t)cfg.flush_ms * 1000000ull) writeBlock(link);
+    return head != tail;
+}
+
+void TelemetryLogger::run() {
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        uint64_t now = HostController::nowNs();
+        bool any = false;
+        for (int link = 0; link < cfg.links; link++) any |= drain(link, now);
+        if (!any) {
+            timespec ts = {0, (long)cfg.poll_us * 1000};
+            nanosleep(&ts, nullptr);
+        }
+    }
+    for (int link = 0; link < cfg.links; link++) {
+        drain(link, UINT64_MAX);
+        writeBlock(link);
+    }
+}
+
+TelemetryLoggerStats TelemetryLogger::stats() const {
+    TelemetryLoggerStats s = {};
+    if (!thread.joinable()) s = st;  // 写入线程一侧的计数只在停止后读取
+    s.frames = s.dropped = s.rejected = 0;
+    for (int i = 0; i < cfg.links; i++) {
+        s.frames += rings[i].head.load(std::memory_order_relaxed);
+        s.dropped += rings[i].dropped.load(std::memory_order_relaxed);
+        s.rejected += rings[i].rejected.load(std::memory_order_relaxed);
+    }
+    return s;
+}
@@ -0,0 +1,114 @@
+// ============================================================================
+// 文件：TelemetryLogger.h
+// 功能：遥测记录 - 各连接的二进制遥测通知无锁入队，写入线程按块分列追加到日志文件
+// 说明：每个连接一个单生产者/单消费者环形队列：通知回调（生产者）解码后写入一个槽位并发布，
+//       不加锁、不分配内存、不做系统调用；队列满时丢弃并计数，从不阻塞回调。
+//       同一连接的通知须由同一线程送入（各连接的通知回调各自串行，满足这一条件）。
+//       写入线程定期取出各队列，按连接攒满一块（block_samples帧）即写入文件，
+//       每flush_ms把未满的块也写出，日志文件在记录过程中即可读取（TelemetryLogReader扫描块头）。
+//       close()写出剩余数据、索引和尾标。格式见TelemetryLog.h
+// ============================================================================
+#ifndef TELEMETRY_LOGGER_H
+#define TELEMETRY_LOGGER_H
+
+#include "TelemetryLog.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// ============================================================================
+// 数据结构定义：TelemetryLoggerConfig
+// 功能：记录参数
+// ============================================================================
+struct TelemetryLoggerConfig {
+    int links = MAX_MOTORS;             //!< 连接数（每个连接一个队列）
+    uint32_t ring_depth = 8192;         //!< 每个队列的槽位数（向上取整到2的幂）
+    uint16_t block_samples = 1024;      //!< 每块最多帧数
+    uint32_t flush_ms = 200;            //!< 未满的块最长停留时间
+    uint32_t poll_us = 1000;            //!< 写入线程空闲时的轮询间隔
+};
+
+// ============================================================================
+// 数据结构定义：TelemetryLoggerStats
+// 功能：记录统计（close()之后读取，frames/dropped/rejected也可在记录中读取）
+// ============================================================================
+struct TelemetryLoggerStats {
+    uint64_t frames;            //!< 入队的遥测帧
+    uint64_t dropped;           //!< 队列满而丢弃的帧
+    uint64_t rejected;          //!< 不是遥测的通知（文本回复等）
+    uint64_t blocks;            //!< 写入的块
+    uint64_t bytes;             //!< 写入的字节（含文件头、索引）
+    uint64_t write_errors;      //!< 写入失败
+    uint32_t max_fill;          //!< 队列最高占用（槽位）
+};
+
+class TelemetryLogger {
+public:
+    explicit TelemetryLogger(const TelemetryLoggerConfig& cfg = TelemetryLoggerConfig());
+    ~TelemetryLogger();
+
+    bool open(const char* path, std::string* err);      //!< 创建日志文件并启动写入线程
+    void close();                                       //!< 写出剩余数据和索引，停止写入线程
+
+    // 设置连接对应的设备ID（如由"<id>:..."回复得知），之后写出的块记录该ID
+    void setDevice(int link, uint8_t id);
+
+    // 送入一条BLE通知（BLE_TELEMETRY_MARKER + 遥测帧）；不是遥测时返回false（调用方按文本处理）。
+    // rx_ns为接收时刻（CLOCK_MONOTONIC），0为取当前时刻
+    bool ingest(int link, const uint8_t* data, size_t len, uint64_t rx_ns = 0);
+    // 送入一帧不带标记的遥测（串口链路等，TELEMETRY_SIZE字节）
+    bool ingestFrame(int link, const uint8_t* frame, size_t len, uint64_t rx_ns = 0);
+
+    TelemetryLoggerStats stats() const;
+
+private:
+    struct Record {
+        uint64_t rx_ns;
+        uint16_t seq;
+        Telemetry t;
+    };
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head{0};      //!< 生产者写入位置
+        char pad0[64 - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t> tail{0};      //!< 写入线程读取位置
+        char pad1[64 - sizeof(std::atomic<uint64_t>)];
+        // head即累计入队的帧数
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint32_t> device{0};
+        std::unique_ptr<Record[]> slots;
+    };
+    struct Block {
+        std::vector<uint8_t> buf;           //!< 块头 + 各通道（按block_samples预留）
+        uint16_t count = 0;
+        uint8_t device = 0;
+        uint64_t first_ns = 0, last_ns = 0;
+        uint64_t opened_ns = 0;             //!< 第一帧放入的时刻（决定何时写出未满的块）
+    };
+    struct IndexEntry {
+        uint64_t offset, first_ns, last_ns;
+        uint8_t device, link;
+        uint16_t count;
+    };
+
+    void run();
+    bool drain(int link, uint64_t now_ns);
+    void append(int link, const Record& r);
+    void writeBlock(int link);
+    bool writeAll(const void* data, size_t len);
+
+    TelemetryLoggerConfig cfg;
+    uint64_t ring_mask;
+    std::unique_ptr<Ring[]> rings;
+    std::vector<Block> blocks;
+    std::vector<size_t> channel_off;        //!< 满块时各通道在块数据中的偏移
+    std::vector<IndexEntry> index;
+    int fd = -1;
+    uint64_t file_off = 0;
+    std::atomic<bool> stop_flag{false};
+    std::thread thread;
+    TelemetryLoggerStats st = {};
+};
+
+#endif // TELEMETRY_LOGGER_H
@@ -0,0 +1,400 @@
+// ============================================================================
+// 文件：Trajectory.cpp
+// 功能：轨迹文件写入、CSV转换与内存映射读取实现
+// ============================================================================
+#include "Trajectory.h"
+#include "TargetsFile.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t trajAlign8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// 各列种类的缩放系数（int16格式）
+static float trajScale(uint8_t data_type, int kind) {
+    return ctlScaleFor(kind == TRAJ_KIND_FEEDFORWARD ? DATA_TYPE_CURRENT : data_type);
+}
+
+static bool trajKindPresent(uint32_t columns, int kind) {
+    if (kind == TRAJ_KIND_VELOCITY) return (columns & TRAJ_COL_VELOCITY) != 0;
+    if (kind == TRAJ_KIND_FEEDFORWARD) return (columns & TRAJ_COL_FEEDFORWARD) != 0;
+    return true;
+}
+
+static bool trajFail(std::string* err, const std::string& msg) {
+    if (err) *err = msg;
+    return false;
+}
+
+// ============================================================================
+// 函数：trajectoryWrite
+// 功能：按格式写出文件头、关节表和各列（先写临时文件再改名，播放中的文件不会被写坏）
+// ============================================================================
+bool trajectoryWrite(const char* path, const TrajectoryData& d, std::string* err) {
+    int joints = (int)d.ids.size();
+    if (joints < 1 || joints > MAX_MOTORS) return trajFail(err, "关节数须为1.." + std::to_string(MAX_MOTORS));
+    for (uint8_t id : d.ids) {
+        if (id < 1 || id > MAX_MOTORS) return trajFail(err, "关节ID超出范围：" + std::to_string(id));
+    }
+    if (!(d.rate_hz > 0) || !std::isfinite(d.rate_hz)) return trajFail(err, "采样率须大于0");
+    if (d.format != TRAJ_FORMAT_INT16 && d.format != TRAJ_FORMAT_FLOAT32) return trajFail(err, "未知的样本格式");
+    if ((int)d.values[TRAJ_KIND_TARGET].size() != joints) return trajFail(err, "目标列数与关节数不一致");
+    uint64_t samples = d.values[TRAJ_KIND_TARGET][0].size();
+    for (int k = 0; k < TRAJ_KIND_COUNT; k++) {
+        if (!trajKindPresent(d.columns, k)) continue;
+        if ((int)d.values[k].size() != joints) return trajFail(err, "可选列数与关节数不一致");
+        for (const auto& col : d.values[k]) {
+            if (col.size() != samples) return trajFail(err, "各列样本数不一致");
+        }
+    }
+    if (samples == 0) return trajFail(err, "没有样本");
+
+    size_t elem = d.format == TRAJ_FORMAT_INT16 ? sizeof(int16_t) : sizeof(float);
+    size_t stride = trajAlign8((size_t)samples * elem);
+    uint64_t table_off = TRAJ_HEADER_SIZE;
+    uint64_t data_off = table_off + trajAlign8((size_t)joints);
+
+    uint8_t header[TRAJ_HEADER_SIZE] = {};
+    uint16_t version = TRAJ_VERSION, header_size = TRAJ_HEADER_SIZE, joint_count = (uint16_t)joints;
+    memcpy(header + 0, TRAJ_MAGIC, 4);
+    memcpy(header + 4, &version, 2);
+    memcpy(header + 6, &header_size, 2);
+    memcpy(header + 8, &d.columns, 4);
+    memcpy(header + 12, &joint_count, 2);
+    header[14] = d.data_type;
+    header[15] = d.format;
+    memcpy(header + 16, &d.rate_hz, 8);
+    memcpy(header + 24, &samples, 8);
+    memcpy(header + 32, &table_off, 8);
+    memcpy(header + 40, &data_off, 8);
+
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return trajFail(err, "无法写入 " + tmp);
+    bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+    std::vector<uint8_t> table(trajAlign8((size_t)joints), 0);
+    memcpy(table.data(), d.ids.data(), (size_t)joints);
+    ok = ok && fwrite(table.data(), 1, table.size(), f) == table.size();
+
+    std::vector<uint8_t> col(stride);
+    for (int k = 0; k < TRAJ_KIND_COUNT && ok; k++) {
+        if (!trajKindPresent(d.columns, k)) continue;
+        float scale = trajScale(d.data_type, k);
+        for (int j = 0; j < joints && ok; j++) {
+            std::fill(col.begin(), col.end(), 0);
+            const std::vector<float>& src = d.values[k][j];
+            for (uint64_t i = 0; i < samples; i++) {
+                if (d.format == TRAJ_FORMAT_INT16) {
+                    if (fabsf(src[i] * scale) > 32767.0f) {
+                        fclose(f);
+                        remove(tmp.c_str());
+                        return trajFail(err, "关节" + std::to_string(d.ids[j]) + "的值超出int16范围，请改用浮点格式");
+                    }
+                    int16_t raw = floatToInt16(src[i], scale);  // 与HostController::setTarget()相同的量化
+                    memcpy(col.data() + i * elem, &raw, elem);
+                } else {
+                    memcpy(col.data() + i * elem, &src[i], elem);
+                }
+            }
+            ok = fwrite(col.data(), 1, stride, f) == stride;
+        }
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path) != 0) {
+        remove(tmp.c_str());
+        return trajFail(err, std::string("写入失败：") + path);
+    }
+    return true;
+}
+
+// 拆分一行CSV（去掉首尾空白），返回列数
+static size_t trajSplit(const std::string& line, std::vector<std::string>& cells) {
+    cells.clear();
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        std::string cell = line.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t b = cell.find_first_not_of(" \t\r\n");
+        size_t e = cell.find_last_not_of(" \t\r\n");
+        cells.push_back(b == std::string::npos ? "" : cell.substr(b, e - b + 1));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return cells.size();
+}
+
+// ============================================================================
+// 函数：trajFromWideCsv
+// 功能：读取每行一个样本的CSV；空白单元格沿用上一个样本的值，#开头的行为注释
+// ============================================================================
+static bool trajFromWideCsv(const char* path, double rate_hz, TrajectoryData& out, std::string* err) {
+    FILE* f = fopen(path, "r");
+    if (!f) return trajFail(err, std::string("无法打开 ") + path);
+
+    struct Column {
+        int kind;       //!< TRAJ_KIND_*，-1为时间列
+        int joint;
+    };
+    std::vector<Column> map;
+    std::vector<std::string> cells;
+    std::vector<double> times;
+    out = TrajectoryData();
+    out.data_type = DATA_TYPE_ANGLE;
+
+    char buf[4096];
+    std::string line;
+    bool have_header = false;
+    int line_no = 0;
+    auto fail = [&](const std::string& msg) {
+        fclose(f);
+        return trajFail(err, std::string(path) + ":" + std::to_string(line_no) + "：" + msg);
+    };
+    while (fgets(buf, sizeof(buf), f)) {
+        line = buf;
+        line_no++;
+        size_t b = line.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos || line[b] == '#') continue;
+        trajSplit(line, cells);
+
+        if (!have_header) {
+            // 表头：先收集目标列确定关节顺序，再对应速度/前馈列
+            std::vector<std::pair<int, int>> pending;  // (种类, ID)
+            for (const std::string& c : cells) {
+                int kind = TRAJ_KIND_TARGET;
+                const char* digits = c.c_str();
+                if (c == "t" || c == "time") {
+                    pending.push_back({-1, 0});
+                    continue;
+                } else if (c.compare(0, 2, "ff") == 0) {
+                    kind = TRAJ_KIND_FEEDFORWARD;
+                    digits += 2;
+                } else if (c.compare(0, 1, "v") == 0) {
+                    kind = TRAJ_KIND_VELOCITY;
+                    digits += 1;
+                }
+                char* end;
+                long id = strtol(digits, &end, 10);
+                if (*digits == '\0' || *end != '\0') return fail("无法识别的列名 \"" + c + "\"");
+                if (id < 1 || id > MAX_MOTORS) return fail("关节ID超出范围 \"" + c + "\"");
+                pending.push_back({kind, (int)id});
+                if (kind == TRAJ_KIND_TARGET) {
+                    for (uint8_t existing : out.ids) {
+                        if (existing == id) return fail("重复的关节列 \"" + c + "\"");
+                    }
+                    out.ids.push_back((uint8_t)id);
+                }
+            }
+            if (out.ids.empty()) return fail("表头中没有关节目标列");
+            for (auto& p : pending) {
+                if (p.first < 0) {
+                    map.push_back({-1, 0});
+                    continue;
+                }
+                int joint = -1;
+                for (size_t j = 0; j < out.ids.size(); j++) {
+                    if (out.ids[j] == p.second) joint = (int)j;
+                }
+                if (joint < 0) return fail("列 v/ff" + std::to_string(p.second) + " 没有对应的目标列");
+                if (p.first == TRAJ_KIND_VELOCITY) out.columns |= TRAJ_COL_VELOCITY;
+                if (p.first == TRAJ_KIND_FEEDFORWARD) out.columns |= TRAJ_COL_FEEDFORWARD;
+                map.push_back({p.first, joint});
+            }
+            for (int k = 0; k < TRAJ_KIND_COUNT; k++) out.values[k].resize(out.ids.size());
+            have_header = true;
+            continue;
+        }
+
+        if (cells.size() > map.size()) return fail("列数多于表头");
+        size_t n = out.values[TRAJ_KIND_TARGET][0].size();
+        for (int k = 0; k < TRAJ_KIND_COUNT; k++) {
+            for (auto& col : out.values[k]) col.push_back(n ? col.back() : 0.0f);
+        }
+        for (size_t c = 0; c < cells.size(); c++) {
+            if (cells[c].empty()) continue;
+            char* end;
+            double v = strtod(cells[c].c_str(), &end);
+            if (*end != '\0' || !std::isfinite(v)) return fail("不是数字 \"" + cells[c] + "\"");
+            if (map[c].kind == -1) times.push_back(v);
+            else out.values[map[c].kind][map[c].joint].back() = (float)v;
+        }
+    }
+    fclose(f);
+    if (!have_header) return trajFail(err, std::string(path) + "：没有表头");
+    size_t n = out.values[TRAJ_KIND_TARGET][0].size();
+    if (n == 0) return trajFail(err, std::string(path) + "：没有样本");
+
+    if (rate_hz > 0) {
+        out.rate_hz = rate_hz;
+    } else {
+        if (times.size() != n || n < 2) return trajFail(err, "未指定采样率，且没有完整的t列可推算");
+        double dt = (times.back() - times.front()) / (double)(n - 1);
+        if (!(dt > 0)) return trajFail(err, "t列须递增");
+        for (size_t i = 1; i < n; i++) {
+            if (fabs(times[i] - times[i - 1] - dt) > 0.01 * dt) {
+                return trajFail(err, "t列不等间隔（第" + std::to_string(i + 1) + "个样本），请先重采样或指定采样率");
+            }
+        }
+        out.rate_hz = 1.0 / dt;
+    }
+    for (int k = 0; k < TRAJ_KIND_COUNT; k++) {
+        if (!trajKindPresent(out.columns, k)) out.values[k].clear();
+    }
+    return true;
+}
+
+// ============================================================================
+// 函数：trajReadTargets
+// 功能：按targets.csv快照格式读取（每行"ID,值"或"键,值"配置项，#开头的行为注释）
+// 返回值：每一行都符合快照格式且至少有一个关节时返回true；has_config给出是否有配置行
+// ============================================================================
+static bool trajReadTargets(const char* path, TargetsFile& out, bool* has_config) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    bool ok = true;
+    *has_config = false;
+    while (ok && fgets(line, sizeof(line), f)) {
+        size_t len = strcspn(line, "\r\n");
+        size_t b = strspn(line, " \t");
+        if (b >= len || line[b] == '#') continue;
+        int id = parseTargetsLine(line, len, out);
+        if (id == 0) *has_config = true;
+        ok = id == 0 || (id >= 1 && id <= MAX_MOTORS);
+    }
+    fclose(f);
+    return ok && !out.id_values.empty();
+}
+
+// ============================================================================
+// 函数：trajectoryFromCsv
+// 功能：CSV转换入口，识别两种格式
+// 说明：有配置行的targets.csv快照直接按快照读取；否则按每行一个样本的格式读取，
+//       失败且文件全部为"ID,值"行时再按快照读取（"1,60"作为表头会被当成关节1和60）。
+//       快照转换为只有一个样本的轨迹，采样率取rate_hz，未指定时取per_device_hz（默认1Hz）
+// ============================================================================
+bool trajectoryFromCsv(const char* path, double rate_hz, TrajectoryData& out, std::string* err) {
+    TargetsFile snap;
+    bool has_config = false;
+    bool is_snapshot = trajReadTargets(path, snap, &has_config);
+    if (!is_snapshot || !has_config) {
+        std::string wide_err;
+        if (trajFromWideCsv(path, rate_hz, out, &wide_err)) return true;
+        if (!is_snapshot) return trajFail(err, wide_err);
+    }
+
+    out = TrajectoryData();
+    out.data_type = snap.data_type;
+    out.rate_hz = rate_hz > 0 ? rate_hz : snap.per_device_hz > 0 ? snap.per_device_hz : 1.0;
+    out.values[TRAJ_KIND_TARGET].resize(snap.id_values.size());
+    size_t j = 0;
+    for (auto& kv : snap.id_values) {
+        out.ids.push_back((uint8_t)kv.first);
+        out.values[TRAJ_KIND_TARGET][j++].push_back(kv.second);
+    }
+    return true;
+}
+
+TrajectoryFile::~TrajectoryFile() { close(); }
+
+void TrajectoryFile::close() {
+    if (base) munmap((void*)base, map_len);
+    base = nullptr;
+    map_len = 0;
+    joint_count = 0;
+    sample_count = 0;
+}
+
+// ============================================================================
+// 函数：TrajectoryFile::open
+// 功能：映射文件并校验；任何一段越界都拒绝打开（播放时不再做范围检查）
+// ============================================================================
+bool TrajectoryFile::open(const char* path, std::string* err) {
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return trajFail(err, std::string("无法打开 ") + path);
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < TRAJ_HEADER_SIZE) {
+        ::close(fd);
+        return trajFail(err, std::string(path) + "：文件过短");
+    }
+    size_t len = (size_t)sb.st_size;
+    void* map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return trajFail(err, std::string("无法映射 ") + path);
+    madvise(map, len, MADV_WILLNEED);
+    base = (const uint8_t*)map;
+    map_len = len;
+
+    uint16_t version, header_size, joints;
+    uint64_t table_off, data_off;
+    memcpy(&version, base + 4, 2);
+    memcpy(&header_size, base + 6, 2);
+    memcpy(&column_flags, base + 8, 4);
+    memcpy(&joints, base + 12, 2);
+    data_type = base[14];
+    sample_format = base[15];
+    memcpy(&rate_hz, base + 16, 8);
+    memcpy(&sample_count, base + 24, 8);
+    memcpy(&table_off, base + 32, 8);
+    memcpy(&data_off, base + 40, 8);
+
+    std::string why;
+    if (memcmp(base, TRAJ_MAGIC, 4) != 0) why = "不是轨迹文件";
+    else if (version != TRAJ_VERSION) why = "不支持的版本 " + std::to_string(version);
+    else if (header_size < TRAJ_HEADER_SIZE || header_size > len) why = "文件头长度错误";
+    else if (joints < 1 || joints > MAX_MOTORS) why = "关节数错误";
+    else if (data_type < DATA_TYPE_ANGLE || data_type > DATA_TYPE_CURRENT) why = "数据类型错误";
+    else if (sample_format != TRAJ_FORMAT_INT16 && sample_format != TRAJ_FORMAT_FLOAT32) why = "样本格式错误";
+    else if (!(rate_hz > 0) || !std::isfinite(rate_hz)) why = "采样率错误";
+    else if (sample_count == 0 || sample_count > len) why = "样本数错误";
+    else if (table_off < header_size || table_off > len || len - table_off < joints) why = "关节表越界";
+    if (why.empty()) {
+        size_t elem = sample_format == TRAJ_FORMAT_INT16 ? sizeof(int16_t) : sizeof(float);
+        column_stride = trajAlign8((size_t)sample_count * elem);
+        int kinds = 0;
+        for (int k = 0; k < TRAJ_KIND_COUNT; k++) kinds += trajKindPresent(column_flags, k) ? 1 : 0;
+        if (data_off % 8 != 0 || data_off > len || (len - data_off) / column_stride < (uint64_t)kinds * joints) {
+            why = "数据段越界";
+        }
+        joint_ids = base + table_off;
+        for (int j = 0; j < joints && why.empty(); j++) {
+            if (joint_ids[j] < 1 || joint_ids[j] > MAX_MOTORS) why = "关节ID错误";
+        }
+        const uint8_t* p = base + data_off;
+        for (int k = 0; k < TRAJ_KIND_COUNT; k++) {
+            kind_base[k] = trajKindPresent(column_flags, k) ? p : nullptr;
+            if (kind_base[k]) p += column_stride * joints;
+        }
+    }
+    if (!why.empty()) {
+        close();
+        return trajFail(err, std::string(path) + "：" + why);
+    }
+    joint_count = joints;
+    return true;
+}
+
+void TrajectoryFile::prefault() const {
+    volatile uint8_t sink = 0;
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < map_len; off += (size_t)page) sink = sink + base[off];
+    (void)sink;
+}
+
+const void* TrajectoryFile::column(int kind, int joint) const {
+    if (kind < 0 || kind >= TRAJ_KIND_COUNT || !kind_base[kind] || joint < 0 || joint >= joint_count) return nullptr;
+    return kind_base[kind] + column_stride * (size_t)joint;
+}
+
+float TrajectoryFile::value(int kind, int joint, uint64_t sample) const {
+    const void* col = column(kind, joint);
+    if (!col || sample >= sample_count) return 0.0f;
+    if (sample_format == TRAJ_FORMAT_FLOAT32) return ((const float*)col)[sample];
+    return int16ToFloat(((const int16_t*)col)[sample], trajScale(data_type, kind));
+}
@@ -0,0 +1,105 @@
+// ============================================================================
+// 文件：Trajectory.h
+// 功能：多关节轨迹文件（二进制、按列存储）的写入与内存映射读取
+// 说明：一个文件保存若干关节在固定采样率下的目标序列，可选速度/前馈列。
+//       读取时mmap整个文件，列直接指向映射区（不解析、不复制），播放见TrajectoryPlayer.h。
+//       速度/前馈列随文件保存并可由读取方取用；当前的目标数据包只下发目标列
+// ============================================================================
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "CtlPacket.h"
+
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 轨迹格式（版本1，全部小端）
+// 文件头64字节：
+//   "FTRJ" | 版本(u16) | 文件头长度(u16) | 列标志(u32) | 关节数(u16) | 数据类型(u8) | 样本格式(u8)
+//   | 采样率Hz(f64) | 样本数(u64) | 关节表偏移(u64) | 数据偏移(u64) | 保留(16)
+// 关节表：关节数个设备ID(u8)，补齐到8字节
+// 数据：按"列种类 → 关节"顺序排列的列，每列为样本数个元素（int16原始值或float32），
+//       列长补齐到8字节。列种类依次为目标、速度（TRAJ_COL_VELOCITY）、前馈（TRAJ_COL_FEEDFORWARD），
+//       未置位的种类不占空间。int16原始值的缩放与数据包相同：目标/速度列按ctlScaleFor(数据类型)，
+//       前馈列按电流（DATA_TYPE_CURRENT）。读取方按文件头中的偏移定位，文件头变长时仍可读
+// ============================================================================
+#define TRAJ_MAGIC          "FTRJ"
+#define TRAJ_VERSION        1
+#define TRAJ_HEADER_SIZE    64
+
+#define TRAJ_COL_VELOCITY    0x01   //!< 含速度列（单位同目标/秒）
+#define TRAJ_COL_FEEDFORWARD 0x02   //!< 含前馈列（电流，A）
+
+#define TRAJ_FORMAT_INT16    0      //!< 样本为量化后的原始值（与数据包相同）
+#define TRAJ_FORMAT_FLOAT32  1      //!< 样本为浮点
+
+#define TRAJ_KIND_TARGET      0     //!< 列种类
+#define TRAJ_KIND_VELOCITY    1
+#define TRAJ_KIND_FEEDFORWARD 2
+#define TRAJ_KIND_COUNT       3
+
+// ============================================================================
+// 数据结构定义：TrajectoryData
+// 功能：写入用的轨迹内容（内存中，按列）
+// ============================================================================
+struct TrajectoryData {
+    std::vector<uint8_t> ids;                           //!< 关节ID
+    double rate_hz = 100.0;                             //!< 采样率
+    uint8_t data_type = DATA_TYPE_ANGLE;                //!< 数据类型
+    uint8_t format = TRAJ_FORMAT_INT16;                 //!< 样本格式
+    uint32_t columns = 0;                               //!< 可选列（TRAJ_COL_*）
+    std::vector<std::vector<float>> values[TRAJ_KIND_COUNT];  //!< [种类][关节][样本]
+};
+
+// 写入轨迹文件，失败时err给出原因
+bool trajectoryWrite(const char* path, const TrajectoryData& d, std::string* err);
+
+// 从CSV转换：表头为"t"（可选，秒）、"<ID>"（目标）、"v<ID>"（速度）、"ff<ID>"（前馈），
+// 之后每行一个样本；rate_hz>0时用指定采样率，否则由t列推算（t须等间隔）。
+// targets.csv快照（每行"ID,值"及"键,值"配置）转换为只有一个样本的轨迹，数据类型取文件中的data_type
+bool trajectoryFromCsv(const char* path, double rate_hz, TrajectoryData& out, std::string* err);
+
+// ============================================================================
+// 类：TrajectoryFile
+// 功能：只读映射一个轨迹文件
+// ============================================================================
+class TrajectoryFile {
+public:
+    TrajectoryFile() {}
+    ~TrajectoryFile();
+    TrajectoryFile(const TrajectoryFile&) = delete;
+    TrajectoryFile& operator=(const TrajectoryFile&) = delete;
+
+    bool open(const char* path, std::string* err);     //!< 映射并校验文件头、各段范围
+    void close();
+
+    int joints() const { return joint_count; }
+    uint8_t id(int joint) const { return joint_ids[joint]; }
+    uint64_t samples() const { return sample_count; }
+    double rate() const { return rate_hz; }
+    uint8_t dataType() const { return data_type; }
+    uint8_t format() const { return sample_format; }
+    uint32_t columns() const { return column_flags; }
+    size_t bytes() const { return map_len; }
+    void prefault() const;                              //!< 逐页读一遍，播放时不再缺页
+
+    // 列起点（映射区内），该种类不存在时返回nullptr；按format()取int16或float
+    const void* column(int kind, int joint) const;
+    // 单个样本（换算为目标单位），用于不在意格式的读取方
+    float value(int kind, int joint, uint64_t sample) const;
+
+private:
+    const uint8_t* base = nullptr;
+    size_t map_len = 0;
+    int joint_count = 0;
+    const uint8_t* joint_ids = nullptr;
+    uint64_t sample_count = 0;
+    double rate_hz = 0;
+    uint8_t data_type = 0, sample_format = 0;
+    uint32_t column_flags = 0;
+    const uint8_t* kind_base[TRAJ_KIND_COUNT] = {};
+    size_t column_stride = 0;
+};
+
+#endif // TRAJECTORY_H
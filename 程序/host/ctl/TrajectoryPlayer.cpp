@@ -0,0 +1,74 @@
+// ============================================================================
+// 文件：TrajectoryPlayer.cpp
+// 功能：轨迹播放实现
+// ============================================================================
+#include "TrajectoryPlayer.h"
+
+#include <cmath>
+
+TrajectoryPlayer::TrajectoryPlayer(const TrajectoryFile& f, uint32_t n) : file(f), loops(n) {}
+
+bool TrajectoryPlayer::attach(HostController& c) {
+    if (file.joints() == 0 || c.config().delta.data_type != file.dataType()) return false;
+    c.setCycleHook(onCycle, this);
+    return true;
+}
+
+uint32_t TrajectoryPlayer::periodFor(const TrajectoryFile& f) {
+    double us = f.rate() > 0 ? 1e6 / f.rate() : 0;
+    return us < 1 ? 1 : (uint32_t)llround(us);
+}
+
+void TrajectoryPlayer::apply(HostController& c, uint64_t sample) {
+    int joints = file.joints();
+    if (file.format() == TRAJ_FORMAT_INT16) {
+        for (int j = 0; j < joints; j++) {
+            c.setTargetRaw(file.id(j), ((const int16_t*)file.column(TRAJ_KIND_TARGET, j))[sample]);
+        }
+    } else {
+        for (int j = 0; j < joints; j++) {
+            c.setTarget(file.id(j), ((const float*)file.column(TRAJ_KIND_TARGET, j))[sample]);
+        }
+    }
+}
+
+// ============================================================================
+// 函数：TrajectoryPlayer::onCycle
+// 功能：由计划时刻算出全局样本序号，写入该样本；播完后保持最后一个样本
+// ============================================================================
+void TrajectoryPlayer::onCycle(void* ctx, HostController& c, uint64_t cycle, uint64_t t_ns) {
+    TrajectoryPlayer& p = *(TrajectoryPlayer*)ctx;
+    (void)cycle;
+    p.st.cycles++;
+    if (p.done.load(std::memory_order_relaxed)) return;
+    if (p.t0_ns == 0) {
+        p.t0_ns = t_ns;
+        p.st.start_ns = t_ns;
+    }
+
+    uint64_t n = p.file.samples();
+    // 每个样本在离其应到时刻最近的周期写入（应到时刻不晚于本周期结束前半个周期），偏差不超过半个控制周期
+    double half_period_ns = c.config().period_us * 500.0;
+    uint64_t index = (uint64_t)(((double)(t_ns - p.t0_ns) + half_period_ns) * p.file.rate() * 1e-9);
+    uint64_t total = p.loops ? (uint64_t)p.loops * n : UINT64_MAX;
+    if (index >= total) {
+        p.done.store(true, std::memory_order_release);
+        if (p.last_index == total) return;  // 最后一个样本已写入
+        index = total - 1;
+    }
+    if (p.last_index != 0 && index + 1 == p.last_index) {
+        p.st.repeated++;
+        return;
+    }
+    if (index + 1 > p.last_index + 1) p.st.skipped += index - p.last_index;
+    uint64_t sample = index % n;
+    p.apply(c, sample);
+    p.pos.store(sample, std::memory_order_relaxed);
+    p.st.samples++;
+    p.st.loops = (uint32_t)((index + 1) / n);
+    p.st.end_ns = t_ns;
+    uint64_t due = p.t0_ns + (uint64_t)((double)index * 1e9 / p.file.rate());
+    uint64_t offset = t_ns > due ? t_ns - due : due - t_ns;
+    if (offset > p.st.max_offset_ns) p.st.max_offset_ns = offset;
+    p.last_index = index + 1;
+}
@@ -0,0 +1,58 @@
+// ============================================================================
+// 文件：TrajectoryPlayer.h
+// 功能：轨迹播放 - 在HostController的周期回调中按采样率逐个样本设置关节目标
+// 说明：样本序号由本周期的计划时刻算出（序号 = 经过时间 × 采样率），与唤醒抖动无关，
+//       长时间播放不累积漂移（控制周期按us取整也不影响）；控制周期等于采样周期时每周期恰好前进一个样本，
+//       周期与采样率不成整数关系时每个样本在离其应到时刻最近的周期写入（重复或跳过计入统计）。
+//       int16格式的列直接作为原始值写入（与文件中的量化一致），浮点格式经setTarget()量化。
+//       回调中只读映射区、不分配内存；先调用TrajectoryFile::prefault()可避免播放时缺页
+// ============================================================================
+#ifndef TRAJECTORY_PLAYER_H
+#define TRAJECTORY_PLAYER_H
+
+#include "HostController.h"
+#include "Trajectory.h"
+
+// ============================================================================
+// 数据结构定义：TrajectoryPlayerStats
+// 功能：播放统计（停止后读取）
+// ============================================================================
+struct TrajectoryPlayerStats {
+    uint64_t cycles;            //!< 回调次数（含结束后保持的周期）
+    uint64_t samples;           //!< 写入的样本（每个样本写入全部关节）
+    uint64_t repeated;          //!< 样本未前进的周期（控制周期短于采样周期）
+    uint64_t skipped;           //!< 跳过的样本（超时或控制周期长于采样周期）
+    uint32_t loops;             //!< 完成的遍数
+    uint64_t start_ns;          //!< 第一个样本的计划时刻
+    uint64_t end_ns;            //!< 最后一个样本的计划时刻
+    uint64_t max_offset_ns;     //!< 样本写入时刻与其应到时刻的最大偏差（不超过半个控制周期）
+};
+
+class TrajectoryPlayer {
+public:
+    // loops为播放遍数，0为一直循环
+    explicit TrajectoryPlayer(const TrajectoryFile& file, uint32_t loops = 1);
+
+    // 注册为控制器的周期回调（start()之前）；控制器的数据类型须与文件一致
+    bool attach(HostController& c);
+    // 与采样率对应的控制周期（us，四舍五入）
+    static uint32_t periodFor(const TrajectoryFile& file);
+
+    bool finished() const { return done.load(std::memory_order_acquire); }
+    uint64_t position() const { return pos.load(std::memory_order_relaxed); }   //!< 当前样本序号（遍内）
+    const TrajectoryPlayerStats& stats() const { return st; }
+
+private:
+    static void onCycle(void* ctx, HostController& c, uint64_t cycle, uint64_t t_ns);
+    void apply(HostController& c, uint64_t sample);
+
+    const TrajectoryFile& file;
+    uint32_t loops;
+    uint64_t t0_ns = 0;
+    uint64_t last_index = 0;            //!< 上次写入的全局序号（跨遍累计）+1，0为尚未写入
+    std::atomic<uint64_t> pos{0};
+    std::atomic<bool> done{false};
+    TrajectoryPlayerStats st = {};
+};
+
+#endif // TRAJECTORY_PLAYER_H
@@ -0,0 +1,473 @@
+// ============================================================================
+// 文件：VirtualBle.cpp
+// 功能：虚拟BLE传输实现（上位机一侧 + 关节进程）
+// ============================================================================
+#include "VirtualBle.h"
+#include "HAL_Host.h"
+#include "HostController.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// 套接字上的消息：消息头 + 载荷（一次GATT写入/通知的内容）
+#define VBLE_KIND_DATA   0      //!< 写入/通知
+#define VBLE_KIND_STOP   1      //!< 上位机→关节：回报统计后退出
+#define VBLE_KIND_REPORT 2      //!< 关节→上位机：VirtualBleJointReport
+
+struct VbleHeader {
+    uint64_t send_ns;           //!< 发送时刻（CLOCK_MONOTONIC）
+    uint8_t kind;
+    uint8_t reserved[7];
+};
+
+static bool vbleSend(int fd, uint8_t kind, const void* data, size_t len, uint64_t send_ns) {
+    VbleHeader h = {send_ns, kind, {}};
+    iovec iov[2] = {{&h, sizeof(h)}, {(void*)data, len}};
+    msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = len ? 2 : 1;
+    return sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)(sizeof(h) + len);
+}
+
+// 等待fd可读或到达deadline_ns（UINT64_MAX为一直等待）
+static void vbleWait(int fd, uint64_t deadline_ns) {
+    pollfd p = {fd, POLLIN, 0};
+    if (deadline_ns == UINT64_MAX) {
+        ppoll(&p, 1, nullptr, nullptr);
+        return;
+    }
+    uint64_t now = HostController::nowNs();
+    uint64_t wait = deadline_ns > now ? deadline_ns - now : 0;
+    timespec ts = {(time_t)(wait / 1000000000ull), (long)(wait % 1000000000ull)};
+    ppoll(&p, 1, &ts, nullptr);
+}
+
+// ============================================================================
+// 类：VirtualBleQueue
+// 功能：一个方向上等待连接事件的包（接收的一端使用）
+// 说明：同一方向的包按发送顺序到达，送达时刻不减，用定长环形队列即可
+// ============================================================================
+class VirtualBleQueue {
+public:
+    void init(const VirtualBleConfig& c, uint64_t anchor, uint64_t seed) {
+        cfg = c;
+        anchor_ns = anchor;
+        rng = seed ? seed : 1;
+        depth = c.queue_depth ? c.queue_depth : 1;
+        slots.reset(new Slot[depth]);
+    }
+
+    // 按丢失概率和队列容量决定是否接收，并排到第一个有空位的连接事件
+    void push(const uint8_t* data, size_t len, uint64_t send_ns) {
+        if (cfg.loss > 0 && nextRandom() < cfg.loss) {
+            st.lost++;
+            return;
+        }
+        if (count == depth || len > VBLE_MAX_PAYLOAD) {
+            st.overflow++;
+            return;
+        }
+        uint64_t interval = (uint64_t)cfg.interval_us * 1000ull;
+        uint64_t k = send_ns <= anchor_ns ? 0 : (send_ns - anchor_ns + interval - 1) / interval;
+        if (k <= event) {
+            k = event;
+            if (event_used >= cfg.packets_per_event) k++;
+        }
+        if (k != event) {
+            event = k;
+            event_used = 0;
+        }
+        event_used++;
+        Slot& s = slots[(head + count++) % depth];
+        s.send_ns = send_ns;
+        s.due_ns = anchor_ns + k * interval;
+        s.len = (uint16_t)len;
+        memcpy(s.data, data, len);
+    }
+
+    uint64_t nextDue() const { return count ? slots[head].due_ns : UINT64_MAX; }
+
+    // 取出一个已到送达时刻的包，没有时返回nullptr（指针在下一次push之前有效）
+    const uint8_t* take(uint64_t now_ns, size_t* len) {
+        if (count == 0 || slots[head].due_ns > now_ns) return nullptr;
+        const Slot& s = slots[head];
+        uint64_t delay = s.due_ns > s.send_ns ? s.due_ns - s.send_ns : 0;
+        st.delivered++;
+        st.delay_sum_ns += delay;
+        if (delay > st.delay_max_ns) st.delay_max_ns = delay;
+        head = (head + 1) % depth;
+        count--;
+        *len = s.len;
+        return s.data;
+    }
+
+    VirtualBleDirStats st = {};
+
+private:
+    struct Slot {
+        uint64_t send_ns;
+        uint64_t due_ns;
+        uint16_t len;
+        uint8_t data[VBLE_MAX_PAYLOAD];
+    };
+
+    double nextRandom() {  // xorshift64*，[0,1)
+        rng ^= rng >> 12;
+        rng ^= rng << 25;
+        rng ^= rng >> 27;
+        return (double)((rng * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    VirtualBleConfig cfg;
+    std::unique_ptr<Slot[]> slots;
+    uint32_t depth = 0, head = 0, count = 0;
+    uint64_t anchor_ns = 0;
+    uint64_t event = 0;             //!< 最近排入的连接事件序号
+    uint32_t event_used = 0;        //!< 该事件已排入的包
+    uint64_t rng = 1;
+};
+
+static uint16_t vblePayloadMax(const VirtualBleConfig& cfg) {
+    uint16_t mtu = cfg.mtu < 23 ? 23 : cfg.mtu;
+    return (uint16_t)(mtu - 3 > VBLE_MAX_PAYLOAD ? VBLE_MAX_PAYLOAD : mtu - 3);
+}
+
+// ============================================================================
+// 关节进程
+// 说明：固件的回复/通知钩子是不带上下文的函数指针，关节进程的状态放在文件静态变量中
+//       （每个进程只有一个关节）
+// ============================================================================
+static int vble_joint_fd = -1;
+static uint16_t vble_joint_payload_max = 0;
+static VirtualBleJointReport vble_joint_report;
+
+static void vbleJointNotify(const uint8_t* data, size_t len) {
+    VirtualBleDirStats& up = vble_joint_report.up;
+    up.sent++;
+    if (len > vble_joint_payload_max) {
+        up.oversize++;
+        len = vble_joint_payload_max;  // 与BLE通知相同，超出MTU的部分被截断
+    }
+    vbleSend(vble_joint_fd, VBLE_KIND_DATA, data, len, HostController::nowNs());
+}
+
+static void vbleJointReply(const char* text) {
+    vbleJointNotify((const uint8_t*)text, strlen(text));
+}
+
+// ============================================================================
+// 函数：vbleJointMain
+// 功能：关节进程主循环：按连接事件把收到的写入放入固件接收FIFO，按loop_us周期执行
+//       BLE_Server_Loop（解析指令、心跳）→ 取指令 → 遥测
+// 说明：虚拟时钟跟随CLOCK_MONOTONIC（相对start_ns），固件的心跳和遥测按真实时间发送。
+//       收到STOP后等在途的写入送达并解析完再回报统计并返回，上位机关闭套接字时直接返回
+// ============================================================================
+static void vbleJointMain(int fd, uint8_t id, const VirtualBleConfig& cfg, uint64_t start_ns, uint64_t anchor_ns,
+                          uint64_t seed) {
+    vble_joint_fd = fd;
+    vble_joint_payload_max = vblePayloadMax(cfg);
+    memset(&vble_joint_report, 0, sizeof(vble_joint_report));
+    VirtualBleQueue down;
+    down.init(cfg, anchor_ns, seed);
+
+    halHostReset();
+    halHostSetLogEnabled(false);
+    initBLEServer();
+    setMyDeviceID(id);
+    ble_response_hook = vbleJointReply;
+    ble_notify_hook = vbleJointNotify;
+    deviceConnected = true;
+
+    uint8_t buf[sizeof(VbleHeader) + VBLE_MAX_PAYLOAD];
+    uint64_t loop_ns = (uint64_t)(cfg.loop_us ? cfg.loop_us : 1) * 1000ull;
+    uint64_t next_loop = HostController::nowNs();
+    bool stopping = false;
+    uint32_t quiet_loops = 0;  //!< 最近一次送达之后执行的loop()次数
+    for (;;) {
+        uint64_t due = down.nextDue();
+        vbleWait(fd, due < next_loop ? due : next_loop);
+        for (;;) {
+            ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n == 0) return;  // 上位机已关闭
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return;
+            }
+            if ((size_t)n < sizeof(VbleHeader)) continue;
+            VbleHeader h;
+            memcpy(&h, buf, sizeof(h));
+            if (h.kind == VBLE_KIND_STOP) stopping = true;
+            else if (h.kind == VBLE_KIND_DATA) down.push(buf + sizeof(h), (size_t)n - sizeof(h), h.send_ns);
+        }
+
+        uint64_t now = HostController::nowNs();
+        const uint8_t* data;
+        size_t len;
+        while ((data = down.take(now, &len)) != nullptr) {
+            bleRxPush(data, len);  // 固件BLE接收回调
+            quiet_loops = 0;
+        }
+        if (now >= next_loop) {
+            halHostSetMicros((now - start_ns) / 1000ull);
+            BLE_Server_Loop();
+            getSerialMotorTarget();
+            cmdTelemetryTick(halMicros());
+            vble_joint_report.loops++;
+            quiet_loops++;
+            next_loop += loop_ns;
+            if (next_loop < now) next_loop = now + loop_ns;  // 落后时不补执行
+        }
+
+        // 停止：在途的写入都已送达，且之后的loop()足以取空接收FIFO，再回报
+        if (stopping && down.nextDue() == UINT64_MAX &&
+            quiet_loops > BLE_RX_FIFO_DEPTH / BLE_RX_DRAIN_PER_LOOP) {
+            vble_joint_report.valid = true;
+            vble_joint_report.id = getMyDeviceID();
+            vble_joint_report.down = down.st;
+            vble_joint_report.link = cmdLinkStats(CMD_TRANSPORT_BLE);
+            vble_joint_report.rx = bleRxStats();
+            vble_joint_report.target = ble_motor_target;
+            vbleSend(fd, VBLE_KIND_REPORT, &vble_joint_report, sizeof(vble_joint_report), HostController::nowNs());
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// 上位机一侧
+// ============================================================================
+VirtualBleTransport::VirtualBleTransport(const uint8_t* ids, int n, const VirtualBleConfig& c)
+    : cfg(c), count(n > 0 ? n : 0) {
+    link_state.reset(new Link[count]);
+    up_queues.reset(new VirtualBleQueue[count]);
+    reports.reset(new VirtualBleJointReport[count]());
+    for (int i = 0; i < count; i++) link_state[i].id = ids[i];
+}
+
+VirtualBleTransport::~VirtualBleTransport() { stop(); }
+
+void VirtualBleTransport::setNotifyHandler(VirtualBleNotifyFn fn, void* ctx) {
+    notify_fn = fn;
+    notify_ctx = ctx;
+}
+
+// ============================================================================
+// 函数：VirtualBleTransport::start
+// 功能：为每个关节创建套接字对并fork关节进程，然后启动接收线程
+// 说明：各连接的连接事件锚点在一个间隔内错开（各关节独立建立连接，相位不同）
+// ============================================================================
+bool VirtualBleTransport::start(std::string* err) {
+    if (started) return false;
+    uint64_t interval_ns = (uint64_t)cfg.interval_us * 1000ull;
+    uint64_t start_ns = HostController::nowNs() + 20000000ull;  // 留出关节进程启动的时间
+    std::vector<int> child_fds(count, -1);
+    for (int i = 0; i < count; i++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+            for (int j = 0; j < i; j++) {
+                ::close(link_state[j].fd);
+                ::close(child_fds[j]);
+                link_state[j].fd = -1;
+            }
+            if (err) *err = std::string("socketpair失败：") + strerror(errno);
+            return false;
+        }
+        link_state[i].fd = sv[0];
+        child_fds[i] = sv[1];
+        link_state[i].anchor_ns = start_ns + interval_ns * (uint64_t)i / (uint64_t)(count ? count : 1);
+        up_queues[i].init(cfg, link_state[i].anchor_ns, ((uint64_t)cfg.seed << 16) ^ (uint64_t)(2 * i + 1));
+        reports[i] = VirtualBleJointReport{};
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < count; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (int j = 0; j < count; j++) {
+                ::close(link_state[j].fd);
+                if (j != i) ::close(child_fds[j]);
+            }
+            vbleJointMain(child_fds[i], link_state[i].id, cfg, start_ns, link_state[i].anchor_ns,
+                          ((uint64_t)cfg.seed << 16) ^ (uint64_t)(2 * i + 2));
+            _exit(0);
+        }
+        if (pid < 0 && err) *err = std::string("fork失败：") + strerror(errno);
+        link_state[i].pid = pid;
+    }
+    for (int i = 0; i < count; i++) ::close(child_fds[i]);
+
+    reports_received.store(0);
+    stop_flag.store(false);
+    thread = std::thread(&VirtualBleTransport::run, this);
+    started = true;
+    for (int i = 0; i < count; i++) {
+        if (link_state[i].pid < 0) {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// 函数：VirtualBleTransport::stop
+// 功能：请各关节进程回报统计（最多等待1秒），停止接收线程，回收关节进程
+// ============================================================================
+void VirtualBleTransport::stop() {
+    if (!started) return;
+    int expected = 0;
+    for (int i = 0; i < count; i++) {
+        if (link_state[i].pid > 0 && vbleSend(link_state[i].fd, VBLE_KIND_STOP, nullptr, 0, HostController::nowNs())) expected++;
+    }
+    uint64_t deadline = HostController::nowNs() + 1000000000ull;
+    while (reports_received.load() < expected && HostController::nowNs() < deadline) {
+        timespec ts = {0, 1000000};
+        nanosleep(&ts, nullptr);
+    }
+    stop_flag.store(true);
+    thread.join();
+    for (int i = 0; i < count; i++) {
+        ::close(link_state[i].fd);
+        link_state[i].fd = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (link_state[i].pid <= 0) continue;
+        if (!reports[i].valid) kill(link_state[i].pid, SIGKILL);
+        waitpid(link_state[i].pid, nullptr, 0);
+        link_state[i].pid = -1;
+    }
+    rusage ru;
+    if (getrusage(RUSAGE_CHILDREN, &ru) == 0) {
+        child_cpu_s = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+    }
+    started = false;
+}
+
+bool VirtualBleTransport::write(int link, const uint8_t* data, size_t len) {
+    if (link < 0 || link >= count || link_state[link].fd < 0) return false;
+    Link& l = link_state[link];
+    if (len > vblePayloadMax(cfg)) {
+        l.oversize++;
+        return false;
+    }
+    if (!vbleSend(l.fd, VBLE_KIND_DATA, data, len, HostController::nowNs())) {
+        l.write_errors++;
+        return false;
+    }
+    l.sent++;
+    return true;
+}
+
+size_t VirtualBleTransport::poll(HostReplyFn fn, void* ctx) {
+    uint32_t tail = reply_tail.load(std::memory_order_relaxed);
+    uint32_t head = reply_head.load(std::memory_order_acquire);
+    size_t n = 0;
+    for (; tail != head; tail++, n++) {
+        const Reply& r = replies[tail % VBLE_REPLY_DEPTH];
+        if (fn) fn(ctx, r.link, r.text);
+    }
+    reply_tail.store(tail, std::memory_order_release);
+    return n;
+}
+
+// 接收线程：一条通知送达
+void VirtualBleTransport::deliver(int link, const uint8_t* data, size_t len, uint64_t now_ns) {
+    Link& l = link_state[link];
+    if (len > 0 && data[0] == BLE_TELEMETRY_MARKER) {
+        l.notifies++;
+        if (notify_fn) notify_fn(notify_ctx, link, data, len, now_ns);
+        return;
+    }
+    l.replies++;
+    uint32_t head = reply_head.load(std::memory_order_relaxed);
+    if (head - reply_tail.load(std::memory_order_acquire) >= VBLE_REPLY_DEPTH) {
+        reply_overflows.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Reply& r = replies[head % VBLE_REPLY_DEPTH];
+    size_t n = len < sizeof(r.text) - 1 ? len : sizeof(r.text) - 1;
+    r.link = link;
+    memcpy(r.text, data, n);
+    r.text[n] = '\0';
+    reply_head.store(head + 1, std::memory_order_release);
+}
+
+// 接收线程：取出一条连接上已到达的全部消息
+void VirtualBleTransport::receive(int link) {
+    uint8_t buf[sizeof(VbleHeader) + sizeof(VirtualBleJointReport) + VBLE_MAX_PAYLOAD];
+    for (;;) {
+        ssize_t n = recv(link_state[link].fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < (ssize_t)sizeof(VbleHeader)) return;  // 无数据/已关闭
+        VbleHeader h;
+        memcpy(&h, buf, sizeof(h));
+        if (h.kind == VBLE_KIND_REPORT && (size_t)n == sizeof(h) + sizeof(VirtualBleJointReport)) {
+            memcpy(&reports[link], buf + sizeof(h), sizeof(VirtualBleJointReport));
+            reports_received.fetch_add(1);
+        } else if (h.kind == VBLE_KIND_DATA) {
+            up_queues[link].push(buf + sizeof(h), (size_t)n - sizeof(h), h.send_ns);
+        }
+    }
+}
+
+// ============================================================================
+// 函数：VirtualBleTransport::run
+// 功能：接收线程：等待任一连接有消息或到达最早的送达时刻，按连接事件送达通知
+// ============================================================================
+void VirtualBleTransport::run() {
+    std::vector<pollfd> fds(count);
+    for (int i = 0; i < count; i++) fds[i] = {link_state[i].fd, POLLIN, 0};
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        uint64_t now = HostController::nowNs();
+        uint64_t wait = 10000000ull;  // 最长10ms检查一次停止标志
+        for (int i = 0; i < count; i++) {
+            uint64_t due = up_queues[i].nextDue();
+            if (due <= now) wait = 0;
+            else if (due - now < wait) wait = due - now;
+        }
+        timespec ts = {0, (long)wait};
+        if (ppoll(fds.data(), fds.size(), &ts, nullptr) > 0) {
+            for (int i = 0; i < count; i++) {
+                if (fds[i].revents & POLLIN) receive(i);
+                if (fds[i].revents & (POLLHUP | POLLERR)) fds[i].fd = -1;  // 关节进程已退出
+            }
+        }
+        now = HostController::nowNs();
+        for (int i = 0; i < count; i++) {
+            const uint8_t* data;
+            size_t len;
+            while ((data = up_queues[i].take(now, &len)) != nullptr) deliver(i, data, len, now);
+        }
+    }
+}
+
+// ============================================================================
+// 函数：VirtualBleTransport::stats
+// 功能：合并两端的统计：发送一侧的计数取自发送端，送达/丢失/延迟取自接收端
+// ============================================================================
+VirtualBleLinkStats VirtualBleTransport::stats(int link) const {
+    VirtualBleLinkStats s = {};
+    if (link < 0 || link >= count) return s;
+    const Link& l = link_state[link];
+    const VirtualBleJointReport& r = reports[link];
+    s.down = r.down;
+    s.down.sent = l.sent;
+    s.down.oversize = l.oversize;
+    s.up = up_queues[link].st;
+    s.up.sent = r.up.sent;
+    s.up.oversize = r.up.oversize;
+    s.write_errors = l.write_errors;
+    s.notifies = l.notifies;
+    s.replies = l.replies;
+    return s;
+}
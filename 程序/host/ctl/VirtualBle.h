@@ -0,0 +1,153 @@
+// ============================================================================
+// 文件：VirtualBle.h
+// 功能：虚拟BLE传输 - 用UNIX域套接字代替N台ESP32，在一台Linux主机上端到端测试
+//       上位机控制库、数据包格式和固件指令层
+// 说明：每个关节一个子进程（固件的全局状态只有一份，一个进程只能运行一个关节），
+//       运行固件的BLE接收FIFO（bleRxPush/BLE_Server_Loop）、指令层（cmdReceive → cmdDecode
+//       → 回复）和遥测（cmdTelemetryTick → BLE_TELEMETRY_MARKER通知），不运行FOC控制环。
+//       关节与上位机之间是一对SOCK_SEQPACKET套接字，一条消息对应一次GATT写入/通知。
+//       两个方向都按BLE连接的行为模拟：
+//         - MTU：写入超过MTU-3字节时失败（写无响应的限制），通知截断到MTU-3字节；
+//         - 连接间隔：数据只在连接事件（anchor + k×interval_us）送达，每个事件每个方向
+//           最多packets_per_event个包，其余顺延到之后的事件；
+//         - 丢失：每个包按loss概率丢弃；等待连接事件的包超过queue_depth时丢弃（控制器缓冲满）。
+//       模拟由接收的一端完成（发送时刻随消息传递，CLOCK_MONOTONIC在进程间一致），
+//       write()只是一次非阻塞send()，可在HostController的实时线程中调用。
+//       上位机一侧的接收线程相当于BLE协议栈的回调线程：二进制通知在送达时刻直接交给
+//       通知回调（如TelemetryLogger::ingest），文本回复放入队列由poll()取出。
+//       start()须在启动其他线程之前调用（fork只复制调用线程）
+// ============================================================================
+#ifndef VIRTUAL_BLE_H
+#define VIRTUAL_BLE_H
+
+#include "HostTransport.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+
+#define VBLE_MAX_PAYLOAD 512    //!< ATT属性值最大长度（MTU上限517）
+
+#ifndef VBLE_REPLY_DEPTH
+#define VBLE_REPLY_DEPTH 256    //!< 文本回复队列深度，满时丢弃新回复并计数
+#endif
+
+// ============================================================================
+// 数据结构定义：VirtualBleConfig
+// 功能：虚拟连接参数（全部连接相同）
+// ============================================================================
+struct VirtualBleConfig {
+    uint16_t mtu = 247;                 //!< ATT MTU（载荷最多mtu-3字节；23为未协商的默认值）
+    uint32_t interval_us = 7500;        //!< 连接间隔
+    uint8_t packets_per_event = 4;      //!< 每个连接事件每个方向最多送达的包
+    double loss = 0;                    //!< 每个包的丢失概率
+    uint32_t queue_depth = 32;          //!< 每个方向等待连接事件的包数上限
+    uint32_t loop_us = 500;             //!< 关节进程的loop()周期
+    uint32_t seed = 1;                  //!< 丢包随机数种子
+};
+
+// ============================================================================
+// 数据结构定义：VirtualBleDirStats
+// 功能：一个方向的统计
+// ============================================================================
+struct VirtualBleDirStats {
+    uint64_t sent;              //!< 发送的包
+    uint64_t oversize;          //!< 超过MTU（写入失败/通知截断）
+    uint64_t delivered;         //!< 送达的包
+    uint64_t lost;              //!< 按丢失概率丢弃
+    uint64_t overflow;          //!< 等待队列满丢弃
+    uint64_t delay_sum_ns;      //!< 发送到送达的延迟（等待连接事件）
+    uint64_t delay_max_ns;
+};
+
+// ============================================================================
+// 数据结构定义：VirtualBleJointReport
+// 功能：关节进程在stop()时回报的统计
+// ============================================================================
+struct VirtualBleJointReport {
+    bool valid;                 //!< 已收到回报
+    uint8_t id;                 //!< 设备ID
+    uint64_t loops;             //!< 执行的loop()次数
+    VirtualBleDirStats down;    //!< 上位机→关节（送达/丢失/延迟在关节一侧统计）
+    VirtualBleDirStats up;      //!< 关节→上位机（发送/截断在关节一侧统计）
+    CommandLinkStats link;      //!< 固件BLE传输统计
+    BleRxStats rx;              //!< 固件接收FIFO统计
+    float target;               //!< 最近一次指令的目标值（ble_motor_target）
+};
+
+// ============================================================================
+// 数据结构定义：VirtualBleLinkStats
+// 功能：一条连接两端合并后的统计（stop()之后读取）
+// ============================================================================
+struct VirtualBleLinkStats {
+    VirtualBleDirStats down;    //!< 上位机→关节（写入）
+    VirtualBleDirStats up;      //!< 关节→上位机（通知）
+    uint64_t write_errors;      //!< 套接字缓冲满而写入失败
+    uint64_t notifies;          //!< 交给通知回调的二进制通知
+    uint64_t replies;           //!< 文本回复
+};
+
+// 通知回调：在接收线程中调用，data为一条二进制通知（BLE_TELEMETRY_MARKER起），rx_ns为送达时刻
+typedef void (*VirtualBleNotifyFn)(void* ctx, int link, const uint8_t* data, size_t len, uint64_t rx_ns);
+
+class VirtualBleQueue;
+
+class VirtualBleTransport : public HostTransport {
+public:
+    VirtualBleTransport(const uint8_t* ids, int count, const VirtualBleConfig& cfg = VirtualBleConfig());
+    ~VirtualBleTransport();
+    VirtualBleTransport(const VirtualBleTransport&) = delete;
+    VirtualBleTransport& operator=(const VirtualBleTransport&) = delete;
+
+    void setNotifyHandler(VirtualBleNotifyFn fn, void* ctx);    //!< start()之前设置
+    bool start(std::string* err);       //!< 创建套接字，启动关节进程和接收线程
+    void stop();                        //!< 关节进程回报统计后退出，停止接收线程
+
+    int links() const override { return count; }
+    bool write(int link, const uint8_t* data, size_t len) override;
+    size_t poll(HostReplyFn fn, void* ctx) override;
+
+    VirtualBleLinkStats stats(int link) const;
+    const VirtualBleJointReport& report(int link) const { return reports[link]; }
+    const VirtualBleConfig& config() const { return cfg; }
+    uint64_t replyOverflows() const { return reply_overflows.load(std::memory_order_relaxed); }
+    double childCpuSeconds() const { return child_cpu_s; }  //!< 关节进程合计CPU时间（stop()之后）
+
+private:
+    struct Reply {
+        int link;
+        char text[64];
+    };
+    struct Link {
+        int fd = -1;
+        pid_t pid = -1;
+        uint8_t id = 0;
+        uint64_t anchor_ns = 0;
+        uint64_t sent = 0, oversize = 0, write_errors = 0;  //!< 写入一侧（调用write()的线程）
+        uint64_t notifies = 0, replies = 0;                 //!< 接收线程
+    };
+
+    void run();
+    void receive(int link);
+    void deliver(int link, const uint8_t* data, size_t len, uint64_t now_ns);
+
+    VirtualBleConfig cfg;
+    int count;
+    std::unique_ptr<Link[]> link_state;
+    std::unique_ptr<VirtualBleQueue[]> up_queues;       //!< 关节→上位机（接收线程）
+    std::unique_ptr<VirtualBleJointReport[]> reports;
+    std::atomic<int> reports_received{0};
+    VirtualBleNotifyFn notify_fn = nullptr;
+    void* notify_ctx = nullptr;
+    Reply replies[VBLE_REPLY_DEPTH];
+    std::atomic<uint32_t> reply_head{0}, reply_tail{0};
+    std::atomic<uint64_t> reply_overflows{0};
+    std::atomic<bool> stop_flag{false};
+    std::thread thread;
+    bool started = false;
+    double child_cpu_s = 0;
+};
+
+#endif // VIRTUAL_BLE_H
@@ -0,0 +1,225 @@
+// ============================================================================
+// 文件：delta_bench_main.cpp
+// 功能：增量目标发送（ctl/DeltaSender）与分组全量发送的空中时间对比
+// 用法：foc_delta_bench [--targets targets.csv] [--seconds 秒] [--rate 轮/秒] [--keyframe 轮]
+//                       [--ack-timeout 轮] [--loss 丢包率] [--seed N]
+// 说明：关节集合和静止目标取自targets.csv，在其上合成几种典型目标流：
+//         static  全部保持（姿态保持）
+//         sparse  targets.csv中非零的关节以0.5Hz、±20°摆动，其余保持
+//         steps   每个关节平均每秒随机跳变一次
+//         wave    全部关节正弦运动、相位依次错开（增量发送的最差情况）
+//       全量方案按ble_input_output.py的broadcast_buffers_multi_rounds()每轮发送全部分组
+//       （group_size/packet_mode取自targets.csv）。BLE上每个包写入每个关节的连接，
+//       空中时间按1M PHY写无响应（数据包+3字节序号前缀+17字节开销，两个T_IFS和空应答包）估算。
+//       每个包逐连接按丢包率丢弃，收到的包交给固件的cmdAddressed()/cmdDecode()解码，
+//       回复（同样可能丢失）交给DeltaSender::onReply()；结算各关节解码得到的目标与期望不符的
+//       关节·轮数（滞后）和最长未收到本关节指令的时间（固件指令看门狗须大于此值）
+// ============================================================================
+#include "SimHarness.h"
+#include "ctl/DeltaSender.h"
+#include "ctl/TargetsFile.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef FOC_TARGETS_CSV
+#define FOC_TARGETS_CSV "targets.csv"
+#endif
+
+// ============================================================================
+// 数据结构定义：LinkSim
+// 功能：全部关节的接收端模拟（每个关节一条BLE连接）
+// ============================================================================
+struct LinkSim {
+    std::vector<uint8_t> ids;           //!< 关节ID
+    std::vector<int16_t> applied;       //!< 各关节解码得到的目标（原始值），下标为ID
+    std::vector<uint64_t> last_rx;      //!< 最近收到本关节指令的轮次
+    std::vector<uint64_t> max_gap;      //!< 最长未收到本关节指令的轮数
+    DeltaSender* sender = nullptr;      //!< 回复的接收者（全量方案为空）
+    std::mt19937* rng = nullptr;
+    double loss = 0;
+    uint64_t round = 0;
+    uint64_t packets = 0, bytes = 0, writes = 0;
+    double airtime_us = 0;
+    uint64_t stale = 0;                 //!< 滞后的关节·轮
+    uint64_t bad_decode = 0;            //!< 收到的包不能被固件解码（不应出现）
+
+    bool dropped() { return loss > 0 && std::uniform_real_distribution<double>(0, 1)(*rng) < loss; }
+};
+
+static void linkEmit(void* ctx, uint8_t* packet, size_t len) {
+    LinkSim& l = *(LinkSim*)ctx;
+    l.packets++;
+    l.bytes += len;
+    for (uint8_t id : l.ids) {
+        l.writes++;
+        l.airtime_us += (17 + 3 + len) * 8.0 + 150 + 80 + 150;
+        if (l.dropped() || !cmdAddressed(packet, len, id)) continue;
+        CommandMsg msg;
+        if (cmdDecode(packet, len, id, &msg) != CMD_DECODE_OK) {
+            l.bad_decode++;
+            continue;
+        }
+        l.applied[id] = msg.raw;
+        if (l.round - l.last_rx[id] > l.max_gap[id]) l.max_gap[id] = l.round - l.last_rx[id];
+        l.last_rx[id] = l.round;
+        if (l.sender && !l.dropped()) {
+            char reply[50];
+            snprintf(reply, sizeof(reply), "%d:%s:%.2f", id, msg.packet_type == PACKET_TYPE_MULTI ? "MULTI" : "MULTI_STRUCT",
+                     int16ToFloat(msg.raw, ANGLE_SCALE));
+            l.sender->onReply(reply);
+        }
+    }
+}
+
+// ============================================================================
+// 目标流
+// ============================================================================
+struct Stream {
+    const char* name;
+};
+
+static const Stream streams[] = {{"static"}, {"sparse"}, {"steps"}, {"wave"}};  // 含义见文件头
+
+static float streamValue(int stream, int id, float base, double t, int n_joints, std::vector<float>& step_val,
+                         std::mt19937& rng, double dt) {
+    switch (stream) {
+        case 1: return base != 0.0f ? base + (float)(20.0 * sin(2.0 * PI * 0.5 * t)) : base;
+        case 2:
+            if (std::uniform_real_distribution<double>(0, 1)(rng) < dt) {
+                step_val[id] = (float)std::uniform_int_distribution<int>(-90, 90)(rng);
+            }
+            return step_val[id];
+        case 3: return (float)(30.0 * sin(2.0 * PI * (0.5 * t + (double)id / n_joints)));
+        default: return base;
+    }
+}
+
+// ============================================================================
+// 函数：runStream
+// 功能：以全量或增量方案运行一个目标流
+// ============================================================================
+static LinkSim runStream(int stream, bool delta, const TargetsFile& tf, const DeltaSenderConfig& cfg, double seconds,
+                         double rate, double loss, unsigned seed) {
+    int max_id = tf.id_values.empty() ? 0 : std::min(tf.id_values.rbegin()->first, MAX_MOTORS);
+    std::mt19937 rng(seed), link_rng(seed + 1);
+    LinkSim l;
+    for (int id = 1; id <= max_id; id++) l.ids.push_back((uint8_t)id);
+    l.applied.assign(MAX_MOTORS + 1, 0);
+    l.last_rx.assign(MAX_MOTORS + 1, 0);
+    l.max_gap.assign(MAX_MOTORS + 1, 0);
+    l.rng = &link_rng;
+    l.loss = loss;
+
+    DeltaSender sender(cfg);
+    if (delta) l.sender = &sender;
+    std::vector<float> step_val(MAX_MOTORS + 1, 0.0f);
+    std::vector<float> values(MAX_MOTORS + 1, 0.0f);
+    for (auto& kv : tf.id_values) {
+        if (kv.first >= 1 && kv.first <= MAX_MOTORS) step_val[kv.first] = kv.second;
+    }
+    int group_size = std::max(1, tf.group_size);
+    uint64_t rounds = (uint64_t)(seconds * rate);
+
+    for (uint64_t r = 0; r < rounds; r++) {
+        l.round = r;
+        double t = r / rate;
+        for (int id = 1; id <= max_id; id++) {
+            auto it = tf.id_values.find(id);
+            float base = it == tf.id_values.end() ? 0.0f : it->second;
+            values[id] = streamValue(stream, id, base, t, max_id, step_val, rng, 1.0 / rate);
+        }
+        if (delta) {
+            for (int id = 1; id <= max_id; id++) sender.setTarget((uint8_t)id, values[id]);
+            sender.round(linkEmit, &l);
+        } else {
+            // 与broadcast_buffers_multi_rounds()相同的分组
+            for (int start = 1; start <= max_id; start += group_size) {
+                uint8_t n = (uint8_t)std::min(group_size, max_id - start + 1);
+                uint8_t ids[MAX_MOTORS];
+                for (uint8_t k = 0; k < n; k++) ids[k] = (uint8_t)(start + k);
+                std::string pkt = tf.use_struct ? simMakeMultiStructPacket(ids, &values[start], n, DATA_TYPE_ANGLE)
+                                                : simMakeMultiSlicePacket((uint8_t)start, &values[start], n, DATA_TYPE_ANGLE);
+                linkEmit(&l, (uint8_t*)&pkt[0], pkt.size());
+            }
+        }
+        for (int id = 1; id <= max_id; id++) {
+            if (l.applied[id] != floatToInt16(values[id], ANGLE_SCALE)) l.stale++;
+        }
+    }
+    for (int id = 1; id <= max_id; id++) {
+        if (rounds - l.last_rx[id] > l.max_gap[id]) l.max_gap[id] = rounds - l.last_rx[id];
+    }
+    return l;
+}
+
+int main(int argc, char** argv) {
+    const char* targets_path = FOC_TARGETS_CSV;
+    double seconds = 20.0;
+    double rate = 50.0;
+    double loss = 0.02;
+    unsigned seed = 1;
+    DeltaSenderConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--targets" && i + 1 < argc) {
+            targets_path = argv[++i];
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--keyframe" && i + 1 < argc) {
+            cfg.keyframe_rounds = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--ack-timeout" && i + 1 < argc) {
+            cfg.ack_timeout_rounds = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--loss" && i + 1 < argc) {
+            loss = atof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (unsigned)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "用法: foc_delta_bench [--targets targets.csv] [--seconds 秒] [--rate 轮/秒] "
+                            "[--keyframe 轮] [--ack-timeout 轮] [--loss 丢包率] [--seed N]\n");
+            return 2;
+        }
+    }
+    TargetsFile tf;
+    if (!loadTargets(targets_path, tf) || tf.id_values.empty()) {
+        fprintf(stderr, "无法读取目标文件 %s\n", targets_path);
+        return 2;
+    }
+    if (rate <= 0 || seconds <= 0 || loss < 0 || loss >= 1) {
+        fprintf(stderr, "轮频率和时长须大于0，丢包率须为0..1\n");
+        return 2;
+    }
+
+    int max_id = std::min(tf.id_values.rbegin()->first, MAX_MOTORS);
+    printf("目标文件 %s：%d 个关节，全量方案 group_size=%d（%s）；%.0f 轮/秒 × %.0fs，"
+           "关键帧每 %u 轮（%.0fms），未确认 %u 轮后重发，丢包率 %.1f%%\n",
+           targets_path, max_id, tf.group_size, tf.use_struct ? "MULTI_STRUCT" : "MULTI切片", rate, seconds,
+           cfg.keyframe_rounds, cfg.keyframe_rounds * 1e3 / rate, cfg.ack_timeout_rounds, loss * 100);
+    printf("目标流   方案  包/轮  字节/轮  空中时间us/轮   节省  滞后关节·轮  最长静默ms\n");
+
+    bool ok = true;
+    for (int s = 0; s < (int)(sizeof(streams) / sizeof(streams[0])); s++) {
+        LinkSim full = runStream(s, false, tf, cfg, seconds, rate, loss, seed);
+        LinkSim delta = runStream(s, true, tf, cfg, seconds, rate, loss, seed);
+        uint64_t rounds = (uint64_t)(seconds * rate);
+        const LinkSim* runs[2] = {&full, &delta};
+        for (int k = 0; k < 2; k++) {
+            const LinkSim& l = *runs[k];
+            uint64_t gap = 0;
+            for (uint8_t id : l.ids) gap = std::max(gap, l.max_gap[id]);
+            double saved = k ? 100.0 * (1.0 - l.airtime_us / std::max(full.airtime_us, 1.0)) : 0.0;
+            printf("%-8s %s %6.2f %8.1f %14.0f %5.1f%% %12llu %11.0f\n", k ? "" : streams[s].name,
+                   k ? "增量" : "全量", (double)l.packets / rounds, (double)l.bytes / rounds, l.airtime_us / rounds,
+                   saved, (unsigned long long)l.stale, gap * 1e3 / rate);
+            if (l.bad_decode) {
+                fprintf(stderr, "%s/%s：%llu 个包不能被固件解码\n", streams[s].name, k ? "增量" : "全量",
+                        (unsigned long long)l.bad_decode);
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
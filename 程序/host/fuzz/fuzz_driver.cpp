@@ -0,0 +1,262 @@
+// ============================================================================
+// 文件：fuzz_driver.cpp
+// 功能：不依赖libFuzzer的模糊测试驱动（gcc构建、AFL、语料回归与吞吐量测量）
+// 用法：
+//   foc_fuzz_parser <文件或目录...>                     逐个执行语料（回归）
+//   foc_fuzz_parser                                     从标准输入读一个输入
+//   foc_fuzz_parser --mutate N [--seed S] <语料...>     随机变异N次（结构感知）
+//   foc_fuzz_parser --bench [--seconds T] [--out 文件] <语料...>   解析吞吐量
+// 说明：AFL使用方式：afl-fuzz -i host/fuzz/corpus -o out -- foc_fuzz_parser @@
+//       出错时当前输入写入crash-input.bin，并以十六进制打印到stderr
+// ============================================================================
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+#define FUZZ_MAX_INPUT 600  //!< 单个输入上限（BLE写入最大512字节，留出变异余量）
+
+// ============================================================================
+// 出错时保存当前输入（信号处理函数中只用write）
+// ============================================================================
+static uint8_t fuzz_cur[FUZZ_MAX_INPUT];
+static size_t fuzz_cur_len = 0;
+
+static void fuzzOnCrash(int sig) {
+    int fd = open("crash-input.bin", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        ssize_t w = write(fd, fuzz_cur, fuzz_cur_len);
+        (void)w;
+        close(fd);
+    }
+    static const char hex[] = "0123456789ABCDEF";
+    char line[3 * FUZZ_MAX_INPUT + 64];
+    size_t n = 0;
+    const char head[] = "\n出错输入(已写入crash-input.bin): ";
+    memcpy(line, head, sizeof(head) - 1);
+    n = sizeof(head) - 1;
+    for (size_t i = 0; i < fuzz_cur_len; i++) {
+        line[n++] = hex[fuzz_cur[i] >> 4];
+        line[n++] = hex[fuzz_cur[i] & 0x0F];
+        line[n++] = ' ';
+    }
+    line[n++] = '\n';
+    ssize_t w = write(2, line, n);
+    (void)w;
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void fuzzExec(const uint8_t* data, size_t len) {
+    if (len > FUZZ_MAX_INPUT) len = FUZZ_MAX_INPUT;
+    memcpy(fuzz_cur, data, len);
+    fuzz_cur_len = len;
+    LLVMFuzzerTestOneInput(fuzz_cur, len);
+}
+
+// ============================================================================
+// 语料读取（文件或目录，目录不递归）
+// ============================================================================
+static bool fuzzReadFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    out.clear();
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+static void fuzzLoadCorpus(const char* path, std::vector<std::vector<uint8_t>>& corpus) {
+    struct stat sb;
+    if (stat(path, &sb) != 0) {
+        fprintf(stderr, "找不到语料: %s\n", path);
+        exit(2);
+    }
+    std::vector<uint8_t> bytes;
+    if (!S_ISDIR(sb.st_mode)) {
+        if (fuzzReadFile(path, bytes)) corpus.push_back(bytes);
+        return;
+    }
+    DIR* dir = opendir(path);
+    if (!dir) return;
+    std::vector<std::string> names;
+    while (struct dirent* e = readdir(dir)) {
+        if (e->d_name[0] != '.') names.push_back(e->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());  // 固定顺序，保证变异结果可复现
+    for (const std::string& name : names) {
+        if (fuzzReadFile(std::string(path) + "/" + name, bytes)) corpus.push_back(bytes);
+    }
+}
+
+// ============================================================================
+// 函数：fuzzMutate
+// 功能：单次变异（位翻转/特殊值/插入/删除/截断/条目复制/长度字段修正/拼接）
+// 说明：长度字段修正让切片COUNT、MULTI_STRUCT COUNT与实际长度一致，
+//       使随机输入能进入解析函数更深的分支
+// ============================================================================
+static void fuzzMutate(std::vector<uint8_t>& in, const std::vector<std::vector<uint8_t>>& corpus, std::mt19937& rng) {
+    static const uint8_t special[] = {0x00, 0x01, 0x02, 0x03, 0x06, 0x0A, 0x14, 0x15, 0x7F, 0x80, 0xAA, 0x55, 0xFF};
+    auto pick = [&](size_t n) { return n ? (size_t)(rng() % n) : 0; };
+
+    switch (rng() % 8) {
+        case 0:
+            if (!in.empty()) in[pick(in.size())] ^= (uint8_t)(1u << (rng() % 8));
+            break;
+        case 1:
+            if (!in.empty()) in[pick(in.size())] = special[pick(sizeof(special))];
+            break;
+        case 2:
+            in.insert(in.begin() + pick(in.size() + 1), (uint8_t)rng());
+            break;
+        case 3:
+            if (!in.empty()) in.erase(in.begin() + pick(in.size()));
+            break;
+        case 4:
+            in.resize(pick(in.size() + 1));
+            break;
+        case 5:
+            // 复制一个3字节条目（MULTI_STRUCT）或2字节数值（切片）
+            if (in.size() >= 3) {
+                size_t w = (rng() & 1) ? 3 : 2;
+                size_t at = pick(in.size() - w + 1);
+                std::vector<uint8_t> chunk(in.begin() + at, in.begin() + at + w);
+                in.insert(in.begin() + pick(in.size() + 1), chunk.begin(), chunk.end());
+            }
+            break;
+        case 6:
+            // 长度字段修正：计数字段改为与长度一致，或按计数字段补齐长度
+            if (in.size() >= 6) {
+                switch (rng() % 4) {
+                    case 0: in[5] = (uint8_t)((in.size() - 6) / 2); break;
+                    case 1: in[4] = (uint8_t)((in.size() - 5) / 3); break;
+                    case 2: in.resize(6 + in[5] * 2, (uint8_t)rng()); break;
+                    default: in.resize(5 + in[4] * 3, (uint8_t)rng()); break;
+                }
+            }
+            break;
+        default: {
+            const std::vector<uint8_t>& other = corpus[pick(corpus.size())];
+            size_t cut = pick(in.size() + 1);
+            size_t from = pick(other.size() + 1);
+            in.resize(cut);
+            in.insert(in.end(), other.begin() + from, other.end());
+            break;
+        }
+    }
+    if (in.size() > FUZZ_MAX_INPUT) in.resize(FUZZ_MAX_INPUT);
+}
+
+int main(int argc, char** argv) {
+    long long mutate = -1;
+    bool bench = false;
+    double seconds = 2.0;
+    uint32_t seed = 1;
+    const char* out_path = nullptr;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mutate" && i + 1 < argc) {
+            mutate = atoll(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--bench") {
+            bench = true;
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    LLVMFuzzerInitialize(&argc, &argv);
+    signal(SIGABRT, fuzzOnCrash);
+    signal(SIGSEGV, fuzzOnCrash);
+    signal(SIGFPE, fuzzOnCrash);
+
+    std::vector<std::vector<uint8_t>> corpus;
+    for (const char* p : paths) fuzzLoadCorpus(p, corpus);
+
+    // 无参数：从标准输入读取一个输入（AFL标准输入模式）
+    if (paths.empty()) {
+        std::vector<uint8_t> in;
+        uint8_t buf[4096];
+        ssize_t n;
+        while ((n = read(0, buf, sizeof(buf))) > 0) in.insert(in.end(), buf, buf + n);
+        fuzzExec(in.data(), in.size());
+        return 0;
+    }
+    if (corpus.empty()) {
+        fprintf(stderr, "语料为空\n");
+        return 2;
+    }
+
+    // 回归：逐个执行
+    for (const std::vector<uint8_t>& in : corpus) fuzzExec(in.data(), in.size());
+    printf("语料 %zu 个输入全部通过\n", corpus.size());
+
+    if (mutate > 0) {
+        std::mt19937 rng(seed);
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<uint8_t> in;
+        for (long long i = 0; i < mutate; i++) {
+            in = corpus[rng() % corpus.size()];
+            int rounds = 1 + (int)(rng() % 4);
+            for (int r = 0; r < rounds; r++) fuzzMutate(in, corpus, rng);
+            fuzzExec(in.data(), in.size());
+        }
+        double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("变异 %lld 次无异常 (种子 %u), %.2fs, %.0f exec/s\n", mutate, seed, dt, mutate / dt);
+    }
+
+    if (bench) {
+        // 吞吐量：按语料顺序循环解析，统计每包耗时和字节速率
+        size_t bytes_per_pass = 0;
+        for (const std::vector<uint8_t>& in : corpus) bytes_per_pass += in.size();
+        uint64_t execs = 0, bytes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        double dt = 0;
+        while (dt < seconds) {
+            for (const std::vector<uint8_t>& in : corpus) LLVMFuzzerTestOneInput(in.data(), in.size());
+            execs += corpus.size();
+            bytes += bytes_per_pass;
+            dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+        double ns_per_packet = dt * 1e9 / execs;
+        double mb_per_s = bytes / dt / 1e6;
+        printf("解析吞吐量: %.0f 包/s, %.1f ns/包, %.2f MB/s (%zu 个输入, %.2fs)\n",
+               execs / dt, ns_per_packet, mb_per_s, corpus.size(), dt);
+        if (out_path) {
+            FILE* f = fopen(out_path, "w");
+            if (!f) {
+                fprintf(stderr, "无法写入 %s\n", out_path);
+                return 2;
+            }
+            fprintf(f, "{\n  \"version\": 1,\n  \"scenarios\": {\n    \"parser_corpus\": {\n"
+                       "      \"cpu_ns_per_packet\": %.2f,\n      \"packets_per_s\": %.0f,\n"
+                       "      \"mb_per_s\": %.3f,\n      \"inputs\": %zu\n    }\n  }\n}\n",
+                    ns_per_packet, execs / dt, mb_per_s, corpus.size());
+            fclose(f);
+        }
+    }
+    return 0;
+}
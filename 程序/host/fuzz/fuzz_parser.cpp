@@ -0,0 +1,180 @@
+// ============================================================================
+// 文件：fuzz_parser.cpp
+// 功能：parseDirectCommandData()的模糊测试目标（libFuzzer入口）
+// 说明：每个输入按一帧BLE写入数据解析。除了依靠ASan/UBSan发现越界和未定义行为，
+//       还用按协议独立实现的参考解码器核对解析后的目标值：
+//       不属于本设备或格式无效的包不得改动ble_motor_target，有效包必须得到同一数值；
+//       帧头筛选（cmdAddressed）丢弃的包对任何设备ID都不得含有指令；
+//       MULTI_SLOT包按固定的槽位/纪元核对，配置包不得改动目标值；
+//       同一输入也按串口二进制帧（FOC_SerialLink.h）解码，并核对编码-解码往返
+// ============================================================================
+#include "HAL_Host.h"
+#include "FOC.h"
+
+#include <memory>
+
+#define FUZZ_DEVICE_ID MY_DEVICE_ID  //!< 被测设备ID
+#define FUZZ_SLOT 3                   //!< 被测设备的槽位（每个输入前重新分配，配置包可改动）
+#define FUZZ_EPOCH 7                  //!< 槽位表纪元号
+
+// ============================================================================
+// 函数：fuzzReadInt16
+// 功能：读取大端int16
+// ============================================================================
+static int16_t fuzzReadInt16(const uint8_t* p) {
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static float fuzzScaleFor(uint8_t data_type) {
+    if (data_type == DATA_TYPE_CURRENT) return 1000.0f;
+    if (data_type == DATA_TYPE_VELOCITY) return VELOCITY_SCALE;
+    return ANGLE_SCALE;
+}
+
+// ============================================================================
+// 函数：fuzzReferenceDecode
+// 功能：协议参考解码（与ble_client.py打包格式及readme中的包格式说明一致）
+// 返回值：包含本设备目标值时返回true并给出value（配置包不改动目标值，返回false）
+// ============================================================================
+static bool fuzzReferenceDecode(const uint8_t* d, size_t len, uint8_t my_id, float* value) {
+    if (len < 3) return false;
+    bool hdr = d[0] == 0xAA && d[1] == 0x55 &&
+               (d[2] == PACKET_TYPE_SINGLE || d[2] == PACKET_TYPE_MULTI || d[2] == PACKET_TYPE_MULTI_STRUCT ||
+                d[2] == PACKET_TYPE_CONFIG || d[2] == PACKET_TYPE_MULTI_SLOT);
+    uint8_t type = hdr ? d[2] : d[0];
+
+    if (type == PACKET_TYPE_MULTI_SLOT && hdr) {
+        // 槽位：AA 55 05 DT EPOCH START COUNT V(start)..，按FUZZ_SLOT/FUZZ_EPOCH取值
+        if (len < 7) return false;
+        int start = d[5];
+        int count = d[6];
+        if (start < 1 || start > MAX_MOTORS || count < 1 || len != (size_t)(7 + count * 2)) return false;
+        if (d[4] != FUZZ_EPOCH || FUZZ_SLOT < start || FUZZ_SLOT > start + count - 1) return false;
+        *value = fuzzReadInt16(d + 7 + (FUZZ_SLOT - start) * 2) / fuzzScaleFor(d[3]);
+        return true;
+    }
+
+    if (type == PACKET_TYPE_SINGLE) {
+        // AA 55 01 DT ID VH VL  /  01 ID DT VH VL 00
+        if (len < (size_t)(hdr ? 7 : 6)) return false;
+        size_t id_off = hdr ? 4 : 1;
+        size_t val_off = hdr ? 5 : 3;
+        if (d[id_off] != my_id) return false;
+        *value = fuzzReadInt16(d + val_off) / ANGLE_SCALE;
+        return true;
+    }
+
+    if (type == PACKET_TYPE_MULTI) {
+        size_t dt_off = hdr ? 3 : 1;
+        float scale = fuzzScaleFor(d[dt_off]);
+        if (hdr && len >= 6) {
+            // 切片：AA 55 02 DT START COUNT V(start)..V(start+count-1)
+            int start = d[4];
+            int count = d[5];
+            if (start >= 1 && start <= MAX_MOTORS && count >= 1 && len == (size_t)(6 + count * 2)) {
+                if (my_id < start || my_id > start + count - 1) return false;
+                *value = fuzzReadInt16(d + 6 + (my_id - start) * 2) / scale;
+                return true;
+            }
+        }
+        if (hdr && len == 24) {
+            // 旧版整包：AA 55 02 DT V1..V10
+            if (my_id < 1 || my_id > 10) return false;
+            *value = fuzzReadInt16(d + 4 + (my_id - 1) * 2) / scale;
+            return true;
+        }
+        return false;
+    }
+
+    if (type == PACKET_TYPE_MULTI_STRUCT) {
+        // AA 55 03 DT COUNT (ID VH VL)*COUNT，取第一个匹配条目
+        size_t dt_off = hdr ? 3 : 1;
+        size_t items = dt_off + 2;
+        if (len < items) return false;
+        int count = d[dt_off + 1];
+        if (len < items + (size_t)count * 3) return false;
+        for (int i = 0; i < count; i++) {
+            const uint8_t* it = d + items + i * 3;
+            if (it[0] == my_id) {
+                *value = fuzzReadInt16(it + 1) / fuzzScaleFor(d[dt_off]);
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+// ============================================================================
+// 响应检查：必须是以设备ID开头的短文本
+// ============================================================================
+static void fuzzCheckResponse(const char* response) {
+    size_t n = strnlen(response, 64);
+    if (n == 0 || n >= 50 || atoi(response) != FUZZ_DEVICE_ID) {
+        fprintf(stderr, "非法响应: \"%.*s\"\n", (int)n, response);
+        abort();
+    }
+}
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc;
+    (void)argv;
+    halHostReset();
+    halHostSetLogEnabled(false);
+    initBLEServer();  // 设置设备ID并注册BLE传输（响应经ble_response_hook核对）
+    my_device_id = FUZZ_DEVICE_ID;
+    deviceConnected = true;
+    ble_response_hook = fuzzCheckResponse;
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // 每个输入从相同的已知目标开始，结果与输入顺序无关
+    const float prev = 12.5f;
+    ble_motor_target = prev;
+    new_command = false;
+    my_device_id = FUZZ_DEVICE_ID;  // 配置包可能改动ID/槽位，每个输入从相同的配置开始
+    setMySlot(FUZZ_SLOT, FUZZ_EPOCH);
+
+    // 解析器直接读取调用者缓冲区：复制到恰好size字节的堆内存，ASan可检出任何越界读
+    std::unique_ptr<uint8_t[]> packet(new uint8_t[size ? size : 1]);
+    if (size) memcpy(packet.get(), data, size);
+    parseDirectCommandData(packet.get(), size);
+
+    float expected;
+    bool accepted = fuzzReferenceDecode(data, size, FUZZ_DEVICE_ID, &expected);
+    if (!accepted) expected = prev;
+
+    bool ok = accepted ? fabsf(ble_motor_target - expected) <= 0.001f : ble_motor_target == prev;
+    if (!ok || !isfinite(ble_motor_target) || (new_command && !accepted)) {
+        fprintf(stderr, "目标值与协议不符: 长度%zu, 期望%s %.4f, 实际 %.4f (new_command=%d)\n",
+                size, accepted ? "接受" : "忽略", expected, ble_motor_target, (int)new_command);
+        abort();
+    }
+
+    // 帧头筛选不得丢弃含某个关节指令的包（对所有设备ID核对）
+    for (uint8_t id = 1; id <= MAX_MOTORS; id++) {
+        float v;
+        if (!cmdAddressed(packet.get(), size, id) && fuzzReferenceDecode(data, size, id, &v)) {
+            fprintf(stderr, "帧头筛选丢弃了设备%u的指令: 长度%zu\n", id, size);
+            abort();
+        }
+    }
+
+    // 串口二进制帧：任意字节按COBS解码不得越界（解码长度不超过输入长度）；
+    // 该包经串口编码后帧内不含0x00，解码必须原样还原
+    std::unique_ptr<uint8_t[]> decoded(new uint8_t[size ? size : 1]);
+    cobsDecode(packet.get(), size, decoded.get());
+    if (size + 3 <= SLINK_FRAME_MAX) {
+        uint8_t wire[SLINK_WIRE_MAX];
+        uint8_t frame[SLINK_FRAME_MAX];
+        size_t n = serialLinkEncodeFrame(SLINK_MSG_PACKET, data, size, wire);
+        size_t m = serialLinkDecodeFrame(wire + 1, n - 2, frame);
+        if (memchr(wire + 1, 0, n - 2) || m != size + 1 || frame[0] != SLINK_MSG_PACKET ||
+            (size && memcmp(frame + 1, data, size) != 0)) {
+            fprintf(stderr, "串口帧编解码往返不一致: 长度%zu, 编码%zu, 解码%zu\n", size, n, m);
+            abort();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+# ============================================================================
+# 文件：make_seed_corpus.py
+# 功能：用ble_client.py中的打包函数生成模糊测试种子语料
+# 用法：python3 make_seed_corpus.py [输出目录]（默认为同目录下的corpus/）
+# 说明：只调用打包函数，不需要真实的bleak库（导入时以空模块代替）
+# ============================================================================
+import os
+import struct
+import sys
+import types
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FW_DIR = os.path.normpath(os.path.join(HERE, "..", ".."))
+
+# ble_client.py顶层导入bleak，这里只需要打包函数
+if "bleak" not in sys.modules:
+    stub = types.ModuleType("bleak")
+    stub.BleakClient = object
+    stub.BleakScanner = object
+    sys.modules["bleak"] = stub
+sys.path.insert(0, FW_DIR)
+import ble_client  # noqa: E402
+
+MY_DEVICE_ID = 6
+MAX_MOTORS = 20
+DT_ANGLE, DT_VELOCITY, DT_CURRENT = 0x01, 0x02, 0x03
+
+
+def main():
+    out_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "corpus")
+    os.makedirs(out_dir, exist_ok=True)
+    c = ble_client.MultiBLECommunicator.__new__(ble_client.MultiBLECommunicator)
+    seeds = {}
+
+    # SINGLE：本设备/其它设备、各数据类型、边界数值
+    for dt in (DT_ANGLE, DT_VELOCITY, DT_CURRENT):
+        seeds[f"single_dt{dt}_self"] = c.create_single_packet(MY_DEVICE_ID, dt, 30.0)
+    seeds["single_other_id"] = c.create_single_packet(MY_DEVICE_ID + 1, DT_ANGLE, 30.0)
+    seeds["single_max"] = c.create_single_packet(MY_DEVICE_ID, DT_ANGLE, 3276.7)
+    seeds["single_min"] = c.create_single_packet(MY_DEVICE_ID, DT_ANGLE, -3276.8)
+    seeds["single_zero"] = c.create_single_packet(MY_DEVICE_ID, DT_ANGLE, 0.0)
+
+    # 切片MULTI：包含/不包含本设备、满20台、各数据类型
+    values = [float(i) * 1.5 - 10.0 for i in range(MAX_MOTORS)]
+    seeds["slice_all"] = c.create_multi_slice_packet(1, values, DT_ANGLE)
+    for start in (1, 5, 6, 7, 16):
+        seeds[f"slice_start{start}_n5"] = c.create_multi_slice_packet(start, values[start - 1:start + 4], DT_ANGLE)
+    seeds["slice_single"] = c.create_multi_slice_packet(MY_DEVICE_ID, [42.0], DT_ANGLE)
+    seeds["slice_velocity"] = c.create_multi_slice_packet(1, values[:10], DT_VELOCITY)
+    seeds["slice_current"] = c.create_multi_slice_packet(1, [0.5] * 10, DT_CURRENT)
+
+    # 旧版24字节整包：AA 55 02 DT V1..V10
+    legacy = bytearray([0xAA, 0x55, 0x02, DT_ANGLE])
+    for v in values[:10]:
+        legacy.extend(struct.pack(">h", int(v * 10.0)))
+    seeds["legacy_24"] = legacy
+
+    # MULTI_STRUCT：本设备在首/中/尾、不含本设备、重复ID、各数据类型
+    seeds["struct_self_first"] = c.create_multi_struct_packet([(6, 12.0), (7, 1.0), (8, 2.0)], DT_ANGLE)
+    seeds["struct_self_last"] = c.create_multi_struct_packet([(1, 1.0), (2, 2.0), (6, -45.0)], DT_ANGLE)
+    seeds["struct_missing"] = c.create_multi_struct_packet([(1, 1.0), (2, 2.0)], DT_ANGLE)
+    seeds["struct_duplicate"] = c.create_multi_struct_packet([(6, 1.0), (6, 2.0)], DT_ANGLE)
+    seeds["struct_all"] = c.create_multi_struct_packet([(i + 1, v) for i, v in enumerate(values)], DT_ANGLE)
+    seeds["struct_velocity"] = c.create_multi_struct_packet([(6, 5.0)], DT_VELOCITY)
+    seeds["struct_current"] = c.create_multi_struct_packet([(6, 1.25)], DT_CURRENT)
+
+    # 配置包：设置ID/槽位、查询（含ID为0的查询）、他人、参数越界、长度不符
+    seeds["config_set_id"] = c.create_config_packet(ble_client.CONFIG_OP_SET_ID, MY_DEVICE_ID, 9)
+    seeds["config_set_id_bad"] = c.create_config_packet(ble_client.CONFIG_OP_SET_ID, MY_DEVICE_ID, 0)
+    seeds["config_set_slot"] = c.create_config_packet(ble_client.CONFIG_OP_SET_SLOT, MY_DEVICE_ID, 2, 8)
+    seeds["config_query_any"] = c.create_config_packet(ble_client.CONFIG_OP_QUERY, 0)
+    seeds["config_other_id"] = c.create_config_packet(ble_client.CONFIG_OP_SET_ID, MY_DEVICE_ID + 1, 4)
+    seeds["config_bad_len"] = c.create_config_packet(ble_client.CONFIG_OP_SET_ID, MY_DEVICE_ID, 9, 9)
+
+    # 槽位包（模糊测试目标按槽位3、纪元7核对）：包含/不包含本槽位、纪元不符
+    seeds["slot_all"] = c.create_multi_slot_packet(7, 1, values[:8], DT_ANGLE)
+    seeds["slot_after"] = c.create_multi_slot_packet(7, 4, values[:4], DT_ANGLE)
+    seeds["slot_stale_epoch"] = c.create_multi_slot_packet(6, 1, values[:8], DT_ANGLE)
+    seeds["slot_velocity"] = c.create_multi_slot_packet(7, 3, [5.0], DT_VELOCITY)
+
+    # 无帧头格式与畸形包（长度/计数字段不一致）
+    seeds["raw_single"] = bytearray([0x01, MY_DEVICE_ID, DT_ANGLE, 0x01, 0x2C, 0x00])
+    seeds["raw_struct"] = bytearray([0x03, DT_ANGLE, 0x01, MY_DEVICE_ID, 0x00, 0x64])
+    seeds["bad_type"] = bytearray([0xAA, 0x55, 0x07, 0x01, 0x06, 0x00, 0x00])
+    seeds["short"] = bytearray([0xAA, 0x55])
+    seeds["slice_count_too_big"] = c.create_multi_slice_packet(1, values[:5], DT_ANGLE)
+    seeds["slice_count_too_big"][5] = 200
+    seeds["struct_count_too_big"] = c.create_multi_struct_packet([(6, 1.0)], DT_ANGLE)
+    seeds["struct_count_too_big"][4] = 255
+
+    # 回归：切片START+COUNT超过255（曾在uint8_t上回绕，导致本设备数据被忽略）
+    seeds["slice_end_id_wrap"] = c.create_multi_slice_packet(5, [1.0] * 252, DT_ANGLE)
+
+    for name, pkt in sorted(seeds.items()):
+        with open(os.path.join(out_dir, name + ".bin"), "wb") as f:
+            f.write(bytes(pkt))
+    print(f"生成 {len(seeds)} 个种子 -> {out_dir}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,100 @@
+// ============================================================================
+// 文件：radio_gateway_main.cpp
+// 功能：ESP-NOW网关的主机替身 - 经UDP组播每周期广播一帧含全部关节目标的无线帧
+// 用法：foc_radio_gateway [组播地址:端口] [--joints N] [--period ms] [--seconds 秒] [--amp 度] [--freq Hz]
+//                         [--group 组号] [--struct]
+// 说明：无线帧格式见FOC_RadioLink.h（默认MULTI切片，--struct时用MULTI_STRUCT），目标为正弦轨迹，
+//       相邻关节相位依次错开；收端为foc_sim --radio-udp（同一组播地址和端口，可同时运行多个）。
+//       周期用绝对时间定时，结束时输出发送统计、周期抖动和ESP-NOW空中时间估算
+// ============================================================================
+#include "SimHarness.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string addr = "239.255.70.67:47067";
+    int joints = 8;
+    double period_ms = 5.0;
+    double seconds = 5.0;
+    double amp_deg = 30.0;
+    double freq_hz = 0.5;
+    int group = RADIO_GROUP;
+    bool use_struct = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--joints" && i + 1 < argc) {
+            joints = atoi(argv[++i]);
+        } else if (arg == "--period" && i + 1 < argc) {
+            period_ms = atof(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--amp" && i + 1 < argc) {
+            amp_deg = atof(argv[++i]);
+        } else if (arg == "--freq" && i + 1 < argc) {
+            freq_hz = atof(argv[++i]);
+        } else if (arg == "--group" && i + 1 < argc) {
+            group = atoi(argv[++i]);
+        } else if (arg == "--struct") {
+            use_struct = true;
+        } else if (arg[0] != '-') {
+            addr = arg;
+        } else {
+            fprintf(stderr, "用法: foc_radio_gateway [组播地址:端口] [--joints N] [--period ms] [--seconds 秒] "
+                            "[--amp 度] [--freq Hz] [--group 组号] [--struct]\n");
+            return 2;
+        }
+    }
+    if (joints < 1 || joints > MAX_MOTORS || period_ms <= 0) {
+        fprintf(stderr, "关节数须为1..%d，周期须大于0\n", MAX_MOTORS);
+        return 2;
+    }
+
+    std::string host = addr.substr(0, addr.find(':'));
+    uint16_t port = addr.find(':') != std::string::npos ? (uint16_t)atoi(addr.c_str() + addr.find(':') + 1) : 47067;
+    halRadioBegin(RADIO_CHANNEL);
+    if (!halHostRadioUdp(host.c_str(), port)) {
+        fprintf(stderr, "无法打开组播 %s:%u\n", host.c_str(), port);
+        return 1;
+    }
+
+    std::vector<float> values(joints);
+    std::vector<uint8_t> ids(joints);
+    for (int j = 0; j < joints; j++) ids[j] = (uint8_t)(j + 1);
+    uint8_t frame[HAL_RADIO_MAX];
+    uint64_t cycles = (uint64_t)(seconds * 1e3 / period_ms);
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(period_ms));
+    auto t0 = std::chrono::steady_clock::now();
+    double jitter_max_us = 0, jitter_sum_us = 0;
+    uint32_t sent = 0, errors = 0;
+    size_t frame_len = 0;
+
+    for (uint64_t c = 0; c < cycles; c++) {
+        auto deadline = t0 + period * c;
+        std::this_thread::sleep_until(deadline);
+        double jitter = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - deadline).count();
+        jitter_sum_us += jitter;
+        if (jitter > jitter_max_us) jitter_max_us = jitter;
+
+        double t = c * period_ms * 1e-3;
+        for (int j = 0; j < joints; j++) values[j] = (float)(amp_deg * sin(2.0 * PI * (freq_hz * t + (double)j / joints)));
+        std::string packet = use_struct ? simMakeMultiStructPacket(ids.data(), values.data(), (uint8_t)joints, DATA_TYPE_ANGLE)
+                                        : simMakeMultiSlicePacket(1, values.data(), (uint8_t)joints, DATA_TYPE_ANGLE);
+        packet = simMakeSequencedPacket((uint16_t)c, packet);
+        frame_len = radioLinkEncode((uint8_t)group, (const uint8_t*)packet.data(), packet.size(), frame);
+        if (frame_len > 0 && halRadioBroadcast(frame, frame_len)) {
+            sent++;
+        } else {
+            errors++;
+        }
+    }
+
+    printf("网关 %s:%u：%d 个关节（%s），组号 %d，周期 %.3fms，发送 %u 帧，失败 %u\n", host.c_str(), port, joints,
+           use_struct ? "MULTI_STRUCT" : "MULTI切片", group, period_ms, sent, errors);
+    printf("周期唤醒抖动：平均 %.1fus，最大 %.1fus；每帧 %zu 字节，ESP-NOW空中时间约 %.0fus（占空比 %.1f%%）\n",
+           cycles ? jitter_sum_us / cycles : 0.0, jitter_max_us, frame_len, 50 + 310 + 192 + (43 + frame_len) * 8.0,
+           (50 + 310 + 192 + (43 + frame_len) * 8.0) / (period_ms * 10.0));
+    return 0;
+}
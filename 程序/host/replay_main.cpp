@@ -0,0 +1,76 @@
+// ============================================================================
+// 文件：replay_main.cpp
+// 功能：现场捕获重放程序 - 以最快速度把捕获数据重放过控制代码
+// 用法：foc_replay <捕获文件> [--loops N] [--log] [--expect-hash 指纹]
+// 说明：捕获文件可以是二进制（foc_sim --trace 或设备导出后转存），
+//       也可以是含"TRACE BEGIN ... TRACE END"的串口日志。
+//       输出与记录不一致、调用顺序失步或指纹不符时返回1，可用于回归测试；
+//       不加--log时关闭调试输出，便于用perf等工具剖析控制代码
+// ============================================================================
+#include "TraceReplay.h"
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    uint64_t max_loops = 0;
+    bool log = false;
+    const char* expect_hash = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--loops" && i + 1 < argc) {
+            max_loops = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--log") {
+            log = true;
+        } else if (arg == "--expect-hash" && i + 1 < argc) {
+            expect_hash = argv[++i];
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "未知参数: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "用法: foc_replay <捕获文件> [--loops N] [--log] [--expect-hash 指纹]\n");
+        return 2;
+    }
+
+    std::vector<uint8_t> bytes;
+    std::string err;
+    TracePlayer player;
+    if (!traceLoadFile(path, bytes, &err) || !player.load(bytes, &err)) {
+        fprintf(stderr, "载入失败: %s\n", err.c_str());
+        return 2;
+    }
+
+    halHostSetLogEnabled(log);
+    TraceReplayStats st = player.run(max_loops);
+    halHostSetLogEnabled(true);
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)st.output_hash);
+    double trace_s = st.trace_us * 1e-6;
+    printf("捕获: %zu 字节, 设备ID %d, 覆盖 %.3fs%s\n", bytes.size(), player.deviceId(), trace_s,
+           player.hasOutputs() ? "" : "（未记录输出，仅计算指纹）");
+    printf("重放: loop %llu 次, 记录 %llu 条, BLE帧 %llu, 耗时 %.3fs (%.0f loop/s, 实时倍率 %.1fx)\n",
+           (unsigned long long)st.loops, (unsigned long long)st.records, (unsigned long long)st.frames,
+           st.wall_s, st.loops / (st.wall_s > 0 ? st.wall_s : 1e-9), trace_s / (st.wall_s > 0 ? st.wall_s : 1e-9));
+    printf("输出核对: %llu 项, 不一致 %llu 项", (unsigned long long)st.outputs_checked,
+           (unsigned long long)st.output_mismatches);
+    if (st.output_mismatches) printf("（首个位于偏移 %zu）", st.first_mismatch_offset);
+    printf("\n输出指纹: %s\n", hash);
+
+    int rc = 0;
+    if (st.desync) {
+        printf("失步: %s（偏移 %zu）\n", st.desync_reason.c_str(), st.desync_offset);
+        rc = 1;
+    } else if (!st.complete && max_loops == 0) {
+        printf("未消耗全部记录\n");
+        rc = 1;
+    }
+    if (st.output_mismatches) rc = 1;
+    if (expect_hash && strcmp(expect_hash, hash) != 0) {
+        printf("指纹不符: 期望 %s\n", expect_hash);
+        rc = 1;
+    }
+    return rc;
+}
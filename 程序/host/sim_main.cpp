@@ -0,0 +1,661 @@
+// ============================================================================
+// 文件：sim_main.cpp
+// 功能：闭环仿真程序 - 在主机上运行Pos_Current_Velocity.ino的setup()/loop()
+// 用法：foc_sim [仿真秒数] [目标输出角度(度)] [--csv] [--trace 捕获文件] [--inject 故障@秒]
+//              [--supply 电源电压] [--bus-r 电源内阻] [--load 输出端负载N·m]
+//              [--drop 秒] [--wdog 策略[:超时ms]] [--disconnect 秒[:重连秒]] [--burst 帧数]
+//              [--binary 遥测Hz] [--can 周期ms[:关节数]] [--radio 周期ms[:关节数]] [--radio-restart 秒]
+//              [--radio-udp 组播地址:端口]
+//              [--provision 设备ID[:槽位]]
+// 说明：被控对象由PlantSim提供，目标值通过BLE SINGLE包注入，
+//       --csv时每1ms输出一行：时间,目标角度,输出角度,电机速度,q轴电流；
+//       --trace时按设备端格式捕获全部HAL输入/输出，可用foc_replay重放；
+//       --inject在指定时刻注入故障，检验故障管理器（FOC_Fault.h）：
+//         i2c（编码器无应答）、adc（A相零点漂移，表现为过流）、
+//         jump（磁铁偏移突变）、stall（单次loop卡顿50ms）；
+//       --supply/--bus-r设置电源空载电压和内阻（固件设定值仍为15.6V），检验母线电压补偿；
+//       --load施加恒定负载，检验绕组热模型和电流降额（FOC_Thermal.h）；
+//       --drop时目标包每20ms重发一次（模拟上位机连续发送），到指定时刻停止发送，
+//       --wdog选择看门狗策略（hold/decel/damp/coast）和指令超时（默认100ms），检验安全停车（FOC_Watchdog.h）；
+//       --disconnect在指定时刻断开BLE连接（可指定重连时刻），检验连接状态机不阻塞控制环；
+//       --burst时每20ms经接收FIFO突发写入若干带序号的目标包（模拟写无响应流水线发送，
+//       每10个序号丢弃1个模拟空中丢包），输出队列与序号统计；
+//       --binary时经串口二进制协议（FOC_SerialLink.h）每20ms发送带序号的目标包（每50帧损坏1帧检验CRC），
+//       按指定频率接收并解码遥测，输出帧统计与下行带宽占用；
+//       --can时模拟CAN总线主机（FOC_CanLink.h）：按周期发送分组目标帧和SYNC（默认8个关节，
+//       本设备为其中之一），接收本设备的遥测/状态帧，输出响应延迟、周期计数核对和整条总线的占用估算；
+//       --radio时本设备作为ESP-NOW网关（FOC_RadioLink.h）：主机每周期经串口发送一帧含全部关节目标的无线帧，
+//       设备广播并在本机取出自己的目标，输出广播帧数和与BLE逐台写入的空中时间对比；
+//       --radio-restart模拟网关脚本在指定时刻重启：此前的无线帧目标为0°，此后序号从0重新开始、
+//       目标为设定值，检验关节重新同步序号并执行重启后的指令；
+//       --radio-udp时本设备作为关节，从UDP组播替身接收foc_radio_gateway广播的无线帧，仿真按墙上时钟运行；
+//       --provision时启动后先经BLE配置包设置设备ID（写入NVS）并可分配槽位，目标包按新ID/槽位构造
+//       （指定槽位时为MULTI_SLOT包），结束时重新启动一次，核对ID从NVS恢复、槽位被清除。
+//       结束时按所选模式核对关键结果（故障锁存、降额上限、看门狗停车、序号/帧计数、NVS恢复等；
+//       未选模式时核对到达目标），不符时输出"检查失败"并返回1，供CTest回归
+// ============================================================================
+#include "SimHarness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define SIM_TRACE_CAPACITY (64u << 20)  //!< 主机捕获缓冲区上限（字节）
+#define SIM_TARGET_TOL_DEG 0.5          //!< 到达目标的容差（输出端，度）
+#define SIM_STOP_VEL_TOL 0.1            //!< 看门狗停车后的电机速度容差（rad/s）
+
+static std::string sim_ble_reply;  //!< 最近一条BLE回复（--provision时记录）
+static void simRecordBleReply(const char* text) { sim_ble_reply = text; }
+
+int main(int argc, char** argv) {
+    double seconds = 3.0;
+    float target_deg = 30.0f;
+    bool csv = false;
+    const char* trace_path = nullptr;
+    std::string inject;
+    double inject_at = -1;
+    PlantParams params;
+    float load = 0;
+    double drop_at = -1;
+    std::string wdog;
+    double disconnect_at = -1;
+    double reconnect_at = -1;
+    int burst = 0;
+    int binary_hz = -1;
+    double can_period_ms = -1;
+    int can_joints = 8;
+    double radio_period_ms = -1;
+    int radio_joints = 8;
+    double radio_restart_at = -1;
+    std::string radio_udp;
+    int provision_id = 0;
+    int provision_slot = 0;
+    int pos = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--supply" && i + 1 < argc) {
+            params.v_bus = (float)atof(argv[++i]);
+        } else if (arg == "--bus-r" && i + 1 < argc) {
+            params.bus_resistance = (float)atof(argv[++i]);
+        } else if (arg == "--load" && i + 1 < argc) {
+            load = (float)atof(argv[++i]);
+        } else if (arg == "--drop" && i + 1 < argc) {
+            drop_at = atof(argv[++i]);
+        } else if (arg == "--disconnect" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            disconnect_at = atof(spec.c_str());
+            if (spec.find(':') != std::string::npos) reconnect_at = atof(spec.c_str() + spec.find(':') + 1);
+        } else if (arg == "--burst" && i + 1 < argc) {
+            burst = atoi(argv[++i]);
+        } else if (arg == "--binary" && i + 1 < argc) {
+            binary_hz = atoi(argv[++i]);
+        } else if (arg == "--radio" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            radio_period_ms = atof(spec.c_str());
+            if (spec.find(':') != std::string::npos) radio_joints = atoi(spec.c_str() + spec.find(':') + 1);
+        } else if (arg == "--radio-restart" && i + 1 < argc) {
+            radio_restart_at = atof(argv[++i]);
+        } else if (arg == "--radio-udp" && i + 1 < argc) {
+            radio_udp = argv[++i];
+        } else if (arg == "--provision" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            provision_id = atoi(spec.c_str());
+            provision_slot = spec.find(':') != std::string::npos ? atoi(spec.c_str() + spec.find(':') + 1) : 0;
+        } else if (arg == "--can" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            can_period_ms = atof(spec.c_str());
+            if (spec.find(':') != std::string::npos) can_joints = atoi(spec.c_str() + spec.find(':') + 1);
+        } else if (arg == "--wdog" && i + 1 < argc) {
+            wdog = argv[++i];
+        } else if (arg == "--inject" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t at = spec.find('@');
+            inject = spec.substr(0, at);
+            inject_at = at == std::string::npos ? 1.0 : atof(spec.c_str() + at + 1);
+        } else if (pos == 0) {
+            seconds = atof(argv[i]);
+            pos++;
+        } else {
+            target_deg = (float)atof(argv[i]);
+        }
+    }
+
+    std::vector<uint8_t> trace_buf;
+    if (trace_path) {
+        trace_buf.resize(SIM_TRACE_CAPACITY);
+        traceBegin(trace_buf.data(), trace_buf.size(), TRACE_FLAG_OUTPUTS);
+    }
+
+    PlantSim plant(params);
+    simBoot(plant);
+    plant.setLoadTorque(load);
+    uint64_t t_start = halHostNowMicros();
+
+    if (!wdog.empty() || drop_at >= 0) {
+        // 经串口命令配置（与设备端操作一致，捕获文件中可重放）
+        std::string policy = wdog.substr(0, wdog.find(':'));
+        std::string timeout = wdog.find(':') != std::string::npos ? wdog.substr(wdog.find(':') + 1) : "100";
+        for (auto& c : policy) c = (char)toupper((unsigned char)c);
+        std::string cmd = (policy.empty() ? "" : "WATCHDOG " + policy + "\n") + "WATCHDOG TIMEOUT " + timeout + "\n";
+        halHostSerialInject((const uint8_t*)cmd.data(), cmd.size());
+    }
+    // 运行时配置：与上位机相同，经BLE配置包设置ID和槽位
+    std::string provision_reply;
+    if (provision_id > 0) {
+        // 与现场一致：关节已在运行（控制周期测量已开始）时才收到配置包
+        for (int k = 0; k < 100; k++) {
+            loop();
+            halHostAdvanceMicros(SIM_LOOP_OVERHEAD_US);
+        }
+        ble_response_hook = simRecordBleReply;
+        parseDirectCommandData(simMakeConfigPacket(CONFIG_OP_SET_ID, getMyDeviceID(), provision_id));
+        provision_reply = sim_ble_reply;
+        if (provision_slot > 0) {
+            parseDirectCommandData(simMakeConfigPacket(CONFIG_OP_SET_SLOT, getMyDeviceID(), provision_slot, 1));
+            provision_reply += " / " + sim_ble_reply;
+        }
+    }
+    std::string packet = simMakeSinglePacket(getMyDeviceID(), DATA_TYPE_ANGLE, target_deg);
+    if (provision_slot > 0) {
+        // 槽位1..provision_slot的紧凑包（其余关节的值与本设备相同）
+        std::vector<float> values(provision_slot, target_deg);
+        packet = simMakeMultiSlotPacket(1, 1, values.data(), (uint8_t)provision_slot, DATA_TYPE_ANGLE);
+    }
+
+    // 二进制串口：0x00切换模式，文本命令帧设置遥测频率，目标包经串口帧发送
+    bool binary = binary_hz >= 0;
+    uint8_t wire[SLINK_WIRE_MAX];
+    std::string seq_packet = simMakeSequencedPacket(0, packet);
+    uint16_t link_seq = 0;
+    uint32_t link_sent = 0, link_corrupted = 0;
+    auto sendSerialPacket = [&]() {
+        seq_packet[1] = (char)(link_seq >> 8);
+        seq_packet[2] = (char)(link_seq & 0xFF);
+        link_seq++;
+        size_t n = serialLinkEncodeFrame(SLINK_MSG_PACKET, (const uint8_t*)seq_packet.data(), seq_packet.size(), wire);
+        if (++link_sent % 50 == 0) {
+            wire[n / 2] ^= 0x10;  // 模拟线路误码（不产生0x00，帧界不变）
+            if (wire[n / 2] == 0) wire[n / 2] = 0x10;
+            link_corrupted++;
+        }
+        halHostSerialInject(wire, n);
+    };
+    if (binary) {
+        halHostSerialCapture(true);
+        std::string cmd = "SLINK RATE " + std::to_string(binary_hz);
+        uint8_t nul = 0;
+        halHostSerialInject(&nul, 1);
+        halHostSerialInject(wire, serialLinkEncodeFrame(SLINK_MSG_TEXT, (const uint8_t*)cmd.data(), cmd.size(), wire));
+        sendSerialPacket();
+    } else if (can_period_ms < 0 && radio_period_ms < 0 && radio_udp.empty()) {
+        parseDirectCommandData(packet);
+    }
+
+    // ESP-NOW网关：全部关节的目标放在一个带序号的MULTI切片包里，经串口帧交给设备广播
+    bool radio = radio_period_ms > 0;
+    if (radio_joints < 1) radio_joints = 1;
+    if (radio_joints > MAX_MOTORS) radio_joints = MAX_MOTORS;
+    uint64_t radio_period_us = radio ? (uint64_t)(radio_period_ms * 1000.0) : 0;
+    uint64_t next_radio = t_start;
+    uint16_t radio_seq = 0;
+    uint32_t radio_sent = 0, radio_heard = 0, radio_mismatch = 0;
+    std::string radio_frame;
+    auto makeRadioFrame = [&](float deg) {
+        std::vector<float> values(radio_joints, deg);
+        std::string slice = simMakeSequencedPacket(0, simMakeMultiSlicePacket(1, values.data(), (uint8_t)radio_joints,
+                                                                              DATA_TYPE_ANGLE));
+        radio_frame.resize(RADIO_HEADER_SIZE + slice.size());
+        radioLinkEncode(RADIO_GROUP, (const uint8_t*)slice.data(), slice.size(), (uint8_t*)&radio_frame[0]);
+    };
+    uint64_t t_radio_restart = radio_restart_at >= 0 ? t_start + (uint64_t)(radio_restart_at * 1e6) : UINT64_MAX;
+    if (radio) {
+        makeRadioFrame(t_radio_restart != UINT64_MAX ? 0.0f : target_deg);
+        if (!binary) {
+            uint8_t nul = 0;
+            halHostSerialInject(&nul, 1);
+        }
+    }
+    // UDP组播替身：仿真按墙上时钟推进，与外部网关进程的发送节奏一致
+    bool radio_wall = !radio_udp.empty();
+    if (radio_wall) {
+        std::string group = radio_udp.substr(0, radio_udp.find(':'));
+        uint16_t port = radio_udp.find(':') != std::string::npos ? (uint16_t)atoi(radio_udp.c_str() + radio_udp.find(':') + 1)
+                                                                 : 47067;
+        if (!halHostRadioUdp(group.c_str(), port)) {
+            fprintf(stderr, "无法加入组播组 %s:%u\n", group.c_str(), port);
+            return 1;
+        }
+    }
+
+    // CAN总线主机：全部关节目标相同，分组帧在前、SYNC在后
+    bool can = can_period_ms > 0;
+    if (can_joints < 1) can_joints = 1;
+    if (can_joints > MAX_MOTORS) can_joints = MAX_MOTORS;
+    uint64_t can_period_us = can ? (uint64_t)(can_period_ms * 1000.0) : 0;
+    uint64_t next_can = t_start;
+    uint64_t can_sync_at = 0;
+    uint8_t can_cycle = 0;
+    uint32_t can_syncs = 0, can_replies = 0, can_status = 0, can_missed = 0, can_cycle_errors = 0;
+    uint64_t can_latency_sum = 0, can_latency_max = 0, can_bits = 0;
+    bool can_waiting = false;
+    CanJointState can_state = {};
+    // 标准帧位数（含帧间隔和最坏情况位填充）
+    auto canFrameBits = [](uint8_t len) { return (uint64_t)(47 + 8 * len + (34 + 8 * len - 1) / 4); };
+
+    // 主机端遥测解码
+    std::vector<uint8_t> tx_chunk;
+    tx_chunk.reserve(SLINK_ENCODED_MAX);
+    uint8_t tx_buf[4096];
+    uint8_t frame[SLINK_FRAME_MAX];
+    uint32_t telem_frames = 0, telem_crc = 0, telem_bad = 0, telem_gaps = 0, replies = 0;
+    uint64_t tx_bytes = 0;
+    uint16_t telem_seq = 0;
+    Telemetry telem = {};
+    std::string last_reply;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t t_end = t_start + (uint64_t)(seconds * 1e6);
+    uint64_t next_sample = t_start;
+    uint64_t loops = 0;
+    if (csv) printf("t_s,target_deg,output_deg,motor_vel_rad_s,iq_a\n");
+
+    uint64_t t_inject = inject_at >= 0 ? t_start + (uint64_t)(inject_at * 1e6) : UINT64_MAX;
+    uint64_t t_trip = 0;
+    uint64_t t_drop = drop_at >= 0 ? t_start + (uint64_t)(drop_at * 1e6) : (binary ? UINT64_MAX : 0);
+    uint64_t next_resend = t_start + 20000;
+    uint64_t t_wd_trip = 0;
+    uint64_t t_disconnect = disconnect_at >= 0 ? t_start + (uint64_t)(disconnect_at * 1e6) : UINT64_MAX;
+    uint64_t t_reconnect = reconnect_at >= 0 ? t_start + (uint64_t)(reconnect_at * 1e6) : UINT64_MAX;
+    uint32_t max_loop_us = 0;
+    uint64_t next_burst = t_start;
+    uint16_t tx_seq = 0;
+    uint32_t burst_pushed = 0, burst_skipped = 0;
+    std::vector<std::string> burst_packets;
+    for (int k = 1; k <= burst; k++) {
+        burst_packets.push_back(simMakeSequencedPacket(0, simMakeSinglePacket(getMyDeviceID(), DATA_TYPE_ANGLE,
+                                                                                target_deg * k / burst)));
+    }
+    double wd_trip_deg = 0;
+    while (halHostNowMicros() < t_end) {
+        if (halHostNowMicros() < t_drop && halHostNowMicros() >= next_resend) {
+            if (binary) {
+                sendSerialPacket();
+            } else {
+                parseDirectCommandData(packet);
+            }
+            next_resend += 20000;
+        }
+        if (can && halHostNowMicros() >= next_can) {
+            if (can_waiting) can_missed++;
+            int16_t raw[CAN_GROUP_SIZE];
+            uint8_t data[8];
+            for (int g = 0; g * CAN_GROUP_SIZE < can_joints; g++) {
+                uint8_t count = (uint8_t)std::min(CAN_GROUP_SIZE, can_joints - g * CAN_GROUP_SIZE);
+                for (int k = 0; k < count; k++) raw[k] = floatToInt16(target_deg, ANGLE_SCALE);
+                uint8_t len = canPackGroup(raw, count, data);
+                halHostCanInject(CAN_ID_GROUP | (DATA_TYPE_ANGLE << 4) | g, data, len);
+                can_bits += canFrameBits(len);
+            }
+            data[0] = ++can_cycle;
+            halHostCanInject(CAN_ID_SYNC, data, 1);
+            // 每个关节回送一帧遥测，状态帧按CAN_STATUS_DIVIDER分摊
+            can_bits += canFrameBits(1) + can_joints * canFrameBits(8) * (CAN_STATUS_DIVIDER + 1) / CAN_STATUS_DIVIDER;
+            can_sync_at = halHostNowMicros();
+            can_syncs++;
+            can_waiting = true;
+            next_can += can_period_us;
+        }
+        if (radio && halHostNowMicros() >= next_radio) {
+            if (halHostNowMicros() >= t_radio_restart) {
+                // 网关脚本重启：序号从0重新开始，发送新的目标
+                radio_seq = 0;
+                makeRadioFrame(target_deg);
+                t_radio_restart = UINT64_MAX;
+            }
+            radio_frame[RADIO_HEADER_SIZE + 1] = (char)(radio_seq >> 8);
+            radio_frame[RADIO_HEADER_SIZE + 2] = (char)(radio_seq & 0xFF);
+            radio_seq++;
+            halHostSerialInject(wire, serialLinkEncodeFrame(SLINK_MSG_RADIO, (const uint8_t*)radio_frame.data(),
+                                                            radio_frame.size(), wire));
+            radio_sent++;
+            next_radio += radio_period_us;
+        }
+        if (burst > 0 && halHostNowMicros() >= next_burst) {
+            // 一个连接间隔内到达的多帧：目标值逐帧逼近最终目标（包已预先构造，只改写序号，不分配内存）
+            for (int k = 0; k < burst; k++, tx_seq++) {
+                if (tx_seq % 10 == 9) {  // 模拟空中丢包
+                    burst_skipped++;
+                    continue;
+                }
+                std::string& p = burst_packets[k];
+                p[1] = (char)(tx_seq >> 8);
+                p[2] = (char)(tx_seq & 0xFF);
+                bleRxPush((const uint8_t*)p.data(), p.size());
+                burst_pushed++;
+            }
+            next_burst += 20000;
+        }
+        if (halHostNowMicros() >= t_disconnect) {
+            t_disconnect = UINT64_MAX;
+            deviceConnected = false;
+            traceRecordConnection(false);
+        }
+        if (halHostNowMicros() >= t_reconnect) {
+            t_reconnect = UINT64_MAX;
+            deviceConnected = true;
+            traceRecordConnection(true);
+        }
+        uint64_t t_loop = halHostNowMicros();
+        if (halHostNowMicros() >= t_inject) {
+            t_inject = UINT64_MAX;
+            if (inject == "i2c") {
+                plant.setSensorFault(true);
+            } else if (inject == "adc") {
+                plant.params.adc_offset_a += 1.8f;
+            } else if (inject == "jump") {
+                plant.params.sensor_offset += 1.5f;
+            } else if (inject == "stall") {
+                halHostAdvanceMicros(50000);
+            } else {
+                fprintf(stderr, "未知故障类型: %s\n", inject.c_str());
+                return 2;
+            }
+        }
+        loop();
+        halHostAdvanceMicros(SIM_LOOP_OVERHEAD_US);
+        if (halHostNowMicros() - t_loop > max_loop_us) max_loop_us = (uint32_t)(halHostNowMicros() - t_loop);
+        loops++;
+        if (binary) {
+            size_t n;
+            while ((n = halHostSerialTake(tx_buf, sizeof(tx_buf))) > 0) {
+                tx_bytes += n;
+                for (size_t k = 0; k < n; k++) {
+                    if (tx_buf[k] != 0) {
+                        if (tx_chunk.size() < SLINK_ENCODED_MAX) tx_chunk.push_back(tx_buf[k]);
+                        continue;
+                    }
+                    if (tx_chunk.empty()) continue;
+                    bool crc_error;
+                    size_t len = serialLinkDecodeFrame(tx_chunk.data(), tx_chunk.size(), frame, &crc_error);
+                    uint16_t seq;
+                    if (len > 0 && frame[0] == SLINK_MSG_TELEMETRY &&
+                        telemetryDecode(frame + 1, len - 1, &seq, &telem)) {
+                        if (telem_frames && seq != (uint16_t)(telem_seq + 1)) telem_gaps++;
+                        telem_seq = seq;
+                        telem_frames++;
+                    } else if (len > 0 && frame[0] == SLINK_MSG_REPLY) {
+                        last_reply.assign((const char*)frame + 1, len - 1);
+                        replies++;
+                    } else if (crc_error) {
+                        telem_crc++;
+                    } else {
+                        telem_bad++;
+                    }
+                    tx_chunk.clear();
+                }
+            }
+        }
+        if (radio) {
+            uint8_t heard[HAL_RADIO_MAX];
+            size_t n;
+            while ((n = halHostRadioTake(heard, sizeof(heard))) > 0) {
+                radio_heard++;
+                if (n != radio_frame.size() || memcmp(heard, radio_frame.data(), n) != 0) radio_mismatch++;
+            }
+        }
+        if (radio_wall) {
+            double ahead = (halHostNowMicros() - t_start) * 1e-6 -
+                           std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+            if (ahead > 0.001) std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+        }
+        if (can) {
+            uint32_t id;
+            uint8_t data[8];
+            uint8_t len;
+            while (halHostCanTake(&id, data, &len)) {
+                if (id == (uint32_t)(CAN_ID_STATUS + getMyDeviceID())) {
+                    canUnpackStatus(data, len, &can_state);
+                    can_status++;
+                } else if (id == (uint32_t)(CAN_ID_TELEMETRY + getMyDeviceID()) && canUnpackTelemetry(data, len, &can_state)) {
+                    if (can_state.cycle != can_cycle) can_cycle_errors++;
+                    uint64_t latency = halHostNowMicros() - can_sync_at;
+                    can_latency_sum += latency;
+                    if (latency > can_latency_max) can_latency_max = latency;
+                    can_replies++;
+                    can_waiting = false;
+                }
+            }
+        }
+        if (!t_trip && faultActive()) t_trip = halHostNowMicros();
+        if (!t_wd_trip && watchdogStatus().trip_count) {
+            t_wd_trip = halHostNowMicros();
+            wd_trip_deg = plant.outputAngle() * 180.0 / PI;
+        }
+
+        if (csv && halHostNowMicros() >= next_sample) {
+            printf("%.4f,%.2f,%.4f,%.3f,%.4f\n",
+                   (halHostNowMicros() - t_start) * 1e-6, target_deg,
+                   plant.outputAngle() * 180.0 / PI, plant.motorVelocity(), plant.currentQ());
+            next_sample += 1000;
+        }
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double sim = (halHostNowMicros() - t_start) * 1e-6;
+    int failures = 0;
+    auto check = [&](bool ok, const char* what) {
+        if (ok) return;
+        fprintf(stderr, "检查失败：%s\n", what);
+        failures++;
+    };
+    fprintf(csv ? stderr : stdout,
+            "仿真 %.2fs, loop %llu 次 (%.0f Hz), 耗时 %.3fs, 实时倍率 %.1fx, 零电角度 %.3f, 输出角度 %.3f° (目标 %.2f°)\n",
+            sim, (unsigned long long)loops, loops / sim, wall, sim / wall, zero_electric_angle,
+            plant.outputAngle() * 180.0 / PI, target_deg);
+    if (params.v_bus != PlantParams().v_bus || params.bus_resistance > 0) {
+        fprintf(csv ? stderr : stdout, "母线电压：实际 %.2fV，固件%s %.2fV\n", plant.busVoltage(),
+                vbus_sensing ? "实测" : "设定", voltage_power_supply);
+        if (vbus_sensing) check(fabs(voltage_power_supply - plant.busVoltage()) < 0.02f * plant.busVoltage(), "母线电压实测值与实际电压相差超过2%");
+    }
+
+    const ThermalState& ts = thermalState();
+    fprintf(csv ? stderr : stdout, "绕组温度 %.1f°C，电流上限 %.2fA，相电阻辨识 %.3fΩ（模型 %.2fΩ）\n",
+            ts.temperature, ts.current_limit, ts.r_identified, params.R);
+    if (load != 0) {
+        check(!faultActive(), "负载运行中触发故障");
+        check(ts.current_limit >= THERMAL_I_CONT - 1e-3f && ts.current_limit <= THERMAL_I_PEAK + 1e-3f,
+              "电流上限超出连续电流~峰值电流范围");
+        if (ts.temperature > THERMAL_T_DERATE + 1.0f) check(ts.current_limit < THERMAL_I_PEAK, "超过降额起点后电流上限未降低");
+        check(fabsf(plant.currentQ()) <= ts.current_limit * 1.05f, "q轴电流超过降额后的上限");
+    }
+
+    if (disconnect_at >= 0) {
+        const BleLinkStatus& ls = bleLinkStatus();
+        fprintf(csv ? stderr : stdout,
+                "BLE连接：%s，断开 %lu 次，重新广播 %lu 次（%.3fs 断开，%.3fs 重新广播），最长loop %luus\n",
+                bleLinkStateName(ls.state), (unsigned long)ls.disconnects, (unsigned long)ls.adv_restarts,
+                disconnect_at, ls.adv_restarts ? ls.last_adv_restart_ms * 1e-3 - t_start * 1e-6 : 0.0,
+                (unsigned long)max_loop_us);
+        check(ls.disconnects == 1, "断开次数不为1");
+        check(reconnect_at >= 0 ? ls.state == BLE_LINK_CONNECTED : ls.state != BLE_LINK_CONNECTED, "连接状态与断开/重连不符");
+        check(max_loop_us < FAULT_LOOP_OVERRUN_US && !faultActive(), "断开连接时控制环阻塞或触发故障");
+        check(watchdogStatus().reason == WATCHDOG_REASON_LINK && watchdogStatus().state == WATCHDOG_STOPPED,
+              "断开连接后看门狗未停车");
+    }
+
+    if (burst > 0) {
+        const BleRxStats& rx = bleRxStats();
+        const CommandLinkStats& cs = cmdLinkStats(CMD_TRANSPORT_BLE);
+        fprintf(csv ? stderr : stdout,
+                "接收FIFO：发送 %u 帧，入队 %lu，解析 %lu，队列满丢弃 %lu，最高占用 %u/%d，序号丢失 %lu，过期 %lu\n",
+                (unsigned)tx_seq, (unsigned long)rx.frames, (unsigned long)rx.processed,
+                (unsigned long)rx.overflows, rx.high_water, BLE_RX_FIFO_DEPTH, (unsigned long)cs.seq_lost,
+                (unsigned long)cs.seq_stale);
+        const MemStats& ms = memStats();
+        fprintf(csv ? stderr : stdout, "堆分配：最近1秒 %lu 次（%lu 字节），累计 %lu 次\n",
+                (unsigned long)ms.allocs_per_s, (unsigned long)ms.bytes_per_s, (unsigned long)ms.allocs);
+        // 写入的帧要么入队要么计为队列满，入队的全部解析；序号丢失只来自模拟丢包和队列满
+        check(rx.frames + rx.overflows == burst_pushed, "写入的帧既未入队也未计为队列满");
+        check(rx.processed == rx.frames, "入队的帧未全部解析");
+        check(cs.seq_stale == 0 && cs.seq_lost <= burst_skipped + rx.overflows, "序号丢失/过期多于模拟丢包和队列满");
+        check(ms.allocs_per_s == 0, "稳态运行中有堆分配");
+    }
+
+    if (binary) {
+        const SerialLinkStats& ls = serialLinkStats();
+        const CommandLinkStats& cs = cmdLinkStats(CMD_TRANSPORT_SERIAL);
+        fprintf(csv ? stderr : stdout,
+                "二进制串口：发送 %lu 帧（损坏 %lu），设备有效帧 %lu，CRC错误 %lu，成帧错误 %lu，序号丢失 %lu，"
+                "回复 %lu 条（最后 \"%s\"）\n",
+                (unsigned long)link_sent, (unsigned long)link_corrupted, (unsigned long)ls.frames,
+                (unsigned long)ls.crc_errors, (unsigned long)ls.framing_errors, (unsigned long)cs.seq_lost,
+                (unsigned long)replies, last_reply.c_str());
+        fprintf(csv ? stderr : stdout,
+                "遥测：%lu Hz，解码 %lu 帧（%.1f 帧/s），CRC错误 %lu，无效 %lu，序号缺口 %lu；下行 %.0f 字节/s，"
+                "占 %lu 波特容量 %.1f%%\n",
+                (unsigned long)cs.telemetry_hz, (unsigned long)telem_frames, telem_frames / sim,
+                (unsigned long)telem_crc, (unsigned long)telem_bad, (unsigned long)telem_gaps, tx_bytes / sim,
+                (unsigned long)halHostSerialBaud(), tx_bytes / sim * 10.0 / halHostSerialBaud() * 100.0);
+        fprintf(csv ? stderr : stdout,
+                "最后一帧遥测：t=%luus，角度 %.4f rad（目标 %.4f），速度 %.3f rad/s，iq %.3fA，母线 %.2fV，"
+                "温度 %.1f°C，故障 0x%04X，看门狗 %s，指令序号 %u\n",
+                (unsigned long)telem.t_us, telem.angle, telem.target, telem.velocity, telem.iq, telem.bus_voltage,
+                telem.temperature, telem.fault, watchdogStateName(telem.watchdog), telem.rx_seq);
+        // 损坏的帧全部被CRC拒绝，其余（含开头的文本命令帧）全部收到并回复；遥测无缺口
+        check(ls.crc_errors == link_corrupted && ls.framing_errors == 0, "CRC错误数与损坏帧数不符");
+        check(ls.frames == link_sent - link_corrupted + 1 && replies == link_sent - link_corrupted, "有效帧或回复丢失");
+        check(cs.seq_lost <= link_corrupted && cs.seq_stale == 0, "序号丢失多于损坏帧");
+        if (binary_hz > 0) {
+            check(telem_crc == 0 && telem_bad == 0 && telem_gaps == 0, "遥测帧损坏或序号缺口");
+            check(telem_frames + 1 >= (uint32_t)(binary_hz * sim * 0.99), "遥测帧数低于设定频率");
+        }
+    }
+
+    if (can) {
+        const CanLinkStats& ls = canLinkStats();
+        const CommandLinkStats& cs = cmdLinkStats(CMD_TRANSPORT_CAN);
+        fprintf(csv ? stderr : stdout,
+                "CAN总线：周期 %.2fms，%d 个关节，SYNC %lu 次，设备收到 %lu 帧（锁存 %lu，覆盖 %lu，他人 %lu，未知 %lu），"
+                "回送遥测 %lu 帧、状态 %lu 帧（未回送周期 %lu，周期计数不符 %lu）\n",
+                can_period_ms, can_joints, (unsigned long)can_syncs, (unsigned long)ls.frames,
+                (unsigned long)ls.latched, (unsigned long)ls.overwritten, (unsigned long)(cs.rejected + cs.ignored),
+                (unsigned long)ls.unknown, (unsigned long)can_replies, (unsigned long)can_status, (unsigned long)can_missed,
+                (unsigned long)can_cycle_errors);
+        fprintf(csv ? stderr : stdout,
+                "SYNC→遥测延迟：平均 %.1fus，最大 %lluus；总线占用估算 %.1f%%（%lu bit/s）\n",
+                can_replies ? (double)can_latency_sum / can_replies : 0.0, (unsigned long long)can_latency_max,
+                can_bits / sim * 100.0 / halHostCanBitrate(), (unsigned long)halHostCanBitrate());
+        fprintf(csv ? stderr : stdout,
+                "最后一帧遥测：角度 %.4f rad，速度 %.2f rad/s，iq %.3fA，母线 %.2fV，温度 %.1f°C，故障 0x%04X，看门狗 %s\n",
+                can_state.angle, can_state.velocity, can_state.iq, can_state.bus_voltage, can_state.temperature,
+                can_state.fault, watchdogStateName(can_state.watchdog));
+        check(can_missed == 0 && can_replies == can_syncs, "有SYNC周期未回送遥测");
+        check(can_cycle_errors == 0 && ls.overwritten == 0 && ls.unknown == 0, "周期计数不符或帧被覆盖/未知");
+    }
+
+    if (radio || radio_wall) {
+        const RadioLinkStats& rs = radioLinkStats();
+        const CommandLinkStats& cs = cmdLinkStats(CMD_TRANSPORT_RADIO);
+        fprintf(csv ? stderr : stdout,
+                "无线广播：%s%lu 帧，设备处理 %lu 帧（组号不符 %lu），含本设备指令 %lu，帧头筛选丢弃 %lu，序号 %u，"
+                "丢失 %lu，过期 %lu，重新同步 %lu\n",
+                radio ? "经串口网关发送 " : "UDP组播收到 ", (unsigned long)(radio ? radio_sent : rs.frames),
+                (unsigned long)rs.frames, (unsigned long)rs.foreign, (unsigned long)cs.accepted,
+                (unsigned long)cs.rejected, cs.last_seq,
+                (unsigned long)cs.seq_lost, (unsigned long)cs.seq_stale, (unsigned long)cs.seq_resync);
+        check(rs.frames > 0 && rs.foreign == 0 && cs.accepted == rs.frames, "无线帧未收到或未全部取到本设备指令");
+        check(cs.seq_lost == 0 && cs.seq_stale == 0, "无线帧序号丢失或过期");
+        if (radio) check(rs.frames == radio_sent, "设备处理的无线帧少于网关发送");
+        check(cs.seq_resync == (radio_restart_at >= 0 ? 1u : 0u), "序号重新同步次数与网关重启不符");
+        if (radio_restart_at >= 0) {
+            check(fabs(plant.outputAngle() * 180.0 / PI - target_deg) < SIM_TARGET_TOL_DEG, "网关重启后的指令未生效");
+        }
+    }
+    if (radio) {
+        // 空中时间估算：ESP-NOW为802.11b 1Mbps长前导（DIFS+平均退避+前导192us+43字节帧头/FCS），
+        // BLE为1M PHY写无响应（17字节开销，加两个T_IFS和空应答包）
+        size_t payload = radio_frame.size();
+        double espnow_us = 50 + 310 + 192 + (43 + payload) * 8.0;
+        size_t ble_packet = payload - RADIO_HEADER_SIZE;
+        double ble_us = (17 + ble_packet) * 8.0 + 150 + 80 + 150;
+        fprintf(csv ? stderr : stdout,
+                "网关广播 %lu 帧（内容不符 %lu），每帧 %zu 字节/%d 个关节；空中时间：ESP-NOW %.0fus/周期（与关节数无关），"
+                "BLE逐台写入 %d×%.0fus=%.0fus/周期\n",
+                (unsigned long)radio_heard, (unsigned long)radio_mismatch, payload, radio_joints, espnow_us,
+                radio_joints, ble_us, radio_joints * ble_us);
+        check(radio_heard == radio_sent && radio_mismatch == 0, "网关广播的帧缺失或内容不符");
+    }
+
+    const WatchdogStatus& ws = watchdogStatus();
+    if (ws.trip_count) {
+        fprintf(csv ? stderr : stdout,
+                "看门狗 %s（策略 %s，%s）于 %.4fs 停车%s，停车后输出端移动 %.3f°，电机速度 %.2f rad/s\n",
+                watchdogStateName(ws.state), watchdogPolicyName(ws.policy),
+                ws.reason == WATCHDOG_REASON_LINK ? "连接断开" : "指令超时", (t_wd_trip - t_start) * 1e-6,
+                ws.stop_us ? ("，减速用时 " + std::to_string(ws.stop_us / 1000) + "ms").c_str() : "",
+                plant.outputAngle() * 180.0 / PI - wd_trip_deg, plant.motorVelocity());
+    }
+    if (drop_at >= 0) {
+        check(ws.trip_count > 0 && ws.state == WATCHDOG_STOPPED, "停止发送后看门狗未停车");
+        check(fabsf(plant.motorVelocity()) < SIM_STOP_VEL_TOL, "看门狗停车后电机未停止");
+    }
+
+    const FaultStatus& fs = faultStatus();
+    if (fs.latched != FAULT_NONE) {
+        fprintf(csv ? stderr : stdout, "故障 0x%04X（首个 %s，触发值 %.3f）于 %.4fs 锁存，PWM占空比 %u/%u/%u\n",
+                fs.latched, faultName(fs.first), fs.trip_value, (t_trip - t_start) * 1e-6,
+                halHostPwmDuty(0), halHostPwmDuty(1), halHostPwmDuty(2));
+    } else if (!inject.empty()) {
+        fprintf(csv ? stderr : stdout, "未触发故障（最大相电流 %.2fA，最长周期 %luus）\n",
+                fs.peak_current, (unsigned long)fs.max_period_us);
+    }
+    if (!inject.empty()) {
+        uint16_t expect = inject == "i2c" ? FAULT_ENCODER_I2C : inject == "adc" ? FAULT_OVERCURRENT
+                        : inject == "jump" ? FAULT_ANGLE_JUMP : FAULT_LOOP_OVERRUN;
+        check(fs.first == expect, "注入的故障未被识别为对应的故障码");
+        check(t_trip && t_trip - t_start <= (uint64_t)(inject_at * 1e6) + 100000, "注入后100ms内未锁存故障");
+        check(halHostPwmDuty(0) == 0 && halHostPwmDuty(1) == 0 && halHostPwmDuty(2) == 0, "故障锁存后PWM占空比不为零");
+    }
+
+    if (trace_path) {
+        traceStop();
+        FILE* f = fopen(trace_path, "wb");
+        if (!f || fwrite(traceData(), 1, traceLength(), f) != traceLength()) {
+            fprintf(stderr, "写入捕获文件失败: %s\n", trace_path);
+            if (f) fclose(f);
+            return 1;
+        }
+        fclose(f);
+        fprintf(csv ? stderr : stdout, "捕获 %zu 字节 (%.1f 字节/loop)%s -> %s\n", traceLength(),
+                (double)traceLength() / (loops ? loops : 1), traceTruncated() ? "，缓冲区已满被截断" : "", trace_path);
+    }
+
+    if (provision_id > 0) {
+        const CommandLinkStats& cs = cmdLinkStats(CMD_TRANSPORT_BLE);
+        fprintf(csv ? stderr : stdout, "运行时配置：回复 \"%s\"，ID %d，槽位 %d（纪元 %d），目标包 %zu 字节，接受 %lu 帧\n",
+                provision_reply.c_str(), getMyDeviceID(), getMySlot(), getMySlotEpoch(), packet.size(),
+                (unsigned long)cs.accepted);
+        check(provision_reply.find(":CONFIG:ID=" + std::to_string(provision_id)) != std::string::npos &&
+              provision_reply.find("PENDING") == std::string::npos, "设置ID的回复不符");
+        check(getMyDeviceID() == provision_id && getMySlot() == provision_slot && cs.accepted > 0,
+              "新ID/槽位未生效或目标包未被接受");
+        check(!faultActive(), "保存ID后锁存了故障（NVS写入的停顿被计为控制环超时）");
+        simBoot(plant);  // 模拟断电重启：NVS保留
+        fprintf(csv ? stderr : stdout, "重启后：ID %d（NVS），槽位 %d\n", getMyDeviceID(), getMySlot());
+        check(getMyDeviceID() == provision_id && getMySlot() == 0, "重启后ID未从NVS恢复或槽位未清除");
+    }
+
+    // 未选择任何模式（含--supply）时核对到达目标
+    bool plain = inject.empty() && load == 0 && drop_at < 0 && disconnect_at < 0 && burst == 0 && !binary &&
+                 !can && !radio && !radio_wall && provision_id == 0;
+    if (plain) {
+        check(!faultActive(), "触发故障");
+        check(fabs(plant.outputAngle() * 180.0 / PI - target_deg) < SIM_TARGET_TOL_DEG, "输出角度未到达目标");
+    }
+    return failures ? 1 : 0;
+}
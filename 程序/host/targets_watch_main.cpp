@@ -0,0 +1,287 @@
+// ============================================================================
+// 文件：targets_watch_main.cpp
+// 功能：目标文件增量读取（ctl/TargetsWatcher）+ 实时发送 - 监听运行或测量"文件变化→首包"延迟
+// 用法：foc_targets_watch [文件] [--rate Hz] [--seconds 秒]
+//       foc_targets_watch [文件] --bench 次数 [--rate Hz] [--changes 每次改动的关节数]
+// 说明：监听运行：文件的每次保存只把值变化的关节交给HostController（经回环传输发送），
+//       并打印变化的关节和"通知→入队"耗时；--seconds为0时一直运行。
+//       --bench：在临时目录复制一份文件，另一个线程反复改动其中几个关节的值
+//       （交替原地重写和"写临时文件再改名"两种保存方式，间隔5~20ms随机），测量
+//         保存→通知：开始保存到inotify事件到达（含写入和close/rename）；
+//         通知→入队：pread、增量解析、比较、setTarget()；
+//         入队→首包：等到实时线程下一个周期把新值写入传输（平均约半个周期）；
+//       并输出映射/解析字节数之比。对照：ble_input_output.py每0.5s轮询并整文件哈希、
+//       重新解析，通知延迟平均约250ms
+// ============================================================================
+#include "ctl/HostController.h"
+#include "ctl/TargetsWatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#ifndef FOC_TARGETS_CSV
+#define FOC_TARGETS_CSV "targets.csv"
+#endif
+
+// ============================================================================
+// 数据结构定义：LatencySample
+// 功能：一次改动的各阶段时刻（CLOCK_MONOTONIC，ns）
+// ============================================================================
+struct LatencySample {
+    uint64_t written;           //!< 开始保存（写入+关闭，或写临时文件+改名）
+    uint64_t event;             //!< inotify事件到达
+    uint64_t enqueued;          //!< 变化的关节已交给HostController
+    uint64_t packet;            //!< 新值第一次写入传输
+};
+
+// ============================================================================
+// 类：ProbeTransport
+// 功能：回环传输 + 首包探针：等待中的关节解码得到期望值时记录时刻
+// ============================================================================
+class ProbeTransport : public LoopbackTransport {
+public:
+    ProbeTransport(const uint8_t* ids, int count) : LoopbackTransport(ids, count) {}
+
+    void arm(int link, int16_t raw, uint64_t* out) {
+        probe_out = out;
+        probe_raw = raw;
+        probe_link.store(link, std::memory_order_release);
+    }
+    bool fired() const { return probe_link.load(std::memory_order_acquire) < 0; }
+
+    bool write(int link, const uint8_t* data, size_t len) override {
+        bool ok = LoopbackTransport::write(link, data, len);
+        if (link == probe_link.load(std::memory_order_acquire) && joint(link).has_target && joint(link).raw == probe_raw) {
+            *probe_out = HostController::nowNs();
+            probe_link.store(-1, std::memory_order_release);
+        }
+        return ok;
+    }
+
+private:
+    std::atomic<int> probe_link{-1};
+    int16_t probe_raw = 0;
+    uint64_t* probe_out = nullptr;
+};
+
+static void printPercentiles(const char* name, std::vector<double> us) {
+    if (us.empty()) return;
+    std::sort(us.begin(), us.end());
+    double sum = 0;
+    for (double v : us) sum += v;
+    printf("  %-10s 平均 %8.1fus  p50 %8.1fus  p99 %8.1fus  最大 %8.1fus\n", name, sum / us.size(), us[us.size() / 2],
+           us[std::min(us.size() - 1, us.size() * 99 / 100)], us.back());
+}
+
+static bool writeFile(const std::string& path, const std::string& content, bool rename_save) {
+    std::string target = rename_save ? path + ".tmp" : path;
+    FILE* f = fopen(target.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(content.data(), 1, content.size(), f) == content.size();
+    ok = fclose(f) == 0 && ok;
+    if (ok && rename_save) ok = rename(target.c_str(), path.c_str()) == 0;
+    return ok;
+}
+
+// ============================================================================
+// 函数：runBench
+// 功能：改动→首包延迟测量
+// ============================================================================
+static int runBench(const char* src, int iterations, int changes_per_write, HostControllerConfig cfg) {
+    std::ifstream in(src, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "无法读取 %s\n", src);
+        return 2;
+    }
+    std::vector<std::string> lines;
+    for (std::string l; std::getline(in, l);) lines.push_back(l);
+
+    char tmpl[] = "/tmp/foc_targets_XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        perror("mkdtemp");
+        return 2;
+    }
+    std::string dir = tmpl, path = dir + "/targets.csv";
+    auto render = [&]() {
+        std::string s;
+        for (auto& l : lines) s += l + "\n";
+        return s;
+    };
+    writeFile(path, render(), false);
+
+    TargetsWatcher watcher(path.c_str());
+    if (!watcher.open()) {
+        fprintf(stderr, "inotify不可用\n");
+        return 1;
+    }
+    std::vector<int> id_line(MAX_MOTORS + 1, -1);
+    int max_id = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        TargetsFile one;
+        int id = parseTargetsLine(lines[i].data(), lines[i].size(), one);
+        if (id >= 1 && id <= MAX_MOTORS) {
+            id_line[id] = (int)i;
+            max_id = std::max(max_id, id);
+        }
+    }
+    if (max_id == 0) {
+        fprintf(stderr, "%s 中没有关节\n", src);
+        return 2;
+    }
+    uint8_t ids[MAX_MOTORS];
+    for (int j = 0; j < max_id; j++) ids[j] = (uint8_t)(j + 1);
+    ProbeTransport transport(ids, max_id);
+    cfg.delta.data_type = watcher.snapshot().data_type;
+    HostController ctl(transport, cfg);
+    for (const TargetsChange& c : watcher.changes()) ctl.setTarget(c.id, c.value);
+    ctl.start();
+
+    std::vector<LatencySample> samples(iterations, LatencySample{});
+    std::atomic<int> current{-1};
+    std::atomic<bool> writer_done{false};
+    float scale = ctlScaleFor(watcher.snapshot().data_type);
+    // 写线程的初始值在启动前复制：此后主线程的wait()/ingest()会修改快照
+    std::vector<float> value(MAX_MOTORS + 1, 0.0f);
+    for (auto& kv : watcher.snapshot().id_values) {
+        if (kv.first >= 1 && kv.first <= MAX_MOTORS) value[kv.first] = kv.second;
+    }
+    std::thread writer([&] {
+        std::mt19937 rng(1);
+        for (int i = 0; i < iterations; i++) {
+            int probe_id = 0;
+            for (int k = 0; k < changes_per_write; k++) {
+                int id;
+                do {
+                    id = std::uniform_int_distribution<int>(1, max_id)(rng);
+                } while (id_line[id] < 0);
+                float v;
+                do {
+                    v = std::uniform_int_distribution<int>(-900, 900)(rng) / 10.0f;
+                } while (floatToInt16(v, scale) == floatToInt16(value[id], scale));
+                value[id] = v;
+                std::ostringstream os;
+                os << id << "," << v;
+                lines[id_line[id]] = os.str();
+                probe_id = id;
+            }
+            transport.arm(probe_id - 1, floatToInt16(value[probe_id], scale), &samples[i].packet);
+            current.store(i, std::memory_order_release);
+            std::string content = render();
+            samples[i].written = HostController::nowNs();
+            writeFile(path, content, i & 1);
+            for (int w = 0; w < 1000 && !transport.fired(); w++) usleep(1000);
+            usleep(std::uniform_int_distribution<int>(5000, 20000)(rng));
+        }
+        writer_done.store(true);
+    });
+    while (!writer_done.load()) {
+        if (!watcher.wait(50)) continue;
+        uint64_t event = watcher.stats().last_event_ns;
+        for (const TargetsChange& c : watcher.changes()) ctl.setTarget(c.id, c.value);
+        int i = current.load(std::memory_order_acquire);
+        if (i >= 0 && samples[i].event == 0) {
+            samples[i].event = event;
+            samples[i].enqueued = HostController::nowNs();
+        }
+    }
+    writer.join();
+    ctl.stop();
+
+    std::vector<double> notify, ingest, send, total;
+    int missed = 0;
+    for (const LatencySample& s : samples) {
+        if (!s.written || !s.event || !s.packet || s.event < s.written) {
+            missed++;
+            continue;
+        }
+        notify.push_back((s.event - s.written) / 1e3);
+        ingest.push_back((s.enqueued - s.event) / 1e3);
+        send.push_back(s.packet > s.enqueued ? (s.packet - s.enqueued) / 1e3 : 0.0);
+        total.push_back((s.packet - s.written) / 1e3);
+    }
+    const TargetsWatcherStats& ws = watcher.stats();
+    printf("改动 %d 次（每次 %d 个关节，交替原地重写/改名保存），发送周期 %.1fms；事件 %llu，读取 %llu，整文件解析 %llu，"
+           "未测到 %d\n",
+           iterations, changes_per_write, cfg.period_us / 1e3, (unsigned long long)ws.events,
+           (unsigned long long)ws.reloads, (unsigned long long)ws.full_parses, missed);
+    printf("读入 %llu 字节，解析 %llu 字节（%.1f%%），变化关节 %llu 个\n", (unsigned long long)ws.bytes_read,
+           (unsigned long long)ws.bytes_parsed, ws.bytes_read ? 100.0 * ws.bytes_parsed / ws.bytes_read : 0.0,
+           (unsigned long long)ws.changes);
+    printPercentiles("保存→通知", notify);
+    printPercentiles("通知→入队", ingest);
+    printPercentiles("入队→首包", send);
+    printPercentiles("保存→首包", total);
+
+    unlink(path.c_str());
+    unlink((path + ".tmp").c_str());
+    rmdir(dir.c_str());
+    return missed ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = FOC_TARGETS_CSV;
+    double seconds = 0;
+    double rate = 100.0;
+    int bench = 0;
+    int changes = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench = atoi(argv[++i]);
+        } else if (arg == "--changes" && i + 1 < argc) {
+            changes = atoi(argv[++i]);
+        } else if (arg[0] != '-') {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "用法: foc_targets_watch [文件] [--rate Hz] [--seconds 秒] [--bench 次数 [--changes N]]\n");
+            return 2;
+        }
+    }
+    if (rate <= 0 || changes < 1) {
+        fprintf(stderr, "频率须大于0，每次改动的关节数至少为1\n");
+        return 2;
+    }
+    HostControllerConfig cfg;
+    cfg.period_us = (uint32_t)(1e6 / rate);
+    if (bench > 0) return runBench(path, bench, changes, cfg);
+
+    TargetsWatcher watcher(path);
+    if (!watcher.open()) {
+        fprintf(stderr, "inotify不可用\n");
+        return 1;
+    }
+    uint8_t ids[MAX_MOTORS];
+    for (int j = 0; j < MAX_MOTORS; j++) ids[j] = (uint8_t)(j + 1);
+    LoopbackTransport transport(ids, MAX_MOTORS);
+    HostControllerConfig live = cfg;
+    live.delta.data_type = watcher.snapshot().data_type;
+    HostController ctl(transport, live);
+    for (const TargetsChange& c : watcher.changes()) ctl.setTarget(c.id, c.value);
+    printf("监听 %s：%zu 个关节，%.0fHz发送（回环传输）\n", path, watcher.changes().size(), rate);
+    ctl.start();
+    uint64_t end = seconds > 0 ? HostController::nowNs() + (uint64_t)(seconds * 1e9) : 0;
+    while (!end || HostController::nowNs() < end) {
+        if (!watcher.wait(100)) continue;
+        for (const TargetsChange& c : watcher.changes()) ctl.setTarget(c.id, c.value);
+        printf("变化 %zu 个关节（通知→入队 %.1fus）:", watcher.changes().size(),
+               (HostController::nowNs() - watcher.stats().last_event_ns) / 1e3);
+        for (const TargetsChange& c : watcher.changes()) printf(" %d=%.1f", c.id, c.value);
+        printf("\n");
+        fflush(stdout);
+    }
+    ctl.stop();
+    const DeltaSenderStats& d = ctl.sender().stats();
+    printf("发送 %llu 包 %llu 字节，文件读取 %llu 次\n", (unsigned long long)d.packets, (unsigned long long)d.bytes,
+           (unsigned long long)watcher.stats().reloads);
+    return 0;
+}
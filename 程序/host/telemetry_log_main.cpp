@@ -0,0 +1,300 @@
+// ============================================================================
+// 文件：telemetry_log_main.cpp
+// 功能：遥测日志工具 - 记录基准与按时间范围读取
+// 用法：foc_telemetry_log bench [--joints N] [--rate Hz] [--seconds 秒] [--burst 帧数] [--out 文件]
+//       foc_telemetry_log read <文件> [--from 秒] [--to 秒] [--id N] [--csv]
+// 说明：bench为每个关节起一个线程模拟该连接的通知回调，按固件格式（telemetryEncode +
+//       BLE_TELEMETRY_MARKER）以给定频率送入TelemetryLogger（--burst为不限速送入N帧，测吞吐上限）；
+//       结束后用TelemetryLogReader映射日志，核对每个关节的帧数、序号连续性和字段内容，
+//       并核对按时间范围切片的结果与逐帧扫描一致。read输出各设备的帧数/时间范围/序号缺口，
+//       --csv输出切片内的逐帧数据
+// ============================================================================
+#include "ctl/HostController.h"
+#include "ctl/TelemetryLogger.h"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+static void usage() {
+    fprintf(stderr, "用法: foc_telemetry_log bench [--joints N] [--rate Hz] [--seconds 秒] [--burst 帧数] [--out 文件]\n"
+                    "      foc_telemetry_log read <文件> [--from 秒] [--to 秒] [--id N] [--csv]\n");
+}
+
+// 第i帧的合成遥测（核对时按同一公式重算）
+static void benchSample(int joint, uint32_t i, uint32_t period_us, Telemetry* t) {
+    t->t_us = i * period_us;
+    t->angle = sinf(0.001f * (float)i + (float)joint);
+    t->velocity = cosf(0.001f * (float)i + (float)joint);
+    t->iq = 0.01f * (float)(i % 100);
+    t->target = (float)joint;
+    t->bus_voltage = 12.0f;
+    t->temperature = 25.0f + 0.001f * (float)(i % 1000);
+    t->fault = 0;
+    t->watchdog = 0;
+    t->rx_seq = (uint16_t)i;
+}
+
+struct Producer {
+    int joint;
+    uint32_t frames;            //!< 送入的帧
+    double ingest_sum_ns;
+    uint64_t ingest_max_ns;
+    uint64_t late_max_ns;       //!< 生产线程唤醒延迟（衡量模拟负载本身是否跟上）
+};
+
+static void produce(TelemetryLogger* log, Producer* p, double rate, double seconds, uint32_t burst) {
+    uint8_t buf[TELEMETRY_SIZE + 1];
+    buf[0] = BLE_TELEMETRY_MARKER;
+    uint32_t period_us = burst ? 1000 : (uint32_t)(1e6 / rate);
+    uint64_t period_ns = burst ? 1000000ull : (uint64_t)(1e9 / rate);
+    uint32_t n = burst ? burst : (uint32_t)(seconds * rate);
+    uint64_t t0 = HostController::nowNs() + 1000000ull;
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t due = t0 + i * period_ns;
+        if (!burst) {
+            timespec ts = {(time_t)(due / 1000000000ull), (long)(due % 1000000000ull)};
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+            }
+        }
+        Telemetry t;
+        benchSample(p->joint, i, period_us, &t);
+        telemetryEncode(t, (uint16_t)i, buf + 1);
+        uint64_t a = HostController::nowNs();
+        if (!burst && a - due > p->late_max_ns) p->late_max_ns = a - due;
+        log->ingest(p->joint - 1, buf, sizeof(buf), burst ? due : a);
+        uint64_t d = HostController::nowNs() - a;
+        p->ingest_sum_ns += (double)d;
+        if (d > p->ingest_max_ns) p->ingest_max_ns = d;
+        p->frames++;
+    }
+}
+
+static int cmdBench(int argc, char** argv) {
+    int joints = 20;
+    double rate = 1000.0, seconds = 5.0;
+    uint32_t burst = 0;
+    std::string out = "telemetry.ftl";
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--joints" && i + 1 < argc) {
+            joints = atoi(argv[++i]);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--burst" && i + 1 < argc) {
+            burst = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (joints < 1 || joints > MAX_MOTORS || rate <= 0 || seconds <= 0) {
+        fprintf(stderr, "关节数须为1..%d，频率和时长须大于0\n", MAX_MOTORS);
+        return 2;
+    }
+
+    TelemetryLoggerConfig cfg;
+    cfg.links = joints;
+    TelemetryLogger log(cfg);
+    std::string err;
+    if (!log.open(out.c_str(), &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    for (int j = 0; j < joints; j++) log.setDevice(j, (uint8_t)(j + 1));
+    std::vector<Producer> prod(joints);
+    std::vector<std::thread> threads;
+    uint64_t w0 = HostController::nowNs();
+    for (int j = 0; j < joints; j++) {
+        prod[j] = Producer{j + 1, 0, 0, 0, 0};
+        threads.emplace_back(produce, &log, &prod[j], rate, seconds, burst);
+    }
+    for (auto& t : threads) t.join();
+    double produce_s = (HostController::nowNs() - w0) * 1e-9;
+    uint64_t c0 = HostController::nowNs();
+    log.close();
+    double close_ms = (HostController::nowNs() - c0) * 1e-6;
+    TelemetryLoggerStats s = log.stats();
+
+    double ingest_sum = 0;
+    uint64_t ingest_max = 0, late_max = 0, sent = 0;
+    for (const Producer& p : prod) {
+        ingest_sum += p.ingest_sum_ns;
+        ingest_max = p.ingest_max_ns > ingest_max ? p.ingest_max_ns : ingest_max;
+        late_max = p.late_max_ns > late_max ? p.late_max_ns : late_max;
+        sent += p.frames;
+    }
+    if (burst) {
+        printf("遥测记录（不限速）：%d 个关节 × %u 帧，%.3fs，%.0f 帧/s\n", joints, burst, produce_s, sent / produce_s);
+    } else {
+        printf("遥测记录：%d 个关节 × %.0fHz，%.1fs（生产线程最大唤醒延迟 %.0fus）\n", joints, rate, seconds,
+               late_max / 1e3);
+    }
+    printf("入队：%llu 帧，丢弃 %llu，队列最高占用 %u/%u；入队耗时 平均 %.0f ns，最大 %.1f us\n",
+           (unsigned long long)s.frames, (unsigned long long)s.dropped, s.max_fill, cfg.ring_depth,
+           sent ? ingest_sum / sent : 0.0, ingest_max / 1e3);
+    printf("写入：%llu 块，%llu 字节（%.1f 字节/帧），写入失败 %llu，关闭 %.2f ms\n", (unsigned long long)s.blocks,
+           (unsigned long long)s.bytes, s.frames ? (double)s.bytes / s.frames : 0.0,
+           (unsigned long long)s.write_errors, close_ms);
+
+    // 读回核对
+    TelemetryLogReader rd;
+    uint64_t r0 = HostController::nowNs();
+    if (!rd.open(out.c_str(), &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    double open_us = (HostController::nowNs() - r0) * 1e-3;
+    std::vector<uint32_t> got(joints + 1, 0), next(joints + 1, 0);
+    uint64_t bad = 0, gaps = 0;
+    uint32_t period_us = burst ? 1000 : (uint32_t)(1e6 / rate);
+    for (const TelemetryBlockRef& b : rd.blocks()) {
+        if (b.device < 1 || b.device > joints) {
+            bad += b.count;
+            continue;
+        }
+        const uint32_t* t_us = (const uint32_t*)rd.column(b, TLOG_CH_T_US);
+        const uint16_t* seq = (const uint16_t*)rd.column(b, TLOG_CH_SEQ);
+        const float* angle = (const float*)rd.column(b, TLOG_CH_ANGLE);
+        const float* temp = (const float*)rd.column(b, TLOG_CH_TEMPERATURE);
+        for (uint16_t k = 0; k < b.count; k++) {
+            uint32_t i = t_us[k] / period_us;
+            Telemetry t;
+            benchSample(b.device, i, period_us, &t);
+            if (i < next[b.device] || seq[k] != (uint16_t)i || angle[k] != t.angle || temp[k] != t.temperature) bad++;
+            if (i > next[b.device]) gaps += i - next[b.device];
+            next[b.device] = i + 1;
+            got[b.device]++;
+        }
+    }
+    uint64_t logged = 0;
+    for (int j = 1; j <= joints; j++) {
+        logged += got[j];
+        gaps += prod[j - 1].frames - next[j];  // 末尾丢弃的帧
+    }
+
+    // 时间切片：中间三分之一，与逐帧扫描比较
+    double span_s = produce_s;
+    uint64_t from = (uint64_t)(span_s / 3 * 1e9), to = (uint64_t)(span_s * 2 / 3 * 1e9);
+    uint64_t q0 = HostController::nowNs();
+    std::vector<TelemetrySlice> sl = rd.slice(from, to, 1);
+    double slice_us = (HostController::nowNs() - q0) * 1e-3;
+    uint64_t in_slice = 0, brute = 0;
+    for (const TelemetrySlice& x : sl) in_slice += x.end - x.begin;
+    for (const TelemetryBlockRef& b : rd.blocks()) {
+        if (b.device != 1) continue;
+        const int64_t* rx = (const int64_t*)rd.column(b, TLOG_CH_RX_NS);
+        for (uint16_t k = 0; k < b.count; k++) {
+            uint64_t rel = (uint64_t)rx[k] - rd.startMonoNs();
+            if (rel >= from && rel < to) brute++;
+        }
+    }
+    printf("读回：映射 %.1f us（%s），%zu 块，%llu 帧，内容不符 %llu，序号缺口 %llu；关节1切片[%.2fs, %.2fs) %llu 帧"
+           "（逐帧扫描 %llu），%zu 块，%.1f us\n",
+           open_us, rd.indexed() ? "索引" : "扫描块头", rd.blocks().size(), (unsigned long long)logged,
+           (unsigned long long)bad, (unsigned long long)gaps, from * 1e-9, to * 1e-9, (unsigned long long)in_slice,
+           (unsigned long long)brute, sl.size(), slice_us);
+    // 不限速时丢帧是测量结果（写入线程跟不上的程度），只要求读回与入队一致
+    bool consistent = logged == s.frames && gaps == s.dropped && bad == 0 && in_slice == brute &&
+                      s.write_errors == 0;
+    bool ok = consistent && (burst || s.dropped == 0);
+    printf("%s\n", !consistent ? "读回不一致" : s.dropped ? "读回一致（有丢帧）" : "无丢帧，读回一致");
+    return ok ? 0 : 1;
+}
+
+static int cmdRead(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    double from_s = 0, to_s = -1;
+    int device = 0;
+    bool csv = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--from" && i + 1 < argc) {
+            from_s = atof(argv[++i]);
+        } else if (arg == "--to" && i + 1 < argc) {
+            to_s = atof(argv[++i]);
+        } else if (arg == "--id" && i + 1 < argc) {
+            device = atoi(argv[++i]);
+        } else if (arg == "--csv") {
+            csv = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    TelemetryLogReader rd;
+    std::string err;
+    if (!rd.open(argv[2], &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    uint64_t from = from_s > 0 ? (uint64_t)(from_s * 1e9) : 0;
+    uint64_t to = to_s >= 0 ? (uint64_t)(to_s * 1e9) : UINT64_MAX;
+    std::vector<TelemetrySlice> sl = rd.slice(from, to, device);
+
+    if (csv) {
+        printf("device");
+        for (int ch = 0; ch < TLOG_CH_COUNT; ch++) printf(",%s", ch == TLOG_CH_RX_NS ? "t_s" : tlogChannelName(ch));
+        printf("\n");
+        for (const TelemetrySlice& x : sl) {
+            const TelemetryBlockRef& b = *x.block;
+            const void* col[TLOG_CH_COUNT];
+            for (int ch = 0; ch < TLOG_CH_COUNT; ch++) col[ch] = rd.column(b, ch);
+            for (uint16_t k = x.begin; k < x.end; k++) {
+                printf("%d,%.6f,%u,%u", b.device, (((const int64_t*)col[TLOG_CH_RX_NS])[k] - (int64_t)rd.startMonoNs()) * 1e-9,
+                       ((const uint16_t*)col[TLOG_CH_SEQ])[k], ((const uint32_t*)col[TLOG_CH_T_US])[k]);
+                for (int ch = TLOG_CH_ANGLE; ch <= TLOG_CH_TEMPERATURE; ch++) printf(",%g", ((const float*)col[ch])[k]);
+                printf(",%u,%u,%u\n", ((const uint16_t*)col[TLOG_CH_FAULT])[k], ((const uint8_t*)col[TLOG_CH_WATCHDOG])[k],
+                       ((const uint16_t*)col[TLOG_CH_RX_SEQ])[k]);
+            }
+        }
+        return 0;
+    }
+
+    struct Summary {
+        uint64_t frames = 0, gaps = 0;
+        uint64_t first = UINT64_MAX, last = 0;
+        int prev_seq = -1;
+    };
+    std::map<int, Summary> by_dev;
+    for (const TelemetrySlice& x : sl) {
+        const TelemetryBlockRef& b = *x.block;
+        const int64_t* rx = (const int64_t*)rd.column(b, TLOG_CH_RX_NS);
+        const uint16_t* seq = (const uint16_t*)rd.column(b, TLOG_CH_SEQ);
+        Summary& m = by_dev[b.device];
+        for (uint16_t k = x.begin; k < x.end; k++) {
+            if (m.prev_seq >= 0) m.gaps += (uint16_t)(seq[k] - m.prev_seq - 1);
+            m.prev_seq = seq[k];
+            m.first = (uint64_t)rx[k] < m.first ? (uint64_t)rx[k] : m.first;
+            m.last = (uint64_t)rx[k] > m.last ? (uint64_t)rx[k] : m.last;
+            m.frames++;
+        }
+    }
+    printf("%s：%zu 字节，%zu 块（%s），切片 %zu 段\n", argv[2], rd.bytes(), rd.blocks().size(),
+           rd.indexed() ? "带索引" : "无索引，已扫描块头", sl.size());
+    for (auto& kv : by_dev) {
+        const Summary& m = kv.second;
+        double span = (m.last - m.first) * 1e-9;
+        printf("  设备 %2d：%llu 帧，%.3fs..%.3fs（%.1f 帧/s），序号缺口 %llu\n", kv.first, (unsigned long long)m.frames,
+               (m.first - rd.startMonoNs()) * 1e-9, (m.last - rd.startMonoNs()) * 1e-9,
+               span > 0 ? (m.frames - 1) / span : 0.0, (unsigned long long)m.gaps);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string cmd = argc > 1 ? argv[1] : "";
+    if (cmd == "bench") return cmdBench(argc, argv);
+    if (cmd == "read") return cmdRead(argc, argv);
+    usage();
+    return 2;
+}
@@ -0,0 +1,271 @@
+// ============================================================================
+// 文件：traj_main.cpp
+// 功能：轨迹文件工具 - CSV转换、生成示例轨迹、查看文件、按采样率播放
+// 用法：foc_traj convert <输入.csv> <输出.ftj> [--rate Hz] [--float] [--type angle|velocity|current]
+//       foc_traj gen <输出.ftj> [--joints N] [--seconds 秒] [--rate Hz] [--velocity] [--float]
+//       foc_traj info <文件.ftj>
+//       foc_traj play <文件.ftj> [--loops N] [--period us] [--rt 优先级] [--cpu 编号] [--keyframe 轮]
+// 说明：play经回环传输（固件指令层解码）播放，HostController周期默认等于采样周期；
+//       结束时输出播放时长、样本时刻偏差、重复/跳过的样本、唤醒抖动和每周期耗时，
+//       并核对每个虚拟关节最后收到的目标等于轨迹的最后一个样本
+// ============================================================================
+#include "ctl/TrajectoryPlayer.h"
+
+#include <chrono>
+#include <cmath>
+#include <string>
+
+static void usage() {
+    fprintf(stderr,
+            "用法: foc_traj convert <输入.csv> <输出.ftj> [--rate Hz] [--float] [--type angle|velocity|current]\n"
+            "      foc_traj gen <输出.ftj> [--joints N] [--seconds 秒] [--rate Hz] [--velocity] [--float]\n"
+            "      foc_traj info <文件.ftj>\n"
+            "      foc_traj play <文件.ftj> [--loops N] [--period us] [--rt 优先级] [--cpu 编号] [--keyframe 轮]\n");
+}
+
+static const char* typeName(uint8_t t) {
+    return t == DATA_TYPE_VELOCITY ? "velocity" : t == DATA_TYPE_CURRENT ? "current" : "angle";
+}
+
+static double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static int cmdConvert(int argc, char** argv) {
+    if (argc < 4) {
+        usage();
+        return 2;
+    }
+    double rate = 0;
+    uint8_t format = TRAJ_FORMAT_INT16;
+    int type = -1;  // 未指定时使用CSV中的数据类型（每行一个样本的格式为angle）
+    for (int i = 4; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--float") {
+            format = TRAJ_FORMAT_FLOAT32;
+        } else if (arg == "--type" && i + 1 < argc) {
+            std::string t = argv[++i];
+            type = t == "velocity" ? DATA_TYPE_VELOCITY : t == "current" ? DATA_TYPE_CURRENT : DATA_TYPE_ANGLE;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    TrajectoryData d;
+    std::string err;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!trajectoryFromCsv(argv[2], rate, d, &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    double parse_ms = msSince(t0);
+    d.format = format;
+    if (type >= 0) d.data_type = (uint8_t)type;
+    if (!trajectoryWrite(argv[3], d, &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    t0 = std::chrono::steady_clock::now();
+    TrajectoryFile f;
+    if (!f.open(argv[3], &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    f.prefault();
+    double open_ms = msSince(t0);
+    printf("%s → %s：%d 个关节，%llu 个样本 @ %.3fHz（%.1fs），%s，%s%s%s，%zu 字节\n", argv[2], argv[3], f.joints(),
+           (unsigned long long)f.samples(), f.rate(), f.samples() / f.rate(), typeName(f.dataType()),
+           f.format() == TRAJ_FORMAT_INT16 ? "int16" : "float32",
+           (f.columns() & TRAJ_COL_VELOCITY) ? " + 速度列" : "", (f.columns() & TRAJ_COL_FEEDFORWARD) ? " + 前馈列" : "",
+           f.bytes());
+    printf("CSV解析 %.2f ms；轨迹文件映射+预读 %.3f ms\n", parse_ms, open_ms);
+    return 0;
+}
+
+// 示例轨迹：各关节相位错开的慢速摆动叠加一个快速小幅分量
+static int cmdGen(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    int joints = 20;
+    double seconds = 180.0, rate = 100.0;
+    TrajectoryData d;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--joints" && i + 1 < argc) {
+            joints = atoi(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--velocity") {
+            d.columns |= TRAJ_COL_VELOCITY;
+        } else if (arg == "--float") {
+            d.format = TRAJ_FORMAT_FLOAT32;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (joints < 1 || joints > MAX_MOTORS || seconds <= 0 || rate <= 0) {
+        fprintf(stderr, "关节数须为1..%d，时长和采样率须大于0\n", MAX_MOTORS);
+        return 2;
+    }
+    size_t n = (size_t)llround(seconds * rate);
+    if (n == 0) n = 1;
+    d.rate_hz = rate;
+    d.values[TRAJ_KIND_TARGET].assign(joints, std::vector<float>(n));
+    if (d.columns & TRAJ_COL_VELOCITY) d.values[TRAJ_KIND_VELOCITY].assign(joints, std::vector<float>(n));
+    for (int j = 0; j < joints; j++) {
+        d.ids.push_back((uint8_t)(j + 1));
+        double phase = (double)j / joints;
+        for (size_t i = 0; i < n; i++) {
+            double t = i / rate;
+            double a = 2.0 * PI * (0.25 * t + phase), b = 2.0 * PI * 1.1 * t;
+            d.values[TRAJ_KIND_TARGET][j][i] = (float)(30.0 * sin(a) + 5.0 * sin(b));
+            if (d.columns & TRAJ_COL_VELOCITY) {
+                d.values[TRAJ_KIND_VELOCITY][j][i] = (float)(30.0 * 2.0 * PI * 0.25 * cos(a) + 5.0 * 2.0 * PI * 1.1 * cos(b));
+            }
+        }
+    }
+    std::string err;
+    if (!trajectoryWrite(argv[2], d, &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    printf("%s：%d 个关节，%zu 个样本 @ %.1fHz（%.1fs）\n", argv[2], joints, n, rate, n / rate);
+    return 0;
+}
+
+static int cmdInfo(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    TrajectoryFile f;
+    std::string err;
+    if (!f.open(argv[2], &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    printf("%s：版本 %d，%d 个关节，%llu 个样本 @ %.3fHz（%.1fs），%s，%s，%zu 字节\n", argv[2], TRAJ_VERSION, f.joints(),
+           (unsigned long long)f.samples(), f.rate(), f.samples() / f.rate(), typeName(f.dataType()),
+           f.format() == TRAJ_FORMAT_INT16 ? "int16" : "float32", f.bytes());
+    static const char* kinds[TRAJ_KIND_COUNT] = {"目标", "速度", "前馈"};
+    for (int j = 0; j < f.joints(); j++) {
+        printf("  关节 %2d", f.id(j));
+        for (int k = 0; k < TRAJ_KIND_COUNT; k++) {
+            if (!f.column(k, j)) continue;
+            float lo = f.value(k, j, 0), hi = lo;
+            for (uint64_t i = 1; i < f.samples(); i++) {
+                float v = f.value(k, j, i);
+                lo = v < lo ? v : lo;
+                hi = v > hi ? v : hi;
+            }
+            printf("  %s %.2f..%.2f", kinds[k], lo, hi);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+static int cmdPlay(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    uint32_t loops = 1, period_us = 0;
+    HostControllerConfig cfg;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--loops" && i + 1 < argc) {
+            loops = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--period" && i + 1 < argc) {
+            period_us = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--rt" && i + 1 < argc) {
+            cfg.rt_priority = atoi(argv[++i]);
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            cfg.cpu = atoi(argv[++i]);
+        } else if (arg == "--keyframe" && i + 1 < argc) {
+            cfg.delta.keyframe_rounds = (uint32_t)atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (loops == 0) {
+        fprintf(stderr, "播放遍数须大于0\n");
+        return 2;
+    }
+
+    TrajectoryFile f;
+    std::string err;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!f.open(argv[2], &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    f.prefault();
+    double open_ms = msSince(t0);
+
+    uint8_t ids[MAX_MOTORS];
+    for (int j = 0; j < f.joints(); j++) ids[j] = f.id(j);
+    LoopbackTransport loop(ids, f.joints());
+    cfg.period_us = period_us ? period_us : TrajectoryPlayer::periodFor(f);
+    cfg.delta.data_type = f.dataType();
+    HostController ctl(loop, cfg);
+    TrajectoryPlayer player(f, loops);
+    player.attach(ctl);
+
+    printf("播放 %s：%d 个关节，%llu 个样本 @ %.3fHz × %u 遍，控制周期 %uus（映射+预读 %.3f ms）\n", argv[2], f.joints(),
+           (unsigned long long)f.samples(), f.rate(), loops, cfg.period_us, open_ms);
+    ctl.start();
+    while (!player.finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // 再等两个周期，确保最后一个样本已发出并解码
+    std::this_thread::sleep_for(std::chrono::microseconds(2 * (uint64_t)cfg.period_us));
+    ctl.stop();
+
+    const HostControllerStats& s = ctl.stats();
+    const TrajectoryPlayerStats& p = player.stats();
+    const DeltaSenderStats& d = ctl.sender().stats();
+    uint64_t total = (uint64_t)loops * f.samples();
+    double span_s = (p.end_ns - p.start_ns) * 1e-9;
+    double expect_s = (total - 1) / f.rate();
+    printf("样本：写入 %llu / %llu，重复 %llu 周期，跳过 %llu；播放时长 %.4fs（样本时间轴 %.4fs），"
+           "样本时刻最大偏差 %.0fus\n",
+           (unsigned long long)p.samples, (unsigned long long)total, (unsigned long long)p.repeated,
+           (unsigned long long)p.skipped, span_s, expect_s, p.max_offset_ns / 1e3);
+    printf("周期 %llu，超时 %llu；唤醒抖动：平均 %.1fus，p99 ≤%.0fus，最大 %.1fus；每周期处理 平均 %.2fus，最大 %.1fus；"
+           "线程CPU占用 %.2f%%\n",
+           (unsigned long long)s.cycles, (unsigned long long)s.overruns, s.jitter_mean_us, s.jitter_p99_us,
+           s.jitter_max_us, s.busy_mean_us, s.busy_max_us, s.cpu_percent);
+    printf("发送：%llu 包，%llu 字节（%.1f 字节/周期），写入失败 %llu\n", (unsigned long long)d.packets,
+           (unsigned long long)d.bytes, s.cycles ? (double)d.bytes / s.cycles : 0.0,
+           (unsigned long long)s.write_errors);
+
+    // 核对：各虚拟关节最后解码得到的目标等于轨迹最后一个样本（按文件的量化）
+    float scale = ctlScaleFor(f.dataType());
+    int mismatch = 0;
+    for (int j = 0; j < f.joints(); j++) {
+        const LoopbackJoint& lj = loop.joint(j);
+        const void* col = f.column(TRAJ_KIND_TARGET, j);
+        int16_t expect = f.format() == TRAJ_FORMAT_INT16 ? ((const int16_t*)col)[f.samples() - 1]
+                                                          : floatToInt16(((const float*)col)[f.samples() - 1], scale);
+        if (!lj.has_target || lj.invalid || lj.raw != expect) mismatch++;
+    }
+    printf("回环关节：%d 个，最终目标与轨迹末样本不符 %d\n", f.joints(), mismatch);
+    return mismatch || s.write_errors ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    std::string cmd = argc > 1 ? argv[1] : "";
+    if (cmd == "convert") return cmdConvert(argc, argv);
+    if (cmd == "gen") return cmdGen(argc, argv);
+    if (cmd == "info") return cmdInfo(argc, argv);
+    if (cmd == "play") return cmdPlay(argc, argv);
+    usage();
+    return 2;
+}
@@ -0,0 +1,294 @@
+// ============================================================================
+// 文件：vble_bench_main.cpp
+// 功能：虚拟BLE端到端基准 - 上位机控制库经虚拟BLE传输驱动N个关节进程（固件指令层）
+// 用法：foc_vble_bench [--joints N] [--rate Hz] [--seconds 秒] [--telemetry Hz] [--mtu 字节]
+//                      [--interval ms] [--per-event N] [--loss 概率] [--queue N] [--loop us]
+//                      [--full] [--keyframe 轮] [--log 文件] [--seed N]
+// 说明：每个关节一个进程（VirtualBle.h），连接按MTU、连接间隔、每事件包数和丢包模拟。
+//       先经配置包（CONFIG_OP_TELEMETRY）打开各关节的二进制遥测，再由HostController按正弦轨迹
+//       周期发送目标（与foc_ctl_bench相同）；遥测通知在接收线程中解码（--log时同时写入遥测日志）。
+//       端到端延迟：上位机写入序号为s的帧 → 首个rx_seq为s的遥测通知到达上位机
+//       （含两个方向的连接事件等待、固件loop()周期和遥测周期）。
+//       无丢包时核对每个关节的序号连续、无溢出，且最后的目标与上位机最后发送的一致
+// ============================================================================
+#include "ctl/HostController.h"
+#include "ctl/TelemetryLogger.h"
+#include "ctl/VirtualBle.h"
+
+#include <chrono>
+#include <string>
+
+#define VBLE_LAT_BIN_US 10          //!< 延迟直方图档宽
+#define VBLE_LAT_BINS 100000        //!< 档数（末档为溢出，上限1s）
+
+// 记录每条连接各序号的写入时刻，再转交虚拟BLE传输
+class TimedTransport : public HostTransport {
+public:
+    TimedTransport(VirtualBleTransport& t) : inner(t), write_ns(new std::atomic<uint64_t>[t.links() * 65536]) {
+        for (size_t i = 0; i < (size_t)t.links() * 65536; i++) write_ns[i].store(0, std::memory_order_relaxed);
+    }
+    int links() const override { return inner.links(); }
+    bool write(int link, const uint8_t* data, size_t len) override {
+        if (len >= 3 && data[0] == BLE_SEQ_PREFIX) {
+            uint16_t seq = (uint16_t)((data[1] << 8) | data[2]);
+            write_ns[(size_t)link * 65536 + seq].store(HostController::nowNs(), std::memory_order_relaxed);
+        }
+        return inner.write(link, data, len);
+    }
+    size_t poll(HostReplyFn fn, void* ctx) override { return inner.poll(fn, ctx); }
+    uint64_t writeNs(int link, uint16_t seq) const {
+        return write_ns[(size_t)link * 65536 + seq].load(std::memory_order_relaxed);
+    }
+
+private:
+    VirtualBleTransport& inner;
+    std::unique_ptr<std::atomic<uint64_t>[]> write_ns;
+};
+
+// 接收线程一侧的统计
+struct NotifyCtx {
+    TimedTransport* timed;
+    TelemetryLogger* logger;
+    std::vector<int> last_rx_seq;       //!< 各连接最近的rx_seq（-1为未收到）
+    std::vector<uint64_t> telemetry;    //!< 各连接收到的遥测
+    std::vector<uint32_t> hist;         //!< 端到端延迟直方图
+    uint64_t samples = 0, bad = 0;
+    double sum_us = 0, max_us = 0;
+};
+
+static void onNotify(void* ctx, int link, const uint8_t* data, size_t len, uint64_t rx_ns) {
+    NotifyCtx& n = *(NotifyCtx*)ctx;
+    if (n.logger) n.logger->ingest(link, data, len, rx_ns);
+    uint16_t seq;
+    Telemetry t;
+    if (len != TELEMETRY_SIZE + 1 || !telemetryDecode(data + 1, len - 1, &seq, &t)) {
+        n.bad++;
+        return;
+    }
+    n.telemetry[link]++;
+    if (t.rx_seq == n.last_rx_seq[link]) return;
+    n.last_rx_seq[link] = t.rx_seq;
+    uint64_t w = n.timed->writeNs(link, t.rx_seq);
+    if (w == 0 || w > rx_ns) return;  // 该序号尚未写入过（固件的初始rx_seq）
+    double us = (rx_ns - w) / 1e3;
+    n.samples++;
+    n.sum_us += us;
+    if (us > n.max_us) n.max_us = us;
+    size_t bin = (size_t)(us / VBLE_LAT_BIN_US);
+    n.hist[bin < VBLE_LAT_BINS ? bin : VBLE_LAT_BINS - 1]++;
+}
+
+static double histPercentile(const std::vector<uint32_t>& hist, uint64_t total, double p) {
+    uint64_t need = (uint64_t)(total * p + 0.999999), seen = 0;
+    for (size_t b = 0; b < hist.size(); b++) {
+        seen += hist[b];
+        if (seen >= need && need > 0) return (double)(b + 1) * VBLE_LAT_BIN_US;  // 档上沿
+    }
+    return 0;
+}
+
+struct WaveCtx {
+    int joints;
+    double freq_hz;
+    double amp_deg;
+    uint64_t t0_ns;
+};
+
+static void waveCycle(void* ctx, HostController& c, uint64_t cycle, uint64_t t_ns) {
+    WaveCtx& w = *(WaveCtx*)ctx;
+    (void)cycle;
+    if (w.t0_ns == 0) w.t0_ns = t_ns;
+    double t = (t_ns - w.t0_ns) * 1e-9;
+    for (int j = 1; j <= w.joints; j++) {
+        c.setTarget((uint8_t)j, (float)(w.amp_deg * sin(2.0 * PI * (w.freq_hz * t + (double)j / w.joints))));
+    }
+}
+
+static void usage() {
+    fprintf(stderr, "用法: foc_vble_bench [--joints N] [--rate Hz] [--seconds 秒] [--telemetry Hz] [--mtu 字节] "
+                    "[--interval ms] [--per-event N] [--loss 概率] [--queue N] [--loop us] [--full] [--keyframe 轮] "
+                    "[--log 文件] [--seed N]\n");
+}
+
+int main(int argc, char** argv) {
+    int joints = 20;
+    double rate = 100.0, seconds = 5.0;
+    uint32_t telemetry_hz = 200;
+    std::string log_path;
+    VirtualBleConfig vcfg;
+    HostControllerConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--joints" && i + 1 < argc) {
+            joints = atoi(argv[++i]);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            telemetry_hz = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--mtu" && i + 1 < argc) {
+            vcfg.mtu = (uint16_t)atoi(argv[++i]);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            vcfg.interval_us = (uint32_t)(atof(argv[++i]) * 1000);
+        } else if (arg == "--per-event" && i + 1 < argc) {
+            vcfg.packets_per_event = (uint8_t)atoi(argv[++i]);
+        } else if (arg == "--loss" && i + 1 < argc) {
+            vcfg.loss = atof(argv[++i]);
+        } else if (arg == "--queue" && i + 1 < argc) {
+            vcfg.queue_depth = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--loop" && i + 1 < argc) {
+            vcfg.loop_us = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--full") {
+            cfg.delta.keyframe_rounds = 1;
+        } else if (arg == "--keyframe" && i + 1 < argc) {
+            cfg.delta.keyframe_rounds = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--log" && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            vcfg.seed = (uint32_t)atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (joints < 1 || joints > MAX_MOTORS || rate <= 0 || seconds <= 0 || vcfg.mtu < 23 || vcfg.mtu > 517 ||
+        vcfg.interval_us < 7500 || vcfg.packets_per_event < 1 || telemetry_hz > 5000) {
+        fprintf(stderr, "关节数须为1..%d，频率和时长须大于0，MTU为23..517，连接间隔不小于7.5ms，每事件至少1包，"
+                        "遥测不超过5000Hz\n", MAX_MOTORS);
+        return 2;
+    }
+    cfg.period_us = (uint32_t)(1e6 / rate);
+    // 单包不超过一次写入的载荷（MTU-3）减去序号前缀
+    if (cfg.delta.max_packet > (size_t)vcfg.mtu - 3 - CTL_HEADROOM) cfg.delta.max_packet = vcfg.mtu - 3 - CTL_HEADROOM;
+
+    uint8_t ids[MAX_MOTORS];
+    for (int j = 0; j < joints; j++) ids[j] = (uint8_t)(j + 1);
+    VirtualBleTransport vble(ids, joints, vcfg);
+    TimedTransport timed(vble);
+    NotifyCtx nc;
+    nc.timed = &timed;
+    nc.logger = nullptr;
+    nc.last_rx_seq.assign(joints, -1);
+    nc.telemetry.assign(joints, 0);
+    nc.hist.assign(VBLE_LAT_BINS, 0);
+    vble.setNotifyHandler(onNotify, &nc);
+    std::string err;
+    if (!vble.start(&err)) {  // 先fork关节进程，再启动其他线程
+        fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+
+    TelemetryLoggerConfig lcfg;
+    lcfg.links = joints;
+    TelemetryLogger logger(lcfg);
+    if (!log_path.empty()) {
+        if (!logger.open(log_path.c_str(), &err)) {
+            fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        for (int j = 0; j < joints; j++) logger.setDevice(j, ids[j]);
+        nc.logger = &logger;
+    }
+
+    // 经配置包打开各关节的二进制遥测（与真实设备相同，走同一条模拟连接）
+    uint8_t pkt[CTL_PACKET_MAX];
+    for (int j = 0; j < joints; j++) {
+        size_t n = ctlPackConfig(pkt, sizeof(pkt), CONFIG_OP_TELEMETRY, ids[j], (int)(telemetry_hz >> 8),
+                                 (int)(telemetry_hz & 0xFF));
+        timed.write(j, pkt, n);
+    }
+
+    HostController ctl(timed, cfg);
+    WaveCtx wave = {joints, 0.5, 30.0, 0};
+    ctl.setCycleHook(waveCycle, &wave);
+    uint64_t w0 = HostController::nowNs();
+    ctl.start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    ctl.stop();
+    double wall_s = (HostController::nowNs() - w0) * 1e-9;
+    vble.stop();  // 关节进程在在途的写入都解析后回报
+    if (!log_path.empty()) logger.close();
+
+    const HostControllerStats& s = ctl.stats();
+    const DeltaSenderStats& d = ctl.sender().stats();
+    printf("虚拟BLE：%d 个关节进程，MTU %u，连接间隔 %.2fms，每事件 %u 包，丢包 %.3f，队列 %u，关节loop %uus\n",
+           joints, vcfg.mtu, vcfg.interval_us / 1e3, vcfg.packets_per_event, vcfg.loss, vcfg.queue_depth,
+           vcfg.loop_us);
+    printf("上位机：%.0fHz（%s），%.1fs，周期 %llu，跳过 %llu，唤醒抖动 平均 %.1fus / 最大 %.1fus，每周期处理 平均 %.2fus\n",
+           rate, cfg.delta.keyframe_rounds == 1 ? "每周期全量" : "增量发送", seconds, (unsigned long long)s.cycles,
+           (unsigned long long)s.overruns, s.jitter_mean_us, s.jitter_max_us, s.busy_mean_us);
+    printf("发送：%llu 包，%llu 字节，写入 %llu 次（失败 %llu），回复 %llu 条（确认 %llu，过期 %llu，重发条目 %llu）\n",
+           (unsigned long long)d.packets, (unsigned long long)d.bytes, (unsigned long long)s.writes,
+           (unsigned long long)s.write_errors, (unsigned long long)s.replies, (unsigned long long)d.acks,
+           (unsigned long long)d.stale_acks, (unsigned long long)d.resends);
+
+    VirtualBleLinkStats sum = {};
+    uint64_t accepted = 0, fw_frames = 0, seq_lost = 0, invalid = 0, rx_ovf = 0, telemetry = 0, loops = 0;
+    int reported = 0, mismatch = 0;
+    float scale = ctlScaleFor(cfg.delta.data_type);
+    for (int j = 0; j < joints; j++) {
+        VirtualBleLinkStats l = vble.stats(j);
+        const VirtualBleJointReport& r = vble.report(j);
+        VirtualBleDirStats* dirs[2][2] = {{&sum.down, &l.down}, {&sum.up, &l.up}};
+        for (auto& dd : dirs) {
+            dd[0]->sent += dd[1]->sent;
+            dd[0]->oversize += dd[1]->oversize;
+            dd[0]->delivered += dd[1]->delivered;
+            dd[0]->lost += dd[1]->lost;
+            dd[0]->overflow += dd[1]->overflow;
+            dd[0]->delay_sum_ns += dd[1]->delay_sum_ns;
+            if (dd[1]->delay_max_ns > dd[0]->delay_max_ns) dd[0]->delay_max_ns = dd[1]->delay_max_ns;
+        }
+        sum.write_errors += l.write_errors;
+        sum.notifies += l.notifies;
+        sum.replies += l.replies;
+        telemetry += nc.telemetry[j];
+        if (!r.valid) continue;
+        reported++;
+        loops += r.loops;
+        fw_frames += r.link.frames;
+        accepted += r.link.accepted;
+        seq_lost += r.link.seq_lost + r.link.seq_stale;
+        invalid += r.link.invalid;
+        rx_ovf += r.rx.overflows + r.rx.oversize;
+        if (r.id != ids[j] || fabsf(r.target - ctl.sender().lastSent(ids[j]) / scale) > 0.5f / scale) mismatch++;
+    }
+    auto dirLine = [](const char* name, const VirtualBleDirStats& x) {
+        printf("  %s：发送 %llu，送达 %llu，丢失 %llu，队列满 %llu，超MTU %llu；等待连接事件 平均 %.2fms，最大 %.2fms\n",
+               name, (unsigned long long)x.sent, (unsigned long long)x.delivered, (unsigned long long)x.lost,
+               (unsigned long long)x.overflow, (unsigned long long)x.oversize,
+               x.delivered ? x.delay_sum_ns / 1e6 / x.delivered : 0.0, x.delay_max_ns / 1e6);
+    };
+    printf("连接：\n");
+    dirLine("上位机→关节", sum.down);
+    dirLine("关节→上位机", sum.up);
+    printf("吞吐：写入 %.0f 帧/s，固件分发 %.0f 帧/s（含本关节指令 %.0f），遥测通知 %.0f 帧/s，文本回复 %.0f 条/s；"
+           "套接字写入失败 %llu，回复队列溢出 %llu\n",
+           sum.down.sent / wall_s, fw_frames / wall_s, accepted / wall_s, telemetry / wall_s, sum.replies / wall_s,
+           (unsigned long long)sum.write_errors, (unsigned long long)vble.replyOverflows());
+    printf("端到端延迟（写入 → 遥测rx_seq回显，%llu 个样本）：平均 %.2fms，p50 ≤%.2fms，p99 ≤%.2fms，最大 %.2fms\n",
+           (unsigned long long)nc.samples, nc.samples ? nc.sum_us / nc.samples / 1e3 : 0.0,
+           histPercentile(nc.hist, nc.samples, 0.5) / 1e3, histPercentile(nc.hist, nc.samples, 0.99) / 1e3,
+           nc.max_us / 1e3);
+    printf("关节进程：回报 %d/%d，loop() %.0f 次/s/关节，CPU合计 %.1f%%；序号丢失/过期 %llu，无效帧 %llu，"
+           "接收FIFO溢出 %llu，目标与上位机不符 %d，遥测解码失败 %llu\n",
+           reported, joints, reported ? loops / wall_s / reported : 0.0, 100.0 * vble.childCpuSeconds() / wall_s,
+           (unsigned long long)seq_lost, (unsigned long long)invalid, (unsigned long long)rx_ovf, mismatch,
+           (unsigned long long)nc.bad);
+    if (sum.up.oversize > 0) {
+        printf("注意：MTU %u 时通知载荷最多 %u 字节，遥测通知（%u 字节）被截断，需要MTU不小于 %u\n", vcfg.mtu,
+               vcfg.mtu - 3, TELEMETRY_SIZE + 1, TELEMETRY_SIZE + 4);
+    }
+    if (!log_path.empty()) {
+        TelemetryLoggerStats ls = logger.stats();
+        printf("遥测日志 %s：%llu 帧，%llu 块，%llu 字节，丢弃 %llu\n", log_path.c_str(), (unsigned long long)ls.frames,
+               (unsigned long long)ls.blocks, (unsigned long long)ls.bytes, (unsigned long long)ls.dropped);
+    }
+
+    // 有丢包/溢出/截断时丢帧是测量结果；没有时要求整条链路无损且目标一致
+    bool lossless = vcfg.loss == 0 && sum.down.overflow == 0 && sum.down.oversize == 0 && rx_ovf == 0;
+    bool ok = reported == joints && invalid == 0 && (nc.bad == 0 || sum.up.oversize > 0) && sum.write_errors == 0 &&
+              (!lossless || (seq_lost == 0 && mismatch == 0));
+    return ok ? 0 : 1;
+}
@@ -11,7 +11,7 @@ LowPassFilter::LowPassFilter(float time_constant)
     , y_prev(0.0f)          // 初始化前一次输出值为0
 {
     // 记录初始时间戳，用于计算时间间隔
-    timestamp_prev = micros();  // 获取当前微秒时间戳
+    timestamp_prev = halMicros();  // 获取当前微秒时间戳
 }
 
 // ============================================================================
@@ -24,7 +24,7 @@ LowPassFilter::LowPassFilter(float time_constant)
 float LowPassFilter::operator() (float x)
 {
     // 获取当前时间戳
-    unsigned long timestamp = micros();
+    uint32_t timestamp = halMicros();
     
     // 计算时间间隔（秒）：当前时间 - 上次时间
     float dt = (timestamp - timestamp_prev) * 1e-6f;  // 微秒转换为秒
@@ -1,4 +1,4 @@
-#include <Arduino.h> 
+#include "HAL.h"
 
 // ============================================================================
 // 头文件保护宏：防止重复包含
@@ -49,11 +49,11 @@ public:
 protected:
     // ============================================================================
     // 保护成员变量：timestamp_prev
-    // 类型：unsigned long
+    // 类型：uint32_t
     // 功能：记录上一次滤波器执行的时间戳（微秒）
     // 说明：用于计算时间间隔，实现自适应滤波系数
     // ============================================================================
-    unsigned long timestamp_prev;  //!< 最后执行时间戳
+    uint32_t timestamp_prev;  //!< 最后执行时间戳
     
     // ============================================================================
     // 保护成员变量：y_prev
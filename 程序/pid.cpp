@@ -1,5 +1,5 @@
 #include "pid.h"
-#include <Arduino.h>
+#include "HAL.h"
 
 // ============================================================================
 // 宏定义：_constrain
@@ -31,7 +31,7 @@ PIDController::PIDController(float P, float I, float D, float ramp, float limit)
     , integral_prev(0.0f)     // 初始化前次积分项为0
 {
     // 记录初始时间戳，用于计算采样周期
-    timestamp_prev = micros();  // 获取当前微秒时间戳
+    timestamp_prev = halMicros();  // 获取当前微秒时间戳
 }
 
 // ============================================================================
@@ -47,7 +47,7 @@ float PIDController::operator() (float error){
     // ============================================================================
     
     // 获取当前时间戳
-    unsigned long timestamp_now = micros();
+    uint32_t timestamp_now = halMicros();
     
     // 计算采样周期（秒）：当前时间 - 上次时间
     float Ts = (timestamp_now - timestamp_prev) * 1e-6f;  // 微秒转换为秒
@@ -115,4 +115,16 @@ float PIDController::operator() (float error){
     
     // 返回PID控制器输出
     return output;
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// 函数：reset
+// 功能：清除控制器历史状态
+// 说明：时间戳同时更新，下一次计算的采样周期从复位时刻开始
+// ============================================================================
+void PIDController::reset() {
+    error_prev = 0.0f;
+    output_prev = 0.0f;
+    integral_prev = 0.0f;
+    timestamp_prev = halMicros();
+}
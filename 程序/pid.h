@@ -4,6 +4,8 @@
 #ifndef PID_H
 #define PID_H
 
+#include "HAL.h"
+
 // ============================================================================
 // 类定义：PIDController
 // 功能：PID控制器类，实现比例-积分-微分控制算法
@@ -41,6 +43,13 @@ public:
     // ============================================================================
     float operator() (float error);
 
+    // ============================================================================
+    // 函数：reset
+    // 功能：清除控制器历史状态（积分、上次误差和输出）
+    // 说明：故障清除后重新投入控制时调用，避免停机期间的旧状态造成输出突变
+    // ============================================================================
+    void reset();
+
     // ============================================================================
     // 公共成员变量：PID参数和限制
     // ============================================================================
@@ -61,7 +70,7 @@ protected:
     float error_prev;        //!< 最后的跟踪误差值 - 上一次的控制误差
     float output_prev;       //!< 最后一个pid输出值 - 上一次的控制器输出
     float integral_prev;     //!< 最后一个积分分量值 - 上一次的积分项累积值
-    unsigned long timestamp_prev; //!< 上次执行时间戳 - 记录上一次计算的时间（微秒）
+    uint32_t timestamp_prev; //!< 上次执行时间戳 - 记录上一次计算的时间（微秒）
 
 };
 